@@ -0,0 +1,522 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "graph/node_binary.h"
+#include "render/attribute.h"
+#include "render/background.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/shader.h"
+#include "render/scene.h"
+#include "subd/subd_dice.h"
+#include "util/util_algorithm.h"
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+#include "util/util_transform.h"
+
+#include "app/cycles_binary.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File Layout
+ *
+ * Header, followed by film, integrator, background and camera settings, all
+ * shaders with their graphs, meshes, objects and lights. Nodes are stored
+ * through their sockets, mesh data which is not exposed as sockets is stored
+ * explicitly. Geometry arrays are stored as raw memory, so loading them is a
+ * single copy out of the mapped file. */
+
+static const char binary_magic[8] = {'C', 'Y', 'C', 'L', 'E', 'S', 'B', 'N'};
+static const uint binary_version = 1;
+
+/* Shader Graph */
+
+static bool binary_skip_shader_node(const ShaderNode *node)
+{
+	/* OSL script nodes have types created at runtime from the compiled
+	 * shader, which can not be recreated from the type name. */
+	return node->special_type == SHADER_SPECIAL_TYPE_SCRIPT;
+}
+
+static void binary_write_shader_graph(BinaryWriter& writer, const ShaderGraph *graph)
+{
+	map<const ShaderNode*, uint> node_index;
+	foreach(const ShaderNode *node, graph->nodes) {
+		if(binary_skip_shader_node(node)) {
+			fprintf(stderr, "Skipping OSL node \"%s\", not supported in binary files.\n", node->name.c_str());
+			continue;
+		}
+		const uint index = node_index.size();
+		node_index[node] = index;
+	}
+
+	writer.write((uint)node_index.size());
+	foreach(const ShaderNode *node, graph->nodes) {
+		if(node_index.find(node) == node_index.end()) {
+			continue;
+		}
+		writer.write_string(node->type->name.string());
+		binary_write_node(writer, node);
+	}
+
+	/* Links as node and socket index pairs. */
+	vector<uint> links;
+	foreach(const ShaderNode *node, graph->nodes) {
+		if(node_index.find(node) == node_index.end()) {
+			continue;
+		}
+		for(size_t i = 0; i < node->inputs.size(); i++) {
+			const ShaderOutput *from = node->inputs[i]->link;
+			if(!from || node_index.find(from->parent) == node_index.end()) {
+				continue;
+			}
+			const ShaderNode *from_node = from->parent;
+			const size_t from_socket = std::find(from_node->outputs.begin(),
+			                                     from_node->outputs.end(),
+			                                     from) - from_node->outputs.begin();
+
+			links.push_back(node_index[from_node]);
+			links.push_back(from_socket);
+			links.push_back(node_index[node]);
+			links.push_back(i);
+		}
+	}
+
+	writer.write((uint)(links.size() / 4));
+	if(!links.empty()) {
+		writer.write(&links[0], sizeof(uint)*links.size());
+	}
+}
+
+static ShaderGraph *binary_read_shader_graph(BinaryReader& reader)
+{
+	ShaderGraph *graph = new ShaderGraph();
+	OutputNode *output = graph->output();
+
+	uint num_nodes;
+	if(!reader.read(num_nodes)) {
+		delete graph;
+		return NULL;
+	}
+
+	vector<ShaderNode*> nodes;
+	for(uint i = 0; i < num_nodes; i++) {
+		string type_name;
+		if(!reader.read_string(type_name)) {
+			delete graph;
+			return NULL;
+		}
+
+		const NodeType *node_type = NodeType::find(ustring(type_name));
+		if(!node_type || node_type->type != NodeType::SHADER) {
+			fprintf(stderr, "Unknown shader node \"%s\".\n", type_name.c_str());
+			delete graph;
+			return NULL;
+		}
+
+		ShaderNode *snode = (node_type == output->type)?
+		                    output:
+		                    graph->add((ShaderNode*)node_type->create(node_type));
+		if(!binary_read_node(reader, snode)) {
+			delete graph;
+			return NULL;
+		}
+		nodes.push_back(snode);
+	}
+
+	uint num_links;
+	if(!reader.read(num_links)) {
+		delete graph;
+		return NULL;
+	}
+
+	for(uint i = 0; i < num_links; i++) {
+		uint link[4];
+		if(!reader.read(link)) {
+			delete graph;
+			return NULL;
+		}
+
+		if(link[0] >= nodes.size() || link[1] >= nodes[link[0]]->outputs.size() ||
+		   link[2] >= nodes.size() || link[3] >= nodes[link[2]]->inputs.size())
+		{
+			fprintf(stderr, "Invalid shader node link.\n");
+			continue;
+		}
+
+		graph->connect(nodes[link[0]]->outputs[link[1]], nodes[link[2]]->inputs[link[3]]);
+	}
+
+	return graph;
+}
+
+/* Mesh */
+
+static void binary_write_attributes(BinaryWriter& writer, const AttributeSet& attributes)
+{
+	vector<const Attribute*> write_attributes;
+	foreach(const Attribute& attr, attributes.attributes) {
+		/* Voxel attributes refer to image slots of the current session. */
+		if(attr.element != ATTR_ELEMENT_VOXEL) {
+			write_attributes.push_back(&attr);
+		}
+	}
+
+	writer.write((uint)write_attributes.size());
+	foreach(const Attribute *attr, write_attributes) {
+		writer.write_string(attr->name.string());
+		writer.write((int)attr->std);
+		writer.write((int)attr->type.basetype);
+		writer.write((int)attr->type.aggregate);
+		writer.write((int)attr->type.vecsemantics);
+		writer.write((int)attr->type.arraylen);
+		writer.write((int)attr->element);
+		writer.write(attr->flags);
+		writer.write((uint64_t)attr->buffer.size());
+		writer.write(attr->data(), attr->buffer.size());
+	}
+}
+
+static bool binary_read_attributes(BinaryReader& reader, AttributeSet& attributes)
+{
+	uint num_attributes;
+	if(!reader.read(num_attributes)) {
+		return false;
+	}
+
+	for(uint i = 0; i < num_attributes; i++) {
+		string name;
+		int std, basetype, aggregate, vecsemantics, arraylen, element;
+		uint flags;
+		uint64_t buffer_size;
+		if(!reader.read_string(name) ||
+		   !reader.read(std) ||
+		   !reader.read(basetype) ||
+		   !reader.read(aggregate) ||
+		   !reader.read(vecsemantics) ||
+		   !reader.read(arraylen) ||
+		   !reader.read(element) ||
+		   !reader.read(flags) ||
+		   !reader.read(buffer_size) ||
+		   buffer_size > reader.size - reader.offset)
+		{
+			return false;
+		}
+
+		TypeDesc type((TypeDesc::BASETYPE)basetype,
+		              (TypeDesc::AGGREGATE)aggregate,
+		              (TypeDesc::VECSEMANTICS)vecsemantics,
+		              arraylen);
+		Attribute *attr = attributes.add(ustring(name), type, (AttributeElement)element);
+		attr->std = (AttributeStandard)std;
+		attr->flags = flags;
+		attr->buffer.resize(buffer_size);
+		if(!reader.read(attr->data(), buffer_size)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void binary_write_mesh(BinaryWriter& writer, const Mesh *mesh)
+{
+	binary_write_node(writer, mesh);
+
+	writer.write((uint)mesh->used_shaders.size());
+	foreach(const Shader *shader, mesh->used_shaders) {
+		writer.write(writer.node_index(shader));
+	}
+
+	writer.write((int)mesh->subdivision_type);
+	writer.write_array(mesh->subd_faces);
+	writer.write_array(mesh->subd_face_corners);
+	writer.write(mesh->num_ngons);
+	writer.write_array(mesh->subd_creases);
+
+	writer.write((uint8_t)(mesh->subd_params != NULL));
+	if(mesh->subd_params) {
+		writer.write(mesh->subd_params->dicing_rate);
+		writer.write(mesh->subd_params->max_level);
+		writer.write(mesh->subd_params->objecttoworld);
+	}
+
+	binary_write_attributes(writer, mesh->attributes);
+	binary_write_attributes(writer, mesh->subd_attributes);
+}
+
+static bool binary_read_mesh(BinaryReader& reader, Scene *scene, Mesh *mesh)
+{
+	if(!binary_read_node(reader, mesh)) {
+		return false;
+	}
+
+	uint num_shaders;
+	if(!reader.read(num_shaders)) {
+		return false;
+	}
+	for(uint i = 0; i < num_shaders; i++) {
+		int index;
+		if(!reader.read(index)) {
+			return false;
+		}
+		Node *shader = reader.node(index);
+		if(shader && shader->type == Shader::node_type) {
+			mesh->used_shaders.push_back((Shader*)shader);
+		}
+		else {
+			mesh->used_shaders.push_back(scene->default_surface);
+		}
+	}
+
+	int subdivision_type;
+	uint8_t has_subd_params;
+	if(!reader.read(subdivision_type) ||
+	   !reader.read_array(mesh->subd_faces) ||
+	   !reader.read_array(mesh->subd_face_corners) ||
+	   !reader.read(mesh->num_ngons) ||
+	   !reader.read_array(mesh->subd_creases) ||
+	   !reader.read(has_subd_params))
+	{
+		return false;
+	}
+	mesh->subdivision_type = (Mesh::SubdivisionType)subdivision_type;
+
+	if(has_subd_params) {
+		if(!mesh->subd_params) {
+			mesh->subd_params = new SubdParams(mesh);
+		}
+		SubdParams& sdparams = *mesh->subd_params;
+		if(!reader.read(sdparams.dicing_rate) ||
+		   !reader.read(sdparams.max_level) ||
+		   !reader.read(sdparams.objecttoworld))
+		{
+			return false;
+		}
+		sdparams.camera = scene->camera;
+	}
+
+	return binary_read_attributes(reader, mesh->attributes) &&
+	       binary_read_attributes(reader, mesh->subd_attributes);
+}
+
+/* File */
+
+bool binary_is_file(const char *filepath)
+{
+	FILE *file = path_fopen(filepath, "rb");
+	if(!file) {
+		return false;
+	}
+
+	char magic[sizeof(binary_magic)];
+	const bool match = (fread(magic, sizeof(magic), 1, file) == 1) &&
+	                   (memcmp(magic, binary_magic, sizeof(magic)) == 0);
+	fclose(file);
+	return match;
+}
+
+bool binary_write_file(Scene *scene, const char *filepath)
+{
+	FILE *file = path_fopen(filepath, "wb");
+	if(!file) {
+		fprintf(stderr, "%s write error: could not open file.\n", filepath);
+		return false;
+	}
+
+	BinaryWriter writer(file);
+	writer.write(binary_magic, sizeof(binary_magic));
+	writer.write(binary_version);
+
+	binary_write_node(writer, scene->film);
+	binary_write_node(writer, scene->integrator);
+	binary_write_node(writer, scene->background);
+
+	writer.write(scene->camera->width);
+	writer.write(scene->camera->height);
+	binary_write_node(writer, scene->camera);
+
+	writer.write((uint)scene->shaders.size());
+	foreach(const Shader *shader, scene->shaders) {
+		binary_write_node(writer, shader);
+		writer.write((uint8_t)(shader->graph != NULL));
+		if(shader->graph) {
+			binary_write_shader_graph(writer, shader->graph);
+		}
+	}
+
+	writer.write((uint)scene->meshes.size());
+	foreach(const Mesh *mesh, scene->meshes) {
+		binary_write_mesh(writer, mesh);
+	}
+
+	writer.write((uint)scene->objects.size());
+	foreach(const Object *object, scene->objects) {
+		binary_write_node(writer, object);
+	}
+
+	writer.write((uint)scene->lights.size());
+	foreach(const Light *light, scene->lights) {
+		binary_write_node(writer, light);
+	}
+
+	fclose(file);
+
+	if(writer.error) {
+		fprintf(stderr, "%s write error: could not write file.\n", filepath);
+		path_remove(filepath);
+		return false;
+	}
+
+	return true;
+}
+
+static bool binary_read_scene(BinaryReader& reader, Scene *scene)
+{
+	char magic[sizeof(binary_magic)];
+	uint version = 0;
+	if(!reader.read(magic) || memcmp(magic, binary_magic, sizeof(magic)) != 0) {
+		fprintf(stderr, "Not a Cycles binary file.\n");
+		return false;
+	}
+	if(!reader.read(version)) {
+		return false;
+	}
+	if(version != binary_version) {
+		fprintf(stderr, "Unsupported binary file version %u.\n", version);
+		return false;
+	}
+
+	if(!binary_read_node(reader, scene->film) ||
+	   !binary_read_node(reader, scene->integrator) ||
+	   !binary_read_node(reader, scene->background))
+	{
+		return false;
+	}
+
+	/* Camera */
+	Camera *cam = scene->camera;
+	if(!reader.read(cam->width) ||
+	   !reader.read(cam->height) ||
+	   !binary_read_node(reader, cam))
+	{
+		return false;
+	}
+	cam->full_width = cam->width;
+	cam->full_height = cam->height;
+	cam->need_update = true;
+	cam->update(scene);
+
+	/* Shaders, the default shaders of the scene are written first. */
+	uint num_shaders;
+	if(!reader.read(num_shaders)) {
+		return false;
+	}
+	const size_t num_existing_shaders = scene->shaders.size();
+	for(uint i = 0; i < num_shaders; i++) {
+		Shader *shader;
+		if(i < num_existing_shaders) {
+			shader = scene->shaders[i];
+		}
+		else {
+			shader = new Shader();
+			scene->shaders.push_back(shader);
+		}
+
+		uint8_t has_graph;
+		if(!binary_read_node(reader, shader) || !reader.read(has_graph)) {
+			return false;
+		}
+		if(has_graph) {
+			ShaderGraph *graph = binary_read_shader_graph(reader);
+			if(!graph) {
+				return false;
+			}
+			shader->set_graph(graph);
+		}
+		shader->tag_update(scene);
+	}
+
+	/* Meshes */
+	uint num_meshes;
+	if(!reader.read(num_meshes)) {
+		return false;
+	}
+	for(uint i = 0; i < num_meshes; i++) {
+		Mesh *mesh = new Mesh();
+		scene->meshes.push_back(mesh);
+		if(!binary_read_mesh(reader, scene, mesh)) {
+			return false;
+		}
+	}
+
+	/* Objects */
+	uint num_objects;
+	if(!reader.read(num_objects)) {
+		return false;
+	}
+	for(uint i = 0; i < num_objects; i++) {
+		Object *object = new Object();
+		scene->objects.push_back(object);
+		if(!binary_read_node(reader, object)) {
+			return false;
+		}
+	}
+
+	/* Lights */
+	uint num_lights;
+	if(!reader.read(num_lights)) {
+		return false;
+	}
+	for(uint i = 0; i < num_lights; i++) {
+		Light *light = new Light();
+		light->shader = scene->default_light;
+		scene->lights.push_back(light);
+		if(!binary_read_node(reader, light)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool binary_read_file(Scene *scene, const char *filepath)
+{
+	BinaryReader reader;
+	if(!reader.open(filepath)) {
+		fprintf(stderr, "%s read error: could not open file.\n", filepath);
+		return false;
+	}
+
+	if(!binary_read_scene(reader, scene)) {
+		fprintf(stderr, "%s read error: invalid or truncated file.\n", filepath);
+		return false;
+	}
+
+	scene->params.bvh_type = SceneParams::BVH_STATIC;
+
+	return true;
+}
+
+CCL_NAMESPACE_END
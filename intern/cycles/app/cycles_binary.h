@@ -0,0 +1,32 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CYCLES_BINARY_H__
+#define __CYCLES_BINARY_H__
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+
+/* Binary scene cache, written from an already loaded scene so following
+ * renders can skip XML parsing. Only readable by the same build. */
+bool binary_is_file(const char *filepath);
+bool binary_read_file(Scene *scene, const char *filepath);
+bool binary_write_file(Scene *scene, const char *filepath);
+
+CCL_NAMESPACE_END
+
+#endif  /* __CYCLES_BINARY_H__ */
@@ -18,6 +18,7 @@
 
 #include "render/buffers.h"
 #include "render/camera.h"
+#include "render/denoising.h"
 #include "device/device.h"
 #include "render/scene.h"
 #include "render/session.h"
@@ -30,6 +31,7 @@
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_string.h"
+#include "util/util_task.h"
 #include "util/util_time.h"
 #include "util/util_transform.h"
 #include "util/util_unique_ptr.h"
@@ -39,6 +41,7 @@
 #include "util/util_view.h"
 #endif
 
+#include "app/cycles_binary.h"
 #include "app/cycles_xml.h"
 
 CCL_NAMESPACE_BEGIN
@@ -53,6 +56,16 @@ struct Options {
 	bool quiet;
 	bool show_help, interactive, pause;
 	string output_path;
+	string binary_path;
+	/* Denoising of previously rendered frames. */
+	bool denoise;
+	vector<string> denoise_filepaths;
+	string denoise_suffix;
+	int denoise_frames;
+	int denoise_samples;
+	int denoise_radius;
+	float denoise_strength;
+	float denoise_feature_strength;
 } options;
 
 static void session_print(const string& str)
@@ -88,6 +101,17 @@ static void session_print_status()
 	session_print(status);
 }
 
+static void denoise_print_status(Progress *progress)
+{
+	string status, substatus;
+	progress->get_status(status, substatus);
+
+	if(substatus != "")
+		status += ": " + substatus;
+
+	session_print(status);
+}
+
 static bool write_render(const uchar *pixels, int w, int h, int channels)
 {
 	string msg = string_printf("Writing image %s", options.output_path.c_str());
@@ -130,8 +154,35 @@ static void scene_init()
 {
 	options.scene = new Scene(options.scene_params, options.session->device);
 
-	/* Read XML */
-	xml_read_file(options.scene, options.filepath.c_str());
+	/* Read binary or XML */
+	const double load_start = time_dt();
+	const bool binary = binary_is_file(options.filepath.c_str());
+
+	if(binary) {
+		if(!binary_read_file(options.scene, options.filepath.c_str())) {
+			exit(EXIT_FAILURE);
+		}
+	}
+	else {
+		xml_read_file(options.scene, options.filepath.c_str());
+	}
+
+	if(!options.quiet) {
+		printf("Scene loaded from %s file in %.3f seconds\n",
+		       (binary)? "binary": "XML", time_dt() - load_start);
+	}
+
+	/* Write binary for faster loading next time */
+	if(options.binary_path != "") {
+		const double write_start = time_dt();
+		if(!binary_write_file(options.scene, options.binary_path.c_str())) {
+			exit(EXIT_FAILURE);
+		}
+		if(!options.quiet) {
+			printf("Scene written to %s in %.3f seconds\n",
+			       options.binary_path.c_str(), time_dt() - write_start);
+		}
+	}
 
 	/* Camera width/height override? */
 	if(!(options.width == 0 || options.height == 0)) {
@@ -342,11 +393,64 @@ static void keyboard(unsigned char key)
 }
 #endif
 
+static string denoise_output_path(const string& filepath)
+{
+	/* Insert suffix before the extension. */
+	const size_t dot = filepath.rfind('.');
+	const size_t slash = filepath.find_last_of("/\\");
+	if(dot == string::npos || (slash != string::npos && dot < slash)) {
+		return filepath + options.denoise_suffix;
+	}
+	return filepath.substr(0, dot) + options.denoise_suffix + filepath.substr(dot);
+}
+
+static void denoise_run()
+{
+	TaskScheduler::init(options.session_params.threads);
+
+	Denoiser denoiser(options.session_params.device);
+	denoiser.input = options.denoise_filepaths;
+	foreach(const string& filepath, options.denoise_filepaths) {
+		denoiser.output.push_back(denoise_output_path(filepath));
+	}
+	denoiser.neighbor_frames = options.denoise_frames;
+	denoiser.samples_override = options.denoise_samples;
+	denoiser.radius = options.denoise_radius;
+	denoiser.strength = options.denoise_strength;
+	denoiser.feature_strength = options.denoise_feature_strength;
+
+	if(!options.quiet) {
+		denoiser.progress.set_update_callback(function_bind(&denoise_print_status, &denoiser.progress));
+	}
+
+	const double start_time = time_dt();
+	const bool ok = denoiser.run();
+
+	if(!options.quiet) {
+		printf("\n");
+	}
+
+	TaskScheduler::exit();
+
+	if(!ok) {
+		fprintf(stderr, "Denoising failed: %s\n", denoiser.error.c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	if(!options.quiet) {
+		printf("Denoised %d frames in %.3f seconds\n",
+		       (int)options.denoise_filepaths.size(), time_dt() - start_time);
+	}
+}
+
 static int files_parse(int argc, const char *argv[])
 {
 	if(argc > 0)
 		options.filepath = argv[0];
 
+	for(int i = 0; i < argc; i++)
+		options.denoise_filepaths.push_back(argv[i]);
+
 	return 0;
 }
 
@@ -357,6 +461,13 @@ static void options_parse(int argc, const char **argv)
 	options.filepath = "";
 	options.session = NULL;
 	options.quiet = false;
+	options.denoise = false;
+	options.denoise_suffix = "_denoised";
+	options.denoise_frames = 2;
+	options.denoise_samples = 0;
+	options.denoise_radius = 8;
+	options.denoise_strength = 0.5f;
+	options.denoise_feature_strength = 0.5f;
 
 	/* device names */
 	string device_names = "";
@@ -380,7 +491,8 @@ static void options_parse(int argc, const char **argv)
 	bool help = false, debug = false, version = false;
 	int verbosity = 1;
 
-	ap.options ("Usage: cycles [options] file.xml",
+	ap.options ("Usage: cycles [options] file.xml|file.bin\n"
+	            "       cycles --denoise [options] frame1.exr frame2.exr ...",
 		"%*", files_parse, "",
 		"--device %s", &devicename, ("Devices to use: " + device_names).c_str(),
 #ifdef WITH_OSL
@@ -390,11 +502,19 @@ static void options_parse(int argc, const char **argv)
 		"--quiet", &options.quiet, "In background mode, don't print progress messages",
 		"--samples %d", &options.session_params.samples, "Number of samples to render",
 		"--output %s", &options.output_path, "File path to write output image",
+		"--write-binary %s", &options.binary_path, "File path to write binary scene, which loads faster than XML",
 		"--threads %d", &options.session_params.threads, "CPU Rendering Threads",
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--tile-width %d", &options.session_params.tile_size.x, "Tile width in pixels",
 		"--tile-height %d", &options.session_params.tile_size.y, "Tile height in pixels",
+		"--denoise", &options.denoise, "Denoise sequence of multilayer EXR files with denoising data passes, instead of rendering",
+		"--denoise-suffix %s", &options.denoise_suffix, "Suffix added to denoised file names, empty to overwrite input files",
+		"--denoise-frames %d", &options.denoise_frames, "Number of frames before and after each frame to filter with",
+		"--denoise-samples %d", &options.denoise_samples, "Number of samples the frames were rendered with, overriding the file metadata",
+		"--denoise-radius %d", &options.denoise_radius, "Denoising radius in pixels",
+		"--denoise-strength %f", &options.denoise_strength, "Denoising strength",
+		"--denoise-feature-strength %f", &options.denoise_feature_strength, "Denoising feature strength",
 		"--list-devices", &list, "List information about all available devices",
 #ifdef WITH_CYCLES_LOGGING
 		"--debug", &debug, "Enable debug logging",
@@ -457,6 +577,13 @@ static void options_parse(int argc, const char **argv)
 	if (!devices.empty()) {
 		options.session_params.device = devices.front();
 		device_available = true;
+
+		/* Render on all listed servers at once. */
+		if(device_type == DEVICE_NETWORK) {
+			options.session_params.device = Device::get_multi_device(devices,
+			                                                         options.session_params.threads,
+			                                                         options.session_params.background);
+		}
 	}
 
 	/* handle invalid configurations */
@@ -497,6 +624,11 @@ int main(int argc, const char **argv)
 	path_init();
 	options_parse(argc, argv);
 
+	if(options.denoise) {
+		denoise_run();
+		return 0;
+	}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 	if(options.session_params.background) {
 #endif
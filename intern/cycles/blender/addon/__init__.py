@@ -58,6 +58,7 @@ class CyclesRender(bpy.types.RenderEngine):
     bl_use_exclude_layers = True
     bl_use_save_buffers = True
     bl_use_spherical_stereo = True
+    bl_use_persistent_depsgraph = True
 
     def __init__(self):
         self.session = None
@@ -84,6 +85,9 @@ class CyclesRender(bpy.types.RenderEngine):
     def bake(self, depsgraph, obj, pass_type, pass_filter, object_id, pixel_array, num_pixels, depth, result):
         engine.bake(self, depsgraph, obj, pass_type, pass_filter, object_id, pixel_array, num_pixels, depth, result)
 
+    def bake_multi(self, depsgraph, passes, targets, callback=None):
+        engine.bake_multi(self, depsgraph, passes, targets, callback)
+
     # viewport render
     def view_update(self, context):
         if not self.session:
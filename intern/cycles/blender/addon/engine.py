@@ -165,10 +165,30 @@ def render(engine, depsgraph):
 
 
 def bake(engine, depsgraph, obj, pass_type, pass_filter, object_id, pixel_array, num_pixels, depth, result):
+    bake_multi(engine, depsgraph, [(pass_type, pass_filter)], [(obj, object_id, pixel_array, num_pixels, [result])])
+
+
+def bake_multi(engine, depsgraph, passes, targets, callback=None):
+    """
+    Bake multiple targets and passes with a single scene synchronization.
+
+    passes: sequence of (pass_type, pass_filter).
+    targets: sequence of (obj, object_id, pixel_array, num_pixels, results),
+        with one result buffer for every pass.
+    callback: called with (target_index, pass_index) when a result is complete.
+    """
     import _cycles
     session = getattr(engine, "session", None)
-    if session is not None:
-        _cycles.bake(engine.session, depsgraph.as_pointer(), obj.as_pointer(), pass_type, pass_filter, object_id, pixel_array.as_pointer(), num_pixels, depth, result.as_pointer())
+    if session is None:
+        raise RuntimeError("Cycles bake requires a session, created by the engine update")
+    _cycles.bake_multi(
+        session,
+        depsgraph.as_pointer(),
+        passes,
+        [(obj.as_pointer(), object_id, pixel_array.as_pointer(), num_pixels,
+          [result.as_pointer() for result in results])
+         for obj, object_id, pixel_array, num_pixels, results in targets],
+        callback)
 
 
 def reset(engine, data, depsgraph):
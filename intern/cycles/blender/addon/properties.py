@@ -115,6 +115,7 @@ enum_use_layer_samples = (
 enum_sampling_pattern = (
     ('SOBOL', "Sobol", "Use Sobol random sampling pattern"),
     ('CORRELATED_MUTI_JITTER', "Correlated Multi-Jitter", "Use Correlated Multi-Jitter random sampling pattern"),
+    ('PROGRESSIVE_MULTI_JITTER', "Progressive Multi-Jitter", "Use Progressive Multi-Jitter random sampling pattern, with noise distributed as blue noise over the image"),
 )
 
 enum_integrator = (
@@ -296,6 +297,34 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0.01,
     )
 
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights for sampling by their estimated contribution using a light tree, "
+        "reduces noise in scenes with many lights at the cost of longer scene update",
+        default=False,
+    )
+
+    use_adaptive_sampling: BoolProperty(
+        name="Use Adaptive Sampling",
+        description="Stop sampling pixels which converged before reaching the number of samples, "
+        "and spend the time on noisier areas instead (final render only)",
+        default=False,
+    )
+    adaptive_threshold: FloatProperty(
+        name="Adaptive Sampling Threshold",
+        description="Noise level at which a pixel is considered converged, lower values give less noise",
+        min=0.0, max=1.0,
+        default=0.01,
+        precision=4,
+    )
+    adaptive_min_samples: IntProperty(
+        name="Adaptive Min Samples",
+        description="Minimum number of samples taken for every pixel before checking convergence, "
+        "automatic if 0",
+        min=0, max=4096,
+        default=0,
+    )
+
     caustics_reflective: BoolProperty(
         name="Reflective Caustics",
         description="Use reflective caustics, resulting in a brighter image (more noise but added realism)",
@@ -547,6 +576,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    debug_use_quantized_bvh: BoolProperty(
+        name="Use Quantized BVH",
+        description="Store BVH node bounds with reduced precision, using less memory for large scenes (only used for BVH4 layout)",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
@@ -660,6 +694,25 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures on demand through a texture cache, instead of loading them completely "
+                    "before rendering (only supported for CPU rendering, works best with tiled and mipmapped images)",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum amount of memory used by the texture cache, in megabytes",
+        default=4096,
+        min=1, max=1024 * 1024,
+    )
+    use_compact_geometry: BoolProperty(
+        name="Compact Geometry",
+        description="Store vertex normals and UV maps with reduced precision, to fit larger meshes into memory",
+        default=False,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -681,6 +734,7 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         scene = context.scene.as_pointer()
         return _cycles.debug_flags_update(scene)
 
+    debug_use_cpu_avx512: BoolProperty(name="AVX-512", default=True)
     debug_use_cpu_avx2: BoolProperty(name="AVX2", default=True)
     debug_use_cpu_avx: BoolProperty(name="AVX", default=True)
     debug_use_cpu_sse41: BoolProperty(name="SSE41", default=True)
@@ -1263,7 +1317,7 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
     )
     pass_debug_render_time: BoolProperty(
         name="Debug Render Time",
-        description="Render time in milliseconds per sample and pixel",
+        description="Render time in milliseconds per sample and pixel, measured per pixel on the CPU and per tile on other devices",
         default=False,
         update=update_render_passes,
     )
@@ -927,7 +927,6 @@ static void create_subd_mesh(Scene *scene,
 	sdparams.dicing_rate = max(0.1f, RNA_float_get(&cobj, "dicing_rate") * dicing_rate);
 	sdparams.max_level = max_subdivisions;
 
-	scene->dicing_camera->update(scene);
 	sdparams.camera = scene->dicing_camera;
 	sdparams.objecttoworld = get_transform(b_ob.matrix_world());
 }
@@ -976,7 +975,9 @@ Mesh *BlenderSync::sync_mesh(BL::Depsgraph& b_depsgraph,
                              BL::Object& b_ob_instance,
                              bool object_updated,
                              bool show_self,
-                             bool show_particles)
+                             bool show_particles,
+                             uint motion_steps,
+                             bool use_motion_blur)
 {
 	/* test if we can instance or if the object is modified */
 	BL::ID b_ob_data = b_ob.data();
@@ -1041,20 +1042,18 @@ Mesh *BlenderSync::sync_mesh(BL::Depsgraph& b_depsgraph,
 
 	mesh_synced.insert(mesh);
 
-	/* create derived mesh */
-	array<int> oldtriangles;
-	array<Mesh::SubdFace> oldsubd_faces;
-	array<int> oldsubd_face_corners;
-	oldtriangles.steal_data(mesh->triangles);
-	oldsubd_faces.steal_data(mesh->subd_faces);
-	oldsubd_face_corners.steal_data(mesh->subd_face_corners);
+	/* Geometry is converted in the task pool, only changes to the mesh which
+	 * objects depend on are done here. Old primitives are kept to detect if
+	 * the BVH needs to be rebuilt once conversion is done. */
+	MeshSync *sync = new MeshSync(mesh, b_ob, show_self, show_particles);
+	sync->oldtriangles.steal_data(mesh->triangles);
+	sync->oldsubd_faces.steal_data(mesh->subd_faces);
+	sync->oldsubd_face_corners.steal_data(mesh->subd_face_corners);
 
 	/* compares curve_keys rather than strands in order to handle quick hair
 	 * adjustments in dynamic BVH - other methods could probably do this better*/
-	array<float3> oldcurve_keys;
-	array<float> oldcurve_radius;
-	oldcurve_keys.steal_data(mesh->curve_keys);
-	oldcurve_radius.steal_data(mesh->curve_radius);
+	sync->oldcurve_keys.steal_data(mesh->curve_keys);
+	sync->oldcurve_radius.steal_data(mesh->curve_radius);
 
 	mesh->clear();
 	mesh->used_shaders = used_shaders;
@@ -1070,50 +1069,96 @@ Mesh *BlenderSync::sync_mesh(BL::Depsgraph& b_depsgraph,
 			mesh->subdivision_type = object_subdivision_type(b_ob, preview, experimental);
 		}
 
+		/* Dicing camera is shared by all meshes, make sure it is up to date
+		 * before threads start dicing. */
+		if(mesh->subdivision_type != Mesh::SUBDIVISION_NONE) {
+			scene->dicing_camera->update(scene);
+		}
+
 		/* For some reason, meshes do not need this... */
 		bool need_undeformed = mesh->need_attribute(scene, ATTR_STD_GENERATED);
 
-		BL::Mesh b_mesh = object_to_mesh(b_data,
-		                                 b_ob,
-		                                 b_depsgraph,
-		                                 need_undeformed,
-		                                 mesh->subdivision_type);
-
-		if(b_mesh) {
-			/* Sync mesh itself. */
-			if(view_layer.use_surfaces && show_self) {
-				if(mesh->subdivision_type != Mesh::SUBDIVISION_NONE)
-					create_subd_mesh(scene, mesh, b_ob, b_mesh, used_shaders,
-					                 dicing_rate, max_subdivisions);
-				else
-					create_mesh(scene, mesh, b_mesh, used_shaders, false);
+		/* Creating a mesh modifies Blender main database, which can only be
+		 * done from a single thread. */
+		sync->b_mesh = object_to_mesh(b_data,
+		                              b_ob,
+		                              b_depsgraph,
+		                              need_undeformed,
+		                              mesh->subdivision_type);
+	}
+	mesh->geometry_flags = requested_geometry_flags;
 
-				create_mesh_volume_attributes(scene, b_ob, mesh, b_scene.frame_current());
-			}
+	/* Objects test this to see if they need to be updated. */
+	mesh->tag_update(scene, false);
 
-			/* Sync hair curves. */
-			if(view_layer.use_hair && show_particles && mesh->subdivision_type == Mesh::SUBDIVISION_NONE) {
-				sync_curves(mesh, b_mesh, b_ob, false);
-			}
+	/* Conversion reads motion settings, set them before it starts instead of
+	 * from the object sync. */
+	if(scene->need_motion() != Scene::MOTION_NONE) {
+		mesh->motion_steps = motion_steps;
+		mesh->use_motion_blur = use_motion_blur;
+	}
+
+	mesh_sync_queue.push_back(sync);
+	mesh_sync_pool.push(function_bind(&BlenderSync::sync_mesh_data, this, sync));
 
-			free_object_to_mesh(b_data, b_ob, b_mesh);
+	return mesh;
+}
+
+void BlenderSync::sync_mesh_data(MeshSync *sync)
+{
+	Mesh *mesh = sync->mesh;
+	BL::Mesh& b_mesh = sync->b_mesh;
+
+	if(b_mesh) {
+		/* Sync mesh itself. */
+		if(view_layer.use_surfaces && sync->show_self) {
+			if(mesh->subdivision_type != Mesh::SUBDIVISION_NONE)
+				create_subd_mesh(scene, mesh, sync->b_ob, b_mesh, mesh->used_shaders,
+				                 dicing_rate, max_subdivisions);
+			else
+				create_mesh(scene, mesh, b_mesh, mesh->used_shaders, false);
+		}
+
+		/* Sync hair curves. */
+		if(view_layer.use_hair && sync->show_particles && mesh->subdivision_type == Mesh::SUBDIVISION_NONE) {
+			sync_curves(mesh, b_mesh, sync->b_ob, false);
 		}
 	}
-	mesh->geometry_flags = requested_geometry_flags;
 
-	/* fluid motion */
-	sync_mesh_fluid_motion(b_ob, scene, mesh);
+	sync->rebuild = (sync->oldtriangles != mesh->triangles) ||
+	                (sync->oldsubd_faces != mesh->subd_faces) ||
+	                (sync->oldsubd_face_corners != mesh->subd_face_corners) ||
+	                (sync->oldcurve_keys != mesh->curve_keys) ||
+	                (sync->oldcurve_radius != mesh->curve_radius);
+}
 
-	/* tag update */
-	bool rebuild = (oldtriangles != mesh->triangles) ||
-	               (oldsubd_faces != mesh->subd_faces) ||
-	               (oldsubd_face_corners != mesh->subd_face_corners) ||
-	               (oldcurve_keys != mesh->curve_keys) ||
-	               (oldcurve_radius != mesh->curve_radius);
+void BlenderSync::sync_mesh_finish()
+{
+	mesh_sync_pool.wait_work();
 
-	mesh->tag_update(scene, rebuild);
+	foreach(MeshSync *sync, mesh_sync_queue) {
+		Mesh *mesh = sync->mesh;
 
-	return mesh;
+		if(sync->b_mesh) {
+			/* Image manager assigns slots in the order volumes are added,
+			 * keep it deterministic. */
+			if(view_layer.use_surfaces && sync->show_self) {
+				create_mesh_volume_attributes(scene, sync->b_ob, mesh, b_scene.frame_current());
+			}
+
+			free_object_to_mesh(b_data, sync->b_ob, sync->b_mesh);
+		}
+
+		/* fluid motion, uses motion steps set by the object */
+		sync_mesh_fluid_motion(sync->b_ob, scene, mesh);
+
+		/* tag update */
+		mesh->tag_update(scene, sync->rebuild);
+
+		delete sync;
+	}
+
+	mesh_sync_queue.clear();
 }
 
 void BlenderSync::sync_mesh_motion(BL::Depsgraph& b_depsgraph,
@@ -403,8 +403,28 @@ Object *BlenderSync::sync_object(BL::Depsgraph& b_depsgraph,
 	if(object_map.sync(&object, b_ob, b_parent, key))
 		object_updated = true;
 
+	/* motion blur settings of the mesh */
+	Scene::MotionType need_motion = scene->need_motion();
+	uint motion_steps = 0;
+	bool use_motion_blur = false;
+
+	if(need_motion == Scene::MOTION_BLUR) {
+		motion_steps = object_motion_steps(b_parent, b_ob);
+		use_motion_blur = motion_steps && object_use_deform_motion(b_parent, b_ob);
+	}
+	else if(need_motion != Scene::MOTION_NONE) {
+		motion_steps = 3;
+	}
+
 	/* mesh sync */
-	object->mesh = sync_mesh(b_depsgraph, b_ob, b_ob_instance, object_updated, show_self, show_particles);
+	object->mesh = sync_mesh(b_depsgraph,
+	                         b_ob,
+	                         b_ob_instance,
+	                         object_updated,
+	                         show_self,
+	                         show_particles,
+	                         motion_steps,
+	                         use_motion_blur);
 
 	/* special case not tracked by object update flags */
 
@@ -453,24 +473,19 @@ Object *BlenderSync::sync_object(BL::Depsgraph& b_depsgraph,
 		object->motion.clear();
 
 		/* motion blur */
-		Scene::MotionType need_motion = scene->need_motion();
 		if(need_motion != Scene::MOTION_NONE && object->mesh) {
 			Mesh *mesh = object->mesh;
-			mesh->use_motion_blur = false;
-			mesh->motion_steps = 0;
-
-			uint motion_steps;
 
-			if(scene->need_motion() == Scene::MOTION_BLUR) {
-				motion_steps = object_motion_steps(b_parent, b_ob);
-				mesh->motion_steps = motion_steps;
-				if(motion_steps && object_use_deform_motion(b_parent, b_ob)) {
-					mesh->use_motion_blur = true;
+			if(mesh->motion_steps != motion_steps ||
+			   mesh->use_motion_blur != use_motion_blur)
+			{
+				/* Mesh is shared with an object with other settings, the
+				 * conversion which reads them might still be running. */
+				if(mesh_synced.find(mesh) != mesh_synced.end()) {
+					mesh_sync_pool.wait_work();
 				}
-			}
-			else {
-				motion_steps = 3;
 				mesh->motion_steps = motion_steps;
+				mesh->use_motion_blur = use_motion_blur;
 			}
 
 			object->motion.clear();
@@ -568,6 +583,13 @@ void BlenderSync::sync_objects(BL::Depsgraph& b_depsgraph, float motion_time)
 		cancel = progress.get_cancel();
 	}
 
+	if(!motion) {
+		/* Wait for geometry conversion, also when cancelled so Blender meshes
+		 * created for conversion are freed. */
+		progress.set_sync_status("Synchronizing geometry");
+		sync_mesh_finish();
+	}
+
 	progress.set_sync_status("");
 
 	if(!cancel && !motion) {
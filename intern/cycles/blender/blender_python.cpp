@@ -64,6 +64,7 @@ bool debug_flags_sync_from_scene(BL::Scene b_scene)
 	/* Synchronize shared flags. */
 	flags.viewport_static_bvh = get_enum(cscene, "debug_bvh_type");
 	/* Synchronize CPU flags. */
+	flags.cpu.avx512 = get_boolean(cscene, "debug_use_cpu_avx512");
 	flags.cpu.avx2 = get_boolean(cscene, "debug_use_cpu_avx2");
 	flags.cpu.avx = get_boolean(cscene, "debug_use_cpu_avx");
 	flags.cpu.sse41 = get_boolean(cscene, "debug_use_cpu_sse41");
@@ -284,15 +285,30 @@ static PyObject *render_func(PyObject * /*self*/, PyObject *args)
 	Py_RETURN_NONE;
 }
 
-/* pixel_array and result passed as pointers */
-static PyObject *bake_func(PyObject * /*self*/, PyObject *args)
+/* Called from the baking thread, which holds no Python lock. */
+static void bake_multi_done(BlenderSession *session, PyObject *pycallback, int target, int pass)
 {
-	PyObject *pysession, *pydepsgraph, *pyobject;
-	PyObject *pypixel_array, *pyresult;
-	const char *pass_type;
-	int num_pixels, depth, object_id, pass_filter;
+	python_thread_state_restore(&session->python_thread_state);
+
+	PyObject *ret = PyObject_CallFunction(pycallback, "ii", target, pass);
+	if(ret) {
+		Py_DECREF(ret);
+	}
+	else {
+		PyErr_Print();
+	}
+
+	python_thread_state_save(&session->python_thread_state);
+}
 
-	if(!PyArg_ParseTuple(args, "OOOsiiOiiO", &pysession, &pydepsgraph, &pyobject, &pass_type, &pass_filter, &object_id, &pypixel_array, &num_pixels, &depth, &pyresult))
+/* passes is a sequence of (pass_type, pass_filter), targets a sequence of
+ * (object, object_id, pixel_array, num_pixels, results) with results being a
+ * sequence of pointers, one for every pass. */
+static PyObject *bake_multi_func(PyObject * /*self*/, PyObject *args)
+{
+	PyObject *pysession, *pydepsgraph, *pypasses, *pytargets, *pycallback;
+
+	if(!PyArg_ParseTuple(args, "OOOOO", &pysession, &pydepsgraph, &pypasses, &pytargets, &pycallback))
 		return NULL;
 
 	BlenderSession *session = (BlenderSession*)PyLong_AsVoidPtr(pysession);
@@ -301,19 +317,83 @@ static PyObject *bake_func(PyObject * /*self*/, PyObject *args)
 	RNA_pointer_create(NULL, &RNA_Depsgraph, PyLong_AsVoidPtr(pydepsgraph), &depsgraphptr);
 	BL::Depsgraph b_depsgraph(depsgraphptr);
 
-	PointerRNA objectptr;
-	RNA_id_pointer_create((ID*)PyLong_AsVoidPtr(pyobject), &objectptr);
-	BL::Object b_object(objectptr);
+	PyObject *pypasses_fast = PySequence_Fast(pypasses, "passes must be a sequence");
+	if(!pypasses_fast) {
+		return NULL;
+	}
+
+	vector<BlenderSession::BakePass> passes;
+	for(Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(pypasses_fast); i++) {
+		PyObject *pypass = PySequence_Fast_GET_ITEM(pypasses_fast, i);
+		const char *pass_type;
+		int pass_filter;
+
+		if(!PyArg_ParseTuple(pypass, "si", &pass_type, &pass_filter)) {
+			Py_DECREF(pypasses_fast);
+			return NULL;
+		}
+
+		BlenderSession::BakePass pass;
+		pass.pass_type = pass_type;
+		pass.pass_filter = pass_filter;
+		passes.push_back(pass);
+	}
+	Py_DECREF(pypasses_fast);
+
+	PyObject *pytargets_fast = PySequence_Fast(pytargets, "targets must be a sequence");
+	if(!pytargets_fast) {
+		return NULL;
+	}
+
+	vector<BlenderSession::BakeTarget> targets;
+	for(Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(pytargets_fast); i++) {
+		PyObject *pytarget = PySequence_Fast_GET_ITEM(pytargets_fast, i);
+		PyObject *pyobject, *pypixel_array, *pyresults;
+		int object_id, num_pixels;
+
+		if(!PyArg_ParseTuple(pytarget, "OiOiO", &pyobject, &object_id, &pypixel_array, &num_pixels, &pyresults)) {
+			Py_DECREF(pytargets_fast);
+			return NULL;
+		}
+
+		PyObject *pyresults_fast = PySequence_Fast(pyresults, "results must be a sequence");
+		if(!pyresults_fast) {
+			Py_DECREF(pytargets_fast);
+			return NULL;
+		}
+		if(PySequence_Fast_GET_SIZE(pyresults_fast) != (Py_ssize_t)passes.size()) {
+			PyErr_SetString(PyExc_ValueError, "number of results must match number of passes");
+			Py_DECREF(pyresults_fast);
+			Py_DECREF(pytargets_fast);
+			return NULL;
+		}
+
+		PointerRNA objectptr;
+		RNA_id_pointer_create((ID*)PyLong_AsVoidPtr(pyobject), &objectptr);
+		BL::Object b_object(objectptr);
+
+		PointerRNA bakepixelptr;
+		RNA_pointer_create(NULL, &RNA_BakePixel, PyLong_AsVoidPtr(pypixel_array), &bakepixelptr);
+		BL::BakePixel b_bake_pixel(bakepixelptr);
 
-	void *b_result = PyLong_AsVoidPtr(pyresult);
+		BlenderSession::BakeTarget target(b_object, object_id, b_bake_pixel, (size_t)num_pixels);
+		for(Py_ssize_t pass = 0; pass < PySequence_Fast_GET_SIZE(pyresults_fast); pass++) {
+			target.results.push_back((float*)PyLong_AsVoidPtr(PySequence_Fast_GET_ITEM(pyresults_fast, pass)));
+		}
+		targets.push_back(target);
+
+		Py_DECREF(pyresults_fast);
+	}
+	Py_DECREF(pytargets_fast);
 
-	PointerRNA bakepixelptr;
-	RNA_pointer_create(NULL, &RNA_BakePixel, PyLong_AsVoidPtr(pypixel_array), &bakepixelptr);
-	BL::BakePixel b_bake_pixel(bakepixelptr);
+	BlenderSession::BakeDoneFunc bake_done;
+	if(pycallback != Py_None) {
+		bake_done = function_bind(&bake_multi_done, session, pycallback, _1, _2);
+	}
 
 	python_thread_state_save(&session->python_thread_state);
 
-	session->bake(b_depsgraph, b_object, pass_type, pass_filter, object_id, b_bake_pixel, (size_t)num_pixels, depth, (float *)b_result);
+	session->bake_multi(b_depsgraph, passes, targets, bake_done);
 
 	python_thread_state_restore(&session->python_thread_state);
 
@@ -773,7 +853,7 @@ static PyMethodDef methods[] = {
 	{"create", create_func, METH_VARARGS, ""},
 	{"free", free_func, METH_O, ""},
 	{"render", render_func, METH_VARARGS, ""},
-	{"bake", bake_func, METH_VARARGS, ""},
+	{"bake_multi", bake_multi_func, METH_VARARGS, ""},
 	{"draw", draw_func, METH_VARARGS, ""},
 	{"sync", sync_func, METH_VARARGS, ""},
 	{"reset", reset_func, METH_VARARGS, ""},
@@ -120,7 +120,7 @@ void BlenderSession::create()
 void BlenderSession::create_session()
 {
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, b_engine.is_animation());
 	bool session_pause = BlenderSync::get_session_pause(b_scene, background);
 
 	/* reset status/progress */
@@ -204,7 +204,7 @@ void BlenderSession::reset_session(BL::BlendData& b_data, BL::Depsgraph& b_depsg
 	}
 
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, b_engine.is_animation());
 
 	if(scene->params.modified(scene_params) ||
 	   session->params.modified(session_params) ||
@@ -219,7 +219,14 @@ void BlenderSession::reset_session(BL::BlendData& b_data, BL::Depsgraph& b_depsg
 	}
 
 	session->progress.reset();
-	scene->reset();
+
+	/* Frames of an animation keep the scene, only datablocks which the
+	 * depsgraph reports as updated are synced again. Otherwise only images
+	 * are kept. */
+	const bool reuse_scene = b_engine.is_animation();
+	if(!reuse_scene) {
+		scene->reset();
+	}
 
 	session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -231,8 +238,15 @@ void BlenderSession::reset_session(BL::BlendData& b_data, BL::Depsgraph& b_depsg
 	/* There is no single depsgraph to use for the entire render.
 	 * See note on create_session().
 	 */
-	/* sync object should be re-created */
-	sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+	if(reuse_scene) {
+		sync->reset(b_data, b_scene);
+		sync->sync_recalc(b_depsgraph);
+	}
+	else {
+		/* sync object should be re-created */
+		delete sync;
+		sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+	}
 
 	BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
 	BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
@@ -631,19 +645,20 @@ static int bake_pass_filter_get(const int pass_filter)
 	return flag;
 }
 
-void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
-                          BL::Object& b_object,
-                          const string& pass_type,
-                          const int pass_filter,
-                          const int object_id,
-                          BL::BakePixel& pixel_array,
-                          const size_t num_pixels,
-                          const int /*depth*/,
-                          float result[])
+static void bake_object_done(const BlenderSession::BakeDoneFunc *bake_done,
+                             const vector<int> *data_target,
+                             int pass,
+                             size_t data_index)
 {
-	b_depsgraph = b_depsgraph_;
+	(*bake_done)((*data_target)[data_index], pass);
+}
 
-	ShaderEvalType shader_type = get_shader_type(pass_type);
+void BlenderSession::bake_multi(BL::Depsgraph& b_depsgraph_,
+                                const vector<BakePass>& passes,
+                                vector<BakeTarget>& targets,
+                                const BakeDoneFunc& bake_done)
+{
+	b_depsgraph = b_depsgraph_;
 
 	/* Set baking flag in advance, so kernel loading can check if we need
 	 * any baking capabilities.
@@ -653,17 +668,26 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 	/* ensure kernels are loaded before we do any scene updates */
 	session->load_kernels();
 
-	if(shader_type == SHADER_EVAL_UV) {
-		/* force UV to be available */
-		Pass::add(PASS_UV, scene->film->passes);
-	}
+	/* film passes needed by any of the bake passes */
+	vector<ShaderEvalType> shader_types(passes.size());
+	vector<int> bake_pass_filters(passes.size());
+
+	for(size_t pass = 0; pass < passes.size(); pass++) {
+		shader_types[pass] = get_shader_type(passes[pass].pass_type);
+
+		if(shader_types[pass] == SHADER_EVAL_UV) {
+			/* force UV to be available */
+			Pass::add(PASS_UV, scene->film->passes);
+		}
 
-	int bake_pass_filter = bake_pass_filter_get(pass_filter);
-	bake_pass_filter = BakeManager::shader_type_to_pass_filter(shader_type, bake_pass_filter);
+		int bake_pass_filter = bake_pass_filter_get(passes[pass].pass_filter);
+		bake_pass_filter = BakeManager::shader_type_to_pass_filter(shader_types[pass], bake_pass_filter);
+		bake_pass_filters[pass] = bake_pass_filter;
 
-	/* force use_light_pass to be true if we bake more than just colors */
-	if(bake_pass_filter & ~BAKE_FILTER_COLOR) {
-		Pass::add(PASS_LIGHT, scene->film->passes);
+		/* force use_light_pass to be true if we bake more than just colors */
+		if(bake_pass_filter & ~BAKE_FILTER_COLOR) {
+			Pass::add(PASS_LIGHT, scene->film->passes);
+		}
 	}
 
 	/* create device and update scene */
@@ -683,7 +707,10 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 		builtin_images_load();
 	}
 
-	BakeData *bake_data = NULL;
+	/* bake data of every target with a matching object, and the target
+	 * index for each of them */
+	vector<BakeData*> bake_data;
+	vector<int> data_target;
 
 	if(!session->progress.get_cancel()) {
 		/* get buffer parameters */
@@ -697,25 +724,30 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 		session->reset(buffer_params, session_params.samples);
 		session->update_scene();
 
-		/* find object index. todo: is arbitrary - copied from mesh_displace.cpp */
-		size_t object_index = OBJECT_NONE;
-		int tri_offset = 0;
+		for(size_t target = 0; target < targets.size(); target++) {
+			BakeTarget& bake_target = targets[target];
+
+			/* find object index. todo: is arbitrary - copied from mesh_displace.cpp */
+			size_t object_index = OBJECT_NONE;
+			int tri_offset = 0;
 
-		for(size_t i = 0; i < scene->objects.size(); i++) {
-			if(strcmp(scene->objects[i]->name.c_str(), b_object.name().c_str()) == 0) {
-				object_index = i;
-				tri_offset = scene->objects[i]->mesh->tri_offset;
-				break;
+			for(size_t i = 0; i < scene->objects.size(); i++) {
+				if(strcmp(scene->objects[i]->name.c_str(), bake_target.b_object.name().c_str()) == 0) {
+					object_index = i;
+					tri_offset = scene->objects[i]->mesh->tri_offset;
+					break;
+				}
 			}
-		}
 
-		/* Object might have been disabled for rendering or excluded in some
-		 * other way, in that case Blender will report a warning afterwards. */
-		if (object_index != OBJECT_NONE) {
-			int object = object_index;
+			/* Object might have been disabled for rendering or excluded in some
+			 * other way, in that case Blender will report a warning afterwards. */
+			if(object_index != OBJECT_NONE) {
+				BakeData *data = new BakeData(object_index, tri_offset, bake_target.num_pixels);
+				populate_bake_data(data, bake_target.object_id, bake_target.pixel_array, bake_target.num_pixels);
 
-			bake_data = scene->bake_manager->init(object, tri_offset, num_pixels);
-			populate_bake_data(bake_data, object_id, pixel_array, num_pixels);
+				bake_data.push_back(data);
+				data_target.push_back(target);
+			}
 		}
 
 		/* set number of samples */
@@ -727,8 +759,35 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 	}
 
 	/* Perform bake. Check cancel to avoid crash with incomplete scene data. */
-	if(!session->progress.get_cancel() && bake_data) {
-		scene->bake_manager->bake(scene->device, &scene->dscene, scene, session->progress, shader_type, bake_pass_filter, bake_data, result);
+	for(size_t pass = 0; pass < passes.size(); pass++) {
+		if(session->progress.get_cancel() || bake_data.empty()) {
+			break;
+		}
+
+		vector<float*> results(bake_data.size());
+		for(size_t i = 0; i < bake_data.size(); i++) {
+			results[i] = targets[data_target[i]].results[pass];
+		}
+
+		BakeManager::ObjectDoneFunc object_done;
+		if(bake_done) {
+			object_done = function_bind(&bake_object_done, &bake_done, &data_target, (int)pass, _1);
+		}
+
+		scene->bake_manager->set_baking(true);
+		scene->bake_manager->bake(scene->device,
+		                          &scene->dscene,
+		                          scene,
+		                          session->progress,
+		                          shader_types[pass],
+		                          bake_pass_filters[pass],
+		                          bake_data,
+		                          results,
+		                          object_done);
+	}
+
+	foreach(BakeData *data, bake_data) {
+		delete data;
 	}
 
 	/* free all memory used (host and device), so we wouldn't leave render
@@ -826,7 +885,7 @@ void BlenderSession::synchronize(BL::Depsgraph& b_depsgraph_)
 
 	/* on session/scene parameter changes, we recreate session entirely */
 	SessionParams session_params = BlenderSync::get_session_params(b_engine, b_userpref, b_scene, background);
-	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background);
+	SceneParams scene_params = BlenderSync::get_scene_params(b_scene, background, b_engine.is_animation());
 	bool session_pause = BlenderSync::get_session_pause(b_scene, background);
 
 	if(session->params.modified(session_params) ||
@@ -60,15 +60,39 @@ public:
 	/* offline render */
 	void render(BL::Depsgraph& b_depsgraph);
 
-	void bake(BL::Depsgraph& b_depsgrah,
-	          BL::Object& b_object,
-	          const string& pass_type,
-	          const int custom_flag,
-	          const int object_id,
-	          BL::BakePixel& pixel_array,
-	          const size_t num_pixels,
-	          const int depth,
-	          float pixels[]);
+	/* Object to bake, with a result buffer of 4 floats per pixel for every
+	 * pass. UDIM tiles of an object are baked as separate targets. */
+	struct BakeTarget {
+		BakeTarget(BL::Object& b_object,
+		           int object_id,
+		           BL::BakePixel& pixel_array,
+		           size_t num_pixels)
+		: b_object(b_object),
+		  object_id(object_id),
+		  pixel_array(pixel_array),
+		  num_pixels(num_pixels) {}
+
+		BL::Object b_object;
+		int object_id;
+		BL::BakePixel pixel_array;
+		size_t num_pixels;
+		vector<float*> results;
+	};
+
+	struct BakePass {
+		string pass_type;
+		int pass_filter;
+	};
+
+	/* Called with indices of target and pass, once the result is complete. */
+	typedef function<void(int, int)> BakeDoneFunc;
+
+	/* Bake many targets and passes, syncing the scene and building the BVH
+	 * only once. */
+	void bake_multi(BL::Depsgraph& b_depsgraph,
+	                const vector<BakePass>& passes,
+	                vector<BakeTarget>& targets,
+	                const BakeDoneFunc& bake_done);
 
 	void write_render_result(BL::RenderResult& b_rr,
 	                         BL::RenderLayer& b_rlay,
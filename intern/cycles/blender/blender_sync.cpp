@@ -37,6 +37,7 @@
 #include "util/util_foreach.h"
 #include "util/util_opengl.h"
 #include "util/util_hash.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -76,6 +77,12 @@ BlenderSync::~BlenderSync()
 {
 }
 
+void BlenderSync::reset(BL::BlendData& b_data, BL::Scene& b_scene)
+{
+	this->b_data = b_data;
+	this->b_scene = b_scene;
+}
+
 /* Sync */
 
 void BlenderSync::sync_recalc(BL::Depsgraph& b_depsgraph)
@@ -196,6 +203,8 @@ void BlenderSync::sync_data(BL::RenderSettings& b_render,
 
 	mesh_synced.clear(); /* use for objects and motion sync */
 
+	const double sync_start_time = time_dt();
+
 	if(scene->need_motion() == Scene::MOTION_PASS ||
 	   scene->need_motion() == Scene::MOTION_NONE ||
 	   scene->camera->motion_position == Camera::MOTION_POSITION_CENTER)
@@ -208,6 +217,8 @@ void BlenderSync::sync_data(BL::RenderSettings& b_render,
 	            width, height,
 	            python_thread_state);
 
+	scene->mesh_manager->sync_time = time_dt() - sync_start_time;
+
 	mesh_synced.clear();
 
 	free_data_after_sync(b_depsgraph);
@@ -280,6 +291,17 @@ void BlenderSync::sync_integrator()
 	integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
 	integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
 
+	/* Light tree is built by the light manager. */
+	const bool use_light_tree = get_boolean(cscene, "use_light_tree");
+	if(integrator->use_light_tree != use_light_tree) {
+		scene->light_manager->tag_update(scene);
+	}
+	integrator->use_light_tree = use_light_tree;
+
+	integrator->use_adaptive_sampling = get_boolean(cscene, "use_adaptive_sampling");
+	integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
 	int diffuse_samples = get_int(cscene, "diffuse_samples");
 	int glossy_samples = get_int(cscene, "glossy_samples");
 	int transmission_samples = get_int(cscene, "transmission_samples");
@@ -621,6 +643,12 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer& b_rlay,
 		scene->film->cryptomatte_passes = (CryptomatteType)(scene->film->cryptomatte_passes | CRYPT_ACCURATE);
 	}
 
+	/* Internal pass used for convergence test, not written to the render result. */
+	PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+	if(get_boolean(cscene, "use_adaptive_sampling")) {
+		Pass::add(PASS_ADAPTIVE_AUX_BUFFER, passes);
+	}
+
 	return passes;
 }
 
@@ -636,6 +664,10 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph& b_depsgraph)
 	if(!can_free_caches) {
 		return;
 	}
+	/* Depsgraph and its evaluated data are kept for the next frame. */
+	if(scene->params.persistent_data && b_engine.is_animation()) {
+		return;
+	}
 	/* TODO(sergey): We can actually remove the whole dependency graph,
 	 * but that will need some API support first.
 	 */
@@ -651,7 +683,8 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph& b_depsgraph)
 /* Scene Parameters */
 
 SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
-                                          bool background)
+                                          bool background,
+                                          bool animation)
 {
 	BL::RenderSettings r = b_scene.render();
 	SceneParams params;
@@ -670,6 +703,7 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 
 	params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
 	params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
+	params.use_bvh_quantized_nodes = RNA_boolean_get(&cscene, "debug_use_quantized_bvh");
 	params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
 
 	if(background && params.shadingsystem != SHADINGSYSTEM_OSL)
@@ -677,6 +711,14 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 	else
 		params.persistent_data = false;
 
+	/* Scene is kept between frames of an animation with persistent data.
+	 * Objects are instanced then, so moving objects only require the top level
+	 * BVH to be rebuilt, and only BVHs of changed meshes are refitted or
+	 * rebuilt. A still render has no next frame to reuse the scene for, so it
+	 * keeps the faster to trace static BVH. */
+	if(params.persistent_data && animation)
+		params.bvh_type = SceneParams::BVH_DYNAMIC;
+
 	int texture_limit;
 	if(background) {
 		texture_limit = RNA_enum_get(&cscene, "texture_limit_render");
@@ -691,6 +733,15 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 		params.texture_limit = 0;
 	}
 
+	if(RNA_boolean_get(&cscene, "use_texture_cache")) {
+		params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+	}
+	else {
+		params.texture_cache_size = 0;
+	}
+
+	params.use_compact_geometry = RNA_boolean_get(&cscene, "use_compact_geometry");
+
 	/* TODO(sergey): Once OSL supports per-microarchitecture optimization get
 	 * rid of this.
 	 */
@@ -29,6 +29,7 @@
 
 #include "util/util_map.h"
 #include "util/util_set.h"
+#include "util/util_task.h"
 #include "util/util_transform.h"
 #include "util/util_vector.h"
 
@@ -58,6 +59,9 @@ public:
 	            Progress &progress);
 	~BlenderSync();
 
+	/* Use new Blender data for a scene which is kept between renders. */
+	void reset(BL::BlendData& b_data, BL::Scene& b_scene);
+
 	/* sync */
 	void sync_recalc(BL::Depsgraph& b_depsgraph);
 	void sync_data(BL::RenderSettings& b_render,
@@ -83,7 +87,8 @@ public:
 
 	/* get parameters */
 	static SceneParams get_scene_params(BL::Scene& b_scene,
-	                                    bool background);
+	                                    bool background,
+	                                    bool animation);
 	static SessionParams get_session_params(BL::RenderEngine& b_engine,
 	                                        BL::Preferences& b_userpref,
 	                                        BL::Scene& b_scene,
@@ -120,7 +125,9 @@ private:
 	                BL::Object& b_ob_instance,
 	                bool object_updated,
 	                bool show_self,
-	                bool show_particles);
+	                bool show_particles,
+	                uint motion_steps,
+	                bool use_motion_blur);
 	void sync_curves(Mesh *mesh,
 	                 BL::Mesh& b_mesh,
 	                 BL::Object& b_ob,
@@ -146,6 +153,36 @@ private:
 	                      BL::Object& b_ob,
 	                      Object *object,
 	                      float motion_time);
+
+	/* Geometry conversion of a mesh, which runs in the task pool while
+	 * objects are synchronized. */
+	struct MeshSync {
+		MeshSync(Mesh *mesh, BL::Object& b_ob, bool show_self, bool show_particles)
+		: mesh(mesh),
+		  b_ob(b_ob),
+		  b_mesh(PointerRNA_NULL),
+		  show_self(show_self),
+		  show_particles(show_particles),
+		  rebuild(false) {}
+
+		Mesh *mesh;
+		BL::Object b_ob;
+		BL::Mesh b_mesh;
+		bool show_self;
+		bool show_particles;
+
+		/* Primitives before the sync, to detect if BVH needs a rebuild. */
+		array<int> oldtriangles;
+		array<Mesh::SubdFace> oldsubd_faces;
+		array<int> oldsubd_face_corners;
+		array<float3> oldcurve_keys;
+		array<float> oldcurve_radius;
+		bool rebuild;
+	};
+
+	void sync_mesh_data(MeshSync *sync);
+	/* Wait for conversion of all meshes and finish them. */
+	void sync_mesh_finish();
 	void sync_camera_motion(BL::RenderSettings& b_render,
 	                        BL::Object& b_ob,
 	                        int width, int height,
@@ -180,6 +217,8 @@ private:
 	id_map<ParticleSystemKey, ParticleSystem> particle_system_map;
 	set<Mesh*> mesh_synced;
 	set<Mesh*> mesh_motion_synced;
+	vector<MeshSync*> mesh_sync_queue;
+	TaskPool mesh_sync_pool;
 	set<float> motion_times;
 	void *world_map;
 	bool world_recalc;
@@ -516,8 +516,11 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 						nsize_bbox = BVH_ONODE_SIZE-1;
 					}
 					else {
-						nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
-						nsize_bbox = (use_qbvh)? BVH_QNODE_SIZE-1 : 0;
+						const size_t qnode_size = (params.use_quantized_nodes)
+							? BVH_QUANTIZED_QNODE_SIZE
+							: BVH_QNODE_SIZE;
+						nsize = (use_qbvh)? qnode_size: BVH_NODE_SIZE;
+						nsize_bbox = (use_qbvh)? qnode_size-1 : 0;
 					}
 				}
 
@@ -176,6 +176,17 @@ void BVH4::pack_aligned_node(int idx,
                              const float time_to,
                              const int num)
 {
+	if(params.use_quantized_nodes) {
+		pack_quantized_node(idx,
+		                    bounds,
+		                    child,
+		                    visibility,
+		                    time_from,
+		                    time_to,
+		                    num);
+		return;
+	}
+
 	float4 data[BVH_QNODE_SIZE];
 	memset(data, 0, sizeof(data));
 
@@ -216,6 +227,142 @@ void BVH4::pack_aligned_node(int idx,
 	memcpy(&pack.nodes[idx], data, sizeof(float4)*BVH_QNODE_SIZE);
 }
 
+/* Quantized nodes store child bounds as 8 bit offsets from the minimum of the
+ * node bounds, with a per axis scale. Rounding is always done outwards, so the
+ * decoded bounds enclose the actual ones.
+ *
+ * Decoding in the kernel is allowed to round differently (e.g. when it uses
+ * fused multiply-add), with an error relative to the magnitude of the decoded
+ * range rather than of the decoded value. Tolerance of a few ulps of the
+ * largest magnitude of the range is added on top to cover that. */
+
+static float bvh_quantize_tolerance(float lower, float upper)
+{
+	return max(fabsf(lower), fabsf(upper)) * 4.0f * FLT_EPSILON;
+}
+
+void bvh_quantize_axis(float lower,
+                       float upper,
+                       float *origin,
+                       float *scale,
+                       float *tolerance)
+{
+	const float node_tolerance = bvh_quantize_tolerance(lower, upper);
+	*origin = lower - node_tolerance;
+	*scale = (upper - *origin + node_tolerance) / 255.0f;
+	while(*origin + 255.0f * *scale < upper + node_tolerance) {
+		*scale *= 1.0f + FLT_EPSILON;
+	}
+	*tolerance = bvh_quantize_tolerance(*origin, *origin + 255.0f * *scale);
+}
+
+uint bvh_quantize_lower(float value, float origin, float scale, float tolerance)
+{
+	if(scale == 0.0f) {
+		return 0;
+	}
+	/* Decoding of zero is exact, the origin is always below the value. */
+	const float target = value - tolerance;
+	int q = clamp((int)floorf((target - origin) / scale), 0, 255);
+	while(q > 0 && origin + scale*q > target) {
+		q--;
+	}
+	return (uint)q;
+}
+
+uint bvh_quantize_upper(float value, float origin, float scale, float tolerance)
+{
+	if(scale == 0.0f) {
+		return 0;
+	}
+	const float target = value + tolerance;
+	int q = clamp((int)ceilf((target - origin) / scale), 0, 255);
+	while(q < 255 && origin + scale*q < target) {
+		q++;
+	}
+	return (uint)q;
+}
+
+void BVH4::pack_quantized_node(int idx,
+                               const BoundBox *bounds,
+                               const int *child,
+                               const uint visibility,
+                               const float time_from,
+                               const float time_to,
+                               const int num)
+{
+	float4 data[BVH_QUANTIZED_QNODE_SIZE];
+	memset(data, 0, sizeof(data));
+
+	/* Children with invalid bounds are never intersected, so the kernel does
+	 * not need to assume there are always 4 child nodes. */
+	BoundBox node_bounds = BoundBox::empty;
+	int child_mask = 0;
+	for(int i = 0; i < num; i++) {
+		if(bounds[i].valid()) {
+			node_bounds.grow(bounds[i]);
+			child_mask |= (1 << i);
+		}
+	}
+
+	float3 origin = make_float3(0.0f, 0.0f, 0.0f);
+	float3 scale = make_float3(0.0f, 0.0f, 0.0f);
+	float3 tolerance = make_float3(0.0f, 0.0f, 0.0f);
+	uint qbounds[6] = {0, 0, 0, 0, 0, 0};
+	if(child_mask != 0) {
+		for(int axis = 0; axis < 3; axis++) {
+			bvh_quantize_axis(node_bounds.min[axis],
+			                  node_bounds.max[axis],
+			                  &origin[axis],
+			                  &scale[axis],
+			                  &tolerance[axis]);
+		}
+		for(int i = 0; i < num; i++) {
+			if((child_mask & (1 << i)) == 0) {
+				continue;
+			}
+			for(int axis = 0; axis < 3; axis++) {
+				const uint lower = bvh_quantize_lower(bounds[i].min[axis],
+				                                      origin[axis],
+				                                      scale[axis],
+				                                      tolerance[axis]);
+				const uint upper = bvh_quantize_upper(bounds[i].max[axis],
+				                                      origin[axis],
+				                                      scale[axis],
+				                                      tolerance[axis]);
+				qbounds[axis*2 + 0] |= lower << (i*8);
+				qbounds[axis*2 + 1] |= upper << (i*8);
+			}
+		}
+	}
+
+	data[0].x = __uint_as_float(visibility & ~PATH_RAY_NODE_UNALIGNED);
+	data[0].y = time_from;
+	data[0].z = time_to;
+	data[0].w = __int_as_float(child_mask);
+
+	data[1] = make_float4(origin.x, origin.y, origin.z, scale.x);
+	data[2] = make_float4(scale.y,
+	                      scale.z,
+	                      __uint_as_float(qbounds[0]),
+	                      __uint_as_float(qbounds[1]));
+	data[3] = make_float4(__uint_as_float(qbounds[2]),
+	                      __uint_as_float(qbounds[3]),
+	                      __uint_as_float(qbounds[4]),
+	                      __uint_as_float(qbounds[5]));
+
+	for(int i = 0; i < num; i++) {
+		data[4][i] = __int_as_float(child[i]);
+	}
+
+	memcpy(&pack.nodes[idx], data, sizeof(float4)*BVH_QUANTIZED_QNODE_SIZE);
+}
+
+int BVH4::aligned_node_size() const
+{
+	return (params.use_quantized_nodes)? BVH_QUANTIZED_QNODE_SIZE: BVH_QNODE_SIZE;
+}
+
 void BVH4::pack_unaligned_inner(const BVHStackEntry& e,
                                 const BVHStackEntry *en,
                                 int num)
@@ -319,10 +466,10 @@ void BVH4::pack_nodes(const BVHNode *root)
 		const size_t num_unaligned_nodes =
 		        root->getSubtreeSize(BVH_STAT_UNALIGNED_INNER_COUNT);
 		node_size = (num_unaligned_nodes * BVH_UNALIGNED_QNODE_SIZE) +
-		            (num_inner_nodes - num_unaligned_nodes) * BVH_QNODE_SIZE;
+		            (num_inner_nodes - num_unaligned_nodes) * aligned_node_size();
 	}
 	else {
-		node_size = num_inner_nodes * BVH_QNODE_SIZE;
+		node_size = num_inner_nodes * aligned_node_size();
 	}
 	/* Resize arrays. */
 	pack.nodes.clear();
@@ -346,7 +493,7 @@ void BVH4::pack_nodes(const BVHNode *root)
 	else {
 		stack.push_back(BVHStackEntry(root, nextNodeIdx));
 		nextNodeIdx += root->has_unaligned() ? BVH_UNALIGNED_QNODE_SIZE
-		                                     : BVH_QNODE_SIZE;
+		                                     : aligned_node_size();
 	}
 
 	while(stack.size()) {
@@ -375,7 +522,7 @@ void BVH4::pack_nodes(const BVHNode *root)
 					idx = nextNodeIdx;
 					nextNodeIdx += children[i]->has_unaligned()
 					                       ? BVH_UNALIGNED_QNODE_SIZE
-					                       : BVH_QNODE_SIZE;
+					                       : aligned_node_size();
 				}
 				stack.push_back(BVHStackEntry(children[i], idx));
 			}
@@ -432,7 +579,7 @@ void BVH4::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 			c = data[13];
 		}
 		else {
-			c = data[7];
+			c = data[aligned_node_size() - 1];
 		}
 		/* Refit inner node, set bbox from children. */
 		BoundBox child_bbox[4] = {BoundBox::empty,
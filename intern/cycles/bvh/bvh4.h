@@ -37,6 +37,7 @@ class Progress;
 #define BVH_QNODE_SIZE           8
 #define BVH_QNODE_LEAF_SIZE      1
 #define BVH_UNALIGNED_QNODE_SIZE 14
+#define BVH_QUANTIZED_QNODE_SIZE 5
 
 /* BVH4
  *
@@ -67,6 +68,15 @@ protected:
 	                       const float time_from,
 	                       const float time_to,
 	                       const int num);
+	void pack_quantized_node(int idx,
+	                         const BoundBox *bounds,
+	                         const int *child,
+	                         const uint visibility,
+	                         const float time_from,
+	                         const float time_to,
+	                         const int num);
+	/* Size of aligned inner nodes, depends on whether bounds are quantized. */
+	int aligned_node_size() const;
 
 	void pack_unaligned_inner(const BVHStackEntry& e,
 	                          const BVHStackEntry *en,
@@ -85,6 +95,17 @@ protected:
 	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
 };
 
+/* Quantization of child bounds of quantized nodes along one axis. The node
+ * range [lower, upper] is mapped to origin + q * scale with 8 bit q, child
+ * bounds are quantized outwards using the returned tolerance. */
+void bvh_quantize_axis(float lower,
+                       float upper,
+                       float *origin,
+                       float *scale,
+                       float *tolerance);
+uint bvh_quantize_lower(float value, float origin, float scale, float tolerance);
+uint bvh_quantize_upper(float value, float origin, float scale, float tolerance);
+
 CCL_NAMESPACE_END
 
 #endif  /* __BVH4_H__ */
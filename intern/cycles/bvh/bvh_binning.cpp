@@ -23,6 +23,8 @@
 
 #include "util/util_algorithm.h"
 #include "util/util_boundbox.h"
+#include "util/util_foreach.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -82,57 +84,41 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange& job,
 	num_bins = min(size_t(MAX_BINS), size_t(4.0f + 0.05f*size()));
 	scale = rcp(cent_bounds_.size()) * make_float3((float)num_bins);
 
-	/* initialize binning counter and bounds */
-	BoundBox bin_bounds[MAX_BINS][4];	/* bounds for every bin in every dimension */
-	int4 bin_count[MAX_BINS];			/* number of primitives mapped to bin */
+	/* map geometry to bins */
+	Bins bins;
+	clear_bins(&bins);
 
-	for(size_t i = 0; i < num_bins; i++) {
-		bin_count[i] = make_int4(0);
-		bin_bounds[i][0] = bin_bounds[i][1] = bin_bounds[i][2] = BoundBox::empty;
+	if(size() < 2*PARALLEL_BLOCK_SIZE) {
+		bin_primitives(prims, start(), end(), &bins);
 	}
-
-	/* map geometry to bins, unrolled once */
-	{
-		ssize_t i;
-
-		for(i = 0; i < ssize_t(size()) - 1; i += 2) {
-			prefetch_L2(&prims[start() + i + 8]);
-
-			/* map even and odd primitive to bin */
-			const BVHReference& prim0 = prims[start() + i + 0];
-			const BVHReference& prim1 = prims[start() + i + 1];
-
-			BoundBox bounds0 = get_prim_bounds(prim0);
-			BoundBox bounds1 = get_prim_bounds(prim1);
-
-			int4 bin0 = get_bin(bounds0);
-			int4 bin1 = get_bin(bounds1);
-
-			/* increase bounds for bins for even primitive */
-			int b00 = (int)extract<0>(bin0); bin_count[b00][0]++; bin_bounds[b00][0].grow(bounds0);
-			int b01 = (int)extract<1>(bin0); bin_count[b01][1]++; bin_bounds[b01][1].grow(bounds0);
-			int b02 = (int)extract<2>(bin0); bin_count[b02][2]++; bin_bounds[b02][2].grow(bounds0);
-
-			/* increase bounds of bins for odd primitive */
-			int b10 = (int)extract<0>(bin1); bin_count[b10][0]++; bin_bounds[b10][0].grow(bounds1);
-			int b11 = (int)extract<1>(bin1); bin_count[b11][1]++; bin_bounds[b11][1].grow(bounds1);
-			int b12 = (int)extract<2>(bin1); bin_count[b12][2]++; bin_bounds[b12][2].grow(bounds1);
+	else {
+		/* Bin blocks of primitives in parallel and merge them in order, the
+		 * result does not depend on the number of threads. */
+		const size_t num_blocks = divide_up(size(), PARALLEL_BLOCK_SIZE);
+		vector<Bins> block_bins(num_blocks);
+
+		TaskPool task_pool;
+		for(size_t block = 0; block < num_blocks; block++) {
+			const int block_start = start() + block*PARALLEL_BLOCK_SIZE;
+			const int block_end = min(block_start + (int)PARALLEL_BLOCK_SIZE, end());
+			clear_bins(&block_bins[block]);
+			task_pool.push(function_bind(&BVHObjectBinning::bin_primitives,
+			                             this,
+			                             prims,
+			                             block_start,
+			                             block_end,
+			                             &block_bins[block]));
 		}
+		task_pool.wait_work();
 
-		/* for uneven number of primitives */
-		if(i < ssize_t(size())) {
-			/* map primitive to bin */
-			const BVHReference& prim0 = prims[start() + i];
-			BoundBox bounds0 = get_prim_bounds(prim0);
-			int4 bin0 = get_bin(bounds0);
-
-			/* increase bounds of bins */
-			int b00 = (int)extract<0>(bin0); bin_count[b00][0]++; bin_bounds[b00][0].grow(bounds0);
-			int b01 = (int)extract<1>(bin0); bin_count[b01][1]++; bin_bounds[b01][1].grow(bounds0);
-			int b02 = (int)extract<2>(bin0); bin_count[b02][2]++; bin_bounds[b02][2].grow(bounds0);
+		foreach(const Bins& other, block_bins) {
+			merge_bins(&bins, other);
 		}
 	}
 
+	BoundBox (*bin_bounds)[4] = bins.bounds;
+	int4 *bin_count = bins.count;
+
 	/* sweep from right to left and compute parallel prefix of merged bounds */
 	float4 r_area[MAX_BINS];	/* area of bounds of primitives on the right */
 	float4 r_count[MAX_BINS];	/* number of primitives on the right */
@@ -188,6 +174,73 @@ BVHObjectBinning::BVHObjectBinning(const BVHRange& job,
 	leafSAH = bounds_.half_area() * blocks(size());
 }
 
+void BVHObjectBinning::clear_bins(Bins *bins) const
+{
+	for(size_t i = 0; i < num_bins; i++) {
+		bins->count[i] = make_int4(0);
+		bins->bounds[i][0] = bins->bounds[i][1] = bins->bounds[i][2] = BoundBox::empty;
+	}
+}
+
+void BVHObjectBinning::merge_bins(Bins *bins, const Bins& other) const
+{
+	for(size_t i = 0; i < num_bins; i++) {
+		bins->count[i] = bins->count[i] + other.count[i];
+		bins->bounds[i][0].grow(other.bounds[i][0]);
+		bins->bounds[i][1].grow(other.bounds[i][1]);
+		bins->bounds[i][2].grow(other.bounds[i][2]);
+	}
+}
+
+void BVHObjectBinning::bin_primitives(const BVHReference *prims,
+                                      int bin_start,
+                                      int bin_end,
+                                      Bins *bins) const
+{
+	BoundBox (*bin_bounds)[4] = bins->bounds;
+	int4 *bin_count = bins->count;
+
+	/* map geometry to bins, unrolled once */
+	ssize_t i;
+
+	for(i = bin_start; i < ssize_t(bin_end) - 1; i += 2) {
+		prefetch_L2(&prims[i + 8]);
+
+		/* map even and odd primitive to bin */
+		const BVHReference& prim0 = prims[i + 0];
+		const BVHReference& prim1 = prims[i + 1];
+
+		BoundBox bounds0 = get_prim_bounds(prim0);
+		BoundBox bounds1 = get_prim_bounds(prim1);
+
+		int4 bin0 = get_bin(bounds0);
+		int4 bin1 = get_bin(bounds1);
+
+		/* increase bounds for bins for even primitive */
+		int b00 = (int)extract<0>(bin0); bin_count[b00][0]++; bin_bounds[b00][0].grow(bounds0);
+		int b01 = (int)extract<1>(bin0); bin_count[b01][1]++; bin_bounds[b01][1].grow(bounds0);
+		int b02 = (int)extract<2>(bin0); bin_count[b02][2]++; bin_bounds[b02][2].grow(bounds0);
+
+		/* increase bounds of bins for odd primitive */
+		int b10 = (int)extract<0>(bin1); bin_count[b10][0]++; bin_bounds[b10][0].grow(bounds1);
+		int b11 = (int)extract<1>(bin1); bin_count[b11][1]++; bin_bounds[b11][1].grow(bounds1);
+		int b12 = (int)extract<2>(bin1); bin_count[b12][2]++; bin_bounds[b12][2].grow(bounds1);
+	}
+
+	/* for uneven number of primitives */
+	if(i < ssize_t(bin_end)) {
+		/* map primitive to bin */
+		const BVHReference& prim0 = prims[i];
+		BoundBox bounds0 = get_prim_bounds(prim0);
+		int4 bin0 = get_bin(bounds0);
+
+		/* increase bounds of bins */
+		int b00 = (int)extract<0>(bin0); bin_count[b00][0]++; bin_bounds[b00][0].grow(bounds0);
+		int b01 = (int)extract<1>(bin0); bin_count[b01][1]++; bin_bounds[b01][1].grow(bounds0);
+		int b02 = (int)extract<2>(bin0); bin_count[b02][2]++; bin_bounds[b02][2].grow(bounds0);
+	}
+}
+
 void BVHObjectBinning::split(BVHReference* prims,
                              BVHObjectBinning& left_o,
                              BVHObjectBinning& right_o) const
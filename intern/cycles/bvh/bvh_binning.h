@@ -27,12 +27,15 @@ CCL_NAMESPACE_BEGIN
 
 class BVHBuild;
 
-/* Single threaded object binner. Finds the split with the best SAH heuristic
- * by testing for each dimension multiple partitionings for regular spaced
- * partition locations. A partitioning for a partition location is computed,
- * by putting primitives whose centroid is on the left and right of the split
- * location to different sets. The SAH is evaluated by computing the number of
- * blocks occupied by the primitives in the partitions. */
+/* Object binner. Finds the split with the best SAH heuristic by testing for
+ * each dimension multiple partitionings for regular spaced partition
+ * locations. A partitioning for a partition location is computed, by putting
+ * primitives whose centroid is on the left and right of the split location to
+ * different sets. The SAH is evaluated by computing the number of blocks
+ * occupied by the primitives in the partitions.
+ *
+ * Large ranges are binned in parallel, every block of primitives into its own
+ * bins which are merged afterwards. */
 
 class BVHObjectBinning : public BVHRange
 {
@@ -68,6 +71,21 @@ protected:
 
 	enum { MAX_BINS = 32 };
 	enum { LOG_BLOCK_SIZE = 2 };
+	/* Number of primitives binned by a single task. */
+	enum { PARALLEL_BLOCK_SIZE = 16384 };
+
+	struct Bins {
+		BoundBox bounds[MAX_BINS][4];	/* bounds for every bin in every dimension */
+		int4 count[MAX_BINS];			/* number of primitives mapped to bin */
+	};
+
+	void clear_bins(Bins *bins) const;
+	void merge_bins(Bins *bins, const Bins& other) const;
+	/* Map primitives of [bin_start, bin_end) to bins. */
+	void bin_primitives(const BVHReference *prims,
+	                    int bin_start,
+	                    int bin_end,
+	                    Bins *bins) const;
 
 	/* computes the bin numbers for each dimension for a box. */
 	__forceinline int4 get_bin(const BoundBox& box) const
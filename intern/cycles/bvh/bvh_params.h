@@ -79,6 +79,12 @@ public:
 	 */
 	bool use_unaligned_nodes;
 
+	/* Store bounds of aligned nodes children quantized to 8 bit relative to
+	 * the node bounds, reducing memory usage at the cost of looser bounds.
+	 * Only used for BVH4 layout.
+	 */
+	bool use_quantized_nodes;
+
 	/* Split time range to this number of steps and create leaf node for each
 	 * of this time steps.
 	 *
@@ -125,6 +131,7 @@ public:
 		top_level = false;
 		bvh_layout = BVH_LAYOUT_BVH2;
 		use_unaligned_nodes = false;
+		use_quantized_nodes = false;
 
 		primitive_mask = PRIMITIVE_ALL;
 
@@ -24,6 +24,7 @@
 #include "render/object.h"
 
 #include "util/util_algorithm.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -174,34 +175,53 @@ BVHSpatialSplit::BVHSpatialSplit(const BVHBuild& builder,
 	}
 
 	/* chop references into bins. */
-	for(unsigned int refIdx = range.start(); refIdx < range.end(); refIdx++) {
-		const BVHReference& ref = references_->at(refIdx);
-		BoundBox prim_bounds = get_prim_bounds(ref);
-		float3 firstBinf = (prim_bounds.min - origin) * invBinSize;
-		float3 lastBinf = (prim_bounds.max - origin) * invBinSize;
-		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
-		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
-
-		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
-		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
-
-		for(int dim = 0; dim < 3; dim++) {
-			BVHReference currRef(get_prim_bounds(ref),
-			                     ref.prim_index(),
-			                     ref.prim_object(),
-			                     ref.prim_type());
-
-			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
-				BVHReference leftRef, rightRef;
-
-				split_reference(builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
-				storage_->bins[dim][i].bounds.grow(leftRef.bounds());
-				currRef = rightRef;
+	if(range.size() < 2*PARALLEL_BLOCK_SIZE) {
+		bin_references(&builder,
+		               range.start(),
+		               range.end(),
+		               origin,
+		               binSize,
+		               invBinSize,
+		               &storage_->bins[0][0]);
+	}
+	else {
+		/* Splitting references is expensive, so at the top levels blocks of
+		 * references are binned in parallel and merged in order. */
+		const int num_bins = 3 * BVHParams::NUM_SPATIAL_BINS;
+		const int num_blocks = divide_up(range.size(), PARALLEL_BLOCK_SIZE);
+		vector<BVHSpatialBin> block_bins(num_blocks * num_bins);
+
+		TaskPool task_pool;
+		for(int block = 0; block < num_blocks; block++) {
+			BVHSpatialBin *bins = &block_bins[block * num_bins];
+			for(int i = 0; i < num_bins; i++) {
+				bins[i].bounds = BoundBox::empty;
+				bins[i].enter = 0;
+				bins[i].exit = 0;
 			}
 
-			storage_->bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
-			storage_->bins[dim][firstBin[dim]].enter++;
-			storage_->bins[dim][lastBin[dim]].exit++;
+			const int block_start = range.start() + block * PARALLEL_BLOCK_SIZE;
+			const int block_end = min(block_start + (int)PARALLEL_BLOCK_SIZE, range.end());
+			task_pool.push(function_bind(&BVHSpatialSplit::bin_references,
+			                             this,
+			                             &builder,
+			                             block_start,
+			                             block_end,
+			                             origin,
+			                             binSize,
+			                             invBinSize,
+			                             bins));
+		}
+		task_pool.wait_work();
+
+		BVHSpatialBin *bins = &storage_->bins[0][0];
+		for(int block = 0; block < num_blocks; block++) {
+			const BVHSpatialBin *other = &block_bins[block * num_bins];
+			for(int i = 0; i < num_bins; i++) {
+				bins[i].bounds.grow(other[i].bounds);
+				bins[i].enter += other[i].enter;
+				bins[i].exit += other[i].exit;
+			}
 		}
 	}
 
@@ -238,6 +258,47 @@ BVHSpatialSplit::BVHSpatialSplit(const BVHBuild& builder,
 	}
 }
 
+void BVHSpatialSplit::bin_references(const BVHBuild *builder,
+                                     int bin_start,
+                                     int bin_end,
+                                     float3 origin,
+                                     float3 bin_size,
+                                     float3 inv_bin_size,
+                                     BVHSpatialBin *bins)
+{
+	for(int refIdx = bin_start; refIdx < bin_end; refIdx++) {
+		const BVHReference& ref = references_->at(refIdx);
+		BoundBox prim_bounds = get_prim_bounds(ref);
+		float3 firstBinf = (prim_bounds.min - origin) * inv_bin_size;
+		float3 lastBinf = (prim_bounds.max - origin) * inv_bin_size;
+		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
+		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+
+		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
+		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+
+		for(int dim = 0; dim < 3; dim++) {
+			BVHSpatialBin *dim_bins = &bins[dim * BVHParams::NUM_SPATIAL_BINS];
+			BVHReference currRef(get_prim_bounds(ref),
+			                     ref.prim_index(),
+			                     ref.prim_object(),
+			                     ref.prim_type());
+
+			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
+				BVHReference leftRef, rightRef;
+
+				split_reference(*builder, leftRef, rightRef, currRef, dim, origin[dim] + bin_size[dim] * (float)(i + 1));
+				dim_bins[i].bounds.grow(leftRef.bounds());
+				currRef = rightRef;
+			}
+
+			dim_bins[lastBin[dim]].bounds.grow(currRef.bounds());
+			dim_bins[firstBin[dim]].enter++;
+			dim_bins[lastBin[dim]].exit++;
+		}
+	}
+}
+
 void BVHSpatialSplit::split(BVHBuild *builder,
                             BVHRange& left,
                             BVHRange& right,
@@ -103,6 +103,19 @@ public:
 	                     float pos);
 
 protected:
+	/* Number of references binned by a single task. */
+	enum { PARALLEL_BLOCK_SIZE = 4096 };
+
+	/* Chop references of [bin_start, bin_end) into bins, which are indexed
+	 * as bins[dim * NUM_SPATIAL_BINS + i]. */
+	void bin_references(const BVHBuild *builder,
+	                    int bin_start,
+	                    int bin_end,
+	                    float3 origin,
+	                    float3 bin_size,
+	                    float3 inv_bin_size,
+	                    BVHSpatialBin *bins);
+
 	BVHSpatialStorage *storage_;
 	vector<BVHReference> *references_;
 	const BVHUnaligned *unaligned_heuristic_;
@@ -376,8 +376,12 @@ Device *Device::create(DeviceInfo& info, Stats &stats, Profiler &profiler, bool
 #endif
 #ifdef WITH_NETWORK
 		case DEVICE_NETWORK:
-			device = device_network_create(info, stats, profiler, "127.0.0.1");
+		{
+			/* Server address follows the NETWORK_ prefix of the identifier. */
+			const string address = string_startswith(info.id, "NETWORK_")? info.id.substr(8): "";
+			device = device_network_create(info, stats, profiler, address.c_str());
 			break;
+		}
 #endif
 #ifdef WITH_OPENCL
 		case DEVICE_OPENCL:
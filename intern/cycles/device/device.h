@@ -319,6 +319,10 @@ public:
 	/* open shading language, only for CPU device */
 	virtual void *osl_memory() { return NULL; }
 
+	/* texture cache for reading images on demand, only for CPU device.
+	 * returns false if the device does not support it */
+	virtual bool set_texture_cache(void * /*texture_cache*/) { return false; }
+
 	/* load/compile kernels, must be called before adding tasks */
 	virtual bool load_kernels(
 	        const DeviceRequestedFeatures& /*requested_features*/)
@@ -337,8 +341,8 @@ public:
 	    bool transparent, const DeviceDrawParams &draw_params);
 
 #ifdef WITH_NETWORK
-	/* networking */
-	void server_run();
+	/* networking, port of zero uses the default port */
+	void server_run(int port);
 #endif
 
 	/* multi device */
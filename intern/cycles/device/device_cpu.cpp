@@ -34,6 +34,7 @@
 #include "kernel/kernel_types.h"
 #include "kernel/split/kernel_split_data.h"
 #include "kernel/kernel_globals.h"
+#include "kernel/kernel_adaptive_sampling.h"
 
 #include "kernel/filter/filter.h"
 
@@ -53,6 +54,7 @@
 #include "util/util_progress.h"
 #include "util/util_system.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -74,7 +76,8 @@ public:
 	                F kernel_sse3,
 	                F kernel_sse41,
 	                F kernel_avx,
-	                F kernel_avx2)
+	                F kernel_avx2,
+	                F kernel_avx512)
 	{
 		const char *architecture_name = "default";
 		kernel = kernel_default;
@@ -86,6 +89,14 @@ public:
 		(void) kernel_sse41;
 		(void) kernel_avx;
 		(void) kernel_avx2;
+		(void) kernel_avx512;
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX512
+		if(DebugFlags().cpu.has_avx512() && system_cpu_support_avx512()) {
+			architecture_name = "AVX-512";
+			kernel = kernel_avx512;
+		}
+		else
+#endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
 		if(DebugFlags().cpu.has_avx2() && system_cpu_support_avx2()) {
 			architecture_name = "AVX2";
@@ -207,7 +218,8 @@ public:
 	      KERNEL_NAME_EVAL(cpu_sse3, name), \
 	      KERNEL_NAME_EVAL(cpu_sse41, name), \
 	      KERNEL_NAME_EVAL(cpu_avx, name), \
-	      KERNEL_NAME_EVAL(cpu_avx2, name)
+	      KERNEL_NAME_EVAL(cpu_avx2, name), \
+	      KERNEL_NAME_EVAL(cpu_avx512, name)
 
 	CPUDevice(DeviceInfo& info_, Stats &stats_, Profiler &profiler_, bool background_)
 	: Device(info_, stats_, profiler_, background_),
@@ -240,6 +252,8 @@ public:
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		kernel_globals.texture_cache = NULL;
+		kernel_globals.texture_cache_thread_info = NULL;
 		use_split_kernel = DebugFlags().cpu.split_kernel;
 		if(use_split_kernel) {
 			VLOG(1) << "Will be using split kernel.";
@@ -422,6 +436,8 @@ public:
 
 			TextureInfo& info = texture_info[flat_slot];
 			info.data = (uint64_t)mem.host_pointer;
+			info.cache_handle = (uint64_t)mem.texture_cache_handle;
+			info.sparse_tiles = mem.sparse_tiles;
 			info.cl_buffer = 0;
 			info.interpolation = mem.interpolation;
 			info.extension = mem.extension;
@@ -456,6 +472,12 @@ public:
 #endif
 	}
 
+	bool set_texture_cache(void *texture_cache)
+	{
+		kernel_globals.texture_cache = texture_cache;
+		return true;
+	}
+
 	void thread_run(DeviceTask *task)
 	{
 		if(task->type == DeviceTask::RENDER) {
@@ -746,11 +768,52 @@ public:
 		return true;
 	}
 
+	/* Check which pixels of the tile converged after given number of samples.
+	 * Returns true if all of them did, so rendering of the tile can stop. */
+	bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile &tile, int num_samples)
+	{
+		float *render_buffer = (float*)tile.buffer;
+		const int pass_stride = kernel_data.film.pass_stride;
+
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				const int index = tile.offset + x + y*tile.stride;
+				kernel_adaptive_stopping(kg, render_buffer + index*pass_stride, num_samples);
+			}
+		}
+
+		bool any = false;
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			any |= kernel_adaptive_filter_x(kg, render_buffer, y, tile.x, tile.w,
+			                                tile.offset, tile.stride, num_samples);
+		}
+		for(int x = tile.x; x < tile.x + tile.w; x++) {
+			any |= kernel_adaptive_filter_y(kg, render_buffer, x, tile.y, tile.h,
+			                                tile.offset, tile.stride, num_samples);
+		}
+		return !any;
+	}
+
+	/* Scale pixels which stopped early to the number of samples of the tile,
+	 * so the rest of the pipeline does not need to know about adaptive sampling. */
+	void adaptive_sampling_post_adjust(KernelGlobals *kg, RenderTile &tile)
+	{
+		float *render_buffer = (float*)tile.buffer;
+		const int pass_stride = kernel_data.film.pass_stride;
+
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				const int index = tile.offset + x + y*tile.stride;
+				kernel_adaptive_post_adjust(kg, render_buffer + index*pass_stride, tile.sample);
+			}
+		}
+	}
+
 	void path_trace(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
 	{
 		const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
-
-		scoped_timer timer(&tile.buffers->render_time);
+		const bool use_adaptive_sampling = kernel_data.film.pass_adaptive_aux_buffer &&
+		                                   kernel_data.integrator.adaptive_threshold > 0.0f;
 
 		Coverage coverage(kg, tile);
 		if(use_coverage) {
@@ -783,10 +846,23 @@ public:
 			tile.sample = sample + 1;
 
 			task.update_progress(&tile, tile.w*tile.h);
+
+			if(use_adaptive_sampling && kernel_adaptive_need_filter(kg, tile.sample)) {
+				if(adaptive_sampling_filter(kg, tile, tile.sample)) {
+					/* Time of the remaining samples goes to other tiles. */
+					const int num_skipped_samples = end_sample - tile.sample;
+					tile.sample = end_sample;
+					task.update_progress(&tile, tile.w*tile.h*num_skipped_samples);
+					break;
+				}
+			}
 		}
 		if(use_coverage) {
 			coverage.finalize();
 		}
+		if(use_adaptive_sampling) {
+			adaptive_sampling_post_adjust(kg, tile);
+		}
 	}
 
 	void denoise(DenoisingTask& denoising, RenderTile &tile)
@@ -844,6 +920,9 @@ public:
 
 		while(task.acquire_tile(this, tile)) {
 			if(tile.task == RenderTile::PATH_TRACE) {
+				/* Render time is measured for the whole tile, timing every
+				 * sample costs more than some of the samples themselves. */
+				scoped_timer timer;
 				if(use_split_kernel) {
 					device_only_memory<uchar> void_buffer(this, "void_buffer");
 					split_kernel->path_trace(&task, tile, kgbuffer, void_buffer);
@@ -851,6 +930,7 @@ public:
 				else {
 					path_trace(task, tile, kg);
 				}
+				tile.buffers->add_tile_render_time(tile, timer.get_time());
 			}
 			else if(tile.task == RenderTile::DENOISE) {
 				denoise(denoising, tile);
@@ -1101,7 +1181,9 @@ int2 CPUSplitKernel::split_kernel_local_size()
 }
 
 int2 CPUSplitKernel::split_kernel_global_size(device_memory& /*kg*/, device_memory& /*data*/, DeviceTask * /*task*/) {
-	return make_int2(1, 1);
+	/* Every thread keeps a wavefront of paths in flight, so there are enough
+	 * of them for sorting by shader and ray direction to find coherent work. */
+	return make_int2(32, 32);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory& kernel_globals, device_memory& /*data*/, size_t num_threads) {
@@ -1139,7 +1221,8 @@ string device_cpu_capabilities()
 	capabilities += system_cpu_support_sse3() ? "SSE3 " : "";
 	capabilities += system_cpu_support_sse41() ? "SSE41 " : "";
 	capabilities += system_cpu_support_avx() ? "AVX " : "";
-	capabilities += system_cpu_support_avx2() ? "AVX2" : "";
+	capabilities += system_cpu_support_avx2() ? "AVX2 " : "";
+	capabilities += system_cpu_support_avx512() ? "AVX512" : "";
 	if(capabilities[capabilities.size() - 1] == ' ')
 		capabilities.resize(capabilities.size() - 1);
 	return capabilities;
@@ -1221,6 +1221,8 @@ public:
 		/* Set Mapping and tag that we need to (re-)upload to device */
 		TextureInfo& info = texture_info[flat_slot];
 		info.data = (uint64_t)cmem->texobject;
+		info.cache_handle = 0;
+		info.sparse_tiles = 0;
 		info.cl_buffer = 0;
 		info.interpolation = mem.interpolation;
 		info.extension = mem.extension;
@@ -1664,7 +1666,7 @@ public:
 
 	void path_trace(DeviceTask& task, RenderTile& rtile, device_vector<WorkTile>& work_tiles)
 	{
-		scoped_timer timer(&rtile.buffers->render_time);
+		scoped_timer timer;
 
 		if(have_error())
 			return;
@@ -1743,6 +1745,8 @@ public:
 					break;
 			}
 		}
+
+		rtile.buffers->add_tile_render_time(rtile, timer.get_time());
 	}
 
 	void film_convert(DeviceTask& task, device_ptr buffer, device_ptr rgba_byte, device_ptr rgba_half)
@@ -204,6 +204,10 @@ public:
 	const char *name;
 	InterpolationType interpolation;
 	ExtensionType extension;
+	/* Image texture which is read on demand by the texture cache. */
+	void *texture_cache_handle;
+	/* Volume which is stored in sparse tiles, see TextureInfo. */
+	bool sparse_tiles;
 
 	/* Pointers. */
 	Device *device;
@@ -62,16 +62,24 @@ public:
 		}
 
 #ifdef WITH_NETWORK
-		/* try to add network devices */
-		ServerDiscovery discovery(true);
-		time_sleep(1.0);
+		/* try to add network devices, unless servers were given explicitly */
+		bool have_network_devices = false;
+		foreach(DeviceInfo& subinfo, info.multi_devices) {
+			if(subinfo.type == DEVICE_NETWORK)
+				have_network_devices = true;
+		}
 
-		vector<string> servers = discovery.get_server_list();
+		if(!have_network_devices) {
+			ServerDiscovery discovery(true);
+			time_sleep(1.0);
 
-		foreach(string& server, servers) {
-			Device *device = device_network_create(info, stats, profiler, server.c_str());
-			if(device)
-				devices.push_back(SubDevice(device));
+			vector<string> servers = discovery.get_server_list();
+
+			foreach(string& server, servers) {
+				Device *device = device_network_create(info, stats, profiler, server.c_str());
+				if(device)
+					devices.push_back(SubDevice(device));
+			}
 		}
 #endif
 	}
@@ -20,15 +20,118 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_murmurhash.h"
+#include "util/util_thread.h"
 
 #if defined(WITH_NETWORK)
 
+#include <zlib.h>
+
 CCL_NAMESPACE_BEGIN
 
 typedef map<device_ptr, device_ptr> PtrMap;
 typedef vector<uint8_t> DataVector;
 typedef map<device_ptr, DataVector> DataMap;
 
+/* Split server address of the form host:port, port is optional. IPv6
+ * addresses are written in brackets when followed by a port, [addr]:port. */
+static void network_parse_address(const string& address, string& host, int& port)
+{
+	host = address;
+	port = SERVER_PORT;
+
+	if(!address.empty() && address[0] == '[') {
+		size_t bracket = address.find(']');
+		if(bracket != string::npos) {
+			host = address.substr(1, bracket - 1);
+			if(bracket + 1 < address.size() && address[bracket + 1] == ':') {
+				port = atoi(address.substr(bracket + 2).c_str());
+			}
+		}
+	}
+	else {
+		/* More than one colon is an IPv6 address without port. */
+		size_t colon = address.find(':');
+		if(colon != string::npos && address.find(':', colon + 1) == string::npos) {
+			host = address.substr(0, colon);
+			port = atoi(address.substr(colon + 1).c_str());
+		}
+	}
+
+	if(host.empty())
+		host = "127.0.0.1";
+	if(port <= 0)
+		port = SERVER_PORT;
+}
+
+/* Hash of buffer contents, used to detect buffers the server already has.
+ * Two differently seeded hashes are combined to make collisions unlikely. */
+static uint64_t network_buffer_hash(const void *data, size_t size)
+{
+	const uint8_t *bytes = (const uint8_t*)data;
+	const size_t chunk_size = (size_t)1 << 30;
+	uint32_t hash_a = 0, hash_b = 0x9e3779b9;
+
+	for(size_t offset = 0; offset < size; offset += chunk_size) {
+		int len = (int)((size - offset < chunk_size)? size - offset: chunk_size);
+		hash_a = util_murmur_hash3(bytes + offset, len, hash_a);
+		hash_b = util_murmur_hash3(bytes + offset, len, hash_b);
+	}
+
+	return ((uint64_t)hash_a << 32) | (uint64_t)hash_b;
+}
+
+/* Lossless compression of buffers sent over the network. Bytes are grouped by
+ * their position within the element first, since exponents and high mantissa
+ * bits of neighboring floats are similar and compress much better that way.
+ * Returns false when the buffer does not get smaller. */
+static bool network_compress_buffer(const uint8_t *data, size_t size, size_t elem_size,
+                                    DataVector& compressed)
+{
+	if(size == 0 || size > (size_t)UINT_MAX)
+		return false;
+	if(elem_size == 0 || size % elem_size != 0)
+		elem_size = 1;
+
+	const size_t num_elements = size / elem_size;
+	DataVector shuffled(size);
+	for(size_t i = 0; i < num_elements; i++)
+		for(size_t b = 0; b < elem_size; b++)
+			shuffled[b*num_elements + i] = data[i*elem_size + b];
+
+	uLongf compressed_size = compressBound((uLong)size);
+	compressed.resize(compressed_size);
+	if(compress2(&compressed[0], &compressed_size, &shuffled[0], (uLong)size, Z_BEST_SPEED) != Z_OK)
+		return false;
+	if(compressed_size >= size)
+		return false;
+
+	compressed.resize(compressed_size);
+	return true;
+}
+
+static bool network_decompress_buffer(const DataVector& compressed, uint8_t *data,
+                                      size_t size, size_t elem_size)
+{
+	if(elem_size == 0 || size % elem_size != 0)
+		elem_size = 1;
+
+	DataVector shuffled(size);
+	uLongf shuffled_size = (uLongf)size;
+	if(uncompress(&shuffled[0], &shuffled_size, &compressed[0], (uLong)compressed.size()) != Z_OK ||
+	   shuffled_size != size)
+	{
+		return false;
+	}
+
+	const size_t num_elements = size / elem_size;
+	for(size_t i = 0; i < num_elements; i++)
+		for(size_t b = 0; b < elem_size; b++)
+			data[i*elem_size + b] = shuffled[b*num_elements + i];
+
+	return true;
+}
+
 /* tile list */
 typedef vector<RenderTile> TileList;
 
@@ -48,23 +151,37 @@ public:
 	tcp::socket socket;
 	device_ptr mem_counter;
 	DeviceTask the_task; /* todo: handle multiple tasks */
+	/* Thread serving tile requests of the server while a task runs. */
+	thread *task_thread;
 
 	thread_mutex rpc_lock;
 
+	/* Hash and size of the contents last sent for buffers which kernels do
+	 * not write to, so scene updates only send what changed. Device pointers
+	 * are never reused by this device, each one is a single allocation on
+	 * this server. */
+	typedef map<device_ptr, pair<uint64_t, size_t> > HashMap;
+	HashMap mem_hash;
+
 	virtual bool show_samples() const
 	{
 		return false;
 	}
 
 	NetworkDevice(DeviceInfo& info, Stats &stats, Profiler &profiler, const char *address)
-	: Device(info, stats, profiler, true), socket(io_service)
+	: Device(info, stats, profiler, true), socket(io_service), task_thread(NULL)
 	{
 		error_func = NetworkError();
+
+		string host;
+		int port;
+		network_parse_address(address, host, port);
+
 		stringstream portstr;
-		portstr << SERVER_PORT;
+		portstr << port;
 
 		tcp::resolver resolver(io_service);
-		tcp::resolver::query query(address, portstr.str());
+		tcp::resolver::query query(host, portstr.str());
 		tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
 		tcp::resolver::iterator end;
 
@@ -83,6 +200,8 @@ public:
 
 	~NetworkDevice()
 	{
+		task_wait();
+
 		RPCSend snd(socket, &error_func, "stop");
 		snd.write();
 	}
@@ -112,6 +231,19 @@ public:
 	{
 		thread_scoped_lock lock(rpc_lock);
 
+		/* Server copy of read-write memory might have been changed by the
+		 * kernels, it is always sent. */
+		if(mem.type == MEM_READ_ONLY || mem.type == MEM_TEXTURE) {
+			const size_t data_size = mem.memory_size();
+			const HashMap::mapped_type entry(network_buffer_hash(mem.host_pointer, data_size),
+			                                 data_size);
+			HashMap::iterator it = mem_hash.find(mem.device_pointer);
+			if(it != mem_hash.end() && it->second == entry) {
+				return;
+			}
+			mem_hash[mem.device_pointer] = entry;
+		}
+
 		RPCSend snd(socket, &error_func, "mem_copy_to");
 
 		snd.add(mem);
@@ -135,13 +267,32 @@ public:
 		snd.write();
 
 		RPCReceive rcv(socket, &error_func);
-		rcv.read_buffer(mem.host_pointer, data_size);
+
+		/* Server compresses the buffer when that makes it smaller. */
+		size_t compressed_size;
+		rcv.read(compressed_size);
+
+		if(compressed_size) {
+			DataVector compressed(compressed_size);
+			rcv.read_buffer(&compressed[0], compressed_size);
+
+			if(!network_decompress_buffer(compressed, (uint8_t*)mem.host_pointer, data_size,
+			                              datatype_size(mem.data_type)))
+			{
+				error_func.network_error("Network receive error: failed to decompress buffer");
+			}
+		}
+		else {
+			rcv.read_buffer(mem.host_pointer, data_size);
+		}
 	}
 
 	void mem_zero(device_memory& mem)
 	{
 		thread_scoped_lock lock(rpc_lock);
 
+		mem_hash.erase(mem.device_pointer);
+
 		RPCSend snd(socket, &error_func, "mem_zero");
 
 		snd.add(mem);
@@ -153,6 +304,8 @@ public:
 		if(mem.device_pointer) {
 			thread_scoped_lock lock(rpc_lock);
 
+			mem_hash.erase(mem.device_pointer);
+
 			RPCSend snd(socket, &error_func, "mem_free");
 
 			snd.add(mem);
@@ -185,7 +338,6 @@ public:
 
 		RPCSend snd(socket, &error_func, "load_kernels");
 		snd.add(requested_features.experimental);
-		snd.add(requested_features.max_closure);
 		snd.add(requested_features.max_nodes_group);
 		snd.add(requested_features.nodes_features);
 		snd.write();
@@ -199,6 +351,9 @@ public:
 
 	void task_add(DeviceTask& task)
 	{
+		/* Only one task runs on the server at a time. */
+		task_wait();
+
 		thread_scoped_lock lock(rpc_lock);
 
 		the_task = task;
@@ -206,9 +361,24 @@ public:
 		RPCSend snd(socket, &error_func, "task_add");
 		snd.add(task);
 		snd.write();
+		lock.unlock();
+
+		/* Serve tile requests from a separate thread, so that with multiple
+		 * servers in a multi device they all render at the same time, pulling
+		 * tiles from the same tile manager as they finish previous ones. */
+		task_thread = new thread(function_bind(&NetworkDevice::task_run, this));
 	}
 
 	void task_wait()
+	{
+		if(task_thread) {
+			task_thread->join();
+			delete task_thread;
+			task_thread = NULL;
+		}
+	}
+
+	void task_run()
 	{
 		thread_scoped_lock lock(rpc_lock);
 
@@ -219,7 +389,6 @@ public:
 
 		TileList the_tiles;
 
-		/* todo: run this threaded for connecting to multiple clients */
 		for(;;) {
 			if(error_func.have_error())
 				break;
@@ -300,19 +469,30 @@ Device *device_network_create(DeviceInfo& info, Stats &stats, Profiler &profiler
 
 void device_network_info(vector<DeviceInfo>& devices)
 {
-	DeviceInfo info;
-
-	info.type = DEVICE_NETWORK;
-	info.description = "Network Device";
-	info.id = "NETWORK";
-	info.num = 0;
-
-	/* todo: get this info from device */
-	info.advanced_shading = true;
-	info.has_volume_decoupled = false;
-	info.has_osl = false;
-
-	devices.push_back(info);
+	/* Servers are listed as host:port or [IPv6]:port, separated by commas. Multiple servers
+	 * on the same machine listen on different ports. */
+	vector<string> servers;
+	const char *servers_env = getenv("CYCLES_NETWORK_SERVERS");
+	if(servers_env)
+		string_split(servers, servers_env, ", ");
+	if(servers.empty())
+		servers.push_back("127.0.0.1");
+
+	for(size_t i = 0; i < servers.size(); i++) {
+		DeviceInfo info;
+
+		info.type = DEVICE_NETWORK;
+		info.description = "Network Device (" + servers[i] + ")";
+		info.id = "NETWORK_" + servers[i];
+		info.num = i;
+
+		/* todo: get this info from device */
+		info.advanced_shading = true;
+		info.has_volume_decoupled = false;
+		info.has_osl = false;
+
+		devices.push_back(info);
+	}
 }
 
 class DeviceServer {
@@ -500,15 +680,27 @@ protected:
 
 			DataVector &data_v = data_vector_find(client_pointer);
 
-			mem.host_pointer = (device_ptr)&(data_v[0]);
+			mem.host_pointer = (void*)&(data_v[0]);
 
 			device->mem_copy_from(mem, y, w, h, elem);
 
 			size_t data_size = mem.memory_size();
 
+			DataVector compressed;
+			size_t compressed_size = 0;
+			if(network_compress_buffer((uint8_t*)mem.host_pointer, data_size,
+			                           datatype_size(mem.data_type), compressed))
+			{
+				compressed_size = compressed.size();
+			}
+
 			RPCSend snd(socket, &error_func, "mem_copy_from");
+			snd.add(compressed_size);
 			snd.write();
-			snd.write_buffer((uint8_t*)mem.host_pointer, data_size);
+			if(compressed_size)
+				snd.write_buffer(&compressed[0], compressed_size);
+			else
+				snd.write_buffer((uint8_t*)mem.host_pointer, data_size);
 			lock.unlock();
 		}
 		else if(rcv.name == "mem_zero") {
@@ -531,7 +723,7 @@ protected:
 			else {
 				/* Allocate host side data buffer. */
 				DataVector &data_v = data_vector_insert(client_pointer, data_size);
-				mem.host_pointer = (void*)? (device_ptr)&(data_v[0]): 0;
+				mem.host_pointer = (data_size)? (void*)&(data_v[0]): 0;
 			}
 
 			/* Zero memory. */
@@ -571,7 +763,6 @@ protected:
 		else if(rcv.name == "load_kernels") {
 			DeviceRequestedFeatures requested_features;
 			rcv.read(requested_features.experimental);
-			rcv.read(requested_features.max_closure);
 			rcv.read(requested_features.max_nodes_group);
 			rcv.read(requested_features.nodes_features);
 
@@ -769,16 +960,42 @@ private:
 
 };
 
-void Device::server_run()
+/* Listen on a dual-stack socket, which accepts IPv4 clients as well. Falls
+ * back to IPv4 only when the system has no IPv6 support. */
+static void network_server_listen(tcp::acceptor& acceptor, int port)
+{
+	boost::system::error_code error;
+	acceptor.open(tcp::v6(), error);
+	if(!error) {
+		/* Not supported everywhere, the socket then only takes IPv6 clients. */
+		acceptor.set_option(boost::asio::ip::v6_only(false), error);
+		acceptor.set_option(tcp::acceptor::reuse_address(true));
+		acceptor.bind(tcp::endpoint(tcp::v6(), port));
+	}
+	else {
+		acceptor.open(tcp::v4());
+		acceptor.set_option(tcp::acceptor::reuse_address(true));
+		acceptor.bind(tcp::endpoint(tcp::v4(), port));
+	}
+	acceptor.listen();
+}
+
+void Device::server_run(int port)
 {
+	if(port <= 0)
+		port = SERVER_PORT;
+
 	try {
 		/* starts thread that responds to discovery requests */
 		ServerDiscovery discovery;
 
+		VLOG(1) << "Listening on port " << port << ".";
+
 		for(;;) {
 			/* accept connection */
 			boost::asio::io_service io_service;
-			tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
+			tcp::acceptor acceptor(io_service);
+			network_server_listen(acceptor, port);
 
 			tcp::socket socket(io_service);
 			acceptor.accept(socket);
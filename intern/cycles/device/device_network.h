@@ -37,6 +37,7 @@
 
 #include "util/util_foreach.h"
 #include "util/util_list.h"
+#include "util/util_logging.h"
 #include "util/util_map.h"
 #include "util/util_param.h"
 #include "util/util_string.h"
@@ -116,7 +117,7 @@ public:
 	{
 		archive & name_;
 		error_func = e;
-		fprintf(stderr, "rpc send %s\n", name.c_str());
+		VLOG(4) << "RPC send " << name;
 	}
 
 	~RPCSend()
@@ -248,7 +249,7 @@ public:
 					archive = new i_archive(*archive_stream);
 
 					*archive & name;
-					fprintf(stderr, "rpc receive %s\n", name.c_str());
+					VLOG(4) << "RPC receive " << name;
 				}
 				else {
 					error_func->network_error("Network receive error: data size doesn't match header");
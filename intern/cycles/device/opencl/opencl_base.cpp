@@ -674,6 +674,8 @@ void OpenCLDeviceBase::flush_texture_buffers()
 
 		MemoryManager::BufferDescriptor desc = memory_manager.get_descriptor(slot.name);
 		info.data = desc.offset;
+		info.cache_handle = 0;
+		info.sparse_tiles = 0;
 		info.cl_buffer = desc.device_buffer;
 
 		if(string_startswith(slot.name, "__tex_image")) {
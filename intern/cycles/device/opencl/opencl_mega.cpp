@@ -63,8 +63,6 @@ public:
 
 	void path_trace(RenderTile& rtile, int sample)
 	{
-		scoped_timer timer(&rtile.buffers->render_time);
-
 		/* Cast arguments to cl types. */
 		cl_mem d_data = CL_MEM_PTR(const_mem_map["__data"]->device_pointer);
 		cl_mem d_buffer = CL_MEM_PTR(rtile.buffer);
@@ -118,6 +116,7 @@ public:
 				if(tile.task == RenderTile::PATH_TRACE) {
 					int start_sample = tile.start_sample;
 					int end_sample = tile.start_sample + tile.num_samples;
+					scoped_timer timer;
 
 					for(int sample = start_sample; sample < end_sample; sample++) {
 						if(task->get_cancel()) {
@@ -142,6 +141,8 @@ public:
 					 * next tile.
 					 */
 					clFinish(cqCommandQueue);
+
+					tile.buffers->add_tile_render_time(tile, timer.get_time());
 				}
 				else if(tile.task == RenderTile::DENOISE) {
 					tile.sample = tile.start_sample + tile.num_samples;
@@ -143,7 +143,7 @@ public:
 			while(task->acquire_tile(this, tile)) {
 				if(tile.task == RenderTile::PATH_TRACE) {
 					assert(tile.task == RenderTile::PATH_TRACE);
-					scoped_timer timer(&tile.buffers->render_time);
+					scoped_timer timer;
 
 					split_kernel->path_trace(task,
 					                         tile,
@@ -160,6 +160,8 @@ public:
 					 * next tile.
 					 */
 					clFinish(cqCommandQueue);
+
+					tile.buffers->add_tile_render_time(tile, timer.get_time());
 				}
 				else if(tile.task == RenderTile::DENOISE) {
 					tile.sample = tile.start_sample + tile.num_samples;
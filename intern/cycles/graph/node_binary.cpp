@@ -0,0 +1,457 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "graph/node_binary.h"
+
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+#include "util/util_transform.h"
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+/* Writer */
+
+BinaryWriter::BinaryWriter(FILE *file)
+: file(file), size(0), error(false)
+{
+}
+
+void BinaryWriter::write(const void *data, size_t data_size)
+{
+	if(file && data_size && fwrite(data, data_size, 1, file) != 1) {
+		error = true;
+	}
+	size += data_size;
+}
+
+void BinaryWriter::write_string(const string& value)
+{
+	write((uint)value.size());
+	write(value.data(), value.size());
+}
+
+int BinaryWriter::node_index(const Node *node) const
+{
+	map<const Node*, int>::const_iterator it = node_map.find(node);
+	return (it != node_map.end())? it->second: -1;
+}
+
+/* Reader */
+
+BinaryReader::BinaryReader()
+: data(NULL), size(0), offset(0), error(false), mapping(NULL)
+{
+}
+
+BinaryReader::~BinaryReader()
+{
+	close();
+}
+
+bool BinaryReader::open(const string& filepath)
+{
+	close();
+
+#ifndef _WIN32
+	int fd = ::open(filepath.c_str(), O_RDONLY);
+	if(fd == -1) {
+		return false;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void *mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(mapped == MAP_FAILED) {
+		return false;
+	}
+	/* File is read front to back, let the kernel read ahead. */
+	madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+
+	mapping = mapped;
+	data = (const char*)mapped;
+	size = st.st_size;
+#else
+	if(!path_read_binary(filepath, buffer) || buffer.empty()) {
+		return false;
+	}
+	data = (const char*)&buffer[0];
+	size = buffer.size();
+#endif
+
+	offset = 0;
+	error = false;
+	return true;
+}
+
+void BinaryReader::close()
+{
+#ifndef _WIN32
+	if(mapping) {
+		munmap(mapping, size);
+	}
+#endif
+	buffer.clear();
+	mapping = NULL;
+	data = NULL;
+	size = 0;
+	offset = 0;
+	nodes.clear();
+}
+
+bool BinaryReader::read(void *value, size_t value_size)
+{
+	if(error || value_size > size - offset) {
+		error = true;
+		return false;
+	}
+	if(value_size) {
+		memcpy(value, data + offset, value_size);
+	}
+	offset += value_size;
+	return true;
+}
+
+bool BinaryReader::read_string(string& value)
+{
+	uint length;
+	if(!read(length) || length > size - offset) {
+		error = true;
+		return false;
+	}
+	value.assign(data + offset, length);
+	offset += length;
+	return true;
+}
+
+bool BinaryReader::skip(size_t skip_size)
+{
+	if(error || skip_size > size - offset) {
+		error = true;
+		return false;
+	}
+	offset += skip_size;
+	return true;
+}
+
+Node *BinaryReader::node(int index) const
+{
+	return (index >= 0 && index < (int)nodes.size())? nodes[index]: NULL;
+}
+
+/* Socket Values */
+
+static void binary_write_value(BinaryWriter& writer, const Node *node, const SocketType& socket)
+{
+	switch(socket.type) {
+		case SocketType::BOOLEAN:
+			writer.write((uint8_t)node->get_bool(socket));
+			break;
+		case SocketType::FLOAT:
+			writer.write(node->get_float(socket));
+			break;
+		case SocketType::INT:
+		case SocketType::ENUM:
+			writer.write(node->get_int(socket));
+			break;
+		case SocketType::UINT:
+			writer.write(node->get_uint(socket));
+			break;
+		case SocketType::COLOR:
+		case SocketType::VECTOR:
+		case SocketType::POINT:
+		case SocketType::NORMAL:
+			writer.write(node->get_float3(socket));
+			break;
+		case SocketType::POINT2:
+			writer.write(node->get_float2(socket));
+			break;
+		case SocketType::STRING:
+			writer.write_string(node->get_string(socket).string());
+			break;
+		case SocketType::TRANSFORM:
+			writer.write(node->get_transform(socket));
+			break;
+		case SocketType::NODE:
+			writer.write(writer.node_index(node->get_node(socket)));
+			break;
+		case SocketType::BOOLEAN_ARRAY:
+			writer.write_array(node->get_bool_array(socket));
+			break;
+		case SocketType::FLOAT_ARRAY:
+			writer.write_array(node->get_float_array(socket));
+			break;
+		case SocketType::INT_ARRAY:
+			writer.write_array(node->get_int_array(socket));
+			break;
+		case SocketType::COLOR_ARRAY:
+		case SocketType::VECTOR_ARRAY:
+		case SocketType::POINT_ARRAY:
+		case SocketType::NORMAL_ARRAY:
+			writer.write_array(node->get_float3_array(socket));
+			break;
+		case SocketType::POINT2_ARRAY:
+			writer.write_array(node->get_float2_array(socket));
+			break;
+		case SocketType::TRANSFORM_ARRAY:
+			writer.write_array(node->get_transform_array(socket));
+			break;
+		case SocketType::STRING_ARRAY:
+		{
+			const array<ustring>& value = node->get_string_array(socket);
+			writer.write((uint64_t)value.size());
+			for(size_t i = 0; i < value.size(); i++) {
+				writer.write_string(value[i].string());
+			}
+			break;
+		}
+		case SocketType::NODE_ARRAY:
+		{
+			const array<Node*>& value = node->get_node_array(socket);
+			writer.write((uint64_t)value.size());
+			for(size_t i = 0; i < value.size(); i++) {
+				writer.write(writer.node_index(value[i]));
+			}
+			break;
+		}
+		case SocketType::CLOSURE:
+		case SocketType::UNDEFINED:
+			break;
+	}
+}
+
+template<typename T>
+static bool binary_read_scalar(BinaryReader& reader, Node *node, const SocketType& socket)
+{
+	T value;
+	if(!reader.read(value)) {
+		return false;
+	}
+	node->set(socket, value);
+	return true;
+}
+
+template<typename T>
+static bool binary_read_array(BinaryReader& reader, Node *node, const SocketType& socket)
+{
+	array<T> value;
+	if(!reader.read_array(value)) {
+		return false;
+	}
+	node->set(socket, value);
+	return true;
+}
+
+static bool binary_read_value(BinaryReader& reader, Node *node, const SocketType& socket)
+{
+	switch(socket.type) {
+		case SocketType::BOOLEAN:
+		{
+			uint8_t value;
+			if(!reader.read(value)) {
+				return false;
+			}
+			node->set(socket, value != 0);
+			return true;
+		}
+		case SocketType::FLOAT:
+			return binary_read_scalar<float>(reader, node, socket);
+		case SocketType::INT:
+		case SocketType::ENUM:
+			return binary_read_scalar<int>(reader, node, socket);
+		case SocketType::UINT:
+			return binary_read_scalar<uint>(reader, node, socket);
+		case SocketType::COLOR:
+		case SocketType::VECTOR:
+		case SocketType::POINT:
+		case SocketType::NORMAL:
+			return binary_read_scalar<float3>(reader, node, socket);
+		case SocketType::POINT2:
+			return binary_read_scalar<float2>(reader, node, socket);
+		case SocketType::STRING:
+		{
+			string value;
+			if(!reader.read_string(value)) {
+				return false;
+			}
+			node->set(socket, ustring(value));
+			return true;
+		}
+		case SocketType::TRANSFORM:
+			return binary_read_scalar<Transform>(reader, node, socket);
+		case SocketType::NODE:
+		{
+			int index;
+			if(!reader.read(index)) {
+				return false;
+			}
+			Node *value_node = reader.node(index);
+			if(value_node && value_node->type == *(socket.node_type)) {
+				node->set(socket, value_node);
+			}
+			return true;
+		}
+		case SocketType::BOOLEAN_ARRAY:
+			return binary_read_array<bool>(reader, node, socket);
+		case SocketType::FLOAT_ARRAY:
+			return binary_read_array<float>(reader, node, socket);
+		case SocketType::INT_ARRAY:
+			return binary_read_array<int>(reader, node, socket);
+		case SocketType::COLOR_ARRAY:
+		case SocketType::VECTOR_ARRAY:
+		case SocketType::POINT_ARRAY:
+		case SocketType::NORMAL_ARRAY:
+			return binary_read_array<float3>(reader, node, socket);
+		case SocketType::POINT2_ARRAY:
+			return binary_read_array<float2>(reader, node, socket);
+		case SocketType::TRANSFORM_ARRAY:
+			return binary_read_array<Transform>(reader, node, socket);
+		case SocketType::STRING_ARRAY:
+		{
+			uint64_t num_elements;
+			if(!reader.read(num_elements) || num_elements > reader.size - reader.offset) {
+				return false;
+			}
+			array<ustring> value;
+			value.resize(num_elements);
+			for(size_t i = 0; i < value.size(); i++) {
+				string element;
+				if(!reader.read_string(element)) {
+					return false;
+				}
+				value[i] = ustring(element);
+			}
+			node->set(socket, value);
+			return true;
+		}
+		case SocketType::NODE_ARRAY:
+		{
+			uint64_t num_elements;
+			if(!reader.read(num_elements) || num_elements > reader.size - reader.offset) {
+				return false;
+			}
+			array<Node*> value;
+			value.resize(num_elements);
+			for(size_t i = 0; i < value.size(); i++) {
+				int index;
+				if(!reader.read(index)) {
+					return false;
+				}
+				Node *value_node = reader.node(index);
+				value[i] = (value_node && value_node->type == *(socket.node_type))? value_node: NULL;
+			}
+			node->set(socket, value);
+			return true;
+		}
+		case SocketType::CLOSURE:
+		case SocketType::UNDEFINED:
+			break;
+	}
+
+	return true;
+}
+
+/* Nodes
+ *
+ * Every socket is stored with its name, type and size, so sockets which no
+ * longer exist can be skipped. */
+
+void binary_write_node(BinaryWriter& writer, const Node *node)
+{
+	const int index = writer.node_map.size();
+	writer.node_map[node] = index;
+
+	vector<const SocketType*> sockets;
+	foreach(const SocketType& socket, node->type->inputs) {
+		if(socket.type == SocketType::CLOSURE || socket.type == SocketType::UNDEFINED) {
+			continue;
+		}
+		if(socket.flags & SocketType::INTERNAL) {
+			continue;
+		}
+		if(node->has_default_value(socket)) {
+			continue;
+		}
+		sockets.push_back(&socket);
+	}
+
+	writer.write_string(node->name.string());
+	writer.write((uint)sockets.size());
+
+	foreach(const SocketType *socket, sockets) {
+		BinaryWriter counter(NULL);
+		binary_write_value(counter, node, *socket);
+
+		writer.write_string(socket->name.string());
+		writer.write((int)socket->type);
+		writer.write((uint64_t)counter.size);
+		binary_write_value(writer, node, *socket);
+	}
+}
+
+bool binary_read_node(BinaryReader& reader, Node *node)
+{
+	reader.nodes.push_back(node);
+
+	string name;
+	uint num_sockets;
+	if(!reader.read_string(name) || !reader.read(num_sockets)) {
+		return false;
+	}
+	node->name = ustring(name);
+
+	for(uint i = 0; i < num_sockets; i++) {
+		string socket_name;
+		int socket_type;
+		uint64_t socket_size;
+		if(!reader.read_string(socket_name) ||
+		   !reader.read(socket_type) ||
+		   !reader.read(socket_size))
+		{
+			return false;
+		}
+
+		const SocketType *socket = node->type->find_input(ustring(socket_name));
+		if(!socket || socket->type != socket_type || (socket->flags & SocketType::INTERNAL)) {
+			fprintf(stderr, "Unknown socket \"%s\" on \"%s\".\n", socket_name.c_str(), node->type->name.c_str());
+			if(!reader.skip(socket_size)) {
+				return false;
+			}
+			continue;
+		}
+
+		const size_t end = reader.offset + socket_size;
+		if(!binary_read_value(reader, node, *socket) || reader.offset != end) {
+			reader.error = true;
+			return false;
+		}
+	}
+
+	return !reader.error;
+}
+
+CCL_NAMESPACE_END
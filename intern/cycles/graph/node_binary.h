@@ -0,0 +1,111 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "graph/node.h"
+
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+#include <stdio.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Binary Node Serialization
+ *
+ * Compact alternative to XML, storing the non-default input sockets of nodes
+ * through their socket reflection. Values are stored in native byte order and
+ * memory layout, so files are only meant to be read back by the same build.
+ * Node sockets refer to other nodes by the order in which they were written,
+ * since nodes are not required to have unique names. */
+
+class BinaryWriter {
+public:
+	/* Without file only the number of bytes is counted. */
+	explicit BinaryWriter(FILE *file);
+
+	void write(const void *data, size_t size);
+	void write_string(const string& value);
+
+	template<typename T> void write(const T& value)
+	{
+		write(&value, sizeof(T));
+	}
+
+	template<typename T> void write_array(const array<T>& value)
+	{
+		write((uint64_t)value.size());
+		write(value.data(), sizeof(T)*value.size());
+	}
+
+	/* Index of previously written node, -1 for NULL or unknown nodes. */
+	int node_index(const Node *node) const;
+
+	FILE *file;
+	size_t size;
+	bool error;
+	map<const Node*, int> node_map;
+};
+
+class BinaryReader {
+public:
+	BinaryReader();
+	~BinaryReader();
+
+	/* Map file into memory, arrays are copied out of it directly. */
+	bool open(const string& filepath);
+	void close();
+
+	bool read(void *data, size_t size);
+	bool read_string(string& value);
+	bool skip(size_t size);
+
+	template<typename T> bool read(T& value)
+	{
+		return read(&value, sizeof(T));
+	}
+
+	template<typename T> bool read_array(array<T>& value)
+	{
+		uint64_t num_elements;
+		if(!read(num_elements) || num_elements > (size - offset) / sizeof(T)) {
+			error = true;
+			return false;
+		}
+		value.resize(num_elements);
+		return read(value.data(), sizeof(T)*num_elements);
+	}
+
+	/* Previously read node by index, NULL if out of range. */
+	Node *node(int index) const;
+
+	const char *data;
+	size_t size;
+	size_t offset;
+	bool error;
+	vector<Node*> nodes;
+
+protected:
+	void *mapping;
+	vector<uint8_t> buffer;
+};
+
+void binary_write_node(BinaryWriter& writer, const Node *node);
+bool binary_read_node(BinaryReader& reader, Node *node);
+
+CCL_NAMESPACE_END
@@ -219,8 +219,7 @@ ccl_device_inline int obvh_aligned_node_intersect(KernelGlobals *ccl_restrict kg
 
 	const avxf tnear = max4(tnear_x, tnear_y, tnear_z, isect_near);
 	const avxf tfar = min4(tfar_x, tfar_y, tfar_z, isect_far);
-	const avxb vmask = tnear <= tfar;
-	int mask = (int)movemask(vmask);
+	int mask = mask_le(tnear, tfar);
 	*dist = tnear;
 	return mask;
 #else
@@ -261,8 +260,7 @@ ccl_device_inline int obvh_aligned_node_intersect_robust(
 	const float round_up = 1.0f + difl;
 	const avxf tnear = max4(tnear_x, tnear_y, tnear_z, isect_near);
 	const avxf tfar = min4(tfar_x, tfar_y, tfar_z, isect_far);
-	const avxb vmask = round_down*tnear <= round_up*tfar;
-	int mask = (int)movemask(vmask);
+	int mask = mask_le(round_down*tnear, round_up*tfar);
 	*dist = tnear;
 	return mask;
 #else
@@ -337,9 +335,8 @@ ccl_device_inline int obvh_unaligned_node_intersect(
 	const avxf tfar_z = max(tlower_z, tupper_z);
 	const avxf tnear = max4(isect_near, tnear_x, tnear_y, tnear_z);
 	const avxf tfar = min4(isect_far, tfar_x, tfar_y, tfar_z);
-	const avxb vmask = tnear <= tfar;
 	*dist = tnear;
-	return movemask(vmask);
+	return mask_le(tnear, tfar);
 }
 
 ccl_device_inline int obvh_unaligned_node_intersect_robust(
@@ -412,9 +409,8 @@ ccl_device_inline int obvh_unaligned_node_intersect_robust(
 
 	const avxf tnear = max4(isect_near, tnear_x, tnear_y, tnear_z);
 	const avxf tfar = min4(isect_far, tfar_x, tfar_y, tfar_z);
-	const avxb vmask = round_down*tnear <= round_up*tfar;
 	*dist = tnear;
-	return movemask(vmask);
+	return mask_le(round_down*tnear, round_up*tfar);
 }
 
 /* Intersectors wrappers.
@@ -83,6 +83,147 @@ ccl_device_inline void qbvh_stack_sort(QBVHStackItem *ccl_restrict s1,
 	if(s3->dist < s2->dist) { qbvh_item_swap(s3, s2); }
 }
 
+/* Offset of child indices of axis-aligned nodes, which are stored after the
+ * bounds of the children. */
+ccl_device_inline int qbvh_aligned_node_children(KernelGlobals *ccl_restrict kg)
+{
+	return (kernel_data.bvh.use_quantized_nodes)? 4: 7;
+}
+
+/* Quantized nodes decoding.
+ *
+ * Bounds of all four children along one side of an axis are stored as four
+ * 8 bit integers packed into a single float, decoded as origin + q * scale. */
+
+ccl_device_inline ssef qbvh_dequantize(const float packed,
+                                       const float origin,
+                                       const float scale)
+{
+	const __m128i bytes = _mm_cvtsi32_si128(__float_as_int(packed));
+#ifdef __KERNEL_SSE41__
+	const ssei q = _mm_cvtepu8_epi32(bytes);
+#else
+	const __m128i zero = _mm_setzero_si128();
+	const ssei q = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+#endif
+	return madd(ssef(scale), _mm_cvtepi32_ps(q), ssef(origin));
+}
+
+/* Decode bounds of the children in the same order as they are stored in
+ * regular axis-aligned nodes: min.x, max.x, min.y, max.y, min.z, max.z. */
+ccl_device_inline void qbvh_quantized_node_bounds(KernelGlobals *ccl_restrict kg,
+                                                  const int node_addr,
+                                                  ssef bounds[6])
+{
+	const float4 data1 = kernel_tex_fetch(__bvh_nodes, node_addr+1);
+	const float4 data2 = kernel_tex_fetch(__bvh_nodes, node_addr+2);
+	const float4 data3 = kernel_tex_fetch(__bvh_nodes, node_addr+3);
+	bounds[0] = qbvh_dequantize(data2.z, data1.x, data1.w);
+	bounds[1] = qbvh_dequantize(data2.w, data1.x, data1.w);
+	bounds[2] = qbvh_dequantize(data3.x, data1.y, data2.x);
+	bounds[3] = qbvh_dequantize(data3.y, data1.y, data2.x);
+	bounds[4] = qbvh_dequantize(data3.z, data1.z, data2.y);
+	bounds[5] = qbvh_dequantize(data3.w, data1.z, data2.y);
+}
+
+/* Mask of children which are actually present in the quantized node. */
+ccl_device_inline int qbvh_quantized_node_child_mask(KernelGlobals *ccl_restrict kg,
+                                                     const int node_addr)
+{
+	return __float_as_int(kernel_tex_fetch(__bvh_nodes, node_addr).w);
+}
+
+ccl_device_inline int qbvh_quantized_node_intersect(
+        KernelGlobals *ccl_restrict kg,
+        const ssef& isect_near,
+        const ssef& isect_far,
+#ifdef __KERNEL_AVX2__
+        const sse3f& org_idir,
+#else
+        const sse3f& org,
+#endif
+        const sse3f& idir,
+        const int near_x,
+        const int near_y,
+        const int near_z,
+        const int far_x,
+        const int far_y,
+        const int far_z,
+        const int node_addr,
+        ssef *ccl_restrict dist)
+{
+	ssef bounds[6];
+	qbvh_quantized_node_bounds(kg, node_addr, bounds);
+#ifdef __KERNEL_AVX2__
+	const ssef tnear_x = msub(bounds[near_x], idir.x, org_idir.x);
+	const ssef tnear_y = msub(bounds[near_y], idir.y, org_idir.y);
+	const ssef tnear_z = msub(bounds[near_z], idir.z, org_idir.z);
+	const ssef tfar_x = msub(bounds[far_x], idir.x, org_idir.x);
+	const ssef tfar_y = msub(bounds[far_y], idir.y, org_idir.y);
+	const ssef tfar_z = msub(bounds[far_z], idir.z, org_idir.z);
+#else
+	const ssef tnear_x = (bounds[near_x] - org.x) * idir.x;
+	const ssef tnear_y = (bounds[near_y] - org.y) * idir.y;
+	const ssef tnear_z = (bounds[near_z] - org.z) * idir.z;
+	const ssef tfar_x = (bounds[far_x] - org.x) * idir.x;
+	const ssef tfar_y = (bounds[far_y] - org.y) * idir.y;
+	const ssef tfar_z = (bounds[far_z] - org.z) * idir.z;
+#endif
+
+	const ssef tnear = max4(isect_near, tnear_x, tnear_y, tnear_z);
+	const ssef tfar = min4(isect_far, tfar_x, tfar_y, tfar_z);
+	const sseb vmask = tnear <= tfar;
+	*dist = tnear;
+	return (int)movemask(vmask) & qbvh_quantized_node_child_mask(kg, node_addr);
+}
+
+ccl_device_inline int qbvh_quantized_node_intersect_robust(
+        KernelGlobals *ccl_restrict kg,
+        const ssef& isect_near,
+        const ssef& isect_far,
+#ifdef __KERNEL_AVX2__
+        const sse3f& P_idir,
+#else
+        const sse3f& P,
+#endif
+        const sse3f& idir,
+        const int near_x,
+        const int near_y,
+        const int near_z,
+        const int far_x,
+        const int far_y,
+        const int far_z,
+        const int node_addr,
+        const float difl,
+        ssef *ccl_restrict dist)
+{
+	ssef bounds[6];
+	qbvh_quantized_node_bounds(kg, node_addr, bounds);
+#ifdef __KERNEL_AVX2__
+	const ssef tnear_x = msub(bounds[near_x], idir.x, P_idir.x);
+	const ssef tnear_y = msub(bounds[near_y], idir.y, P_idir.y);
+	const ssef tnear_z = msub(bounds[near_z], idir.z, P_idir.z);
+	const ssef tfar_x = msub(bounds[far_x], idir.x, P_idir.x);
+	const ssef tfar_y = msub(bounds[far_y], idir.y, P_idir.y);
+	const ssef tfar_z = msub(bounds[far_z], idir.z, P_idir.z);
+#else
+	const ssef tnear_x = (bounds[near_x] - P.x) * idir.x;
+	const ssef tnear_y = (bounds[near_y] - P.y) * idir.y;
+	const ssef tnear_z = (bounds[near_z] - P.z) * idir.z;
+	const ssef tfar_x = (bounds[far_x] - P.x) * idir.x;
+	const ssef tfar_y = (bounds[far_y] - P.y) * idir.y;
+	const ssef tfar_z = (bounds[far_z] - P.z) * idir.z;
+#endif
+
+	const float round_down = 1.0f - difl;
+	const float round_up = 1.0f + difl;
+	const ssef tnear = max4(isect_near, tnear_x, tnear_y, tnear_z);
+	const ssef tfar = min4(isect_far, tfar_x, tfar_y, tfar_z);
+	const sseb vmask = round_down*tnear <= round_up*tfar;
+	*dist = tnear;
+	return (int)movemask(vmask) & qbvh_quantized_node_child_mask(kg, node_addr);
+}
+
 /* Axis-aligned nodes intersection */
 
 //ccl_device_inline int qbvh_aligned_node_intersect(KernelGlobals *ccl_restrict kg,
@@ -104,6 +245,22 @@ static int qbvh_aligned_node_intersect(KernelGlobals *ccl_restrict kg,
                                                   const int node_addr,
                                                   ssef *ccl_restrict dist)
 {
+	if(kernel_data.bvh.use_quantized_nodes) {
+		return qbvh_quantized_node_intersect(kg,
+		                                     isect_near,
+		                                     isect_far,
+#ifdef __KERNEL_AVX2__
+		                                     org_idir,
+#else
+		                                     org,
+#endif
+		                                     idir,
+		                                     near_x, near_y, near_z,
+		                                     far_x, far_y, far_z,
+		                                     node_addr,
+		                                     dist);
+	}
+
 	const int offset = node_addr + 1;
 #ifdef __KERNEL_AVX2__
 	const ssef tnear_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x), idir.x, org_idir.x);
@@ -156,6 +313,23 @@ ccl_device_inline int qbvh_aligned_node_intersect_robust(
         const float difl,
         ssef *ccl_restrict dist)
 {
+	if(kernel_data.bvh.use_quantized_nodes) {
+		return qbvh_quantized_node_intersect_robust(kg,
+		                                            isect_near,
+		                                            isect_far,
+#ifdef __KERNEL_AVX2__
+		                                            P_idir,
+#else
+		                                            P,
+#endif
+		                                            idir,
+		                                            near_x, near_y, near_z,
+		                                            far_x, far_y, far_z,
+		                                            node_addr,
+		                                            difl,
+		                                            dist);
+	}
+
 	const int offset = node_addr + 1;
 #ifdef __KERNEL_AVX2__
 	const ssef tnear_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x), idir.x, P_idir.x);
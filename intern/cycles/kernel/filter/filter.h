@@ -47,6 +47,9 @@ CCL_NAMESPACE_BEGIN
 #define KERNEL_ARCH cpu_avx2
 #include "kernel/kernels/cpu/filter_cpu.h"
 
+#define KERNEL_ARCH cpu_avx512
+#include "kernel/kernels/cpu/filter_cpu.h"
+
 CCL_NAMESPACE_END
 
 #endif  /* __FILTER_H__ */
@@ -74,15 +74,25 @@ ccl_device_inline void triangle_vertices(KernelGlobals *kg, int prim, float3 P[3
 	P[2] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w+2));
 }
 
+/* Vertex normal, octahedral encoded with compact geometry storage */
+
+ccl_device_inline float3 triangle_vertex_normal(KernelGlobals *kg, uint vert)
+{
+	if(kernel_data.bvh.use_compact_geometry) {
+		return octahedral_to_float3(kernel_tex_fetch(__tri_vnormal_packed, vert));
+	}
+	return float4_to_float3(kernel_tex_fetch(__tri_vnormal, vert));
+}
+
 /* Interpolate smooth vertex normal from vertices */
 
 ccl_device_inline float3 triangle_smooth_normal(KernelGlobals *kg, float3 Ng, int prim, float u, float v)
 {
 	/* load triangle vertices */
 	const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-	float3 n0 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.x));
-	float3 n1 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.y));
-	float3 n2 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.z));
+	float3 n0 = triangle_vertex_normal(kg, tri_vindex.x);
+	float3 n1 = triangle_vertex_normal(kg, tri_vindex.y);
+	float3 n2 = triangle_vertex_normal(kg, tri_vindex.z);
 
 	float3 N = safe_normalize((1.0f - u - v)*n2 + u*n0 + v*n1);
 
@@ -171,7 +181,10 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg, const ShaderData
 
 		return sd->u*f0 + sd->v*f1 + (1.0f - sd->u - sd->v)*f2;
 	}
-	else if(desc.element == ATTR_ELEMENT_CORNER || desc.element == ATTR_ELEMENT_CORNER_BYTE) {
+	else if(desc.element == ATTR_ELEMENT_CORNER ||
+	        desc.element == ATTR_ELEMENT_CORNER_BYTE ||
+	        desc.element == ATTR_ELEMENT_CORNER_HALF2)
+	{
 		int tri = desc.offset + sd->prim*3;
 		float3 f0, f1, f2;
 
@@ -180,6 +193,11 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg, const ShaderData
 			f1 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 1));
 			f2 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 2));
 		}
+		else if(desc.element == ATTR_ELEMENT_CORNER_HALF2) {
+			f0 = float2_to_float3(half2_bits_to_float2(kernel_tex_fetch(__attributes_half2, tri + 0)));
+			f1 = float2_to_float3(half2_bits_to_float2(kernel_tex_fetch(__attributes_half2, tri + 1)));
+			f2 = float2_to_float3(half2_bits_to_float2(kernel_tex_fetch(__attributes_half2, tri + 2)));
+		}
 		else {
 			f0 = color_byte_to_float(kernel_tex_fetch(__attributes_uchar4, tri + 0));
 			f1 = color_byte_to_float(kernel_tex_fetch(__attributes_uchar4, tri + 1));
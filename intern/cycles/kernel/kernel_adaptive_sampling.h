@@ -0,0 +1,292 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_ADAPTIVE_SAMPLING_H__
+#define __KERNEL_ADAPTIVE_SAMPLING_H__
+
+CCL_NAMESPACE_BEGIN
+
+/* Adaptive Sampling
+ *
+ * Radiance of even samples is accumulated twice as strong into the auxiliary
+ * pass, so it converges to the same value as the combined pass. Difference
+ * between the two is used as per-pixel error estimate, as described in
+ * "A hierarchical automatic stopping condition for Monte Carlo global
+ * illumination" by Dammertz et al.
+ *
+ * The fourth component of the auxiliary pass is the number of samples after
+ * which the pixel was found to be converged, or zero if pixel still needs to
+ * be sampled. */
+
+ccl_device_inline ccl_global float *kernel_adaptive_aux_buffer(KernelGlobals *kg,
+                                                               ccl_global float *buffer)
+{
+	return buffer + kernel_data.film.pass_adaptive_aux_buffer;
+}
+
+ccl_device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg,
+                                                       ccl_global float *buffer)
+{
+	return kernel_data.film.pass_adaptive_aux_buffer &&
+	       kernel_adaptive_aux_buffer(kg, buffer)[3] != 0.0f;
+}
+
+ccl_device_inline bool kernel_adaptive_need_filter(KernelGlobals *kg, int num_samples)
+{
+	const int step = kernel_data.integrator.adaptive_step;
+	return (num_samples >= kernel_data.integrator.adaptive_min_samples) &&
+	       (num_samples % step == 0);
+}
+
+/* Check whether pixel converged after taking given number of samples, buffer
+ * points to the pixel. */
+ccl_device void kernel_adaptive_stopping(KernelGlobals *kg,
+                                         ccl_global float *buffer,
+                                         int num_samples)
+{
+	ccl_global float *aux = kernel_adaptive_aux_buffer(kg, buffer);
+	if(aux[3] != 0.0f) {
+		return;
+	}
+	const float inv_num_samples = 1.0f / num_samples;
+	const float error = (fabsf(buffer[0] - aux[0]) +
+	                     fabsf(buffer[1] - aux[1]) +
+	                     fabsf(buffer[2] - aux[2])) * inv_num_samples;
+	const float intensity = max(buffer[0] + buffer[1] + buffer[2], 0.0f) * inv_num_samples;
+	/* Small epsilon avoids division by zero in black regions. */
+	if(error < kernel_data.integrator.adaptive_threshold * (1e-4f + sqrtf(intensity))) {
+		aux[3] = (float)num_samples;
+	}
+}
+
+/* Denoiser estimates variance of a feature from its sum and sum of squares
+ * as (E[x^2] - E[x]^2) / (N - 1) / N. Rescale the sum of squares, so the
+ * estimate done with num_samples matches the one of the samples actually
+ * taken, instead of making the pixel look less noisy than it is. */
+ccl_device_inline float kernel_adaptive_rescale_squares(float sum,
+                                                        float sum_squares,
+                                                        float pixel_samples,
+                                                        float num_samples,
+                                                        float variance_scale)
+{
+	const float mean = sum / pixel_samples;
+	if(pixel_samples < 2.0f) {
+		/* Variance is unknown anyway. */
+		return sum_squares * num_samples / pixel_samples;
+	}
+	const float variance_sum = max(sum_squares - mean * sum, 0.0f);
+	return mean * mean * num_samples +
+	       variance_sum * variance_scale * (num_samples - 1.0f) / (pixel_samples - 1.0f);
+}
+
+ccl_device void kernel_adaptive_post_adjust_denoising(ccl_global float *buffer,
+                                                      float pixel_samples,
+                                                      float num_samples)
+{
+	const float sample_multiplier = num_samples / pixel_samples;
+
+	/* Features with the sum of squares stored next to them. */
+	const int feature_offsets[] = {DENOISING_PASS_NORMAL,
+	                               DENOISING_PASS_ALBEDO,
+	                               DENOISING_PASS_DEPTH,
+	                               DENOISING_PASS_COLOR};
+	const int variance_offsets[] = {DENOISING_PASS_NORMAL_VAR,
+	                                DENOISING_PASS_ALBEDO_VAR,
+	                                DENOISING_PASS_DEPTH_VAR,
+	                                DENOISING_PASS_COLOR_VAR};
+	const int feature_sizes[] = {3, 3, 1, 3};
+	for(int feature = 0; feature < 4; feature++) {
+		for(int i = 0; i < feature_sizes[feature]; i++) {
+			ccl_global float *sum = buffer + feature_offsets[feature] + i;
+			ccl_global float *sum_squares = buffer + variance_offsets[feature] + i;
+			*sum_squares = kernel_adaptive_rescale_squares(*sum,
+			                                               *sum_squares,
+			                                               pixel_samples,
+			                                               num_samples,
+			                                               sample_multiplier);
+			*sum *= sample_multiplier;
+		}
+	}
+
+	/* Shadow feature is split into even and odd samples, the denoiser only
+	 * uses the ratio of its sums, and the variance of each half divided by
+	 * the total number of samples. */
+	const float half_samples[2] = {floorf((pixel_samples + 1.0f) * 0.5f),
+	                               floorf(pixel_samples * 0.5f)};
+	const float half_num_samples[2] = {floorf((num_samples + 1.0f) * 0.5f),
+	                                   floorf(num_samples * 0.5f)};
+	const int shadow_offsets[2] = {DENOISING_PASS_SHADOW_A, DENOISING_PASS_SHADOW_B};
+	for(int half = 0; half < 2; half++) {
+		ccl_global float *shadow = buffer + shadow_offsets[half];
+		if(half_samples[half] == 0.0f) {
+			continue;
+		}
+		const float ratio = shadow[1] / max(shadow[0], 1e-7f);
+		shadow[2] = kernel_adaptive_rescale_squares(ratio * half_samples[half],
+		                                            shadow[2],
+		                                            half_samples[half],
+		                                            half_num_samples[half],
+		                                            sample_multiplier);
+		shadow[0] *= sample_multiplier;
+		shadow[1] *= sample_multiplier;
+	}
+}
+
+/* Scale passes of a pixel which stopped early, so they look like they were
+ * accumulated from num_samples samples, same as the rest of the tile. */
+ccl_device void kernel_adaptive_post_adjust(KernelGlobals *kg,
+                                            ccl_global float *buffer,
+                                            int num_samples)
+{
+	ccl_global float *aux = kernel_adaptive_aux_buffer(kg, buffer);
+	const float pixel_samples = aux[3];
+	if(pixel_samples == 0.0f || pixel_samples >= (float)num_samples) {
+		return;
+	}
+	const float sample_multiplier = (float)num_samples / pixel_samples;
+
+	/* These passes are only written by the first sample. */
+	const int flag = kernel_data.film.pass_flag;
+	const float depth = (flag & PASSMASK(DEPTH))? buffer[kernel_data.film.pass_depth]: 0.0f;
+	const float object_id = (flag & PASSMASK(OBJECT_ID))? buffer[kernel_data.film.pass_object_id]: 0.0f;
+	const float material_id = (flag & PASSMASK(MATERIAL_ID))? buffer[kernel_data.film.pass_material_id]: 0.0f;
+
+	/* Cryptomatte IDs are stored next to the weights, only weights are scaled. */
+	int cryptomatte_start = 0, cryptomatte_end = 0;
+	if(kernel_data.film.cryptomatte_passes) {
+		const int num_types = ((kernel_data.film.cryptomatte_passes & CRYPT_OBJECT)? 1: 0) +
+		                      ((kernel_data.film.cryptomatte_passes & CRYPT_MATERIAL)? 1: 0) +
+		                      ((kernel_data.film.cryptomatte_passes & CRYPT_ASSET)? 1: 0);
+		cryptomatte_start = kernel_data.film.pass_cryptomatte;
+		cryptomatte_end = cryptomatte_start + num_types * 4 * kernel_data.film.cryptomatte_depth;
+	}
+
+	for(int i = 0; i < kernel_data.film.pass_stride; i++) {
+		if(i >= cryptomatte_start && i < cryptomatte_end && ((i - cryptomatte_start) & 1) == 0) {
+			continue;
+		}
+		/* Render time is a measurement of the samples actually taken. */
+		if(kernel_data.film.pass_render_time && i == kernel_data.film.pass_render_time) {
+			continue;
+		}
+		/* Denoising data is adjusted separately, variance needs more than scaling. */
+		if(kernel_data.film.pass_denoising_data &&
+		   i >= kernel_data.film.pass_denoising_data &&
+		   i < kernel_data.film.pass_denoising_data + DENOISING_PASS_SIZE_BASE)
+		{
+			continue;
+		}
+		buffer[i] *= sample_multiplier;
+	}
+
+	if(kernel_data.film.pass_denoising_data) {
+		kernel_adaptive_post_adjust_denoising(buffer + kernel_data.film.pass_denoising_data,
+		                                      pixel_samples,
+		                                      (float)num_samples);
+	}
+
+	if(flag & PASSMASK(DEPTH)) {
+		buffer[kernel_data.film.pass_depth] = depth;
+	}
+	if(flag & PASSMASK(OBJECT_ID)) {
+		buffer[kernel_data.film.pass_object_id] = object_id;
+	}
+	if(flag & PASSMASK(MATERIAL_ID)) {
+		buffer[kernel_data.film.pass_material_id] = material_id;
+	}
+
+	/* Pixel is still converged, now at the number of samples of the tile. */
+	aux[3] = (float)num_samples;
+}
+
+/* Make pixel which was considered converged receive samples again. Pixels which
+ * stopped at an earlier check are scaled first, so the missed samples do not
+ * make them darker. */
+ccl_device_inline void kernel_adaptive_reactivate(KernelGlobals *kg,
+                                                  ccl_global float *buffer,
+                                                  int num_samples)
+{
+	kernel_adaptive_post_adjust(kg, buffer, num_samples);
+	kernel_adaptive_aux_buffer(kg, buffer)[3] = 0.0f;
+}
+
+/* Pixels next to the ones which still need samples are marked as not converged
+ * as well, which avoids visible seams between converged and noisy regions.
+ * Done separately for rows and columns, so the active region grows by one pixel
+ * in every direction.
+ *
+ * Returns true when any pixel in the row still needs samples. */
+ccl_device bool kernel_adaptive_filter_x(KernelGlobals *kg,
+                                         ccl_global float *tile_buffer,
+                                         int y, int x_start, int w,
+                                         int offset, int stride,
+                                         int num_samples)
+{
+	const int pass_stride = kernel_data.film.pass_stride;
+	bool any = false;
+	bool prev_active = false;
+	for(int x = x_start; x < x_start + w; ++x) {
+		const int index = offset + x + y*stride;
+		ccl_global float *pixel_buffer = tile_buffer + index*pass_stride;
+		if(!kernel_adaptive_pixel_converged(kg, pixel_buffer)) {
+			any = true;
+			if(x > x_start && !prev_active) {
+				kernel_adaptive_reactivate(kg, pixel_buffer - pass_stride, num_samples);
+			}
+			prev_active = true;
+		}
+		else {
+			if(prev_active) {
+				kernel_adaptive_reactivate(kg, pixel_buffer, num_samples);
+			}
+			prev_active = false;
+		}
+	}
+	return any;
+}
+
+ccl_device bool kernel_adaptive_filter_y(KernelGlobals *kg,
+                                         ccl_global float *tile_buffer,
+                                         int x, int y_start, int h,
+                                         int offset, int stride,
+                                         int num_samples)
+{
+	const int pass_stride = kernel_data.film.pass_stride;
+	bool any = false;
+	bool prev_active = false;
+	for(int y = y_start; y < y_start + h; ++y) {
+		const int index = offset + x + y*stride;
+		ccl_global float *pixel_buffer = tile_buffer + index*pass_stride;
+		if(!kernel_adaptive_pixel_converged(kg, pixel_buffer)) {
+			any = true;
+			if(y > y_start && !prev_active) {
+				kernel_adaptive_reactivate(kg, pixel_buffer - stride*pass_stride, num_samples);
+			}
+			prev_active = true;
+		}
+		else {
+			if(prev_active) {
+				kernel_adaptive_reactivate(kg, pixel_buffer, num_samples);
+			}
+			prev_active = false;
+		}
+	}
+	return any;
+}
+
+CCL_NAMESPACE_END
+
+#endif  /* __KERNEL_ADAPTIVE_SAMPLING_H__ */
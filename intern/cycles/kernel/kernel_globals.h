@@ -64,6 +64,11 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #  endif
 
+	/* Texture cache for images which are read on demand, owned by the
+	 * ImageManager. Per-thread data of the cache is fetched on first use. */
+	void *texture_cache;
+	void *texture_cache_thread_info;
+
 	/* **** Run-time data ****  */
 
 	/* Heap-allocated storage for transparent shadows intersections. */
@@ -495,6 +495,15 @@ ccl_device_inline float3 background_light_sample(KernelGlobals *kg,
 	return D;
 }
 
+/* Probability of picking the background light in light_sample(). */
+ccl_device_inline float light_distant_select_pdf(KernelGlobals *kg)
+{
+	if(kernel_data.integrator.use_light_tree) {
+		return kernel_data.integrator.light_tree_pdf_distant;
+	}
+	return kernel_data.integrator.pdf_lights;
+}
+
 ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direction)
 {
 	/* Probability of sampling portals instead of the map. */
@@ -509,7 +518,7 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 			/* Portal sampling is not possible here because all portals point to the wrong side.
 			 * If map sampling is possible, it would be used instead, otherwise fallback sampling is used. */
 			if(portal_sampling_pdf == 1.0f) {
-				return kernel_data.integrator.pdf_lights / M_4PI_F;
+				return light_distant_select_pdf(kg) / M_4PI_F;
 			}
 			else {
 				/* Force map sampling. */
@@ -521,16 +530,44 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 		/* Evaluate PDF of sampling this direction by map sampling. */
 		map_pdf = background_map_pdf(kg, direction) * (1.0f - portal_sampling_pdf);
 	}
-	return (portal_pdf + map_pdf) * kernel_data.integrator.pdf_lights;
+	return (portal_pdf + map_pdf) * light_distant_select_pdf(kg);
 }
 #endif
 
 /* Regular Light */
 
+/* Probability of picking the lamp in light_sample(). */
+ccl_device_inline float lamp_light_select_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+	if(kernel_data.integrator.use_light_tree) {
+		return light_tree_lamp_pdf(kg, lamp, P);
+	}
+	return kernel_data.integrator.pdf_lights;
+}
+
+/* Probability of picking the lamp to use for the sample when all lamps are
+ * sampled, and the weight of the sample which compensates for it. The light
+ * tree probability is kept, so MIS weights match the ones of a BSDF ray
+ * hitting the lamp, and only the weight changes. */
+ccl_device_inline float lamp_light_sample_all_weight(KernelGlobals *kg,
+                                                     int lamp,
+                                                     float3 P,
+                                                     float *select_pdf)
+{
+	if(kernel_data.integrator.use_light_tree) {
+		*select_pdf = light_tree_lamp_pdf(kg, lamp, P);
+		return *select_pdf;
+	}
+	*select_pdf = kernel_data.integrator.pdf_lights;
+	return 1.0f/kernel_data.integrator.num_all_lights;
+}
+
+/* Sample point on the lamp, select_pdf is the probability of picking the lamp. */
 ccl_device_inline bool lamp_light_sample(KernelGlobals *kg,
                                          int lamp,
                                          float randu, float randv,
                                          float3 P,
+                                         float select_pdf,
                                          LightSample *ls)
 {
 	const ccl_global KernelLight *klight = &kernel_tex_fetch(__lights, lamp);
@@ -657,7 +694,7 @@ ccl_device_inline bool lamp_light_sample(KernelGlobals *kg,
 		}
 	}
 
-	ls->pdf *= kernel_data.integrator.pdf_lights;
+	ls->pdf *= select_pdf;
 
 	return (ls->pdf > 0.0f);
 }
@@ -808,7 +845,7 @@ ccl_device bool lamp_light_eval(KernelGlobals *kg, int lamp, float3 P, float3 D,
 		return false;
 	}
 
-	ls->pdf *= kernel_data.integrator.pdf_lights;
+	ls->pdf *= lamp_light_select_pdf(kg, lamp, P);
 
 	return true;
 }
@@ -846,9 +883,8 @@ ccl_device_inline bool triangle_world_space_vertices(KernelGlobals *kg, int obje
 	return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg, const float3 Ng, const float3 I, float t)
+ccl_device_inline float triangle_light_pdf_area(float pdf, const float3 Ng, const float3 I, float t)
 {
-	float pdf = kernel_data.integrator.pdf_triangles;
 	float cos_pi = fabsf(dot(Ng, I));
 
 	if(cos_pi == 0.0f)
@@ -857,6 +893,32 @@ ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg, const float3
 	return t*t*pdf/cos_pi;
 }
 
+/* Probability of picking the triangle in light_sample(), divided by the area
+ * of the triangle at the center of the frame. Light distribution picks
+ * triangles proportional to that area, so this is constant without the light
+ * tree. */
+ccl_device_inline float triangle_light_select_pdf_area(KernelGlobals *kg,
+                                                       int object, int prim,
+                                                       float3 P,
+                                                       float select_pdf,
+                                                       bool has_motion,
+                                                       float area)
+{
+	if(!kernel_data.integrator.use_light_tree) {
+		return kernel_data.integrator.pdf_triangles;
+	}
+
+	if(select_pdf == 0.0f) {
+		select_pdf = light_tree_triangle_pdf(kg, object, prim, P);
+	}
+	if(has_motion) {
+		float3 V[3];
+		triangle_world_space_vertices(kg, object, prim, -1.0f, V);
+		area = triangle_area(V[0], V[1], V[2]);
+	}
+	return (area != 0.0f)? select_pdf / area: 0.0f;
+}
+
 ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *sd, float t)
 {
 	/* A naive heuristic to decide between costly solid angle sampling
@@ -873,10 +935,17 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 	const float3 N = cross(e0, e1);
 	const float distance_to_plane = fabsf(dot(N, sd->I * t))/dot(N, N);
 
+	/* sd contains the point on the light source
+	 * calculate Px, the point that we're shading */
+	const float3 Px = sd->P + sd->I * t;
+	const float pdf_triangles = triangle_light_select_pdf_area(kg,
+	                                                           sd->object, sd->prim,
+	                                                           Px,
+	                                                           0.0f,
+	                                                           has_motion,
+	                                                           0.5f * len(N));
+
 	if(longest_edge_squared > distance_to_plane*distance_to_plane) {
-		/* sd contains the point on the light source
-		 * calculate Px, the point that we're shading */
-		const float3 Px = sd->P + sd->I * t;
 		const float3 v0_p = V[0] - Px;
 		const float3 v1_p = V[1] - Px;
 		const float3 v2_p = V[2] - Px;
@@ -904,12 +973,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 			else {
 				area = 0.5f * len(N);
 			}
-			const float pdf = area * kernel_data.integrator.pdf_triangles;
+			const float pdf = area * pdf_triangles;
 			return pdf / solid_angle;
 		}
 	}
 	else {
-		float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+		float pdf = triangle_light_pdf_area(pdf_triangles, sd->Ng, sd->I, t);
 		if(has_motion) {
 			const float	area = 0.5f * len(N);
 			if(UNLIKELY(area == 0.0f)) {
@@ -926,8 +995,10 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 	}
 }
 
+/* Sample point on the triangle, select_pdf is the probability of picking the
+ * triangle, or zero when it was picked from the light distribution. */
 ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, int object,
-	float randu, float randv, float time, LightSample *ls, const float3 P)
+	float randu, float randv, float time, float select_pdf, LightSample *ls, const float3 P)
 {
 	/* A naive heuristic to decide between costly solid angle sampling
 	 * and simple area sampling, comparing the distance to the triangle plane
@@ -958,6 +1029,13 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, i
 	ls->shader |= SHADER_USE_MIS;
 	ls->type = LIGHT_TRIANGLE;
 
+	const float pdf_triangles = triangle_light_select_pdf_area(kg,
+	                                                           object, prim,
+	                                                           P,
+	                                                           select_pdf,
+	                                                           has_motion,
+	                                                           area);
+
 	float distance_to_plane = fabsf(dot(N0, V[0] - P)/dot(N0, N0));
 
 	if(longest_edge_squared > distance_to_plane*distance_to_plane) {
@@ -1045,7 +1123,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, i
 				triangle_world_space_vertices(kg, object, prim, -1.0f, V);
 				area = triangle_area(V[0], V[1], V[2]);
 			}
-			const float pdf = area * kernel_data.integrator.pdf_triangles;
+			const float pdf = area * pdf_triangles;
 			ls->pdf = pdf / solid_angle;
 		}
 	}
@@ -1059,7 +1137,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, i
 		ls->P = u * V[0] + v * V[1] + t * V[2];
 		/* compute incoming direction, distance and pdf */
 		ls->D = normalize_len(ls->P - P, &ls->t);
-		ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+		ls->pdf = triangle_light_pdf_area(pdf_triangles, ls->Ng, -ls->D, ls->t);
 		if(has_motion && area != 0.0f) {
 			/* scale the PDF.
 			 * area = the area the sample was taken from
@@ -1127,7 +1205,18 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       LightSample *ls)
 {
 	/* sample index */
-	int index = light_distribution_sample(kg, &randu);
+	int index;
+	float select_pdf = 0.0f;
+
+	if(kernel_data.integrator.use_light_tree) {
+		index = light_tree_sample(kg, P, &randu, &select_pdf);
+		if(index == -1) {
+			return false;
+		}
+	}
+	else {
+		index = light_distribution_sample(kg, &randu);
+	}
 
 	/* fetch light data */
 	const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution, index);
@@ -1137,7 +1226,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 		int object = kdistribution->mesh_light.object_id;
 		int shader_flag = kdistribution->mesh_light.shader_flag;
 
-		triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+		triangle_light_sample(kg, prim, object, randu, randv, time, select_pdf, ls, P);
 		ls->shader |= shader_flag;
 		return (ls->pdf > 0.0f);
 	}
@@ -1148,7 +1237,11 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 			return false;
 		}
 
-		return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+		if(!kernel_data.integrator.use_light_tree) {
+			select_pdf = kernel_data.integrator.pdf_lights;
+		}
+
+		return lamp_light_sample(kg, lamp, randu, randv, P, select_pdf, ls);
 	}
 }
 
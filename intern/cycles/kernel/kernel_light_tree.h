@@ -0,0 +1,228 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Importance sampling of many lights, based on:
+ *
+ * Alejandro Conty Estevez and Christopher Kulla
+ * Importance Sampling of Many Lights with Adaptive Tree Splitting.
+ *
+ * Traversal picks one child at every inner node, proportional to an estimate
+ * of the contribution of the whole subtree to the shading point. The estimate
+ * only depends on the shading point, so the same probabilities are computed
+ * again when evaluating the pdf for multiple importance sampling.
+ *
+ * Layout of the emitter map:
+ * - Emitter index of every lamp.
+ * - Pair of integers per object: offset of the triangle table of the object in
+ *   the map or -1, and offset of the mesh triangles.
+ * - Triangle tables, emitter index of every triangle of the mesh or -1. */
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, int node, float3 P)
+{
+	const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node);
+	const float energy = knode->bbox_min.w;
+	if(energy == 0.0f) {
+		return 0.0f;
+	}
+
+	const float3 bbox_min = float4_to_float3(knode->bbox_min);
+	const float3 bbox_max = float4_to_float3(knode->bbox_max);
+	const float3 centroid = 0.5f*(bbox_min + bbox_max);
+	const float radius = 0.5f*len(bbox_max - bbox_min);
+
+	float distance;
+	const float3 D = normalize_len(P - centroid, &distance);
+
+	/* Angle between the axis and the direction towards the shading point,
+	 * reduced by the spread of emission and the angle the bounds cover as
+	 * seen from the shading point. */
+	const float theta_u = (distance > radius)? fast_asinf(radius/distance): M_PI_F;
+	const float theta_o = knode->bbox_max.w;
+	const float theta_e = knode->axis.w;
+	const float theta = fast_acosf(clamp(dot(float4_to_float3(knode->axis), D), -1.0f, 1.0f));
+	const float theta_prime = max(theta - theta_o - theta_u, 0.0f);
+	if(theta_prime >= theta_e) {
+		return 0.0f;
+	}
+
+	/* Avoid singularity when the shading point is inside the bounds. */
+	const float distance_clamped = max(distance, radius);
+	return energy*fast_cosf(theta_prime) / max(distance_clamped*distance_clamped, 1e-8f);
+}
+
+/* Probability of picking the emitter when sampling its tree from P. */
+ccl_device float light_tree_emitter_pdf(KernelGlobals *kg, int emitter, float3 P)
+{
+	const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters, emitter);
+	int node = kemitter->leaf;
+	const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node);
+	if(knode->bbox_min.w == 0.0f) {
+		return 0.0f;
+	}
+	float pdf = kemitter->energy / knode->bbox_min.w;
+
+	int parent = knode->parent;
+	while(parent != -1 && pdf != 0.0f) {
+		const int left = parent + 1;
+		const int right = kernel_tex_fetch(__light_tree_nodes, parent).child_index;
+		const float importance_left = light_tree_node_importance(kg, left, P);
+		const float importance_right = light_tree_node_importance(kg, right, P);
+		const float total = importance_left + importance_right;
+		if(total == 0.0f) {
+			return 0.0f;
+		}
+		pdf *= ((node == left)? importance_left: importance_right) / total;
+
+		node = parent;
+		parent = kernel_tex_fetch(__light_tree_nodes, node).parent;
+	}
+
+	return pdf;
+}
+
+/* Traverse tree starting at root, returns emitter index or -1 when no light
+ * can contribute to P. Random number is rescaled for reuse. */
+ccl_device int light_tree_sample_emitter(KernelGlobals *kg, int root, float3 P, float *randu, float *pdf)
+{
+	float r = *randu;
+	int node = root;
+	*pdf = 1.0f;
+
+	const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node);
+	while(knode->num_emitters == 0) {
+		const int left = node + 1;
+		const int right = knode->child_index;
+		const float importance_left = light_tree_node_importance(kg, left, P);
+		const float importance_right = light_tree_node_importance(kg, right, P);
+		const float total = importance_left + importance_right;
+		if(total == 0.0f) {
+			return -1;
+		}
+
+		const float pdf_left = importance_left / total;
+		if(r < pdf_left) {
+			node = left;
+			r = r / pdf_left;
+			*pdf *= pdf_left;
+		}
+		else {
+			node = right;
+			r = (r - pdf_left) / (1.0f - pdf_left);
+			*pdf *= 1.0f - pdf_left;
+		}
+		r = min(r, 1.0f - 1e-6f);
+		knode = &kernel_tex_fetch(__light_tree_nodes, node);
+	}
+
+	/* Pick emitter of the leaf proportional to energy. */
+	const float total_energy = knode->bbox_min.w;
+	if(total_energy == 0.0f) {
+		return -1;
+	}
+
+	const int first = knode->child_index;
+	const int last = first + knode->num_emitters - 1;
+	float energy_r = r * total_energy;
+	for(int emitter = first; emitter <= last; emitter++) {
+		const float energy = kernel_tex_fetch(__light_tree_emitters, emitter).energy;
+		if(energy_r < energy || emitter == last) {
+			if(energy == 0.0f) {
+				return -1;
+			}
+			*pdf *= energy / total_energy;
+			*randu = min(energy_r / energy, 1.0f - 1e-6f);
+			return emitter;
+		}
+		energy_r -= energy;
+	}
+
+	return -1;
+}
+
+/* Pick light from the trees or distant lights, returns index in the light
+ * distribution or -1. Triangles are picked first, same as in the light
+ * distribution, so callers can force mesh light sampling the same way. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float *randu, float *pdf)
+{
+	const float pdf_triangles = kernel_data.integrator.light_tree_pdf_triangles;
+	const float pdf_lamps = kernel_data.integrator.light_tree_pdf_lamps;
+	float r = *randu;
+	int emitter;
+
+	if(r < pdf_triangles) {
+		r = r / pdf_triangles;
+		emitter = light_tree_sample_emitter(kg, kernel_data.integrator.light_tree_triangle_root, P, &r, pdf);
+		*pdf *= pdf_triangles;
+	}
+	else if(r < pdf_triangles + pdf_lamps) {
+		r = (r - pdf_triangles) / pdf_lamps;
+		emitter = light_tree_sample_emitter(kg, kernel_data.integrator.light_tree_lamp_root, P, &r, pdf);
+		*pdf *= pdf_lamps;
+	}
+	else {
+		/* Distant lights are picked uniformly. */
+		const float pdf_distant = kernel_data.integrator.light_tree_pdf_distant;
+		const int num_distant = kernel_data.integrator.light_tree_num_distant;
+		if(num_distant == 0) {
+			return -1;
+		}
+		r = (r - pdf_triangles - pdf_lamps) / pdf_distant;
+		const int index = clamp(float_to_int(r), 0, num_distant - 1);
+		r = min(r - index, 1.0f - 1e-6f);
+		emitter = kernel_data.integrator.light_tree_distant_offset + index;
+		*pdf = pdf_distant;
+	}
+
+	if(emitter == -1) {
+		return -1;
+	}
+
+	*randu = r;
+	return kernel_tex_fetch(__light_tree_emitters, emitter).distribution_index;
+}
+
+ccl_device float light_tree_lamp_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+	const int emitter = kernel_tex_fetch(__light_tree_emitter_map, lamp);
+	if(emitter == -1) {
+		return 0.0f;
+	}
+	if(kernel_tex_fetch(__light_tree_emitters, emitter).leaf == -1) {
+		return kernel_data.integrator.light_tree_pdf_distant;
+	}
+	return kernel_data.integrator.light_tree_pdf_lamps * light_tree_emitter_pdf(kg, emitter, P);
+}
+
+ccl_device float light_tree_triangle_pdf(KernelGlobals *kg, int object, int prim, float3 P)
+{
+	const int object_map = kernel_data.integrator.num_all_lights + object*2;
+	const int table_offset = kernel_tex_fetch(__light_tree_emitter_map, object_map);
+	if(table_offset == -1) {
+		return 0.0f;
+	}
+	const int tri_offset = kernel_tex_fetch(__light_tree_emitter_map, object_map + 1);
+	const int emitter = kernel_tex_fetch(__light_tree_emitter_map, table_offset + prim - tri_offset);
+	if(emitter == -1) {
+		return 0.0f;
+	}
+	return kernel_data.integrator.light_tree_pdf_triangles * light_tree_emitter_pdf(kg, emitter, P);
+}
+
+CCL_NAMESPACE_END
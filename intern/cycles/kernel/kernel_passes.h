@@ -18,6 +18,7 @@
 #define __ATOMIC_PASS_WRITE__
 #endif
 
+#include "kernel/kernel_adaptive_sampling.h"
 #include "kernel/kernel_id_passes.h"
 
 CCL_NAMESPACE_BEGIN
@@ -384,6 +385,12 @@ ccl_device_inline void kernel_write_result(KernelGlobals *kg,
 
 	kernel_write_pass_float4(buffer, make_float4(L_sum.x, L_sum.y, L_sum.z, alpha));
 
+	/* Even samples for the error estimate of adaptive sampling. */
+	if(kernel_data.film.pass_adaptive_aux_buffer && (sample & 1) == 0) {
+		kernel_write_pass_float4(kernel_adaptive_aux_buffer(kg, buffer),
+		                         make_float4(L_sum.x*2.0f, L_sum.y*2.0f, L_sum.z*2.0f, 0.0f));
+	}
+
 	kernel_write_light_passes(kg, buffer, L);
 
 #ifdef __DENOISING_FEATURES__
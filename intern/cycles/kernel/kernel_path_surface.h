@@ -47,8 +47,13 @@ ccl_device_noinline void kernel_branched_path_surface_connect_light(
 			if(UNLIKELY(light_select_reached_max_bounces(kg, i, state->bounce)))
 				continue;
 
+			float select_pdf;
+			float select_weight = lamp_light_sample_all_weight(kg, i, sd->P, &select_pdf);
+			if(select_pdf == 0.0f)
+				continue;
+
 			int num_samples = ceil_to_int(num_samples_adjust*light_select_num_samples(kg, i));
-			float num_samples_inv = num_samples_adjust/(num_samples*kernel_data.integrator.num_all_lights);
+			float num_samples_inv = num_samples_adjust*select_weight/num_samples;
 			uint lamp_rng_hash = cmj_hash(state->rng_hash, i);
 
 			for(int j = 0; j < num_samples; j++) {
@@ -57,10 +62,10 @@ ccl_device_noinline void kernel_branched_path_surface_connect_light(
 				float terminate = path_branched_rng_light_termination(kg, lamp_rng_hash, state, j, num_samples);
 
 				LightSample ls;
-				if(lamp_light_sample(kg, i, light_u, light_v, sd->P, &ls)) {
+				if(lamp_light_sample(kg, i, light_u, light_v, sd->P, select_pdf, &ls)) {
 					/* The sampling probability returned by lamp_light_sample assumes that all lights were sampled.
 					 * However, this code only samples lamps, so if the scene also had mesh lights, the real probability is twice as high. */
-					if(kernel_data.integrator.pdf_triangles != 0.0f)
+					if(kernel_data.integrator.pdf_triangles != 0.0f && !kernel_data.integrator.use_light_tree)
 						ls.pdf *= 2.0f;
 
 					if(direct_emission(kg, sd, emission_sd, &ls, state, &light_ray, &L_light, &is_lamp, terminate)) {
@@ -90,13 +95,18 @@ ccl_device_noinline void kernel_branched_path_surface_connect_light(
 				float terminate = path_branched_rng_light_termination(kg, state->rng_hash, state, j, num_samples);
 
 				/* only sample triangle lights */
-				if(kernel_data.integrator.num_all_lights)
+				if(kernel_data.integrator.num_all_lights && !kernel_data.integrator.use_light_tree)
 					light_u = 0.5f*light_u;
 
 				LightSample ls;
 				if(light_sample(kg, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+					/* Lamps picked by the light tree were already sampled above, their
+					 * contribution here is zero, which keeps the tree probability of
+					 * triangles for MIS. */
+					if(kernel_data.integrator.use_light_tree && ls.type != LIGHT_TRIANGLE)
+						continue;
 					/* Same as above, probability needs to be corrected since the sampling was forced to select a mesh light. */
-					if(kernel_data.integrator.num_all_lights)
+					if(kernel_data.integrator.num_all_lights && !kernel_data.integrator.use_light_tree)
 						ls.pdf *= 2.0f;
 
 					if(direct_emission(kg, sd, emission_sd, &ls, state, &light_ray, &L_light, &is_lamp, terminate)) {
@@ -158,7 +158,6 @@ ccl_device void kernel_branched_path_volume_connect_light(
 				continue;
 
 			int num_samples = light_select_num_samples(kg, i);
-			float num_samples_inv = 1.0f/(num_samples*kernel_data.integrator.num_all_lights);
 			uint lamp_rng_hash = cmj_hash(state->rng_hash, i);
 
 			for(int j = 0; j < num_samples; j++) {
@@ -167,7 +166,7 @@ ccl_device void kernel_branched_path_volume_connect_light(
 				path_branched_rng_2D(kg, lamp_rng_hash, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
 
 				LightSample ls;
-				lamp_light_sample(kg, i, light_u, light_v, ray->P, &ls);
+				lamp_light_sample(kg, i, light_u, light_v, ray->P, kernel_data.integrator.pdf_lights, &ls);
 
 				float3 tp = throughput;
 
@@ -178,10 +177,18 @@ ccl_device void kernel_branched_path_volume_connect_light(
 				VolumeIntegrateResult result = kernel_volume_decoupled_scatter(kg,
 					state, ray, sd, &tp, rphase, rscatter, segment, (ls.t != FLT_MAX)? &ls.P: NULL, false);
 
+				if(result != VOLUME_PATH_SCATTERED)
+					continue;
+
+				/* Probability of the lamp depends on the scatter position. */
+				float select_pdf;
+				float select_weight = lamp_light_sample_all_weight(kg, i, sd->P, &select_pdf);
+				float num_samples_inv = select_weight/num_samples;
+
 				/* todo: split up light_sample so we don't have to call it again with new position */
-				if(result == VOLUME_PATH_SCATTERED &&
-				   lamp_light_sample(kg, i, light_u, light_v, sd->P, &ls)) {
-					if(kernel_data.integrator.pdf_triangles != 0.0f)
+				if(select_pdf != 0.0f &&
+				   lamp_light_sample(kg, i, light_u, light_v, sd->P, select_pdf, &ls)) {
+					if(kernel_data.integrator.pdf_triangles != 0.0f && !kernel_data.integrator.use_light_tree)
 						ls.pdf *= 2.0f;
 
 					float terminate = path_branched_rng_light_termination(kg, state->rng_hash, state, j, num_samples);
@@ -209,7 +216,7 @@ ccl_device void kernel_branched_path_volume_connect_light(
 				path_branched_rng_2D(kg, state->rng_hash, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
 
 				/* only sample triangle lights */
-				if(kernel_data.integrator.num_all_lights)
+				if(kernel_data.integrator.num_all_lights && !kernel_data.integrator.use_light_tree)
 					light_u = 0.5f*light_u;
 
 				LightSample ls;
@@ -227,7 +234,10 @@ ccl_device void kernel_branched_path_volume_connect_light(
 				/* todo: split up light_sample so we don't have to call it again with new position */
 				if(result == VOLUME_PATH_SCATTERED &&
 				   light_sample(kg, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
-					if(kernel_data.integrator.num_all_lights)
+					/* Lamps picked by the light tree were already sampled above. */
+					if(kernel_data.integrator.use_light_tree && ls.type != LIGHT_TRIANGLE)
+						continue;
+					if(kernel_data.integrator.num_all_lights && !kernel_data.integrator.use_light_tree)
 						ls.pdf *= 2.0f;
 
 					float terminate = path_branched_rng_light_termination(kg, state->rng_hash, state, j, num_samples);
@@ -52,6 +52,39 @@ ccl_device uint sobol_dimension(KernelGlobals *kg, int index, int dimension)
 
 #endif  /* __SOBOL__ */
 
+/* Progressive Multi-Jitter
+ *
+ * Precomputed (0,2) sequences, see render/jitter.cpp. All pixels share the
+ * same patterns and are decorrelated by a Cranley-Patterson rotation read from
+ * a blue noise mask, so the remaining error is distributed as blue noise over
+ * the image. The position of the pixel in the mask is stored in the low bits
+ * of the rng hash by path_rng_init(). Hashes derived for branched paths lose
+ * it, their rotation is then effectively random. */
+
+ccl_device_inline float pmj_shift(KernelGlobals *kg, uint rng_hash, int dimension)
+{
+	/* Toroidal offset of the mask per dimension, so dimensions are
+	 * decorrelated while each still has blue noise error. */
+	const uint offset = cmj_hash_simple(dimension, kernel_data.integrator.seed);
+	const uint x = (rng_hash + offset) & (BLUE_NOISE_SIZE - 1);
+	const uint y = ((rng_hash >> BLUE_NOISE_SIZE_BITS) + (offset >> 16)) & (BLUE_NOISE_SIZE - 1);
+	return kernel_tex_fetch(__blue_noise, y*BLUE_NOISE_SIZE + x);
+}
+
+ccl_device float pmj_sample_1D(KernelGlobals *kg, uint rng_hash, int sample, int dimension)
+{
+	/* Fall back to random numbers beyond the table size. */
+	if(sample >= NUM_PMJ_SAMPLES) {
+		return cmj_randfloat(sample, rng_hash + dimension);
+	}
+
+	/* Dimension pairs share a pattern, use x for even and y for odd ones. */
+	const int pattern = (dimension >> 1) % NUM_PMJ_PATTERNS;
+	const int index = (pattern*NUM_PMJ_SAMPLES + sample)*2 + (dimension & 1);
+	const float r = kernel_tex_fetch(__pmj_samples, index) + pmj_shift(kg, rng_hash, dimension);
+	return r - floorf(r);
+}
+
 
 ccl_device_forceinline float path_rng_1D(KernelGlobals *kg,
                                          uint rng_hash,
@@ -62,6 +95,10 @@ ccl_device_forceinline float path_rng_1D(KernelGlobals *kg,
 	return (float)drand48();
 #endif
 
+	if(kernel_data.integrator.sampling_pattern == SAMPLING_PATTERN_PMJ) {
+		return pmj_sample_1D(kg, rng_hash, sample, dimension);
+	}
+
 #ifdef __CMJ__
 #  ifdef __SOBOL__
 	if(kernel_data.integrator.sampling_pattern == SAMPLING_PATTERN_CMJ)
@@ -103,6 +140,12 @@ ccl_device_forceinline void path_rng_2D(KernelGlobals *kg,
 	return;
 #endif
 
+	if(kernel_data.integrator.sampling_pattern == SAMPLING_PATTERN_PMJ) {
+		*fx = pmj_sample_1D(kg, rng_hash, sample, dimension);
+		*fy = pmj_sample_1D(kg, rng_hash, sample, dimension + 1);
+		return;
+	}
+
 #ifdef __CMJ__
 #  ifdef __SOBOL__
 	if(kernel_data.integrator.sampling_pattern == SAMPLING_PATTERN_CMJ)
@@ -132,6 +175,13 @@ ccl_device_inline void path_rng_init(KernelGlobals *kg,
 	*rng_hash = hash_int_2d(x, y);
 	*rng_hash ^= kernel_data.integrator.seed;
 
+	if(kernel_data.integrator.sampling_pattern == SAMPLING_PATTERN_PMJ) {
+		/* Pixel position in the blue noise mask. */
+		const uint mask = BLUE_NOISE_SIZE - 1;
+		*rng_hash &= ~((mask << BLUE_NOISE_SIZE_BITS) | mask);
+		*rng_hash |= ((y & mask) << BLUE_NOISE_SIZE_BITS) | (x & mask);
+	}
+
 #ifdef __DEBUG_CORRELATION__
 	srand48(*rng_hash + sample);
 #endif
@@ -103,6 +103,7 @@ CCL_NAMESPACE_BEGIN
 #  define __SHADOW_RECORD_ALL__
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  define __TEXTURE_CACHE__
 #endif  /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -321,10 +322,20 @@ enum PathTraceDimension {
 enum SamplingPattern {
 	SAMPLING_PATTERN_SOBOL = 0,
 	SAMPLING_PATTERN_CMJ = 1,
+	SAMPLING_PATTERN_PMJ = 2,
 
 	SAMPLING_NUM_PATTERNS,
 };
 
+/* Progressive multi-jitter tables, every pattern is shared by all pixels and
+ * used for one dimension pair. */
+#define NUM_PMJ_SAMPLES (64*64)
+#define NUM_PMJ_PATTERNS 48
+
+/* Blue noise mask for per-pixel scrambling, size must be a power of two. */
+#define BLUE_NOISE_SIZE_BITS 6
+#define BLUE_NOISE_SIZE (1 << BLUE_NOISE_SIZE_BITS)
+
 /* these flags values correspond to raytypes in osl.cpp, so keep them in sync! */
 
 enum PathRayFlag {
@@ -423,6 +434,7 @@ typedef enum PassType {
 #endif
 	PASS_RENDER_TIME,
 	PASS_CRYPTOMATTE,
+	PASS_ADAPTIVE_AUX_BUFFER,
 	PASS_CATEGORY_MAIN_END = 31,
 
 	PASS_MIST = 32,
@@ -798,6 +810,9 @@ typedef enum AttributeElement {
 	ATTR_ELEMENT_VERTEX_MOTION,
 	ATTR_ELEMENT_CORNER,
 	ATTR_ELEMENT_CORNER_BYTE,
+	/* Texture coordinates of triangles packed as half floats, only used by
+	 * the kernel for compact geometry storage. */
+	ATTR_ELEMENT_CORNER_HALF2,
 	ATTR_ELEMENT_CURVE,
 	ATTR_ELEMENT_CURVE_KEY,
 	ATTR_ELEMENT_CURVE_KEY_MOTION,
@@ -1301,6 +1316,10 @@ typedef struct KernelFilm {
 	int pass_denoising_clean;
 	int denoising_flags;
 
+	int pass_adaptive_aux_buffer;
+	int pass_render_time;
+	int pad1, pad2;
+
 	/* XYZ to rendering color space transform. float4 instead of float3 to
 	 * ensure consistent padding/alignment across devices. */
 	float4 xyz_to_r;
@@ -1404,7 +1423,20 @@ typedef struct KernelIntegrator {
 
 	int max_closures;
 
-	int pad1, pad2, pad3;
+	/* adaptive sampling */
+	float adaptive_threshold;
+	int adaptive_min_samples;
+	int adaptive_step;
+
+	/* light tree */
+	int use_light_tree;
+	int light_tree_triangle_root;
+	int light_tree_lamp_root;
+	int light_tree_num_distant;
+	float light_tree_pdf_triangles;
+	float light_tree_pdf_lamps;
+	float light_tree_pdf_distant;
+	int light_tree_distant_offset;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1427,6 +1459,9 @@ typedef struct KernelBVH {
 	int have_instancing;
 	int bvh_layout;
 	int use_bvh_steps;
+	int use_quantized_nodes;
+	int use_compact_geometry;
+	int pad3, pad4;
 
 	/* Embree */
 #ifdef __EMBREE__
@@ -1566,6 +1601,36 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Node of the light tree, used for importance sampling of scenes with many
+ * lights. See render/light_tree.h for details. */
+typedef struct KernelLightTreeNode {
+	/* Bounds of the emitters, w holds their total energy. */
+	float4 bbox_min;
+	/* w holds spread of the emission directions around the axis. */
+	float4 bbox_max;
+	/* w holds additional falloff angle of the emission. */
+	float4 axis;
+	/* Inner nodes: index of the second child, first child follows directly
+	 * after the node. Leaf nodes: index of the first emitter. */
+	int child_index;
+	/* Zero for inner nodes. */
+	int num_emitters;
+	int parent;
+	int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+	float energy;
+	/* Index in the light distribution. */
+	int distribution_index;
+	/* Leaf containing the emitter, -1 for distant lights which are not part
+	 * of the tree. */
+	int leaf;
+	int pad;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
 	int index;
 	float age;
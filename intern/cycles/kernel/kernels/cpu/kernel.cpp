@@ -49,6 +49,10 @@
 #    define __KERNEL_SSE__
 #    define __KERNEL_AVX2__
 #  endif
+#  if defined(__AVX512F__) && defined(__AVX512CD__) && defined(__AVX512DQ__) && \
+      defined(__AVX512BW__) && defined(__AVX512VL__)
+#    define __KERNEL_AVX512__
+#  endif
 #endif
 
 /* quiet unused define warnings */
@@ -60,6 +64,8 @@
 #define KERNEL_ARCH cpu
 #include "kernel/kernels/cpu/kernel_cpu_impl.h"
 
+#include <OpenImageIO/texture.h>
+
 CCL_NAMESPACE_BEGIN
 
 /* Memory Copy */
@@ -91,4 +97,63 @@ void kernel_tex_copy(KernelGlobals *kg,
 	}
 }
 
+/* Texture Cache */
+
+float4 kernel_tex_image_cache_lookup(KernelGlobals *kg,
+                                     const TextureInfo& info,
+                                     float x, float y,
+                                     float2 dx, float2 dy)
+{
+	OIIO::TextureSystem *ts = (OIIO::TextureSystem*)kg->texture_cache;
+	if(kg->texture_cache_thread_info == NULL) {
+		kg->texture_cache_thread_info = ts->get_perthread_info();
+	}
+
+	OIIO::TextureOpt options;
+	switch(info.extension) {
+		case EXTENSION_EXTEND:
+			options.swrap = options.twrap = OIIO::TextureOpt::WrapClamp;
+			break;
+		case EXTENSION_CLIP:
+			options.swrap = options.twrap = OIIO::TextureOpt::WrapBlack;
+			break;
+		default:
+			options.swrap = options.twrap = OIIO::TextureOpt::WrapPeriodic;
+			break;
+	}
+	switch(info.interpolation) {
+		case INTERPOLATION_CLOSEST:
+			options.interpmode = OIIO::TextureOpt::InterpClosest;
+			break;
+		case INTERPOLATION_CUBIC:
+			options.interpmode = OIIO::TextureOpt::InterpBicubic;
+			break;
+		case INTERPOLATION_SMART:
+			options.interpmode = OIIO::TextureOpt::InterpSmartBicubic;
+			break;
+		default:
+			options.interpmode = OIIO::TextureOpt::InterpBilinear;
+			break;
+	}
+	/* Alpha of images without alpha channel. */
+	options.fill = 1.0f;
+
+	/* Images are stored bottom to top in Cycles, the texture system uses
+	 * the opposite direction. Derivatives select the MIP level, zero
+	 * derivatives give the full resolution. */
+	float result[4];
+	if(!ts->texture((OIIO::TextureSystem::TextureHandle*)info.cache_handle,
+	                (OIIO::TextureSystem::Perthread*)kg->texture_cache_thread_info,
+	                options,
+	                x, 1.0f - y,
+	                dx.x, -dx.y,
+	                dy.x, -dy.y,
+	                4, result))
+	{
+		return make_float4(TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+	}
+
+	return make_float4(result[0], result[1], result[2], result[3]);
+}
+
 CCL_NAMESPACE_END
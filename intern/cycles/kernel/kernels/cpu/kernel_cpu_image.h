@@ -256,6 +256,28 @@ template<typename T> struct TextureInterpolator  {
 
 	/* ********  3D interpolation ******** */
 
+	/* Read voxel from dense or sparse tiled storage, see TextureInfo. */
+	static ccl_always_inline float4 read_3d(const TextureInfo& info,
+	                                        int x, int y, int z)
+	{
+		const T *data = (const T*)info.data;
+		const int width = info.width;
+		const int height = info.height;
+		if(info.sparse_tiles) {
+			const int tiles_x = (width + TEX_SPARSE_TILE_MASK) >> TEX_SPARSE_TILE_SHIFT;
+			const int tiles_y = (height + TEX_SPARSE_TILE_MASK) >> TEX_SPARSE_TILE_SHIFT;
+			const int tile = (x >> TEX_SPARSE_TILE_SHIFT) +
+			                 ((y >> TEX_SPARSE_TILE_SHIFT) +
+			                  (z >> TEX_SPARSE_TILE_SHIFT) * tiles_y) * tiles_x;
+			const int offset = ((const int*)data)[tile];
+			return read(data[offset +
+			                 (x & TEX_SPARSE_TILE_MASK) +
+			                 ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+			                 ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT))]);
+		}
+		return read(data[x + y*width + z*width*height]);
+	}
+
 	static ccl_always_inline float4 interp_3d_closest(const TextureInfo& info,
 	                                                  float x, float y, float z)
 	{
@@ -291,8 +313,7 @@ template<typename T> struct TextureInterpolator  {
 				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 		}
 
-		const T *data = (const T*)info.data;
-		return read(data[ix + iy*width + iz*width*height]);
+		return read_3d(info, ix, iy, iz);
 	}
 
 	static ccl_always_inline float4 interp_3d_linear(const TextureInfo& info,
@@ -339,18 +360,17 @@ template<typename T> struct TextureInterpolator  {
 				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 		}
 
-		const T *data = (const T*)info.data;
 		float4 r;
 
-		r  = (1.0f - tz)*(1.0f - ty)*(1.0f - tx)*read(data[ix + iy*width + iz*width*height]);
-		r += (1.0f - tz)*(1.0f - ty)*tx*read(data[nix + iy*width + iz*width*height]);
-		r += (1.0f - tz)*ty*(1.0f - tx)*read(data[ix + niy*width + iz*width*height]);
-		r += (1.0f - tz)*ty*tx*read(data[nix + niy*width + iz*width*height]);
+		r  = (1.0f - tz)*(1.0f - ty)*(1.0f - tx)*read_3d(info, ix, iy, iz);
+		r += (1.0f - tz)*(1.0f - ty)*tx*read_3d(info, nix, iy, iz);
+		r += (1.0f - tz)*ty*(1.0f - tx)*read_3d(info, ix, niy, iz);
+		r += (1.0f - tz)*ty*tx*read_3d(info, nix, niy, iz);
 
-		r += tz*(1.0f - ty)*(1.0f - tx)*read(data[ix + iy*width + niz*width*height]);
-		r += tz*(1.0f - ty)*tx*read(data[nix + iy*width + niz*width*height]);
-		r += tz*ty*(1.0f - tx)*read(data[ix + niy*width + niz*width*height]);
-		r += tz*ty*tx*read(data[nix + niy*width + niz*width*height]);
+		r += tz*(1.0f - ty)*(1.0f - tx)*read_3d(info, ix, iy, niz);
+		r += tz*(1.0f - ty)*tx*read_3d(info, nix, iy, niz);
+		r += tz*ty*(1.0f - tx)*read_3d(info, ix, niy, niz);
+		r += tz*ty*tx*read_3d(info, nix, niy, niz);
 
 		return r;
 	}
@@ -427,20 +447,14 @@ template<typename T> struct TextureInterpolator  {
 		}
 
 		const int xc[4] = {pix, ix, nix, nnix};
-		const int yc[4] = {width * piy,
-		                   width * iy,
-		                   width * niy,
-		                   width * nniy};
-		const int zc[4] = {width * height * piz,
-		                   width * height * iz,
-		                   width * height * niz,
-		                   width * height * nniz};
+		const int yc[4] = {piy, iy, niy, nniy};
+		const int zc[4] = {piz, iz, niz, nniz};
 		float u[4], v[4], w[4];
 
 		/* Some helper macro to keep code reasonable size,
 		 * let compiler to inline all the matrix multiplications.
 		 */
-#define DATA(x, y, z) (read(data[xc[x] + yc[y] + zc[z]]))
+#define DATA(x, y, z) (read_3d(info, xc[x], yc[y], zc[z]))
 #define COL_TERM(col, row) \
 		(v[col] * (u[0] * DATA(0, col, row) + \
 		           u[1] * DATA(1, col, row) + \
@@ -457,7 +471,6 @@ template<typename T> struct TextureInterpolator  {
 		SET_CUBIC_SPLINE_WEIGHTS(w, tz);
 
 		/* Actual interpolation. */
-		const T *data = (const T*)info.data;
 		return ROW_TERM(0) + ROW_TERM(1) + ROW_TERM(2) + ROW_TERM(3);
 
 #undef COL_TERM
@@ -484,10 +497,24 @@ template<typename T> struct TextureInterpolator  {
 #undef SET_CUBIC_SPLINE_WEIGHTS
 };
 
+/* Lookup into an image which is read on demand through the texture cache.
+ * Compiled only once, in kernel.cpp, so the image library does not have to be
+ * included for every instruction set. */
+float4 kernel_tex_image_cache_lookup(KernelGlobals *kg,
+                                     const TextureInfo& info,
+                                     float x, float y,
+                                     float2 dx, float2 dy);
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
 	const TextureInfo& info = kernel_tex_fetch(__texture_info, id);
 
+	if(info.cache_handle) {
+		return kernel_tex_image_cache_lookup(kg, info, x, y,
+		                                     make_float2(0.0f, 0.0f),
+		                                     make_float2(0.0f, 0.0f));
+	}
+
 	switch(kernel_tex_type(id)) {
 		case IMAGE_DATA_TYPE_HALF:
 			return TextureInterpolator<half>::interp(info, x, y);
@@ -511,6 +538,19 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 	}
 }
 
+/* Lookup with the footprint of the shading point in texture space, which
+ * chooses the resolution of images read through the texture cache. */
+ccl_device float4 kernel_tex_image_interp_d(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+	const TextureInfo& info = kernel_tex_fetch(__texture_info, id);
+
+	if(info.cache_handle) {
+		return kernel_tex_image_cache_lookup(kg, info, x, y, dx, dy);
+	}
+
+	return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg, int id, float x, float y, float z, InterpolationType interp)
 {
 	const TextureInfo& info = kernel_tex_fetch(__texture_info, id);
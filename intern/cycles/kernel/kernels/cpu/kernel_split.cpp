@@ -50,6 +50,10 @@
 #    define __KERNEL_SSE__
 #    define __KERNEL_AVX2__
 #  endif
+#  if defined(__AVX512F__) && defined(__AVX512CD__) && defined(__AVX512DQ__) && \
+      defined(__AVX512BW__) && defined(__AVX512VL__)
+#    define __KERNEL_AVX512__
+#  endif
 #endif
 
 /* quiet unused define warnings */
@@ -30,6 +30,13 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
 	ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
 	int ray_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
+#ifdef __KERNEL_CPU__
+	if(local_use_queues_flag && ray_index == 0) {
+		kernel_split_sort_queue_by_direction(kg,
+		                                     QUEUE_ACTIVE_AND_REGENERATED_RAYS,
+		                                     kernel_split_state.ray);
+	}
+#endif  /* __KERNEL_CPU__ */
 	if(local_use_queues_flag) {
 		ray_index = get_ray_index(kg, ray_index,
 		                          QUEUE_ACTIVE_AND_REGENERATED_RAYS,
@@ -55,7 +55,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg,
 	}
 	ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-	/* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
 	/* bitonic sort */
@@ -78,6 +77,13 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg,
 			}
 		}
 	}
+#  elif defined(__KERNEL_CPU__)
+	/* single thread sorts the whole block on cpu */
+	ushort temp[SHADER_SORT_BLOCK_SIZE];
+	kernel_split_sort_indices(local_value,
+	                          local_index,
+	                          temp,
+	                          min((int)(qsize - offset), SHADER_SORT_BLOCK_SIZE));
 #  endif  /* __KERNEL_OPENCL__ */
 
 	/* copy to destination */
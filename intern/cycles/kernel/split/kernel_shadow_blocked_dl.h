@@ -24,6 +24,13 @@ ccl_device void kernel_shadow_blocked_dl(KernelGlobals *kg)
 
 	int ray_index = QUEUE_EMPTY_SLOT;
 	int thread_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
+#ifdef __KERNEL_CPU__
+	if(thread_index == 0) {
+		kernel_split_sort_queue_by_direction(kg,
+		                                     QUEUE_SHADOW_RAY_CAST_DL_RAYS,
+		                                     kernel_split_state.light_ray);
+	}
+#endif  /* __KERNEL_CPU__ */
 	if(thread_index < dl_queue_length) {
 		ray_index = get_ray_index(kg, thread_index, QUEUE_SHADOW_RAY_CAST_DL_RAYS,
 		                          kernel_split_state.queue_data, kernel_split_params.queue_size, 1);
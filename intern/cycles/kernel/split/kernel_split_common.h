@@ -98,6 +98,95 @@ ccl_device_inline void kernel_split_path_end(KernelGlobals *kg, int ray_index)
 #endif
 }
 
+#ifdef __KERNEL_CPU__
+/* Wavefront sorting on CPU
+ *
+ * CPU split kernel runs every kernel for all global ids sequentially on the
+ * same thread, so the first invocation can reorder a whole queue before other
+ * invocations read from it. Rays and shaders which follow each other in the
+ * queue then access the same BVH nodes and SVM nodes while they are in cache. */
+
+/* Stable merge sort of the index array by the value it refers to. */
+ccl_device void kernel_split_sort_indices(const uint *value,
+                                          ushort *index,
+                                          ushort *temp,
+                                          int num)
+{
+	ushort *src = index, *dst = temp;
+
+	for(int width = 1; width < num; width <<= 1) {
+		for(int start = 0; start < num; start += 2*width) {
+			int mid = min(start + width, num);
+			int end = min(start + 2*width, num);
+			int i = start, j = mid, k = start;
+
+			while(i < mid && j < end) {
+				dst[k++] = (value[src[j]] < value[src[i]])? src[j++]: src[i++];
+			}
+			while(i < mid) {
+				dst[k++] = src[i++];
+			}
+			while(j < end) {
+				dst[k++] = src[j++];
+			}
+		}
+
+		ushort *swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if(src != index) {
+		for(int i = 0; i < num; i++) {
+			index[i] = src[i];
+		}
+	}
+}
+
+/* Sort key of a ray direction: octant in the highest bits, followed by the
+ * quantized absolute value of every component. */
+ccl_device_inline uint kernel_split_direction_key(float3 D)
+{
+	uint key = ((D.x < 0.0f)? 4: 0) | ((D.y < 0.0f)? 2: 0) | ((D.z < 0.0f)? 1: 0);
+	key = (key << 4) | (uint)clamp(fabsf(D.x)*16.0f, 0.0f, 15.0f);
+	key = (key << 4) | (uint)clamp(fabsf(D.y)*16.0f, 0.0f, 15.0f);
+	key = (key << 4) | (uint)clamp(fabsf(D.z)*16.0f, 0.0f, 15.0f);
+	return key;
+}
+
+/* Reorder the queue so rays with similar directions are traversed one after
+ * another. Empty slots are moved to the end of every block. */
+ccl_device void kernel_split_sort_queue_by_direction(KernelGlobals *kg,
+                                                     int queue_number,
+                                                     ccl_global Ray *rays)
+{
+	int qsize = min(kernel_split_params.queue_index[queue_number],
+	                kernel_split_params.queue_size);
+	ccl_global int *queue = kernel_split_state.queue_data + queue_number*kernel_split_params.queue_size;
+
+	ShaderSortLocals locals;
+	ushort temp[SHADER_SORT_BLOCK_SIZE];
+	int ray_index[SHADER_SORT_BLOCK_SIZE];
+
+	for(int offset = 0; offset < qsize; offset += SHADER_SORT_BLOCK_SIZE) {
+		int num = min(qsize - offset, SHADER_SORT_BLOCK_SIZE);
+
+		for(int i = 0; i < num; i++) {
+			ray_index[i] = queue[offset + i];
+			locals.local_value[i] = (ray_index[i] == QUEUE_EMPTY_SLOT)?
+			        (~0): kernel_split_direction_key(rays[ray_index[i]].D);
+			locals.local_index[i] = i;
+		}
+
+		kernel_split_sort_indices(locals.local_value, locals.local_index, temp, num);
+
+		for(int i = 0; i < num; i++) {
+			queue[offset + i] = ray_index[locals.local_index[i]];
+		}
+	}
+}
+#endif  /* __KERNEL_CPU__ */
+
 CCL_NAMESPACE_END
 
 #endif  /* __KERNEL_SPLIT_H__ */
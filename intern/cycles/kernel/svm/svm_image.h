@@ -16,9 +16,13 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint srgb, uint use_alpha)
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint srgb, uint use_alpha)
 {
+#ifdef __TEXTURE_CACHE__
+	float4 r = kernel_tex_image_interp_d(kg, id, x, y, dx, dy);
+#else
 	float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
 	const float alpha = r.w;
 
 	if(use_alpha && alpha != 1.0f && alpha != 0.0f) {
@@ -46,15 +50,30 @@ ccl_device_inline float3 texco_remap_square(float3 co)
 	return (co - make_float3(0.5f, 0.5f, 0.5f)) * 2.0f;
 }
 
-ccl_device void svm_node_tex_image(KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node)
+ccl_device void svm_node_tex_image(KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node, int *offset)
 {
 	uint id = node.y;
 	uint co_offset, out_offset, alpha_offset, srgb;
+	uint4 node2 = read_node(kg, offset);
 
 	decode_node_uchar4(node.z, &co_offset, &out_offset, &alpha_offset, &srgb);
 
+	/* Texture mapping which the compiler fused into this node. */
+	Transform tfm;
+	tfm.x = tfm.y = tfm.z = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+	if(node2.z) {
+		tfm.x = read_node_float(kg, offset);
+		tfm.y = read_node_float(kg, offset);
+		tfm.z = read_node_float(kg, offset);
+	}
+
 	float3 co = stack_load_float3(stack, co_offset);
+	if(node2.z) {
+		co = transform_point(&tfm, co);
+	}
 	float2 tex_co;
+	float2 dx = make_float2(0.0f, 0.0f);
+	float2 dy = make_float2(0.0f, 0.0f);
 	uint use_alpha = stack_valid(alpha_offset);
 	if(node.w == NODE_IMAGE_PROJ_SPHERE) {
 		co = texco_remap_square(co);
@@ -66,8 +85,26 @@ ccl_device void svm_node_tex_image(KernelGlobals *kg, ShaderData *sd, float *sta
 	}
 	else {
 		tex_co = make_float2(co.x, co.y);
+#ifdef __TEXTURE_CACHE__
+		/* Footprint in texture space, from coordinates evaluated at positions
+		 * offset by the ray differentials. */
+		if(stack_valid(node2.x)) {
+			float3 co_dx = stack_load_float3(stack, node2.x);
+			if(node2.z) {
+				co_dx = transform_point(&tfm, co_dx);
+			}
+			dx = make_float2(co_dx.x - co.x, co_dx.y - co.y);
+		}
+		if(stack_valid(node2.y)) {
+			float3 co_dy = stack_load_float3(stack, node2.y);
+			if(node2.z) {
+				co_dy = transform_point(&tfm, co_dy);
+			}
+			dy = make_float2(co_dy.x - co.x, co_dy.y - co.y);
+		}
+#endif
 	}
-	float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, srgb, use_alpha);
+	float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, dx, dy, srgb, use_alpha);
 
 	if(stack_valid(out_offset))
 		stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -154,19 +191,20 @@ ccl_device void svm_node_tex_image_box(KernelGlobals *kg, ShaderData *sd, float
 
 	float4 f = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 	uint use_alpha = stack_valid(alpha_offset);
+	const float2 zero = make_float2(0.0f, 0.0f);
 
 	/* Map so that no textures are flipped, rotation is somewhat arbitrary. */
 	if(weight.x > 0.0f) {
 		float2 uv = make_float2((signed_N.x < 0.0f)? 1.0f - co.y: co.y, co.z);
-		f += weight.x*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.x*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 	if(weight.y > 0.0f) {
 		float2 uv = make_float2((signed_N.y > 0.0f)? 1.0f - co.x: co.x, co.z);
-		f += weight.y*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.y*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 	if(weight.z > 0.0f) {
 		float2 uv = make_float2((signed_N.z > 0.0f)? 1.0f - co.y: co.y, co.x);
-		f += weight.z*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.z*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 
 	if(stack_valid(out_offset))
@@ -194,7 +232,7 @@ ccl_device void svm_node_tex_environment(KernelGlobals *kg, ShaderData *sd, floa
 		uv = direction_to_mirrorball(co);
 
 	uint use_alpha = stack_valid(alpha_offset);
-	float4 f = svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+	float4 f = svm_image_texture(kg, id, uv.x, uv.y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), srgb, use_alpha);
 
 	if(stack_valid(out_offset))
 		stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
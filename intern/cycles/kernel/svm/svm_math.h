@@ -18,16 +18,39 @@ CCL_NAMESPACE_BEGIN
 
 /* Nodes */
 
-ccl_device void svm_node_math(KernelGlobals *kg, ShaderData *sd, float *stack, uint itype, uint f1_offset, uint f2_offset, int *offset)
+ccl_device void svm_node_math(KernelGlobals *kg, ShaderData *sd, float *stack, uint inputs, uint use_clamp, uint num_chained, int *offset)
 {
+	uint itype, f1_offset, f2_offset, out_offset;
+	decode_node_uchar4(inputs, &itype, &f1_offset, &f2_offset, &out_offset);
+
 	NodeMath type = (NodeMath)itype;
 	float f1 = stack_load_float(stack, f1_offset);
 	float f2 = stack_load_float(stack, f2_offset);
 	float f = svm_math(type, f1, f2);
 
-	uint4 node1 = read_node(kg, offset);
+	if(use_clamp) {
+		f = saturate(f);
+	}
+
+	/* Math nodes with a constant operand which the compiler chained onto this
+	 * one, intermediate results are not stored on the stack. */
+	for(uint i = 0; i < num_chained; i++) {
+		uint4 node1 = read_node(kg, offset);
+		NodeMath chain_type = (NodeMath)node1.x;
+		float value = __uint_as_float(node1.z);
+
+		if(node1.y & NODE_MATH_CHAIN_SWAP)
+			f = svm_math(chain_type, value, f);
+		else
+			f = svm_math(chain_type, f, value);
+
+		if(node1.y & NODE_MATH_CHAIN_CLAMP)
+			f = saturate(f);
+
+		out_offset = node1.w;
+	}
 
-	stack_store_float(stack, node1.y, f);
+	stack_store_float(stack, out_offset, f);
 }
 
 ccl_device void svm_node_vector_math(KernelGlobals *kg, ShaderData *sd, float *stack, uint itype, uint v1_offset, uint v2_offset, int *offset)
@@ -268,6 +268,11 @@ typedef enum NodeMath {
 	NODE_MATH_CLAMP /* used for the clamp UI option */
 } NodeMath;
 
+typedef enum NodeMathChainFlag {
+	NODE_MATH_CHAIN_SWAP = (1 << 0),  /* chained value is the second operand */
+	NODE_MATH_CHAIN_CLAMP = (1 << 1),
+} NodeMathChainFlag;
+
 typedef enum NodeVectorMath {
 	NODE_VECTOR_MATH_ADD,
 	NODE_VECTOR_MATH_SUBTRACT,
@@ -21,6 +21,7 @@
 #include "render/integrator.h"
 
 #include "util/util_foreach.h"
+#include "util/util_map.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -102,7 +103,6 @@ uint4 BakeData::differentials(int i)
 
 BakeManager::BakeManager()
 {
-	m_bake_data = NULL;
 	m_is_baking = false;
 	need_update = true;
 	m_shader_limit = 512 * 512;
@@ -110,8 +110,6 @@ BakeManager::BakeManager()
 
 BakeManager::~BakeManager()
 {
-	if(m_bake_data)
-		delete m_bake_data;
 }
 
 bool BakeManager::get_baking()
@@ -124,104 +122,156 @@ void BakeManager::set_baking(const bool value)
 	m_is_baking = value;
 }
 
-BakeData *BakeManager::init(const int object, const size_t tri_offset, const size_t num_pixels)
-{
-	m_bake_data = new BakeData(object, tri_offset, num_pixels);
-	return m_bake_data;
-}
-
 void BakeManager::set_shader_limit(const size_t x, const size_t y)
 {
 	m_shader_limit = x * y;
 	m_shader_limit = (size_t)pow(2, ceil(log(m_shader_limit)/log(2)));
 }
 
-bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[])
+bool BakeManager::bake(Device *device,
+                       DeviceScene *dscene,
+                       Scene *scene,
+                       Progress& progress,
+                       ShaderEvalType shader_type,
+                       const int pass_filter,
+                       const vector<BakeData*>& bake_data,
+                       const vector<float*>& results,
+                       const ObjectDoneFunc& object_done)
 {
-	size_t num_pixels = bake_data->size();
+	size_t num_pixels = 0;
+	foreach(BakeData *data, bake_data) {
+		num_pixels += data->size();
+	}
 
-	int num_samples = aa_samples(scene, bake_data, shader_type);
+	if(num_pixels == 0) {
+		m_is_baking = false;
+		return false;
+	}
+
+	/* group objects by number of samples, and count valid pixels */
+	map<int, vector<size_t> > sample_groups;
+	vector<size_t> num_valid_pixels(bake_data.size(), 0);
 
-	/* calculate the total pixel samples for the progress bar */
 	total_pixel_samples = 0;
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
-		total_pixel_samples += shader_size * num_samples;
+	for(size_t object = 0; object < bake_data.size(); object++) {
+		BakeData *data = bake_data[object];
+		int num_samples = aa_samples(scene, data, shader_type);
+		sample_groups[num_samples].push_back(object);
+
+		for(size_t i = 0; i < data->size(); i++) {
+			if(data->is_valid(i)) {
+				num_valid_pixels[object]++;
+			}
+		}
+
+		/* calculate the total pixel samples for the progress bar */
+		total_pixel_samples += num_valid_pixels[object] * num_samples;
 	}
+
 	progress.reset_sample();
 	progress.set_total_pixel_samples(total_pixel_samples);
 
-	/* needs to be up to date for baking specific AA samples */
-	dscene->data.integrator.aa_samples = num_samples;
-	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+	for(map<int, vector<size_t> >::iterator it = sample_groups.begin();
+	    it != sample_groups.end();
+	    it++)
+	{
+		const int num_samples = it->first;
+		const vector<size_t>& objects = it->second;
+
+		/* pack valid pixels of all objects, invalid pixels are skipped */
+		vector<int> pixel_object;
+		vector<int> pixel_index;
+		vector<size_t> num_remaining_pixels(bake_data.size(), 0);
+
+		foreach(size_t object, objects) {
+			BakeData *data = bake_data[object];
+
+			for(size_t i = 0; i < data->size(); i++) {
+				if(data->is_valid(i)) {
+					pixel_object.push_back(object);
+					pixel_index.push_back(i);
+				}
+			}
 
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+			num_remaining_pixels[object] = num_valid_pixels[object];
+			if(num_remaining_pixels[object] == 0 && object_done) {
+				object_done(object);
+			}
+		}
 
-		/* setup input for device task */
-		device_vector<uint4> d_input(device, "bake_input", MEM_READ_ONLY);
-		uint4 *d_input_data = d_input.alloc(shader_size * 2);
-		size_t d_input_size = 0;
+		/* needs to be up to date for baking specific AA samples */
+		dscene->data.integrator.aa_samples = num_samples;
+		device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
-		for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
-			d_input_data[d_input_size++] = bake_data->data(i);
-			d_input_data[d_input_size++] = bake_data->differentials(i);
-		}
+		const size_t num_group_pixels = pixel_object.size();
 
-		if(d_input_size == 0) {
-			m_is_baking = false;
-			return false;
-		}
+		for(size_t shader_offset = 0; shader_offset < num_group_pixels; shader_offset += m_shader_limit) {
+			size_t shader_size = (size_t)fminf(num_group_pixels - shader_offset, m_shader_limit);
+
+			/* setup input for device task */
+			device_vector<uint4> d_input(device, "bake_input", MEM_READ_ONLY);
+			uint4 *d_input_data = d_input.alloc(shader_size * 2);
+			size_t d_input_size = 0;
+
+			for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
+				BakeData *data = bake_data[pixel_object[i]];
+				d_input_data[d_input_size++] = data->data(pixel_index[i]);
+				d_input_data[d_input_size++] = data->differentials(pixel_index[i]);
+			}
+
+			/* run device task */
+			device_vector<float4> d_output(device, "bake_output", MEM_READ_WRITE);
+			d_output.alloc(shader_size);
+			d_output.zero_to_device();
+			d_input.copy_to_device();
+
+			DeviceTask task(DeviceTask::SHADER);
+			task.shader_input = d_input.device_pointer;
+			task.shader_output = d_output.device_pointer;
+			task.shader_eval_type = shader_type;
+			task.shader_filter = pass_filter;
+			task.shader_x = 0;
+			task.offset = shader_offset;
+			task.shader_w = d_output.size();
+			task.num_samples = num_samples;
+			task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+			task.update_progress_sample = function_bind(&Progress::add_samples_update, &progress, _1, _2);
+
+			device->task_add(task);
+			device->task_wait();
+
+			if(progress.get_cancel()) {
+				d_input.free();
+				d_output.free();
+				m_is_baking = false;
+				return false;
+			}
 
-		/* run device task */
-		device_vector<float4> d_output(device, "bake_output", MEM_READ_WRITE);
-		d_output.alloc(shader_size);
-		d_output.zero_to_device();
-		d_input.copy_to_device();
-
-		DeviceTask task(DeviceTask::SHADER);
-		task.shader_input = d_input.device_pointer;
-		task.shader_output = d_output.device_pointer;
-		task.shader_eval_type = shader_type;
-		task.shader_filter = pass_filter;
-		task.shader_x = 0;
-		task.offset = shader_offset;
-		task.shader_w = d_output.size();
-		task.num_samples = num_samples;
-		task.get_cancel = function_bind(&Progress::get_cancel, &progress);
-		task.update_progress_sample = function_bind(&Progress::add_samples_update, &progress, _1, _2);
-
-		device->task_add(task);
-		device->task_wait();
-
-		if(progress.get_cancel()) {
+			d_output.copy_from_device(0, 1, d_output.size());
 			d_input.free();
-			d_output.free();
-			m_is_baking = false;
-			return false;
-		}
 
-		d_output.copy_from_device(0, 1, d_output.size());
-		d_input.free();
+			/* read result */
+			int k = 0;
 
-		/* read result */
-		int k = 0;
+			float4 *offset = d_output.data();
 
-		float4 *offset = d_output.data();
+			size_t depth = 4;
+			for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
+				const size_t object = pixel_object[i];
+				size_t index = pixel_index[i] * depth;
+				float4 out = offset[k++];
 
-		size_t depth = 4;
-		for(size_t i=shader_offset; i < (shader_offset + shader_size); i++) {
-			size_t index = i * depth;
-			float4 out = offset[k++];
+				for(size_t j = 0; j < 4; j++) {
+					results[object][index + j] = out[j];
+				}
 
-			if(bake_data->is_valid(i)) {
-				for(size_t j=0; j < 4; j++) {
-					result[index + j] = out[j];
+				if(--num_remaining_pixels[object] == 0 && object_done) {
+					object_done(object);
 				}
 			}
-		}
 
-		d_output.free();
+			d_output.free();
+		}
 	}
 
 	m_is_baking = false;
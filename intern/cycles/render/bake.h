@@ -20,6 +20,7 @@
 #include "device/device.h"
 #include "render/scene.h"
 
+#include "util/util_function.h"
 #include "util/util_progress.h"
 #include "util/util_vector.h"
 
@@ -59,11 +60,23 @@ public:
 	bool get_baking();
 	void set_baking(const bool value);
 
-	BakeData *init(const int object, const size_t tri_offset, const size_t num_pixels);
-
 	void set_shader_limit(const size_t x, const size_t y);
 
-	bool bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[]);
+	/* Bake multiple objects for the same pass. Valid pixels of all objects are
+	 * packed together into shader tasks, so threads stay busy regardless of
+	 * how many pixels each object has. Objects needing the same number of AA
+	 * samples are baked together, object_done is called with the index of an
+	 * object as soon as all its pixels are written to its result. */
+	typedef function<void(size_t)> ObjectDoneFunc;
+	bool bake(Device *device,
+	          DeviceScene *dscene,
+	          Scene *scene,
+	          Progress& progress,
+	          ShaderEvalType shader_type,
+	          const int pass_filter,
+	          const vector<BakeData*>& bake_data,
+	          const vector<float*>& results,
+	          const ObjectDoneFunc& object_done);
 
 	void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
@@ -76,7 +89,6 @@ public:
 	size_t total_pixel_samples;
 
 private:
-	BakeData *m_bake_data;
 	bool m_is_baking;
 	size_t m_shader_limit;
 };
@@ -130,7 +130,7 @@ RenderTile::RenderTile()
 
 RenderBuffers::RenderBuffers(Device *device)
 : buffer(device, "RenderBuffers", MEM_READ_WRITE),
-  map_neighbor_copied(false), render_time(0.0f)
+  map_neighbor_copied(false)
 {
 }
 
@@ -146,11 +146,19 @@ void RenderBuffers::reset(BufferParams& params_)
 	/* re-allocate buffer */
 	buffer.alloc(params.width*params.height*params.get_passes_size());
 	buffer.zero_to_device();
+
+	tile_render_time.clear();
+	foreach(Pass& pass, params.passes) {
+		if(pass.type == PASS_RENDER_TIME) {
+			tile_render_time.resize(params.width*params.height, 0.0f);
+		}
+	}
 }
 
 void RenderBuffers::zero()
 {
 	buffer.zero_to_device();
+	tile_render_time.assign(tile_render_time.size(), 0.0f);
 }
 
 bool RenderBuffers::copy_from_device()
@@ -163,6 +171,24 @@ bool RenderBuffers::copy_from_device()
 	return true;
 }
 
+/* Spread render time of a tile evenly over its pixels. Tiles rendered by
+ * different devices never overlap, so this is safe to call from multiple
+ * device threads at once. */
+void RenderBuffers::add_tile_render_time(const RenderTile& rtile, double time)
+{
+	if(tile_render_time.empty() || rtile.w == 0 || rtile.h == 0) {
+		return;
+	}
+
+	const float pixel_time = (float)(1000.0 * time / (rtile.w * rtile.h));
+	for(int y = rtile.y; y < rtile.y + rtile.h; y++) {
+		float *row = &tile_render_time[rtile.offset + rtile.x + y*rtile.stride];
+		for(int x = 0; x < rtile.w; x++) {
+			row[x] += pixel_time;
+		}
+	}
+}
+
 bool RenderBuffers::get_denoising_pass_rect(int type, float exposure, int sample, int components, float *pixels)
 {
 	if(buffer.data() == NULL) {
@@ -262,18 +288,23 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 
 		int size = params.width*params.height;
 
-		if(components == 1 && type == PASS_RENDER_TIME) {
-			/* Render time is not stored by kernel, but measured per tile. */
-			float val = (float) (1000.0 * render_time/(params.width * params.height * sample));
-			for(int i = 0; i < size; i++, pixels++) {
-				pixels[0] = val;
-			}
-		}
-		else if(components == 1) {
+		if(components == 1) {
 			assert(pass.components == components);
 
 			/* Scalar */
-			if(type == PASS_DEPTH) {
+			if(type == PASS_RENDER_TIME) {
+				/* Devices measure it per tile, kernels leave the pass in the
+				 * buffer at zero. */
+				const bool have_tile_time = !tile_render_time.empty();
+				for(int i = 0; i < size; i++, in += pass_stride, pixels++) {
+					float f = *in;
+					if(have_tile_time) {
+						f += tile_render_time[i];
+					}
+					pixels[0] = f*scale;
+				}
+			}
+			else if(type == PASS_DEPTH) {
 				for(int i = 0; i < size; i++, in += pass_stride, pixels++) {
 					float f = *in;
 					pixels[0] = (f == 0.0f)? 1e10f: f*scale_exposure;
@@ -27,11 +27,13 @@
 #include "util/util_string.h"
 #include "util/util_thread.h"
 #include "util/util_types.h"
+#include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
 class Device;
 struct DeviceDrawParams;
+class RenderTile;
 struct float4;
 
 /* Buffer Parameters
@@ -80,7 +82,10 @@ public:
 	/* float buffer */
 	device_vector<float> buffer;
 	bool map_neighbor_copied;
-	double render_time;
+	/* Render time in milliseconds per pixel, of tiles rendered by devices
+	 * which can not write it to the render time pass per pixel. Empty when
+	 * there is no render time pass. */
+	vector<float> tile_render_time;
 
 	explicit RenderBuffers(Device *device);
 	~RenderBuffers();
@@ -89,6 +94,7 @@ public:
 	void zero();
 
 	bool copy_from_device();
+	void add_tile_render_time(const RenderTile& rtile, double time);
 	bool get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels, const string &name);
 	bool get_denoising_pass_rect(int offset, float exposure, int sample, int components, float *pixels);
 };
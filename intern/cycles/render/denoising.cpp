@@ -0,0 +1,775 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/denoising.h"
+
+#include "kernel/filter/filter_defines.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+
+#include <OpenImageIO/filesystem.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Utility Functions */
+
+/* Layout of the device input buffer, matching the passes of the denoising
+ * buffer as read by DenoisingTask::load_buffer(). */
+#define INPUT_NUM_CHANNELS 15
+#define INPUT_DENOISING_DEPTH 0
+#define INPUT_DENOISING_NORMAL 1
+#define INPUT_DENOISING_SHADOWING 4
+#define INPUT_DENOISING_ALBEDO 5
+#define INPUT_NOISY_IMAGE 8
+#define INPUT_DENOISING_VARIANCE 11
+#define INPUT_DENOISING_INTENSITY 14
+
+#define OUTPUT_NUM_CHANNELS 3
+
+struct ChannelMapping {
+	int channel;
+	string name;
+
+	ChannelMapping(int channel, const string& name)
+	: channel(channel), name(name) {}
+};
+
+static void fill_mapping(vector<ChannelMapping>& map, int pos, string name, string channels)
+{
+	for(size_t i = 0; i < channels.size(); i++) {
+		map.push_back(ChannelMapping(pos + i, name + "." + channels[i]));
+	}
+}
+
+/* Channel names as written by Blender for the denoising data passes. */
+static vector<ChannelMapping> input_channels()
+{
+	vector<ChannelMapping> map;
+	fill_mapping(map, INPUT_DENOISING_DEPTH, "Denoising Depth", "Z");
+	fill_mapping(map, INPUT_DENOISING_NORMAL, "Denoising Normal", "XYZ");
+	fill_mapping(map, INPUT_DENOISING_SHADOWING, "Denoising Shadowing", "X");
+	fill_mapping(map, INPUT_DENOISING_ALBEDO, "Denoising Albedo", "RGB");
+	fill_mapping(map, INPUT_NOISY_IMAGE, "Noisy Image", "RGB");
+	fill_mapping(map, INPUT_DENOISING_VARIANCE, "Denoising Variance", "RGB");
+	fill_mapping(map, INPUT_DENOISING_INTENSITY, "Denoising Intensity", "X");
+	return map;
+}
+
+static vector<ChannelMapping> output_channels()
+{
+	vector<ChannelMapping> map;
+	fill_mapping(map, 0, "Combined", "RGB");
+	return map;
+}
+
+static bool split_last_dot(string& in, string& suffix)
+{
+	size_t pos = in.rfind(".");
+	if(pos == string::npos) {
+		return false;
+	}
+	suffix = in.substr(pos+1);
+	in = in.substr(0, pos);
+	return true;
+}
+
+/* Separate channel names as generated by Blender, in the form
+ * Layer.Pass.Channel or Layer.Pass.View.Channel for multiview images. */
+static bool parse_channel_name(string name,
+                               string& layer,
+                               string& pass,
+                               string& view,
+                               string& channel,
+                               bool multiview_channels)
+{
+	if(!split_last_dot(name, channel)) {
+		return false;
+	}
+	view = "";
+	if(multiview_channels && !split_last_dot(name, view)) {
+		return false;
+	}
+	if(!split_last_dot(name, pass)) {
+		return false;
+	}
+	layer = name;
+	return true;
+}
+
+/* Denoise Image Layer */
+
+bool DenoiseImageLayer::detect_denoising_channels()
+{
+	/* Map device input to image channels. */
+	input_to_image_channel.clear();
+	input_to_image_channel.resize(INPUT_NUM_CHANNELS, -1);
+
+	foreach(const ChannelMapping& mapping, input_channels()) {
+		vector<string>::iterator i = find(channels.begin(), channels.end(), mapping.name);
+		if(i == channels.end()) {
+			return false;
+		}
+		input_to_image_channel[mapping.channel] = layer_to_image_channel[i - channels.begin()];
+	}
+
+	/* Map device output to image channels. */
+	output_to_image_channel.clear();
+	output_to_image_channel.resize(OUTPUT_NUM_CHANNELS, -1);
+
+	foreach(const ChannelMapping& mapping, output_channels()) {
+		vector<string>::iterator i = find(channels.begin(), channels.end(), mapping.name);
+		if(i == channels.end()) {
+			return false;
+		}
+		output_to_image_channel[mapping.channel] = layer_to_image_channel[i - channels.begin()];
+	}
+
+	return true;
+}
+
+bool DenoiseImageLayer::match_channels(int neighbor,
+                                       const std::vector<string>& channelnames,
+                                       const std::vector<string>& neighbor_channelnames)
+{
+	neighbor_input_to_image_channel.resize(neighbor + 1);
+	vector<int>& mapping = neighbor_input_to_image_channel[neighbor];
+
+	mapping.clear();
+	mapping.resize(input_to_image_channel.size(), -1);
+
+	for(size_t i = 0; i < input_to_image_channel.size(); i++) {
+		const string& channel = channelnames[input_to_image_channel[i]];
+		std::vector<string>::const_iterator frame_channel = find(neighbor_channelnames.begin(),
+		                                                         neighbor_channelnames.end(),
+		                                                         channel);
+		if(frame_channel == neighbor_channelnames.end()) {
+			return false;
+		}
+		mapping[i] = frame_channel - neighbor_channelnames.begin();
+	}
+
+	return true;
+}
+
+/* Denoise Image */
+
+DenoiseImage::DenoiseImage()
+: width(0), height(0), num_channels(0)
+{
+}
+
+DenoiseImage::~DenoiseImage()
+{
+	free();
+}
+
+void DenoiseImage::close_input()
+{
+	foreach(ImageInput *in, in_neighbors) {
+		in->close();
+		delete in;
+	}
+	in_neighbors.clear();
+}
+
+void DenoiseImage::free()
+{
+	close_input();
+	pixels.clear();
+}
+
+bool DenoiseImage::parse_channels(const ImageSpec& in_spec, string& error)
+{
+	const std::vector<string>& channels = in_spec.channelnames;
+	const bool multiview_channels = (in_spec.get_string_attribute("multiView") != "");
+
+	/* Group channels by layer and view. */
+	map<string, DenoiseImageLayer> file_layers;
+	for(int i = 0; i < channels.size(); i++) {
+		string layer, pass, view, channel;
+		if(!parse_channel_name(channels[i], layer, pass, view, channel, multiview_channels)) {
+			continue;
+		}
+
+		const string key = (view.empty())? layer: layer + "." + view;
+		DenoiseImageLayer& file_layer = file_layers[key];
+		file_layer.name = layer;
+		file_layer.channels.push_back(pass + "." + channel);
+		file_layer.layer_to_image_channel.push_back(i);
+	}
+
+	/* Keep layers with a full set of denoising passes, other channels are
+	 * written to the output unchanged. */
+	layers.clear();
+	for(map<string, DenoiseImageLayer>::iterator i = file_layers.begin(); i != file_layers.end(); ++i) {
+		DenoiseImageLayer& layer = i->second;
+		if(!layer.detect_denoising_channels()) {
+			continue;
+		}
+
+		/* Samples are stored in the metadata by Blender. */
+		layer.samples = 0;
+		const string samples = in_spec.get_string_attribute("cycles." + layer.name + ".samples", "");
+		if(samples != "" && sscanf(samples.c_str(), "%d", &layer.samples) != 1) {
+			error = "Failed to parse samples metadata: " + samples;
+			return false;
+		}
+
+		layers.push_back(layer);
+	}
+
+	return true;
+}
+
+bool DenoiseImage::load(const string& in_filepath, string& error)
+{
+	if(!path_exists(in_filepath)) {
+		error = "Couldn't find file: " + in_filepath;
+		return false;
+	}
+
+	unique_ptr<ImageInput> in(ImageInput::create(in_filepath));
+	if(!in || !in->open(in_filepath, in_spec)) {
+		error = "Couldn't open file: " + in_filepath;
+		return false;
+	}
+
+	width = in_spec.width;
+	height = in_spec.height;
+	num_channels = in_spec.nchannels;
+
+	if(!parse_channels(in_spec, error)) {
+		return false;
+	}
+
+	if(layers.empty()) {
+		error = "Could not find a render layer containing denoising data passes in " + in_filepath;
+		return false;
+	}
+
+	/* Read all channels at once, which is faster than reading them one by
+	 * one since EXR stores channels interleaved. */
+	pixels.resize((size_t)width * height * num_channels);
+	if(!in->read_image(TypeDesc::FLOAT, pixels.data())) {
+		error = "Failed to read image: " + in_filepath;
+		return false;
+	}
+
+	in->close();
+	return true;
+}
+
+bool DenoiseImage::load_neighbors(const vector<string>& filepaths, const vector<int>& frames, string& error)
+{
+	if(frames.size() > DENOISE_MAX_FRAMES - 1) {
+		error = string_printf("Maximum number of neighbors (%d) exceeded", DENOISE_MAX_FRAMES - 1);
+		return false;
+	}
+
+	for(int neighbor = 0; neighbor < frames.size(); neighbor++) {
+		const string& filepath = filepaths[frames[neighbor]];
+
+		if(!path_exists(filepath)) {
+			error = "Couldn't find neighbor frame: " + filepath;
+			return false;
+		}
+
+		ImageSpec neighbor_spec;
+		ImageInput *in_neighbor = ImageInput::create(filepath);
+		if(!in_neighbor || !in_neighbor->open(filepath, neighbor_spec)) {
+			delete in_neighbor;
+			error = "Couldn't open neighbor frame: " + filepath;
+			return false;
+		}
+		in_neighbors.push_back(in_neighbor);
+
+		if(neighbor_spec.width != width || neighbor_spec.height != height) {
+			error = "Neighbor frame has different dimensions: " + filepath;
+			return false;
+		}
+
+		foreach(DenoiseImageLayer& layer, layers) {
+			if(!layer.match_channels(neighbor, in_spec.channelnames, neighbor_spec.channelnames)) {
+				error = "Neighbor frame misses denoising data passes: " + filepath;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void DenoiseImage::read_pixels(const DenoiseImageLayer& layer, float *input_pixels)
+{
+	const int *input_to_image_channel = &layer.input_to_image_channel[0];
+	const size_t num_pixels = (size_t)width * height;
+
+	for(size_t i = 0; i < num_pixels; i++) {
+		const float *in = &pixels[i * num_channels];
+		float *out = input_pixels + i * INPUT_NUM_CHANNELS;
+		for(int j = 0; j < INPUT_NUM_CHANNELS; j++) {
+			out[j] = in[input_to_image_channel[j]];
+		}
+	}
+}
+
+bool DenoiseImage::read_neighbor_pixels(int neighbor, const DenoiseImageLayer& layer, float *input_pixels)
+{
+	ImageInput *in = in_neighbors[neighbor];
+	const int neighbor_channels = in->spec().nchannels;
+	const size_t num_pixels = (size_t)width * height;
+
+	/* Only a single neighbor frame is in memory at a time. */
+	array<float> neighbor_pixels(num_pixels * neighbor_channels);
+	if(!in->read_image(TypeDesc::FLOAT, neighbor_pixels.data())) {
+		return false;
+	}
+
+	const int *input_to_image_channel = &layer.neighbor_input_to_image_channel[neighbor][0];
+	for(size_t i = 0; i < num_pixels; i++) {
+		const float *in_pixel = &neighbor_pixels[i * neighbor_channels];
+		float *out = input_pixels + i * INPUT_NUM_CHANNELS;
+		for(int j = 0; j < INPUT_NUM_CHANNELS; j++) {
+			out[j] = in_pixel[input_to_image_channel[j]];
+		}
+	}
+
+	return true;
+}
+
+bool DenoiseImage::save_output(const string& out_filepath, string& error)
+{
+	/* Save image with identical dimensions, channels and metadata. */
+	ImageSpec out_spec = in_spec;
+
+	/* Ensure the output contains the sample count even if the input didn't. */
+	foreach(const DenoiseImageLayer& layer, layers) {
+		const string name = "cycles." + layer.name + ".samples";
+		if(!out_spec.find_attribute(name, TypeDesc::STRING)) {
+			out_spec.attribute(name, string_printf("%d", layer.samples));
+		}
+	}
+
+	/* Input is not needed anymore, and might be overwritten. */
+	close_input();
+
+	/* Write to a temporary file first, so frames can be denoised in place
+	 * without risking to destroy them when writing fails. */
+	const string extension = OIIO::Filesystem::extension(out_filepath);
+	const string tmp_filepath = out_filepath + ".denoise-tmp-" + OIIO::Filesystem::unique_path() + extension;
+
+	unique_ptr<ImageOutput> out(ImageOutput::create(tmp_filepath));
+	if(!out) {
+		error = "Failed to create temporary file " + tmp_filepath + " for writing";
+		return false;
+	}
+
+	if(!out->open(tmp_filepath, out_spec)) {
+		error = "Failed to open file " + tmp_filepath + " for writing: " + out->geterror();
+		return false;
+	}
+
+	bool ok = true;
+	if(!out->write_image(TypeDesc::FLOAT, pixels.data())) {
+		error = "Failed to write to file " + tmp_filepath + ": " + out->geterror();
+		ok = false;
+	}
+	if(!out->close()) {
+		error = "Failed to save file " + tmp_filepath + ": " + out->geterror();
+		ok = false;
+	}
+	out.reset();
+
+	string rename_error;
+	if(ok && !OIIO::Filesystem::rename(tmp_filepath, out_filepath, rename_error)) {
+		error = "Failed to move denoised image to " + out_filepath + ": " + rename_error;
+		ok = false;
+	}
+
+	if(!ok) {
+		OIIO::Filesystem::remove(tmp_filepath);
+	}
+
+	return ok;
+}
+
+/* Denoise Task */
+
+DenoiseTask::DenoiseTask(Device *device,
+                         Denoiser *denoiser,
+                         int frame,
+                         const vector<int>& neighbor_frames)
+: denoiser(denoiser),
+  device(device),
+  frame(frame),
+  neighbor_frames(neighbor_frames),
+  current_layer(0),
+  input_pixels(device, "filter input buffer", MEM_READ_ONLY),
+  num_tiles(0),
+  num_tiles_done(0)
+{
+}
+
+DenoiseTask::~DenoiseTask()
+{
+	free();
+}
+
+void DenoiseTask::free()
+{
+	image.free();
+	input_pixels.free();
+	assert(output_pixels.empty());
+}
+
+bool DenoiseTask::load()
+{
+	const string& center_filepath = denoiser->input[frame];
+
+	if(!image.load(center_filepath, error)) {
+		return false;
+	}
+
+	if(!image.load_neighbors(denoiser->input, neighbor_frames, error)) {
+		return false;
+	}
+
+	foreach(DenoiseImageLayer& layer, image.layers) {
+		if(denoiser->samples_override > 0) {
+			layer.samples = denoiser->samples_override;
+		}
+		if(layer.samples < 1) {
+			error = string_printf("No sample number specified in the file for layer %s or on the command line",
+			                      layer.name.c_str());
+			return false;
+		}
+	}
+
+	/* Allocate device buffer. */
+	const int num_frames = image.in_neighbors.size() + 1;
+	input_pixels.alloc(image.width * INPUT_NUM_CHANNELS, image.height * num_frames);
+
+	/* Read pixels of the first layer. */
+	current_layer = 0;
+	return load_input_pixels(current_layer);
+}
+
+bool DenoiseTask::load_input_pixels(int layer)
+{
+	const size_t frame_stride = (size_t)image.width * image.height * INPUT_NUM_CHANNELS;
+	const DenoiseImageLayer& image_layer = image.layers[layer];
+
+	float *buffer_data = input_pixels.data();
+	image.read_pixels(image_layer, buffer_data);
+	buffer_data += frame_stride;
+
+	for(int neighbor = 0; neighbor < image.in_neighbors.size(); neighbor++) {
+		if(!image.read_neighbor_pixels(neighbor, image_layer, buffer_data)) {
+			error = "Failed to read neighbor frame pixels of " + denoiser->input[neighbor_frames[neighbor]];
+			return false;
+		}
+		buffer_data += frame_stride;
+	}
+
+	input_pixels.copy_to_device();
+
+	return true;
+}
+
+bool DenoiseTask::exec()
+{
+	for(current_layer = 0; current_layer < image.layers.size(); current_layer++) {
+		/* Pixels of the first layer were read while loading. */
+		if(current_layer > 0 && !load_input_pixels(current_layer)) {
+			return false;
+		}
+
+		DeviceTask task(DeviceTask::RENDER);
+		create_task(task);
+		device->task_add(task);
+		device->task_wait();
+	}
+
+	return true;
+}
+
+bool DenoiseTask::save()
+{
+	return image.save_output(denoiser->output[frame], error);
+}
+
+void DenoiseTask::create_task(DeviceTask& task)
+{
+	/* Callback functions. */
+	task.acquire_tile = function_bind(&DenoiseTask::acquire_tile, this, device, _1, _2);
+	task.map_neighbor_tiles = function_bind(&DenoiseTask::map_neighboring_tiles, this, _1, _2);
+	task.unmap_neighbor_tiles = function_bind(&DenoiseTask::unmap_neighboring_tiles, this, _1);
+	task.release_tile = function_bind(&DenoiseTask::release_tile, this);
+
+	/* Denoising parameters. */
+	task.denoising_radius = denoiser->radius;
+	task.denoising_strength = denoiser->strength;
+	task.denoising_feature_strength = denoiser->feature_strength;
+	task.denoising_relative_pca = denoiser->relative_pca;
+	task.denoising_do_filter = true;
+	task.denoising_write_passes = false;
+	task.denoising_from_render = false;
+
+	task.denoising_frames.resize(neighbor_frames.size());
+	for(int i = 0; i < neighbor_frames.size(); i++) {
+		task.denoising_frames[i] = neighbor_frames[i] - frame;
+	}
+
+	/* Buffer parameters. The result is written to separate output buffers
+	 * of every tile, and is not scaled by the number of samples. */
+	task.pass_stride = INPUT_NUM_CHANNELS;
+	task.target_pass_stride = OUTPUT_NUM_CHANNELS;
+	task.pass_denoising_data = 0;
+	task.pass_denoising_clean = -1;
+	task.frame_stride = image.width * image.height * INPUT_NUM_CHANNELS;
+
+	/* Create tiles. */
+	thread_scoped_lock tile_lock(tiles_mutex);
+	thread_scoped_lock output_lock(output_mutex);
+
+	tiles.clear();
+	assert(output_pixels.empty());
+	output_pixels.clear();
+
+	const int2 tile_size = denoiser->tile_size;
+	const int tiles_x = divide_up(image.width, tile_size.x);
+	const int tiles_y = divide_up(image.height, tile_size.y);
+
+	for(int ty = 0; ty < tiles_y; ty++) {
+		for(int tx = 0; tx < tiles_x; tx++) {
+			RenderTile tile;
+			tile.x = tx * tile_size.x;
+			tile.y = ty * tile_size.y;
+			tile.w = min(image.width - tile.x, tile_size.x);
+			tile.h = min(image.height - tile.y, tile_size.y);
+			tile.start_sample = 0;
+			tile.num_samples = image.layers[current_layer].samples;
+			tile.sample = 0;
+			tile.offset = 0;
+			tile.stride = image.width;
+			tile.tile_index = ty * tiles_x + tx;
+			tile.task = RenderTile::DENOISE;
+			tile.buffers = NULL;
+			tile.buffer = input_pixels.device_pointer;
+			tiles.push_back(tile);
+		}
+	}
+
+	num_tiles = tiles.size();
+	num_tiles_done = 0;
+}
+
+bool DenoiseTask::acquire_tile(Device *device, Device *tile_device, RenderTile& tile)
+{
+	thread_scoped_lock tile_lock(tiles_mutex);
+
+	if(tiles.empty()) {
+		return false;
+	}
+
+	tile = tiles.front();
+	tiles.pop_front();
+
+	device->map_tile(tile_device, tile);
+
+	return true;
+}
+
+/* Regular rendering maps tiles since each has its own memory, possibly on
+ * another device. Here the whole image is in a single buffer, so only the
+ * geometry of the surrounding tiles is filled in. The result is written to a
+ * separate buffer per tile, so neighbors still read the noisy input. */
+void DenoiseTask::map_neighboring_tiles(RenderTile *tiles, Device *tile_device)
+{
+	const int2 tile_size = denoiser->tile_size;
+
+	for(int i = 0; i < 9; i++) {
+		if(i == 4) {
+			continue;
+		}
+
+		const int dx = (i % 3) - 1;
+		const int dy = (i / 3) - 1;
+		tiles[i].x = clamp(tiles[4].x + dx * tile_size.x, 0, image.width);
+		tiles[i].w = clamp(tiles[4].x + (dx + 1) * tile_size.x, 0, image.width) - tiles[i].x;
+		tiles[i].y = clamp(tiles[4].y + dy * tile_size.y, 0, image.height);
+		tiles[i].h = clamp(tiles[4].y + (dy + 1) * tile_size.y, 0, image.height) - tiles[i].y;
+		tiles[i].buffer = tiles[4].buffer;
+		tiles[i].offset = tiles[4].offset;
+		tiles[i].stride = image.width;
+	}
+
+	/* Allocate output buffer. */
+	device_vector<float> *output_mem = new device_vector<float>(tile_device, "denoising output", MEM_READ_WRITE);
+	output_mem->alloc(OUTPUT_NUM_CHANNELS * tiles[4].w * tiles[4].h);
+
+	/* Fill output buffer with the noisy image, which is kept by the
+	 * reconstruction for pixels that could not be filtered. */
+	const DenoiseImageLayer& layer = image.layers[current_layer];
+	const int *input_to_image_channel = &layer.input_to_image_channel[0];
+
+	float *result = output_mem->data();
+	const float *in = &image.pixels[(size_t)image.num_channels * (tiles[4].y * image.width + tiles[4].x)];
+
+	for(int y = 0; y < tiles[4].h; y++) {
+		for(int x = 0; x < tiles[4].w; x++, result += OUTPUT_NUM_CHANNELS) {
+			for(int i = 0; i < OUTPUT_NUM_CHANNELS; i++) {
+				result[i] = in[image.num_channels * x + input_to_image_channel[INPUT_NOISY_IMAGE + i]];
+			}
+		}
+		in += (size_t)image.num_channels * image.width;
+	}
+
+	output_mem->copy_to_device();
+
+	/* Fill output tile info. */
+	tiles[9] = tiles[4];
+	tiles[9].buffer = output_mem->device_pointer;
+	tiles[9].stride = tiles[9].w;
+	tiles[9].offset -= tiles[9].x + tiles[9].y * tiles[9].stride;
+
+	thread_scoped_lock output_lock(output_mutex);
+	assert(output_pixels.count(tiles[4].tile_index) == 0);
+	output_pixels[tiles[9].tile_index] = output_mem;
+}
+
+void DenoiseTask::unmap_neighboring_tiles(RenderTile *tiles)
+{
+	thread_scoped_lock output_lock(output_mutex);
+	assert(output_pixels.count(tiles[4].tile_index) == 1);
+	device_vector<float> *output_mem = output_pixels[tiles[9].tile_index];
+	output_pixels.erase(tiles[4].tile_index);
+	output_lock.unlock();
+
+	/* Copy denoised pixels from device. */
+	output_mem->copy_from_device(0, OUTPUT_NUM_CHANNELS * tiles[9].w, tiles[9].h);
+
+	/* Tiles don't overlap, so writing into the image needs no lock. */
+	const DenoiseImageLayer& layer = image.layers[current_layer];
+	const int *output_to_image_channel = &layer.output_to_image_channel[0];
+
+	const float *result = output_mem->data();
+	float *out = &image.pixels[(size_t)image.num_channels * (tiles[9].y * image.width + tiles[9].x)];
+
+	for(int y = 0; y < tiles[9].h; y++) {
+		for(int x = 0; x < tiles[9].w; x++, result += OUTPUT_NUM_CHANNELS) {
+			for(int i = 0; i < OUTPUT_NUM_CHANNELS; i++) {
+				out[image.num_channels * x + output_to_image_channel[i]] = result[i];
+			}
+		}
+		out += (size_t)image.num_channels * image.width;
+	}
+
+	output_mem->free();
+	delete output_mem;
+}
+
+void DenoiseTask::release_tile()
+{
+	thread_scoped_lock tile_lock(tiles_mutex);
+	num_tiles_done++;
+
+	const string substatus = string_printf("Frame %d/%d, layer %d/%d, tile %d/%d",
+	                                       frame + 1, (int)denoiser->input.size(),
+	                                       current_layer + 1, (int)image.layers.size(),
+	                                       num_tiles_done, num_tiles);
+	tile_lock.unlock();
+
+	denoiser->progress.set_status("Denoising", substatus);
+}
+
+/* Denoiser */
+
+Denoiser::Denoiser(DeviceInfo& device_info)
+{
+	samples_override = 0;
+	tile_size = make_int2(64, 64);
+
+	radius = 8;
+	strength = 0.5f;
+	feature_strength = 0.5f;
+	relative_pca = false;
+	neighbor_frames = 2;
+
+	device = Device::create(device_info, stats, profiler, true);
+
+	if(device) {
+		DeviceRequestedFeatures req;
+		device->load_kernels(req);
+	}
+}
+
+Denoiser::~Denoiser()
+{
+	delete device;
+}
+
+bool Denoiser::run()
+{
+	assert(input.size() == output.size());
+
+	if(!device) {
+		error = "Failed to create denoising device";
+		return false;
+	}
+
+	const int num_frames = output.size();
+
+	for(int frame = 0; frame < num_frames; frame++) {
+		/* Skip empty output paths. */
+		if(output[frame].empty()) {
+			continue;
+		}
+
+		/* Neighbor frames which are used for filtering. */
+		vector<int> frames;
+		for(int f = frame - neighbor_frames; f <= frame + neighbor_frames; f++) {
+			if(f >= 0 && f < num_frames && f != frame) {
+				frames.push_back(f);
+			}
+		}
+
+		DenoiseTask task(device, this, frame, frames);
+
+		if(!task.load()) {
+			error = task.error;
+			return false;
+		}
+
+		if(!task.exec()) {
+			error = task.error;
+			return false;
+		}
+
+		if(!task.save()) {
+			error = task.error;
+			return false;
+		}
+
+		task.free();
+	}
+
+	return true;
+}
+
+CCL_NAMESPACE_END
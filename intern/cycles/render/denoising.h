@@ -0,0 +1,217 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DENOISING_H__
+#define __DENOISING_H__
+
+#include "device/device.h"
+#include "device/device_denoising.h"
+
+#include "render/buffers.h"
+
+#include "util/util_image.h"
+#include "util/util_list.h"
+#include "util/util_map.h"
+#include "util/util_progress.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_unique_ptr.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Denoiser
+ *
+ * Denoises previously rendered frames, stored as multilayer EXR files with
+ * the denoising data passes. Every frame is filtered together with its
+ * neighboring frames, which removes flickering in animations. Only the frames
+ * needed for the current one are kept in memory. */
+
+class Denoiser {
+public:
+	Denoiser(DeviceInfo& device_info);
+	~Denoiser();
+
+	/* Denoise all frames with a non-empty output path. */
+	bool run();
+
+	/* Error message after running, in case of failure. */
+	string error;
+
+	/* Sequential list of frame file paths to denoise. */
+	vector<string> input;
+	/* Sequential list of frame file paths to write the result to. Empty
+	 * entries are skipped, so a subset of the sequence can be denoised while
+	 * still using all input frames as neighbors. */
+	vector<string> output;
+
+	/* Sample number override, takes precedence over the file metadata. */
+	int samples_override;
+	/* Tile size for processing on the device. */
+	int2 tile_size;
+
+	/* Equivalent to the settings of the regular denoiser. */
+	int radius;
+	float strength;
+	float feature_strength;
+	bool relative_pca;
+
+	/* Number of frames before and after the current one to filter with. */
+	int neighbor_frames;
+
+	/* Status is updated whenever a tile is done. */
+	Progress progress;
+
+protected:
+	friend class DenoiseTask;
+
+	Stats stats;
+	Profiler profiler;
+	Device *device;
+};
+
+/* Render layer of an image, with the mapping of its channels to the device
+ * input and output buffers. */
+
+struct DenoiseImageLayer {
+	string name;
+	/* All channels belonging to this layer, as "Pass.Channel". */
+	vector<string> channels;
+	/* Layer to image channel mapping. */
+	vector<int> layer_to_image_channel;
+
+	/* Sample amount that was used for rendering this layer. */
+	int samples;
+
+	/* Device input channel i is copied from image channel input_to_image_channel[i]. */
+	vector<int> input_to_image_channel;
+	/* Same as input_to_image_channel, for every neighbor frame. */
+	vector<vector<int> > neighbor_input_to_image_channel;
+
+	/* Device output channel i is written to image channel output_to_image_channel[i]. */
+	vector<int> output_to_image_channel;
+
+	/* Detect whether this layer contains a full set of channels and set up
+	 * the mapping accordingly. */
+	bool detect_denoising_channels();
+
+	/* Map channels of a neighbor frame to the channels required for
+	 * processing, returns false if any of them is missing. */
+	bool match_channels(int neighbor,
+	                    const std::vector<string>& channelnames,
+	                    const std::vector<string>& neighbor_channelnames);
+};
+
+/* Image of a single frame. Pixels of the frame itself are kept, since the
+ * output is written into them. Neighbor frames are only read when a layer is
+ * loaded into the device buffer. */
+
+class DenoiseImage {
+public:
+	DenoiseImage();
+	~DenoiseImage();
+
+	/* Dimensions */
+	int width, height, num_channels;
+
+	/* Pixel buffer with interleaved channels. */
+	array<float> pixels;
+
+	/* Image file handles */
+	ImageSpec in_spec;
+	vector<ImageInput*> in_neighbors;
+
+	/* Render layers */
+	vector<DenoiseImageLayer> layers;
+
+	void free();
+
+	/* Open the input image, parse its channels and read all pixels. */
+	bool load(const string& in_filepath, string& error);
+	/* Open neighbor frames and match their channels. */
+	bool load_neighbors(const vector<string>& filepaths, const vector<int>& frames, string& error);
+
+	/* Copy channels of a layer into the device input buffer, reordered
+	 * following the layer mapping. */
+	void read_pixels(const DenoiseImageLayer& layer, float *input_pixels);
+	bool read_neighbor_pixels(int neighbor, const DenoiseImageLayer& layer, float *input_pixels);
+
+	/* Write all channels, including the denoised ones, with the metadata of
+	 * the input file. */
+	bool save_output(const string& out_filepath, string& error);
+
+protected:
+	/* Group channels into layers and keep those with all denoising passes. */
+	bool parse_channels(const ImageSpec& in_spec, string& error);
+
+	void close_input();
+};
+
+/* Task denoising a single frame, all its layers are processed in sequence
+ * with the tiles of every layer distributed over the device threads. */
+
+class DenoiseTask {
+public:
+	DenoiseTask(Device *device, Denoiser *denoiser, int frame, const vector<int>& neighbor_frames);
+	~DenoiseTask();
+
+	/* Task stages */
+	bool load();
+	bool exec();
+	bool save();
+	void free();
+
+	string error;
+
+protected:
+	/* Denoiser parameters and device */
+	Denoiser *denoiser;
+	Device *device;
+
+	/* Frame number to be denoised */
+	int frame;
+	vector<int> neighbor_frames;
+
+	/* Image file data */
+	DenoiseImage image;
+	int current_layer;
+
+	/* Device input buffer, with the center frame followed by the neighbors. */
+	device_vector<float> input_pixels;
+
+	/* Tiles */
+	thread_mutex tiles_mutex;
+	list<RenderTile> tiles;
+	int num_tiles;
+	int num_tiles_done;
+
+	thread_mutex output_mutex;
+	map<int, device_vector<float>*> output_pixels;
+
+	/* Task handling */
+	bool load_input_pixels(int layer);
+	void create_task(DeviceTask& task);
+
+	/* Device task callbacks */
+	bool acquire_tile(Device *device, Device *tile_device, RenderTile& tile);
+	void map_neighboring_tiles(RenderTile *tiles, Device *tile_device);
+	void unmap_neighboring_tiles(RenderTile *tiles);
+	void release_tile();
+};
+
+CCL_NAMESPACE_END
+
+#endif  /* __DENOISING_H__ */
@@ -122,8 +122,9 @@ void Pass::add(PassType type, vector<Pass>& passes, const char *name)
 			break;
 #endif
 		case PASS_RENDER_TIME:
-			/* This pass is handled entirely on the host side. */
-			pass.components = 0;
+			/* Written on the host side, per pixel by devices which can measure
+			 * it and per tile otherwise. */
+			pass.components = 1;
 			break;
 
 		case PASS_DIFFUSE_COLOR:
@@ -164,6 +165,10 @@ void Pass::add(PassType type, vector<Pass>& passes, const char *name)
 		case PASS_CRYPTOMATTE:
 			pass.components = 4;
 			break;
+		case PASS_ADAPTIVE_AUX_BUFFER:
+			pass.components = 4;
+			pass.filter = false;
+			break;
 		default:
 			assert(false);
 			break;
@@ -324,6 +329,9 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 	kfilm->pass_stride = 0;
 	kfilm->use_light_pass = use_light_visibility || use_sample_clamp;
 
+	kfilm->pass_adaptive_aux_buffer = 0;
+	kfilm->pass_render_time = 0;
+
 	bool have_cryptomatte = false;
 
 	for(size_t i = 0; i < passes.size(); i++) {
@@ -454,11 +462,15 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 				break;
 #endif
 			case PASS_RENDER_TIME:
+				kfilm->pass_render_time = kfilm->pass_stride;
 				break;
 			case PASS_CRYPTOMATTE:
 				kfilm->pass_cryptomatte = have_cryptomatte ? min(kfilm->pass_cryptomatte, kfilm->pass_stride) : kfilm->pass_stride;
 				have_cryptomatte = true;
 				break;
+			case PASS_ADAPTIVE_AUX_BUFFER:
+				kfilm->pass_adaptive_aux_buffer = kfilm->pass_stride;
+				break;
 			default:
 				assert(false);
 				break;
@@ -344,6 +344,9 @@ void ShaderGraph::finalize(Scene *scene,
 		if(do_bump)
 			bump_from_displacement(bump_in_object_space);
 
+		if(scene->params.texture_cache_size > 0 && !scene->shader_manager->use_osl())
+			add_image_differentials();
+
 		ShaderInput *surface_in = output()->input("Surface");
 		ShaderInput *volume_in = output()->input("Volume");
 
@@ -637,6 +640,55 @@ void ShaderGraph::deduplicate_nodes()
 	}
 }
 
+/* Mapping nodes in front of image textures are merged into the texture
+ * mapping of the image node, which SVM can apply as part of the texture
+ * lookup instead of storing the mapped vector on the stack. OSL image
+ * textures only apply the mapping transform, so min/max clamping and
+ * normal mapping are left to the mapping node there.
+ */
+void ShaderGraph::merge_texture_mapping(bool do_osl)
+{
+	int num_merged = 0;
+
+	foreach(ShaderNode *node, nodes) {
+		if(node->type != ImageTextureNode::node_type) {
+			continue;
+		}
+
+		ImageTextureNode *image_node = (ImageTextureNode*)node;
+		ShaderInput *vector_in = image_node->input("Vector");
+		ShaderInput *vector_dx_in = image_node->input("VectorDX");
+		if(!vector_in->link || vector_dx_in->link || !image_node->tex_mapping.skip()) {
+			continue;
+		}
+
+		ShaderNode *mapping_node = vector_in->link->parent;
+		if(mapping_node->type != MappingNode::node_type) {
+			continue;
+		}
+
+		TextureMapping& tex_mapping = ((MappingNode*)mapping_node)->tex_mapping;
+		if(do_osl && !tex_mapping.is_transform_only()) {
+			continue;
+		}
+
+		ShaderInput *mapping_in = mapping_node->input("Vector");
+		if(!mapping_in->link) {
+			continue;
+		}
+
+		/* Mapping node is removed once no other node uses it. */
+		image_node->tex_mapping = tex_mapping;
+		disconnect(vector_in);
+		connect(mapping_in->link, vector_in);
+		num_merged++;
+	}
+
+	if(num_merged > 0) {
+		VLOG(1) << "Merged " << num_merged << " mapping nodes into image textures.";
+	}
+}
+
 /* Check whether volume output has meaningful nodes, otherwise
  * disconnect the output.
  */
@@ -737,6 +789,7 @@ void ShaderGraph::clean(Scene *scene)
 	constant_fold(scene);
 	simplify_settings(scene);
 	deduplicate_nodes();
+	merge_texture_mapping(scene->shader_manager->use_osl());
 	verify_volume_output();
 
 	/* we do two things here: find cycles and break them, and remove unused
@@ -894,6 +947,55 @@ void ShaderGraph::refine_bump_nodes()
 	}
 }
 
+void ShaderGraph::add_image_differentials()
+{
+	/* images read through the texture cache choose their resolution from the
+	 * footprint of the shading point in texture space. like for bump nodes, the
+	 * sub-graph defined by the vector input is copied twice, and the copies are
+	 * evaluated at positions offset by the ray differentials. */
+
+	foreach(ShaderNode *node, nodes) {
+		if(node->special_type != SHADER_SPECIAL_TYPE_IMAGE_SLOT ||
+		   node->bump == SHADER_BUMP_DX || node->bump == SHADER_BUMP_DY)
+		{
+			continue;
+		}
+
+		ShaderInput *vector_in = node->input("Vector");
+		ShaderInput *vector_dx_in = node->input("VectorDX");
+		ShaderInput *vector_dy_in = node->input("VectorDY");
+		if(!vector_dx_in || !vector_in->link || vector_dx_in->link)
+			continue;
+
+		/* box projection does not use derivatives */
+		if(((ImageTextureNode*)node)->projection == NODE_IMAGE_PROJ_BOX)
+			continue;
+
+		ShaderNodeSet nodes_vector;
+		ShaderNodeMap nodes_dx;
+		ShaderNodeMap nodes_dy;
+
+		find_dependencies(nodes_vector, vector_in);
+
+		copy_nodes(nodes_vector, nodes_dx);
+		copy_nodes(nodes_vector, nodes_dy);
+
+		foreach(NodePair& pair, nodes_dx)
+			pair.second->bump = SHADER_BUMP_DX;
+		foreach(NodePair& pair, nodes_dy)
+			pair.second->bump = SHADER_BUMP_DY;
+
+		ShaderOutput *out = vector_in->link;
+		connect(nodes_dx[out->parent]->output(out->name()), vector_dx_in);
+		connect(nodes_dy[out->parent]->output(out->name()), vector_dy_in);
+
+		foreach(NodePair& pair, nodes_dx)
+			add(pair.second);
+		foreach(NodePair& pair, nodes_dy)
+			add(pair.second);
+	}
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
 	/* generate bump mapping automatically from displacement. bump mapping is
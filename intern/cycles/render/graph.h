@@ -280,6 +280,7 @@ protected:
 	void break_cycles(ShaderNode *node, vector<bool>& visited, vector<bool>& on_stack);
 	void bump_from_displacement(bool use_object_space);
 	void refine_bump_nodes();
+	void add_image_differentials();
 	void default_inputs(bool do_osl);
 	void transform_multi_closure(ShaderNode *node, ShaderOutput *weight_out, bool volume);
 
@@ -288,6 +289,7 @@ protected:
 	void constant_fold(Scene *scene);
 	void simplify_settings(Scene *scene);
 	void deduplicate_nodes();
+	void merge_texture_mapping(bool do_osl);
 	void verify_volume_output();
 };
 
@@ -24,8 +24,11 @@
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_texture.h"
+#include "util/util_time.h"
 #include "util/util_unique_ptr.h"
 
+#include <OpenImageIO/texture.h>
+
 #ifdef WITH_OSL
 #include <OSL/oslexec.h>
 #endif
@@ -88,6 +91,8 @@ ImageManager::ImageManager(const DeviceInfo& info)
 {
 	need_update = true;
 	osl_texture_system = NULL;
+	texture_cache = NULL;
+	load_time = 0.0;
 	animation_frame = 0;
 
 	/* Set image limits */
@@ -105,6 +110,10 @@ ImageManager::~ImageManager()
 		for(size_t slot = 0; slot < images[type].size(); slot++)
 			assert(!images[type][slot]);
 	}
+
+	if(texture_cache) {
+		OIIO::TextureSystem::destroy((OIIO::TextureSystem*)texture_cache);
+	}
 }
 
 void ImageManager::set_osl_texture_system(void *texture_system)
@@ -138,6 +147,27 @@ device_memory *ImageManager::image_memory(int flat_slot)
 	return img->mem;
 }
 
+size_t ImageManager::voxel_index(const device_memory *mem, size_t x, size_t y, size_t z)
+{
+	const size_t width = mem->data_width;
+	const size_t height = mem->data_height;
+	if(!mem->sparse_tiles) {
+		return x + (y + z*height)*width;
+	}
+
+	/* See sparse_tiles_from_dense() for the layout. */
+	const size_t tiles_x = divide_up(width, TEX_SPARSE_TILE_SIZE);
+	const size_t tiles_y = divide_up(height, TEX_SPARSE_TILE_SIZE);
+	const size_t tile = (x >> TEX_SPARSE_TILE_SHIFT) +
+	                    ((y >> TEX_SPARSE_TILE_SHIFT) +
+	                     (z >> TEX_SPARSE_TILE_SHIFT) * tiles_y) * tiles_x;
+	const int *offsets = (const int*)mem->host_pointer;
+	return offsets[tile] +
+	       (x & TEX_SPARSE_TILE_MASK) +
+	       ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+	       ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT));
+}
+
 bool ImageManager::get_image_metadata(int flat_slot,
                                       ImageMetaData& metadata)
 {
@@ -510,6 +540,10 @@ bool ImageManager::file_load_image(Image *img,
                                    int texture_limit,
                                    device_vector<DeviceType>& tex_img)
 {
+	if(use_texture_cache(img, texture_limit)) {
+		return texture_cache_load_image(img, tex_img);
+	}
+
 	unique_ptr<ImageInput> in = NULL;
 	if(!file_load_image_generic(img, &in)) {
 		return false;
@@ -712,6 +746,175 @@ bool ImageManager::file_load_image(Image *img,
 	return true;
 }
 
+void ImageManager::device_update_texture_cache(Device *device, Scene *scene)
+{
+	const int cache_size = scene->params.texture_cache_size;
+	if(texture_cache || cache_size == 0 || osl_texture_system) {
+		return;
+	}
+
+	OIIO::TextureSystem *ts = OIIO::TextureSystem::create(false);
+	ts->attribute("max_memory_MB", (float)cache_size);
+	/* Images which are not tiled and mipmapped are still supported, but they
+	 * have to be read completely on first access. */
+	ts->attribute("autotile", 64);
+	ts->attribute("automip", 1);
+	ts->attribute("gray_to_rgb", 1);
+
+	if(!device->set_texture_cache(ts)) {
+		VLOG(1) << "Texture cache is not supported by the device.";
+		OIIO::TextureSystem::destroy(ts);
+		return;
+	}
+
+	VLOG(1) << "Using texture cache of " << cache_size << " MB.";
+	texture_cache = ts;
+}
+
+void ImageManager::device_free_texture_cache(Device *device)
+{
+	if(texture_cache) {
+		device->set_texture_cache(NULL);
+		OIIO::TextureSystem::destroy((OIIO::TextureSystem*)texture_cache);
+		texture_cache = NULL;
+	}
+}
+
+bool ImageManager::use_texture_cache(Image *img, int texture_limit)
+{
+	/* Only 2D image files, with pixels as they are stored in the file. Images
+	 * with alpha which is to be ignored are unassociated on load, which the
+	 * texture system does not support per image. */
+	const int channels = img->metadata.channels;
+	return texture_cache &&
+	       !img->builtin_data &&
+	       img->metadata.depth <= 1 &&
+	       texture_limit == 0 &&
+	       (img->use_alpha || (channels != 2 && channels != 4));
+}
+
+template<typename DeviceType>
+bool ImageManager::texture_cache_load_image(Image *img,
+                                            device_vector<DeviceType>& tex_img)
+{
+	OIIO::TextureSystem *ts = (OIIO::TextureSystem*)texture_cache;
+	ustring filename(img->filename);
+
+	/* Make sure tiles of a previous version of the file are not used. */
+	ts->invalidate(filename);
+
+	OIIO::TextureSystem::TextureHandle *handle = ts->get_texture_handle(filename);
+	if(handle == NULL || !ts->good(handle)) {
+		return false;
+	}
+
+	/* Pixels are read by the kernel, a single pixel is allocated only so the
+	 * image gets a slot on the device. */
+	thread_scoped_lock device_lock(device_mutex);
+	DeviceType *pixels = tex_img.alloc(1, 1);
+	memset(pixels, 0, sizeof(DeviceType));
+	tex_img.texture_cache_handle = handle;
+
+	return true;
+}
+
+/* Convert a dense volume into tiles, storing only tiles which have non-zero
+ * voxels and one zero tile shared by all others. Offsets of the tiles come
+ * first in the buffer, so the kernel finds the tile of a voxel with a single
+ * indirection. */
+template<typename DeviceType>
+void ImageManager::sparse_tiles_from_dense(device_vector<DeviceType>& tex_img)
+{
+	const size_t width = tex_img.data_width;
+	const size_t height = tex_img.data_height;
+	const size_t depth = tex_img.data_depth;
+	if(depth <= 1) {
+		return;
+	}
+
+	const size_t tiles_x = divide_up(width, TEX_SPARSE_TILE_SIZE);
+	const size_t tiles_y = divide_up(height, TEX_SPARSE_TILE_SIZE);
+	const size_t tiles_z = divide_up(depth, TEX_SPARSE_TILE_SIZE);
+	const size_t num_tiles = tiles_x * tiles_y * tiles_z;
+	const size_t tile_voxels = TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE;
+	const DeviceType *dense = tex_img.data();
+
+	DeviceType zero;
+	memset(&zero, 0, sizeof(zero));
+
+	/* Find tiles with non-zero voxels. */
+	vector<bool> active(num_tiles, false);
+	size_t num_active = 0;
+	for(size_t z = 0; z < depth; z++) {
+		for(size_t y = 0; y < height; y++) {
+			for(size_t x = 0; x < width; x++) {
+				const DeviceType& voxel = dense[x + (y + z*height)*width];
+				if(memcmp(&voxel, &zero, sizeof(zero)) == 0) {
+					continue;
+				}
+				const size_t tile = (x >> TEX_SPARSE_TILE_SHIFT) +
+				                    ((y >> TEX_SPARSE_TILE_SHIFT) +
+				                     (z >> TEX_SPARSE_TILE_SHIFT) * tiles_y) * tiles_x;
+				if(!active[tile]) {
+					active[tile] = true;
+					num_active++;
+				}
+			}
+		}
+	}
+
+	const size_t header_size = divide_up(num_tiles * sizeof(int), sizeof(DeviceType));
+	const size_t sparse_size = header_size + (num_active + 1) * tile_voxels;
+	const size_t dense_size = width * height * depth;
+	if(sparse_size >= dense_size || sparse_size > INT_MAX) {
+		return;
+	}
+
+	/* First tile after the offsets is the shared zero tile. */
+	array<DeviceType> sparse(sparse_size);
+	memset(sparse.data(), 0, sizeof(DeviceType) * sparse_size);
+	int *offsets = (int*)sparse.data();
+	size_t next_offset = header_size + tile_voxels;
+
+	for(size_t tile = 0; tile < num_tiles; tile++) {
+		if(!active[tile]) {
+			offsets[tile] = (int)header_size;
+			continue;
+		}
+
+		offsets[tile] = (int)next_offset;
+
+		const size_t tile_x = (tile % tiles_x) << TEX_SPARSE_TILE_SHIFT;
+		const size_t tile_y = ((tile / tiles_x) % tiles_y) << TEX_SPARSE_TILE_SHIFT;
+		const size_t tile_z = (tile / (tiles_x * tiles_y)) << TEX_SPARSE_TILE_SHIFT;
+		for(size_t z = tile_z; z < min(tile_z + TEX_SPARSE_TILE_SIZE, depth); z++) {
+			for(size_t y = tile_y; y < min(tile_y + TEX_SPARSE_TILE_SIZE, height); y++) {
+				for(size_t x = tile_x; x < min(tile_x + TEX_SPARSE_TILE_SIZE, width); x++) {
+					const size_t local = (x & TEX_SPARSE_TILE_MASK) +
+					                     ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+					                     ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT));
+					sparse[next_offset + local] = dense[x + (y + z*height)*width];
+				}
+			}
+		}
+
+		next_offset += tile_voxels;
+	}
+
+	VLOG(1) << "Storing volume " << tex_img.name << " in " << num_active << " of "
+	        << num_tiles << " tiles, "
+	        << string_human_readable_size(sparse_size * sizeof(DeviceType)) << " instead of "
+	        << string_human_readable_size(dense_size * sizeof(DeviceType)) << ".";
+
+	/* Sparse buffer keeps dimensions of the volume. */
+	thread_scoped_lock device_lock(device_mutex);
+	tex_img.steal_data(sparse);
+	tex_img.data_width = width;
+	tex_img.data_height = height;
+	tex_img.data_depth = depth;
+	tex_img.sparse_tiles = true;
+}
+
 void ImageManager::device_load_image(Device *device,
                                      Scene *scene,
                                      ImageDataType type,
@@ -762,6 +965,9 @@ void ImageManager::device_load_image(Device *device,
 			pixels[2] = TEX_IMAGE_MISSING_B;
 			pixels[3] = TEX_IMAGE_MISSING_A;
 		}
+		else if(device->info.type == DEVICE_CPU) {
+			sparse_tiles_from_dense(*tex_img);
+		}
 
 		img->mem = tex_img;
 		img->mem->interpolation = img->interpolation;
@@ -785,6 +991,9 @@ void ImageManager::device_load_image(Device *device,
 
 			pixels[0] = TEX_IMAGE_MISSING_R;
 		}
+		else if(device->info.type == DEVICE_CPU) {
+			sparse_tiles_from_dense(*tex_img);
+		}
 
 		img->mem = tex_img;
 		img->mem->interpolation = img->interpolation;
@@ -949,6 +1158,10 @@ void ImageManager::device_free_image(Device *, ImageDataType type, int slot)
 			((OSL::TextureSystem*)osl_texture_system)->invalidate(filename);
 #endif
 		}
+		else if(img->mem && img->mem->texture_cache_handle) {
+			ustring filename(images[type][slot]->filename);
+			((OIIO::TextureSystem*)texture_cache)->invalidate(filename);
+		}
 
 		if(img->mem) {
 			thread_scoped_lock device_lock(device_mutex);
@@ -969,6 +1182,10 @@ void ImageManager::device_update(Device *device,
 		return;
 	}
 
+	scoped_timer timer(&load_time);
+
+	device_update_texture_cache(device, scene);
+
 	TaskPool pool;
 	for(int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
 		for(size_t slot = 0; slot < images[type].size(); slot++) {
@@ -1071,6 +1288,8 @@ void ImageManager::device_free(Device *device)
 		}
 		images[type].clear();
 	}
+
+	device_free_texture_cache(device);
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -1082,6 +1301,19 @@ void ImageManager::collect_statistics(RenderStats *stats)
 			                       image->mem->memory_size()));
 		}
 	}
+
+	stats->image.load_time = load_time;
+
+	if(texture_cache) {
+		OIIO::TextureSystem *ts = (OIIO::TextureSystem*)texture_cache;
+		long long memory_used = 0, bytes_read = 0;
+		ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+		ts->getattribute("stat:bytes_read", TypeDesc::INT64, &bytes_read);
+
+		stats->image.use_texture_cache = true;
+		stats->image.texture_cache_memory = memory_used;
+		stats->image.texture_cache_bytes_read = bytes_read;
+	}
 }
 
 CCL_NAMESPACE_END
@@ -107,6 +107,13 @@ public:
 
 	device_memory *image_memory(int flat_slot);
 
+	/* Index of a voxel in host memory of a 3D image, in elements of the image
+	 * data type. Takes volumes stored in sparse tiles into account. */
+	static size_t voxel_index(const device_memory *mem, size_t x, size_t y, size_t z);
+
+	template<typename DeviceType>
+	void sparse_tiles_from_dense(device_vector<DeviceType>& tex_img);
+
 	void collect_statistics(RenderStats *stats);
 
 	bool need_update;
@@ -158,8 +165,21 @@ private:
 	vector<Image*> images[IMAGE_DATA_NUM_TYPES];
 	void *osl_texture_system;
 
+	/* Texture system used to read image files on demand, see
+	 * SceneParams::texture_cache_size. */
+	void *texture_cache;
+	/* Time spent in the last update, which delays start of rendering. */
+	double load_time;
+
 	bool file_load_image_generic(Image *img, unique_ptr<ImageInput> *in);
 
+	void device_update_texture_cache(Device *device, Scene *scene);
+	void device_free_texture_cache(Device *device);
+	bool use_texture_cache(Image *img, int texture_limit);
+	template<typename DeviceType>
+	bool texture_cache_load_image(Image *img,
+	                              device_vector<DeviceType>& tex_img);
+
 	template<TypeDesc::BASETYPE FileFormat,
 	         typename StorageType,
 	         typename DeviceType>
@@ -17,6 +17,7 @@
 #include "device/device.h"
 #include "render/background.h"
 #include "render/integrator.h"
+#include "render/jitter.h"
 #include "render/film.h"
 #include "render/light.h"
 #include "render/scene.h"
@@ -25,9 +26,47 @@
 
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_task.h"
+#include "util/util_thread.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Progressive multi-jitter tables only depend on constants, so they are
+ * generated once and shared by all scenes. */
+
+struct PMJTables {
+	vector<float> samples;
+	vector<float> blue_noise;
+};
+
+static PMJTables pmj_tables;
+static thread_mutex pmj_tables_mutex;
+
+static const PMJTables& pmj_tables_get()
+{
+	thread_scoped_lock lock(pmj_tables_mutex);
+
+	if(pmj_tables.samples.empty()) {
+		pmj_tables.samples.resize(NUM_PMJ_PATTERNS*NUM_PMJ_SAMPLES*2);
+		float2 *points = (float2*)&pmj_tables.samples[0];
+
+		TaskPool pool;
+		for(int j = 0; j < NUM_PMJ_PATTERNS; j++) {
+			pool.push(function_bind(&progressive_multi_jitter_02_generate_2D,
+			                        points + j*NUM_PMJ_SAMPLES,
+			                        NUM_PMJ_SAMPLES,
+			                        j));
+		}
+
+		pmj_tables.blue_noise.resize(BLUE_NOISE_SIZE*BLUE_NOISE_SIZE);
+		blue_noise_generate_2D(&pmj_tables.blue_noise[0], BLUE_NOISE_SIZE, 0);
+
+		pool.wait_work();
+	}
+
+	return pmj_tables;
+}
+
 NODE_DEFINE(Integrator)
 {
 	NodeType *type = NodeType::add("integrator", create);
@@ -68,6 +107,12 @@ NODE_DEFINE(Integrator)
 	SOCKET_BOOLEAN(sample_all_lights_indirect, "Sample All Lights Indirect", true);
 	SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
 
+	SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
+
+	SOCKET_BOOLEAN(use_adaptive_sampling, "Use Adaptive Sampling", false);
+	SOCKET_FLOAT(adaptive_threshold, "Adaptive Threshold", 0.01f);
+	SOCKET_INT(adaptive_min_samples, "Adaptive Min Samples", 0);
+
 	static NodeEnum method_enum;
 	method_enum.insert("path", PATH);
 	method_enum.insert("branched_path", BRANCHED_PATH);
@@ -76,6 +121,7 @@ NODE_DEFINE(Integrator)
 	static NodeEnum sampling_pattern_enum;
 	sampling_pattern_enum.insert("sobol", SAMPLING_PATTERN_SOBOL);
 	sampling_pattern_enum.insert("cmj", SAMPLING_PATTERN_CMJ);
+	sampling_pattern_enum.insert("pmj", SAMPLING_PATTERN_PMJ);
 	SOCKET_ENUM(sampling_pattern, "Sampling Pattern", sampling_pattern_enum, SAMPLING_PATTERN_SOBOL);
 
 	return type;
@@ -175,6 +221,25 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 		kintegrator->light_inv_rr_threshold = 0.0f;
 	}
 
+	/* Adaptive sampling only does something when the film has the auxiliary
+	 * pass, see Film::device_update(). Convergence is checked every few samples
+	 * only, since a single sample does not change the estimate much. */
+	if(use_adaptive_sampling && adaptive_threshold > 0.0f) {
+		kintegrator->adaptive_threshold = adaptive_threshold;
+		kintegrator->adaptive_step = 4;
+		if(adaptive_min_samples > 0) {
+			kintegrator->adaptive_min_samples = adaptive_min_samples;
+		}
+		else {
+			kintegrator->adaptive_min_samples = max(4, (int)sqrtf((float)aa_samples));
+		}
+	}
+	else {
+		kintegrator->adaptive_threshold = 0.0f;
+		kintegrator->adaptive_step = 1;
+		kintegrator->adaptive_min_samples = INT_MAX;
+	}
+
 	/* sobol directions table */
 	int max_samples = 1;
 
@@ -203,6 +268,19 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 
 	dscene->sobol_directions.copy_to_device();
 
+	/* progressive multi-jitter tables */
+	if(sampling_pattern == SAMPLING_PATTERN_PMJ) {
+		const PMJTables& tables = pmj_tables_get();
+
+		float *samples = dscene->pmj_samples.alloc(tables.samples.size());
+		memcpy(samples, &tables.samples[0], sizeof(float)*tables.samples.size());
+		dscene->pmj_samples.copy_to_device();
+
+		float *blue_noise = dscene->blue_noise.alloc(tables.blue_noise.size());
+		memcpy(blue_noise, &tables.blue_noise[0], sizeof(float)*tables.blue_noise.size());
+		dscene->blue_noise.copy_to_device();
+	}
+
 	/* Clamping. */
 	bool use_sample_clamp = (sample_clamp_direct != 0.0f ||
 	                         sample_clamp_indirect != 0.0f);
@@ -217,6 +295,8 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 void Integrator::device_free(Device *, DeviceScene *dscene)
 {
 	dscene->sobol_directions.free();
+	dscene->pmj_samples.free();
+	dscene->blue_noise.free();
 }
 
 bool Integrator::modified(const Integrator& integrator)
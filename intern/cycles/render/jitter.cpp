@@ -0,0 +1,361 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/jitter.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_hash.h"
+#include "util/util_math.h"
+#include "util/util_vector.h"
+
+#include <math.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Deterministic random numbers, so tables are identical across runs. */
+
+class JitterRNG {
+public:
+	explicit JitterRNG(int seed)
+	: seed(seed), counter(0)
+	{
+	}
+
+	uint next_uint()
+	{
+		return hash_int_2d(seed, counter++);
+	}
+
+	/* Random number in [0, 1). */
+	float next_float()
+	{
+		return (next_uint() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	int next_int(int range)
+	{
+		return next_uint() % range;
+	}
+
+	void shuffle(vector<int>& values)
+	{
+		for(int i = (int)values.size() - 1; i > 0; i--) {
+			swap(values[i], values[next_int(i + 1)]);
+		}
+	}
+
+protected:
+	uint seed;
+	uint counter;
+};
+
+/* Progressive Multi-Jittered (0,2) Sequence
+ *
+ * The sequence is built up by repeatedly quadrupling the number of points in
+ * two steps. With N points, each point is in its own cell of a sqrt(N) grid.
+ * First every cell gets a point in the subquadrant diagonally opposite to its
+ * existing point, then the two remaining subquadrants are filled.
+ *
+ * Within a subquadrant the new point is placed such that it occupies an empty
+ * stratum for every elementary interval shape of the new point count. Since
+ * the finest 1D strata of the new point count determine all other strata,
+ * candidates are pairs of free 1D strata, tested in random order. */
+
+class PMJ02_Generator {
+public:
+	PMJ02_Generator(float2 *points, int rng_seed)
+	: points(points), rng(rng_seed), num_strata_log2(0)
+	{
+	}
+
+	void generate(int size)
+	{
+		points[0] = make_float2(rng.next_float(), rng.next_float());
+
+		for(int N = 1; N < size; N *= 4) {
+			const int num_cells = (int)sqrtf((float)N);
+
+			/* N to 2N points, diagonally opposite subquadrant. */
+			begin_level(N, 2*N);
+
+			for(int i = 0; i < N; i++) {
+				int cell_x, cell_y, sub_x, sub_y;
+				find_cell(points[i], num_cells, &cell_x, &cell_y, &sub_x, &sub_y);
+				place_point(N + i, cell_x, cell_y, num_cells, 1 - sub_x, 1 - sub_y);
+			}
+
+			if(2*N >= size) {
+				break;
+			}
+
+			/* 2N to 4N points, remaining two subquadrants. Which of them comes
+			 * first is random, so intermediate point counts stay balanced. */
+			begin_level(2*N, 4*N);
+
+			for(int i = 0; i < N; i++) {
+				int cell_x, cell_y, sub_x, sub_y;
+				find_cell(points[i], num_cells, &cell_x, &cell_y, &sub_x, &sub_y);
+
+				if(rng.next_uint() & 1) {
+					place_point(2*N + i, cell_x, cell_y, num_cells, 1 - sub_x, sub_y);
+					place_point(3*N + i, cell_x, cell_y, num_cells, sub_x, 1 - sub_y);
+				}
+				else {
+					place_point(2*N + i, cell_x, cell_y, num_cells, sub_x, 1 - sub_y);
+					place_point(3*N + i, cell_x, cell_y, num_cells, 1 - sub_x, sub_y);
+				}
+			}
+		}
+	}
+
+protected:
+	float2 *points;
+	JitterRNG rng;
+
+	/* Elementary intervals for 2^num_strata_log2 points. Shape k divides x
+	 * into 2^k and y into 2^(num_strata_log2 - k) strata. */
+	int num_strata_log2;
+	vector<vector<bool> > occupied;
+
+	static int stratum(float value, int num_strata)
+	{
+		return min((int)(value * num_strata), num_strata - 1);
+	}
+
+	void find_cell(float2 p, int num_cells, int *cell_x, int *cell_y, int *sub_x, int *sub_y)
+	{
+		const int x = stratum(p.x, 2*num_cells);
+		const int y = stratum(p.y, 2*num_cells);
+		*cell_x = x >> 1;
+		*cell_y = y >> 1;
+		*sub_x = x & 1;
+		*sub_y = y & 1;
+	}
+
+	void begin_level(int num_points, int num_strata)
+	{
+		num_strata_log2 = 0;
+		while((1 << num_strata_log2) < num_strata) {
+			num_strata_log2++;
+		}
+
+		occupied.resize(num_strata_log2 + 1);
+		for(int k = 0; k <= num_strata_log2; k++) {
+			occupied[k].assign(num_strata, false);
+		}
+
+		for(int i = 0; i < num_points; i++) {
+			mark_occupied(stratum(points[i].x, num_strata), stratum(points[i].y, num_strata));
+		}
+	}
+
+	void mark_occupied(int x, int y)
+	{
+		for(int k = 0; k <= num_strata_log2; k++) {
+			const int xi = x >> (num_strata_log2 - k);
+			const int yi = y >> k;
+			occupied[k][(yi << k) + xi] = true;
+		}
+	}
+
+	bool is_occupied(int x, int y) const
+	{
+		for(int k = 0; k <= num_strata_log2; k++) {
+			const int xi = x >> (num_strata_log2 - k);
+			const int yi = y >> k;
+			if(occupied[k][(yi << k) + xi]) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* Random position within a stratum, without rounding into the next one. */
+	float jitter(int stratum, int num_strata)
+	{
+		const float lower = (float)stratum / num_strata;
+		const float upper = (float)(stratum + 1) / num_strata;
+		const float value = lower + rng.next_float() * (upper - lower);
+		return (value < upper)? value: nextafterf(upper, 0.0f);
+	}
+
+	void place_point(int index, int cell_x, int cell_y, int num_cells, int sub_x, int sub_y)
+	{
+		const int num_strata = 1 << num_strata_log2;
+		const int sub_strata = num_strata / (2*num_cells);
+		const int x_begin = (2*cell_x + sub_x) * sub_strata;
+		const int y_begin = (2*cell_y + sub_y) * sub_strata;
+
+		/* Free 1D strata within the subquadrant. */
+		vector<int> xs, ys;
+		for(int i = 0; i < sub_strata; i++) {
+			if(!occupied[num_strata_log2][x_begin + i]) {
+				xs.push_back(x_begin + i);
+			}
+			if(!occupied[0][y_begin + i]) {
+				ys.push_back(y_begin + i);
+			}
+		}
+		rng.shuffle(xs);
+		rng.shuffle(ys);
+
+		/* Should not happen, but fall back to any stratum in the subquadrant
+		 * rather than failing. */
+		int x = xs.empty()? x_begin + rng.next_int(sub_strata): xs[0];
+		int y = ys.empty()? y_begin + rng.next_int(sub_strata): ys[0];
+
+		bool found = false;
+		for(size_t i = 0; i < xs.size() && !found; i++) {
+			for(size_t j = 0; j < ys.size() && !found; j++) {
+				if(!is_occupied(xs[i], ys[j])) {
+					x = xs[i];
+					y = ys[j];
+					found = true;
+				}
+			}
+		}
+
+		points[index] = make_float2(jitter(x, num_strata), jitter(y, num_strata));
+		mark_occupied(x, y);
+	}
+};
+
+void progressive_multi_jitter_02_generate_2D(float2 points[], int size, int rng_seed)
+{
+	PMJ02_Generator generator(points, rng_seed);
+	generator.generate(size);
+}
+
+/* Blue Noise
+ *
+ * Void-and-cluster: points are ranked by repeatedly removing the point in the
+ * tightest cluster or adding a point in the largest void, measured by the
+ * energy of a toroidal Gaussian filter over the binary pattern. The rank of
+ * each pixel is its value. */
+
+static void blue_noise_update_energy(vector<float>& energy,
+                                     const vector<float>& filter,
+                                     int size,
+                                     int index,
+                                     float sign)
+{
+	const int ix = index % size;
+	const int iy = index / size;
+
+	for(int y = 0; y < size; y++) {
+		const int dy = (y - iy + size) % size;
+		for(int x = 0; x < size; x++) {
+			const int dx = (x - ix + size) % size;
+			energy[y*size + x] += sign * filter[dy*size + dx];
+		}
+	}
+}
+
+static int blue_noise_find(const vector<float>& energy,
+                           const vector<bool>& pattern,
+                           bool value,
+                           bool find_max)
+{
+	int best = -1;
+	for(size_t i = 0; i < energy.size(); i++) {
+		if(pattern[i] != value) {
+			continue;
+		}
+		if(best == -1 ||
+		   (find_max && energy[i] > energy[best]) ||
+		   (!find_max && energy[i] < energy[best]))
+		{
+			best = i;
+		}
+	}
+	return best;
+}
+
+void blue_noise_generate_2D(float values[], int size, int rng_seed)
+{
+	const int num_pixels = size*size;
+	const float sigma = 1.5f;
+
+	/* Toroidal Gaussian filter, indexed by offset. */
+	vector<float> filter(num_pixels);
+	for(int y = 0; y < size; y++) {
+		const int dy = min(y, size - y);
+		for(int x = 0; x < size; x++) {
+			const int dx = min(x, size - x);
+			filter[y*size + x] = expf(-(dx*dx + dy*dy) / (2.0f*sigma*sigma));
+		}
+	}
+
+	vector<bool> pattern(num_pixels, false);
+	vector<float> energy(num_pixels, 0.0f);
+	vector<int> rank(num_pixels, 0);
+
+	/* Initial random pattern. */
+	JitterRNG rng(rng_seed);
+	const int num_initial = max(num_pixels / 10, 1);
+	for(int i = 0; i < num_initial; ) {
+		const int index = rng.next_int(num_pixels);
+		if(!pattern[index]) {
+			pattern[index] = true;
+			blue_noise_update_energy(energy, filter, size, index, 1.0f);
+			i++;
+		}
+	}
+
+	/* Move points from the tightest cluster to the largest void until the
+	 * pattern is stable. */
+	for(int i = 0; i < num_pixels; i++) {
+		const int cluster = blue_noise_find(energy, pattern, true, true);
+		pattern[cluster] = false;
+		blue_noise_update_energy(energy, filter, size, cluster, -1.0f);
+
+		const int largest_void = blue_noise_find(energy, pattern, false, false);
+		pattern[largest_void] = true;
+		blue_noise_update_energy(energy, filter, size, largest_void, 1.0f);
+
+		if(largest_void == cluster) {
+			break;
+		}
+	}
+
+	/* Rank initial points by removing them from the tightest clusters. */
+	vector<bool> initial_pattern = pattern;
+	vector<float> initial_energy = energy;
+
+	for(int r = num_initial - 1; r >= 0; r--) {
+		const int cluster = blue_noise_find(energy, pattern, true, true);
+		pattern[cluster] = false;
+		blue_noise_update_energy(energy, filter, size, cluster, -1.0f);
+		rank[cluster] = r;
+	}
+
+	/* Rank remaining pixels by filling the largest voids. */
+	pattern = initial_pattern;
+	energy = initial_energy;
+
+	for(int r = num_initial; r < num_pixels; r++) {
+		const int largest_void = blue_noise_find(energy, pattern, false, false);
+		pattern[largest_void] = true;
+		blue_noise_update_energy(energy, filter, size, largest_void, 1.0f);
+		rank[largest_void] = r;
+	}
+
+	for(int i = 0; i < num_pixels; i++) {
+		values[i] = (rank[i] + 0.5f) / num_pixels;
+	}
+}
+
+CCL_NAMESPACE_END
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/light.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -479,6 +480,222 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 	}
 }
 
+/* Estimate of the emitted power per unit area, using constant emission of the
+ * shader when known, light tree falls back to spatial and orientation bounds
+ * for other shaders. */
+static float light_tree_shader_energy(DeviceScene *dscene, Shader *shader)
+{
+	const KernelShader *kshader = &dscene->shaders[shader->id];
+	if(kshader->flags & SD_HAS_CONSTANT_EMISSION) {
+		return (fabsf(kshader->constant_emission[0]) +
+		        fabsf(kshader->constant_emission[1]) +
+		        fabsf(kshader->constant_emission[2])) * (1.0f/3.0f);
+	}
+	return 1.0f;
+}
+
+void LightManager::device_update_tree(Device *, DeviceScene *dscene, Scene *scene, Progress& progress)
+{
+	KernelIntegrator *kintegrator = &dscene->data.integrator;
+
+	kintegrator->use_light_tree = false;
+	kintegrator->light_tree_triangle_root = -1;
+	kintegrator->light_tree_lamp_root = -1;
+	kintegrator->light_tree_num_distant = 0;
+	kintegrator->light_tree_pdf_triangles = 0.0f;
+	kintegrator->light_tree_pdf_lamps = 0.0f;
+	kintegrator->light_tree_pdf_distant = 0.0f;
+	kintegrator->light_tree_distant_offset = 0;
+
+	if(!scene->integrator->use_light_tree || !kintegrator->use_direct_light) {
+		return;
+	}
+
+	progress.set_status("Updating Lights", "Building light tree");
+
+	const KernelLightDistribution *distribution = dscene->light_distribution.data();
+	const int num_distribution = kintegrator->num_distribution;
+	const int num_lights = kintegrator->num_all_lights;
+	const int num_triangles = num_distribution - num_lights;
+
+	vector<Light*> lights;
+	foreach(Light *light, scene->lights) {
+		if(light->is_enabled) {
+			lights.push_back(light);
+		}
+	}
+
+	/* Triangles, same order as in the distribution. */
+	vector<LightTreePrimitive> triangle_primitives;
+	triangle_primitives.reserve(num_triangles);
+
+	for(int i = 0; i < num_triangles; i++) {
+		if(progress.get_cancel()) return;
+
+		const Object *object = scene->objects[distribution[i].mesh_light.object_id];
+		const Mesh *mesh = object->mesh;
+		const int triangle = distribution[i].prim - mesh->tri_offset;
+
+		Mesh::Triangle t = mesh->get_triangle(triangle);
+		if(!t.valid(&mesh->verts[0])) {
+			continue;
+		}
+		float3 p1 = mesh->verts[t.v[0]];
+		float3 p2 = mesh->verts[t.v[1]];
+		float3 p3 = mesh->verts[t.v[2]];
+
+		if(!mesh->transform_applied) {
+			p1 = transform_point(&object->tfm, p1);
+			p2 = transform_point(&object->tfm, p2);
+			p3 = transform_point(&object->tfm, p3);
+		}
+
+		int shader_index = mesh->shader[triangle];
+		Shader *shader = (shader_index < mesh->used_shaders.size())
+		                         ? mesh->used_shaders[shader_index]
+		                         : scene->default_surface;
+
+		/* Emission from meshes is two sided, only the position and power of
+		 * triangles can be used for importance. */
+		LightTreePrimitive prim;
+		prim.distribution_index = i;
+		prim.bbox.grow(p1);
+		prim.bbox.grow(p2);
+		prim.bbox.grow(p3);
+		prim.cone = LightTreeCone(safe_normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+		prim.energy = triangle_area(p1, p2, p3) * light_tree_shader_energy(dscene, shader);
+		triangle_primitives.push_back(prim);
+	}
+
+	/* Lamps, distant lights are sampled separately since they have no
+	 * position to bound. */
+	vector<LightTreePrimitive> lamp_primitives;
+	vector<int> distant_lights;
+
+	for(int i = 0; i < num_lights; i++) {
+		const Light *light = lights[i];
+		const int distribution_index = num_triangles + i;
+
+		if(light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+			distant_lights.push_back(distribution_index);
+			continue;
+		}
+
+		LightTreePrimitive prim;
+		prim.distribution_index = distribution_index;
+		prim.energy = light_tree_shader_energy(dscene, light->shader);
+
+		if(light->type == LIGHT_AREA) {
+			const float3 axisu = light->axisu*(light->sizeu*light->size);
+			const float3 axisv = light->axisv*(light->sizev*light->size);
+			prim.bbox.grow(light->co - 0.5f*axisu - 0.5f*axisv);
+			prim.bbox.grow(light->co + 0.5f*axisu - 0.5f*axisv);
+			prim.bbox.grow(light->co - 0.5f*axisu + 0.5f*axisv);
+			prim.bbox.grow(light->co + 0.5f*axisu + 0.5f*axisv);
+			prim.cone = LightTreeCone(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+		}
+		else {
+			prim.bbox.grow(light->co, light->size);
+			if(light->type == LIGHT_SPOT) {
+				prim.cone = LightTreeCone(safe_normalize(light->dir),
+				                          min(light->spot_angle*0.5f, M_PI_F),
+				                          M_PI_2_F);
+			}
+			else {
+				prim.cone = LightTreeCone::sphere();
+			}
+		}
+
+		lamp_primitives.push_back(prim);
+	}
+
+	/* Build trees into shared arrays. */
+	vector<KernelLightTreeNode> nodes;
+	vector<KernelLightTreeEmitter> emitters;
+
+	LightTreeBuilder triangle_builder(triangle_primitives, nodes, emitters);
+	const int triangle_root = triangle_builder.build();
+	LightTreeBuilder lamp_builder(lamp_primitives, nodes, emitters);
+	const int lamp_root = lamp_builder.build();
+
+	const int distant_offset = emitters.size();
+	foreach(int distribution_index, distant_lights) {
+		KernelLightTreeEmitter kemitter;
+		kemitter.energy = 0.0f;
+		kemitter.distribution_index = distribution_index;
+		kemitter.leaf = -1;
+		kemitter.pad = 0;
+		emitters.push_back(kemitter);
+	}
+
+	if(progress.get_cancel()) return;
+
+	/* Map from lamps and triangles to emitters, for evaluating the pdf of
+	 * lights hit by rays. See kernel_light_tree.h for the layout. */
+	const int num_objects = scene->objects.size();
+	vector<int> emitter_map(num_lights + num_objects*2, -1);
+
+	for(int i = 0; i < emitters.size(); i++) {
+		const int distribution_index = emitters[i].distribution_index;
+		if(distribution_index >= num_triangles) {
+			emitter_map[distribution_index - num_triangles] = i;
+			continue;
+		}
+
+		const int object_id = distribution[distribution_index].mesh_light.object_id;
+		const Mesh *mesh = scene->objects[object_id]->mesh;
+		const int object_map = num_lights + object_id*2;
+		if(emitter_map[object_map] == -1) {
+			emitter_map[object_map] = emitter_map.size();
+			emitter_map[object_map + 1] = mesh->tri_offset;
+			emitter_map.resize(emitter_map.size() + mesh->num_triangles(), -1);
+		}
+		emitter_map[emitter_map[object_map] + distribution[distribution_index].prim - mesh->tri_offset] = i;
+	}
+
+	/* Pick triangles and lamps with the same probabilities as the light
+	 * distribution, distant lights get a share of the lamp probability
+	 * according to their number. */
+	const bool has_triangles = (triangle_root != -1);
+	const bool has_lamps = (num_lights > 0);
+	const float pdf_triangles = has_triangles? (has_lamps? 0.5f: 1.0f): 0.0f;
+	const float pdf_all_lamps = 1.0f - pdf_triangles;
+	const int num_distant = distant_lights.size();
+
+	kintegrator->use_light_tree = true;
+	kintegrator->light_tree_triangle_root = triangle_root;
+	kintegrator->light_tree_lamp_root = lamp_root;
+	kintegrator->light_tree_num_distant = num_distant;
+	kintegrator->light_tree_pdf_triangles = pdf_triangles;
+	if(has_lamps) {
+		kintegrator->light_tree_pdf_lamps = (lamp_root != -1)? pdf_all_lamps * (num_lights - num_distant) / num_lights: 0.0f;
+		kintegrator->light_tree_pdf_distant = pdf_all_lamps / num_lights;
+	}
+	kintegrator->light_tree_distant_offset = distant_offset;
+
+	VLOG(1) << "Light tree built with " << nodes.size() << " nodes for "
+	        << triangle_primitives.size() << " triangles and "
+	        << lamp_primitives.size() << " lamps.";
+
+	if(nodes.size()) {
+		KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+		memcpy(knodes, &nodes[0], sizeof(KernelLightTreeNode)*nodes.size());
+		dscene->light_tree_nodes.copy_to_device();
+	}
+
+	if(emitters.size()) {
+		KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(emitters.size());
+		memcpy(kemitters, &emitters[0], sizeof(KernelLightTreeEmitter)*emitters.size());
+		dscene->light_tree_emitters.copy_to_device();
+	}
+
+	if(emitter_map.size()) {
+		int *kemitter_map = dscene->light_tree_emitter_map.alloc(emitter_map.size());
+		memcpy(kemitter_map, &emitter_map[0], sizeof(int)*emitter_map.size());
+		dscene->light_tree_emitter_map.copy_to_device();
+	}
+}
+
 static void background_cdf(int start,
                            int end,
                            int res_x,
@@ -889,6 +1106,9 @@ void LightManager::device_update(Device *device, DeviceScene *dscene, Scene *sce
 	device_update_distribution(device, dscene, scene, progress);
 	if(progress.get_cancel()) return;
 
+	device_update_tree(device, dscene, scene, progress);
+	if(progress.get_cancel()) return;
+
 	device_update_background(device, dscene, scene, progress);
 	if(progress.get_cancel()) return;
 
@@ -907,6 +1127,9 @@ void LightManager::device_free(Device *, DeviceScene *dscene)
 {
 	dscene->light_distribution.free();
 	dscene->lights.free();
+	dscene->light_tree_nodes.free();
+	dscene->light_tree_emitters.free();
+	dscene->light_tree_emitter_map.free();
 	dscene->light_background_marginal_cdf.free();
 	dscene->light_background_conditional_cdf.free();
 	dscene->ies_lights.free();
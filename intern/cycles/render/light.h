@@ -119,6 +119,10 @@ protected:
 	                                DeviceScene *dscene,
 	                                Scene *scene,
 	                                Progress& progress);
+	void device_update_tree(Device *device,
+	                        DeviceScene *dscene,
+	                        Scene *scene,
+	                        Progress& progress);
 	void device_update_background(Device *device,
 	                              DeviceScene *dscene,
 	                              Scene *scene,
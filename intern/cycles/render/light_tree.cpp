@@ -0,0 +1,283 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of buckets used to find the best split along an axis. */
+#define LIGHT_TREE_NUM_BUCKETS 12
+/* Emitters with the same centroid are kept in a single leaf, up to this
+ * number, since no split would separate them anyway. */
+#define LIGHT_TREE_MAX_LEAF_SIZE 8
+
+/* Cone */
+
+static LightTreeCone light_tree_cone_union(const LightTreeCone& cone_a,
+                                           const LightTreeCone& cone_b)
+{
+	const LightTreeCone *a = &cone_a, *b = &cone_b;
+	if(b->theta_o > a->theta_o) {
+		swap(a, b);
+	}
+
+	const float theta_d = safe_acosf(dot(a->axis, b->axis));
+	const float theta_e = max(a->theta_e, b->theta_e);
+
+	/* Wider cone already covers the other one. */
+	if(min(theta_d + b->theta_o, M_PI_F) <= a->theta_o) {
+		return LightTreeCone(a->axis, a->theta_o, theta_e);
+	}
+
+	const float theta_o = 0.5f*(a->theta_o + theta_d + b->theta_o);
+	const float3 rotation_axis = cross(a->axis, b->axis);
+	if(theta_o >= M_PI_F || len_squared(rotation_axis) < 1e-12f) {
+		return LightTreeCone(a->axis, M_PI_F, theta_e);
+	}
+
+	/* Rotate axis of the wider cone towards the other one. */
+	const float3 axis = rotate_around_axis(a->axis,
+	                                       normalize(rotation_axis),
+	                                       theta_o - a->theta_o);
+	return LightTreeCone(normalize(axis), theta_o, theta_e);
+}
+
+/* Integral of the cosine weighted solid angle of the cone. */
+static float light_tree_cone_measure(const LightTreeCone& cone)
+{
+	const float theta_w = min(cone.theta_o + cone.theta_e, M_PI_F);
+	const float cos_o = cosf(cone.theta_o);
+	const float sin_o = sinf(cone.theta_o);
+	return M_2PI_F*(1.0f - cos_o) +
+	       M_PI_2_F*(2.0f*theta_w*sin_o - cosf(cone.theta_o - 2.0f*theta_w) -
+	                 2.0f*cone.theta_o*sin_o + cos_o);
+}
+
+/* Surface area of the bounds, with every dimension clamped to a minimum size,
+ * so point lights placed along a line or in a plane can still be compared. */
+static float light_tree_bbox_measure(const BoundBox& bbox, float min_size)
+{
+	const float3 size = max(bbox.size(), make_float3(min_size, min_size, min_size));
+	return 2.0f*(size.x*size.y + size.y*size.z + size.z*size.x);
+}
+
+/* Builder */
+
+static int light_tree_bucket_index(const LightTreePrimitive& prim,
+                                   const BoundBox& centroid_bbox,
+                                   int dim)
+{
+	const float extent = centroid_bbox.max[dim] - centroid_bbox.min[dim];
+	const float offset = (prim.bbox.center()[dim] - centroid_bbox.min[dim]) / extent;
+	return clamp((int)(offset * LIGHT_TREE_NUM_BUCKETS), 0, LIGHT_TREE_NUM_BUCKETS - 1);
+}
+
+struct LightTreeBucketLess {
+	const BoundBox& centroid_bbox;
+	int dim;
+	int bucket;
+
+	LightTreeBucketLess(const BoundBox& centroid_bbox, int dim, int bucket)
+	: centroid_bbox(centroid_bbox), dim(dim), bucket(bucket) {}
+
+	bool operator()(const LightTreePrimitive& prim) const
+	{
+		return light_tree_bucket_index(prim, centroid_bbox, dim) <= bucket;
+	}
+};
+
+LightTreeBuilder::LightTreeBuilder(vector<LightTreePrimitive>& primitives,
+                                   vector<KernelLightTreeNode>& nodes,
+                                   vector<KernelLightTreeEmitter>& emitters)
+: primitives(primitives),
+  nodes(nodes),
+  emitters(emitters)
+{
+}
+
+int LightTreeBuilder::build()
+{
+	if(primitives.empty()) {
+		return -1;
+	}
+	return recursive_build(0, primitives.size(), -1);
+}
+
+int LightTreeBuilder::recursive_build(int start, int end, int parent)
+{
+	const int node = nodes.size();
+	nodes.push_back(KernelLightTreeNode());
+
+	BoundBox bbox = BoundBox::empty;
+	BoundBox centroid_bbox = BoundBox::empty;
+	LightTreeCone cone = primitives[start].cone;
+	float energy = 0.0f;
+
+	for(int i = start; i < end; i++) {
+		const LightTreePrimitive& prim = primitives[i];
+		bbox.grow(prim.bbox);
+		centroid_bbox.grow(prim.bbox.center());
+		cone = light_tree_cone_union(cone, prim.cone);
+		energy += prim.energy;
+	}
+
+	KernelLightTreeNode& knode = nodes[node];
+	knode.bbox_min = make_float4(bbox.min.x, bbox.min.y, bbox.min.z, energy);
+	knode.bbox_max = make_float4(bbox.max.x, bbox.max.y, bbox.max.z, cone.theta_o);
+	knode.axis = make_float4(cone.axis.x, cone.axis.y, cone.axis.z, cone.theta_e);
+	knode.child_index = -1;
+	knode.num_emitters = 0;
+	knode.parent = parent;
+	knode.pad = 0;
+
+	const int num_primitives = end - start;
+	if(num_primitives == 1) {
+		create_leaf(node, start, end);
+		return node;
+	}
+
+	int split = partition(start, end, centroid_bbox);
+	if(split == start) {
+		if(num_primitives <= LIGHT_TREE_MAX_LEAF_SIZE) {
+			create_leaf(node, start, end);
+			return node;
+		}
+		split = start + num_primitives/2;
+	}
+
+	/* First child directly follows its parent. */
+	recursive_build(start, split, node);
+	const int right = recursive_build(split, end, node);
+	nodes[node].child_index = right;
+
+	return node;
+}
+
+void LightTreeBuilder::create_leaf(int node, int start, int end)
+{
+	nodes[node].child_index = emitters.size();
+	nodes[node].num_emitters = end - start;
+
+	for(int i = start; i < end; i++) {
+		KernelLightTreeEmitter kemitter;
+		kemitter.energy = primitives[i].energy;
+		kemitter.distribution_index = primitives[i].distribution_index;
+		kemitter.leaf = node;
+		kemitter.pad = 0;
+		emitters.push_back(kemitter);
+	}
+}
+
+int LightTreeBuilder::partition(int start, int end, const BoundBox& centroid_bbox)
+{
+	struct Bucket {
+		int count;
+		float energy;
+		BoundBox bbox;
+		LightTreeCone cone;
+
+		Bucket() : count(0), energy(0.0f), bbox(BoundBox::empty) {}
+
+		void add(const Bucket& other)
+		{
+			if(other.count == 0) {
+				return;
+			}
+			cone = (count == 0)? other.cone: light_tree_cone_union(cone, other.cone);
+			count += other.count;
+			energy += other.energy;
+			bbox.grow(other.bbox);
+		}
+
+		float cost(float min_size) const
+		{
+			return energy * light_tree_bbox_measure(bbox, min_size) * light_tree_cone_measure(cone);
+		}
+	};
+
+	const float3 centroid_size = centroid_bbox.size();
+	const float max_extent = max3(centroid_size);
+	if(max_extent == 0.0f) {
+		return start;
+	}
+	const float min_size = 1e-3f * max_extent;
+
+	float best_cost = FLT_MAX;
+	int best_dim = -1;
+	int best_bucket = -1;
+
+	for(int dim = 0; dim < 3; dim++) {
+		const float extent = centroid_size[dim];
+		if(extent == 0.0f) {
+			continue;
+		}
+
+		Bucket buckets[LIGHT_TREE_NUM_BUCKETS];
+		for(int i = start; i < end; i++) {
+			const LightTreePrimitive& prim = primitives[i];
+			const int index = light_tree_bucket_index(prim, centroid_bbox, dim);
+
+			Bucket bucket;
+			bucket.count = 1;
+			bucket.energy = prim.energy;
+			bucket.bbox = prim.bbox;
+			bucket.cone = prim.cone;
+			buckets[index].add(bucket);
+		}
+
+		/* Accumulate buckets from the right, so every split is evaluated in a
+		 * single sweep from the left. */
+		Bucket right[LIGHT_TREE_NUM_BUCKETS];
+		right[LIGHT_TREE_NUM_BUCKETS - 1] = buckets[LIGHT_TREE_NUM_BUCKETS - 1];
+		for(int i = LIGHT_TREE_NUM_BUCKETS - 2; i >= 0; i--) {
+			right[i] = right[i + 1];
+			right[i].add(buckets[i]);
+		}
+
+		/* Penalize splits along short axes, which produce thin nodes. */
+		const float regularization = max_extent / extent;
+
+		Bucket left;
+		for(int i = 0; i < LIGHT_TREE_NUM_BUCKETS - 1; i++) {
+			left.add(buckets[i]);
+			if(left.count == 0 || right[i + 1].count == 0) {
+				continue;
+			}
+			const float cost = regularization * (left.cost(min_size) + right[i + 1].cost(min_size));
+			if(cost < best_cost) {
+				best_cost = cost;
+				best_dim = dim;
+				best_bucket = i;
+			}
+		}
+	}
+
+	if(best_dim == -1) {
+		return start;
+	}
+
+	const LightTreeBucketLess bucket_less(centroid_bbox, best_dim, best_bucket);
+	LightTreePrimitive *middle = std::partition(&primitives[start],
+	                                            &primitives[end - 1] + 1,
+	                                            bucket_less);
+
+	return middle - &primitives[0];
+}
+
+CCL_NAMESPACE_END
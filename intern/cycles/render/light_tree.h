@@ -0,0 +1,95 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounds of emission directions: emitters emit into directions within
+ * theta_o around the axis, with cosine falloff over an additional theta_e. */
+
+struct LightTreeCone {
+	float3 axis;
+	float theta_o;
+	float theta_e;
+
+	LightTreeCone()
+	: axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(0.0f) {}
+
+	LightTreeCone(const float3& axis, float theta_o, float theta_e)
+	: axis(axis), theta_o(theta_o), theta_e(theta_e) {}
+
+	/* Cone covering all directions, used for emitters without orientation. */
+	static LightTreeCone sphere()
+	{
+		return LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+	}
+};
+
+/* Emitter which is to be put into the tree. */
+
+struct LightTreePrimitive {
+	/* Index in the light distribution. */
+	int distribution_index;
+	BoundBox bbox;
+	LightTreeCone cone;
+	float energy;
+
+	LightTreePrimitive()
+	: distribution_index(-1), bbox(BoundBox::empty), energy(0.0f) {}
+};
+
+/* Light Tree Builder
+ *
+ * Builds bounding volume hierarchy over emitters, storing total energy and
+ * bounds of emission directions in every node, so the kernel can estimate
+ * the contribution of the whole subtree to a shading point. Splits minimize
+ * the surface area orientation heuristic from "Importance Sampling of Many
+ * Lights with Adaptive Tree Splitting" by Conty Estevez and Kulla.
+ *
+ * Multiple trees can be packed into the same arrays. */
+
+class LightTreeBuilder {
+public:
+	LightTreeBuilder(vector<LightTreePrimitive>& primitives,
+	                 vector<KernelLightTreeNode>& nodes,
+	                 vector<KernelLightTreeEmitter>& emitters);
+
+	/* Returns index of the root node, or -1 when there are no primitives. */
+	int build();
+
+protected:
+	int recursive_build(int start, int end, int parent);
+	void create_leaf(int node, int start, int end);
+	/* Partition primitives for the children of a node, returns the first
+	 * primitive of the second child or start when no split was found. */
+	int partition(int start, int end, const BoundBox& centroid_bbox);
+
+	vector<LightTreePrimitive>& primitives;
+	vector<KernelLightTreeNode>& nodes;
+	vector<KernelLightTreeEmitter>& emitters;
+};
+
+CCL_NAMESPACE_END
+
+#endif  /* __LIGHT_TREE_H__ */
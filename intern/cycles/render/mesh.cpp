@@ -35,9 +35,11 @@
 #include "subd/subd_patch_table.h"
 
 #include "util/util_foreach.h"
+#include "util/util_half.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_time.h"
 
 #ifdef WITH_EMBREE
 #  include "bvh/bvh_embree.h"
@@ -459,6 +461,7 @@ Mesh::Mesh()
 
 	subdivision_type = SUBDIVISION_NONE;
 	subd_params = NULL;
+	subd_split_cache = NULL;
 
 	patch_table = NULL;
 }
@@ -468,6 +471,7 @@ Mesh::~Mesh()
 	delete bvh;
 	delete patch_table;
 	delete subd_params;
+	delete subd_split_cache;
 }
 
 void Mesh::resize_mesh(int numverts, int numtris)
@@ -880,7 +884,7 @@ void Mesh::pack_shaders(Scene *scene, uint *tri_shader)
 	}
 }
 
-void Mesh::pack_normals(float4 *vnormal)
+void Mesh::pack_normals(float4 *vnormal, uint *vnormal_packed)
 {
 	Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
 	if(attr_vN == NULL) {
@@ -900,7 +904,12 @@ void Mesh::pack_normals(float4 *vnormal)
 		if(do_transform)
 			vNi = safe_normalize(transform_direction(&ntfm, vNi));
 
-		vnormal[i] = make_float4(vNi.x, vNi.y, vNi.z, 0.0f);
+		if(vnormal_packed) {
+			vnormal_packed[i] = float3_to_octahedral(vNi);
+		}
+		else {
+			vnormal[i] = make_float4(vNi.x, vNi.y, vNi.z, 0.0f);
+		}
 	}
 }
 
@@ -1051,6 +1060,7 @@ void Mesh::compute_bvh(Device *device,
 			        device->get_bvh_layout_mask());
 			bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
 			                              params->use_bvh_unaligned_nodes;
+			bparams.use_quantized_nodes = params->use_bvh_quantized_nodes;
 			bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
 			bparams.num_motion_curve_steps = params->num_bvh_time_steps;
 			bparams.bvh_type = params->bvh_type;
@@ -1150,6 +1160,8 @@ MeshManager::MeshManager()
 {
 	need_update = true;
 	need_flags_update = true;
+	bvh_build_time = 0.0;
+	sync_time = 0.0;
 }
 
 MeshManager::~MeshManager()
@@ -1376,12 +1388,26 @@ void MeshManager::update_svm_attributes(Device *, DeviceScene *dscene, Scene *sc
 	dscene->attributes_map.copy_to_device();
 }
 
+/* Texture coordinates of triangles are packed into half floats for compact
+ * geometry storage. */
+static bool attribute_use_half2(const Attribute *mattr,
+                                AttributePrimitive prim,
+                                bool use_compact_geometry)
+{
+	return use_compact_geometry &&
+	       prim == ATTR_PRIM_TRIANGLE &&
+	       mattr->element == ATTR_ELEMENT_CORNER &&
+	       mattr->std == ATTR_STD_UV;
+}
+
 static void update_attribute_element_size(Mesh *mesh,
                                           Attribute *mattr,
                                           AttributePrimitive prim,
+                                          bool use_compact_geometry,
                                           size_t *attr_float_size,
                                           size_t *attr_float3_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_half2_size)
 {
 	if(mattr) {
 		size_t size = mattr->element_size(mesh, prim);
@@ -1392,6 +1418,9 @@ static void update_attribute_element_size(Mesh *mesh,
 		else if(mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
 			*attr_uchar4_size += size;
 		}
+		else if(attribute_use_half2(mattr, prim, use_compact_geometry)) {
+			*attr_half2_size += size;
+		}
 		else if(mattr->type == TypeDesc::TypeFloat) {
 			*attr_float_size += size;
 		}
@@ -1411,8 +1440,11 @@ static void update_attribute_element_offset(Mesh *mesh,
                                             size_t& attr_float3_offset,
                                             device_vector<uchar4>& attr_uchar4,
                                             size_t& attr_uchar4_offset,
+                                            device_vector<uint>& attr_half2,
+                                            size_t& attr_half2_offset,
                                             Attribute *mattr,
                                             AttributePrimitive prim,
+                                            bool use_compact_geometry,
                                             TypeDesc& type,
                                             AttributeDescriptor& desc)
 {
@@ -1443,6 +1475,18 @@ static void update_attribute_element_offset(Mesh *mesh,
 			}
 			attr_uchar4_offset += size;
 		}
+		else if(attribute_use_half2(mattr, prim, use_compact_geometry)) {
+			float3 *data = mattr->data_float3();
+			offset = attr_half2_offset;
+			element = ATTR_ELEMENT_CORNER_HALF2;
+
+			assert(attr_half2.size() >= offset + size);
+			for(size_t k = 0; k < size; k++) {
+				attr_half2[offset+k] = (uint)(ushort)float_to_half(data[k].x) |
+				                       ((uint)(ushort)float_to_half(data[k].y) << 16);
+			}
+			attr_half2_offset += size;
+		}
 		else if(mattr->type == TypeDesc::TypeFloat) {
 			float *data = mattr->data_float();
 			offset = attr_float_offset;
@@ -1490,7 +1534,10 @@ static void update_attribute_element_offset(Mesh *mesh,
 			else
 				offset -= mesh->face_offset;
 		}
-		else if(element == ATTR_ELEMENT_CORNER || element == ATTR_ELEMENT_CORNER_BYTE) {
+		else if(element == ATTR_ELEMENT_CORNER ||
+		        element == ATTR_ELEMENT_CORNER_BYTE ||
+		        element == ATTR_ELEMENT_CORNER_HALF2)
+		{
 			if(prim == ATTR_PRIM_TRIANGLE)
 				offset -= 3*mesh->tri_offset;
 			else
@@ -1536,9 +1583,11 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	/* Pre-allocate attributes to avoid arrays re-allocation which would
 	 * take 2x of overall attribute memory usage.
 	 */
+	const bool use_compact_geometry = scene->params.use_compact_geometry;
 	size_t attr_float_size = 0;
 	size_t attr_float3_size = 0;
 	size_t attr_uchar4_size = 0;
+	size_t attr_half2_size = 0;
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 		AttributeRequestSet& attributes = mesh_attributes[i];
@@ -1550,31 +1599,39 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			update_attribute_element_size(mesh,
 			                              triangle_mattr,
 			                              ATTR_PRIM_TRIANGLE,
+			                              use_compact_geometry,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_half2_size);
 			update_attribute_element_size(mesh,
 			                              curve_mattr,
 			                              ATTR_PRIM_CURVE,
+			                              use_compact_geometry,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_half2_size);
 			update_attribute_element_size(mesh,
 			                              subd_mattr,
 			                              ATTR_PRIM_SUBD,
+			                              use_compact_geometry,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_half2_size);
 		}
 	}
 
 	dscene->attributes_float.alloc(attr_float_size);
 	dscene->attributes_float3.alloc(attr_float3_size);
 	dscene->attributes_uchar4.alloc(attr_uchar4_size);
+	dscene->attributes_half2.alloc(attr_half2_size);
 
 	size_t attr_float_offset = 0;
 	size_t attr_float3_offset = 0;
 	size_t attr_uchar4_offset = 0;
+	size_t attr_half2_offset = 0;
 
 	/* Fill in attributes. */
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
@@ -1592,8 +1649,10 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_float, attr_float_offset,
 			                                dscene->attributes_float3, attr_float3_offset,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                dscene->attributes_half2, attr_half2_offset,
 			                                triangle_mattr,
 			                                ATTR_PRIM_TRIANGLE,
+			                                use_compact_geometry,
 			                                req.triangle_type,
 			                                req.triangle_desc);
 
@@ -1601,8 +1660,10 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_float, attr_float_offset,
 			                                dscene->attributes_float3, attr_float3_offset,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                dscene->attributes_half2, attr_half2_offset,
 			                                curve_mattr,
 			                                ATTR_PRIM_CURVE,
+			                                use_compact_geometry,
 			                                req.curve_type,
 			                                req.curve_desc);
 
@@ -1610,8 +1671,10 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_float, attr_float_offset,
 			                                dscene->attributes_float3, attr_float3_offset,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                dscene->attributes_half2, attr_half2_offset,
 			                                subd_mattr,
 			                                ATTR_PRIM_SUBD,
+			                                use_compact_geometry,
 			                                req.subd_type,
 			                                req.subd_desc);
 
@@ -1639,6 +1702,9 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	if(dscene->attributes_uchar4.size()) {
 		dscene->attributes_uchar4.copy_to_device();
 	}
+	if(dscene->attributes_half2.size()) {
+		dscene->attributes_half2.copy_to_device();
+	}
 
 	if(progress.get_cancel()) return;
 
@@ -1747,13 +1813,23 @@ void MeshManager::device_update_mesh(Device *,
 		}
 	}
 
+	dscene->data.bvh.use_compact_geometry = scene->params.use_compact_geometry;
+
 	/* Fill in all the arrays. */
 	if(tri_size != 0) {
 		/* normals */
 		progress.set_status("Updating Mesh", "Computing normals");
 
+		const bool use_compact_geometry = scene->params.use_compact_geometry;
 		uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-		float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
+		float4 *vnormal = NULL;
+		uint *vnormal_packed = NULL;
+		if(use_compact_geometry) {
+			vnormal_packed = dscene->tri_vnormal_packed.alloc(vert_size);
+		}
+		else {
+			vnormal = dscene->tri_vnormal.alloc(vert_size);
+		}
 		uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
 		uint *tri_patch = dscene->tri_patch.alloc(tri_size);
 		float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
@@ -1761,7 +1837,8 @@ void MeshManager::device_update_mesh(Device *,
 		foreach(Mesh *mesh, scene->meshes) {
 			mesh->pack_shaders(scene,
 			                   &tri_shader[mesh->tri_offset]);
-			mesh->pack_normals(&vnormal[mesh->vert_offset]);
+			mesh->pack_normals((vnormal)? &vnormal[mesh->vert_offset]: NULL,
+			                   (vnormal_packed)? &vnormal_packed[mesh->vert_offset]: NULL);
 			mesh->pack_verts(tri_prim_index,
 			                 &tri_vindex[mesh->tri_offset],
 			                 &tri_patch[mesh->tri_offset],
@@ -1775,7 +1852,12 @@ void MeshManager::device_update_mesh(Device *,
 		progress.set_status("Updating Mesh", "Copying Mesh to device");
 
 		dscene->tri_shader.copy_to_device();
-		dscene->tri_vnormal.copy_to_device();
+		if(use_compact_geometry) {
+			dscene->tri_vnormal_packed.copy_to_device();
+		}
+		else {
+			dscene->tri_vnormal.copy_to_device();
+		}
 		dscene->tri_vindex.copy_to_device();
 		dscene->tri_patch.copy_to_device();
 		dscene->tri_patch_uv.copy_to_device();
@@ -1842,6 +1924,7 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
 	bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
 	                              scene->params.use_bvh_unaligned_nodes;
+	bparams.use_quantized_nodes = scene->params.use_bvh_quantized_nodes;
 	bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
 	bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
 	bparams.bvh_type = scene->params.bvh_type;
@@ -1860,7 +1943,9 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 #endif
 
 	BVH *bvh = BVH::create(bparams, scene->objects);
+	const double bvh_start_time = time_dt();
 	bvh->build(progress, &device->stats);
+	bvh_build_time += time_dt() - bvh_start_time;
 
 	if(progress.get_cancel()) {
 #ifdef WITH_EMBREE
@@ -1923,6 +2008,8 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	dscene->data.bvh.root = pack.root_index;
 	dscene->data.bvh.bvh_layout = bparams.bvh_layout;
 	dscene->data.bvh.use_bvh_steps = (scene->params.num_bvh_time_steps != 0);
+	dscene->data.bvh.use_quantized_nodes = bparams.use_quantized_nodes &&
+	                                       bparams.bvh_layout == BVH_LAYOUT_BVH4;
 
 
 #ifdef WITH_EMBREE
@@ -2097,6 +2184,12 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 				total_tess_needed++;
 			}
 
+			/* Free split cache once subdivision is turned off. */
+			if(mesh->subdivision_type == Mesh::SUBDIVISION_NONE && mesh->subd_split_cache) {
+				delete mesh->subd_split_cache;
+				mesh->subd_split_cache = NULL;
+			}
+
 			/* Test if we need displacement. */
 			if(mesh->has_true_displacement()) {
 				true_displacement_used = true;
@@ -2185,6 +2278,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 		if(progress.get_cancel()) return;
 	}
 
+	const double bvh_start_time = time_dt();
 	TaskPool pool;
 
 	size_t i = 0;
@@ -2208,6 +2302,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	pool.wait_work(&summary);
 	VLOG(2) << "Objects BVH build pool statistics:\n"
 	        << summary.full_report();
+	bvh_build_time = time_dt() - bvh_start_time;
 
 	foreach(Shader *shader, scene->shaders) {
 		shader->need_update_mesh = false;
@@ -2257,6 +2352,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	dscene->prim_time.free();
 	dscene->tri_shader.free();
 	dscene->tri_vnormal.free();
+	dscene->tri_vnormal_packed.free();
 	dscene->tri_vindex.free();
 	dscene->tri_patch.free();
 	dscene->tri_patch_uv.free();
@@ -2267,6 +2363,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	dscene->attributes_float.free();
 	dscene->attributes_float3.free();
 	dscene->attributes_uchar4.free();
+	dscene->attributes_half2.free();
 
 #ifdef WITH_OSL
 	OSLGlobals *og = (OSLGlobals*)device->osl_memory();
@@ -2294,6 +2391,8 @@ void MeshManager::collect_statistics(const Scene *scene, RenderStats *stats)
 		        NamedSizeEntry(string(mesh->name.c_str()),
 		                       mesh->get_total_size_in_bytes()));
 	}
+	stats->mesh.bvh_build_time = bvh_build_time;
+	stats->mesh.sync_time = sync_time;
 }
 
 bool Mesh::need_attribute(Scene *scene, AttributeStandard std)
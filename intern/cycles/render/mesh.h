@@ -45,6 +45,7 @@ class SceneParams;
 class AttributeRequest;
 struct SubdParams;
 class DiagSplit;
+class SubdSplitCache;
 struct PackedPatchTable;
 
 /* Mesh */
@@ -220,6 +221,8 @@ public:
 	array<SubdEdgeCrease> subd_creases;
 
 	SubdParams *subd_params;
+	/* Split results of the last tessellation, kept when the mesh is cleared. */
+	SubdSplitCache *subd_split_cache;
 
 	vector<Shader*> used_shaders;
 	AttributeSet attributes;
@@ -281,7 +284,9 @@ public:
 	void add_undisplaced();
 
 	void pack_shaders(Scene *scene, uint *shader);
-	void pack_normals(float4 *vnormal);
+	/* Either one of the arrays is filled, packed normals are octahedral
+	 * encoded for the compact geometry storage. */
+	void pack_normals(float4 *vnormal, uint *vnormal_packed);
 	void pack_verts(const vector<uint>& tri_prim_index,
 	                uint4 *tri_vindex,
 	                uint *tri_patch,
@@ -334,6 +339,13 @@ public:
 	bool need_update;
 	bool need_flags_update;
 
+	/* Time spent building BVH during the last update, in seconds. */
+	double bvh_build_time;
+
+	/* Time the host application spent synchronizing geometry into the
+	 * scene during the last update, in seconds. */
+	double sync_time;
+
 	MeshManager();
 	~MeshManager();
 
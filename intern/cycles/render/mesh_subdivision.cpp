@@ -24,6 +24,8 @@
 
 #include "util/util_foreach.h"
 #include "util/util_algorithm.h"
+#include "util/util_logging.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -339,6 +341,36 @@ struct OsdPatch : Patch {
 
 #endif
 
+/* Number of regions split and subpatches diced by a single task. */
+#define TESSELLATE_REGIONS_PER_TASK 64
+#define TESSELLATE_SUBPATCHES_PER_TASK 256
+
+static void tessellate_split_regions(DiagSplit *split,
+                                     QuadDice::SubPatch *regions,
+                                     int num_regions)
+{
+	for(int i = 0; i < num_regions; i++) {
+		split->split_quad(regions[i].patch, &regions[i]);
+	}
+}
+
+static void tessellate_dice_subpatches(const QuadDice *shared_dice,
+                                       QuadDice::SubPatch *subpatches,
+                                       QuadDice::EdgeFactors *edgefactors,
+                                       const int *vert_offsets,
+                                       const int *tri_offsets,
+                                       int num_subpatches)
+{
+	/* Own copy of the dicer, pointing at the same mesh arrays. */
+	QuadDice dice = *shared_dice;
+
+	for(int i = 0; i < num_subpatches; i++) {
+		dice.vert_offset = vert_offsets[i];
+		dice.tri_offset = tri_offsets[i];
+		dice.dice(subpatches[i], edgefactors[i]);
+	}
+}
+
 void Mesh::tessellate(DiagSplit *split)
 {
 #ifdef WITH_OPENSUBDIV
@@ -369,30 +401,50 @@ void Mesh::tessellate(DiagSplit *split)
 	Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
 	float3* vN = attr_vN->data_float3();
 
+	/* Create all patches up front, so they can be split and diced in parallel.
+	 * Patch index is the ptex face, which is unique for every patch. */
+	int num_patches = 0;
+	for(int f = 0; f < num_faces; f++) {
+		num_patches += subd_faces[f].num_ptex_faces();
+	}
+
+	vector<LinearQuadPatch> linear_patches;
+#ifdef WITH_OPENSUBDIV
+	vector<OsdPatch> osd_patches;
+#endif
+	vector<Patch*> patches(num_patches, NULL);
+	vector<QuadDice::SubPatch> regions;
+
+#ifdef WITH_OPENSUBDIV
+	if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
+		osd_patches.reserve(num_patches);
+	}
+	else
+#endif
+	{
+		linear_patches.reserve(num_patches);
+	}
+
 	for(int f = 0; f < num_faces; f++) {
 		SubdFace& face = subd_faces[f];
 
 		if(face.is_quad()) {
 			/* quad */
-			QuadDice::SubPatch subpatch;
+			Patch *patch;
 
-			LinearQuadPatch quad_patch;
 #ifdef WITH_OPENSUBDIV
-			OsdPatch osd_patch(&osd_data);
-
 			if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
-				osd_patch.patch_index = face.ptex_offset;
-
-				subpatch.patch = &osd_patch;
+				osd_patches.push_back(OsdPatch(&osd_data));
+				patch = &osd_patches.back();
 			}
 			else
 #endif
 			{
+				linear_patches.push_back(LinearQuadPatch());
+				LinearQuadPatch& quad_patch = linear_patches.back();
 				float3 *hull = quad_patch.hull;
 				float3 *normals = quad_patch.normals;
 
-				quad_patch.patch_index = face.ptex_offset;
-
 				for(int i = 0; i < 4; i++) {
 					hull[i] = verts[subd_face_corners[face.start_corner+i]];
 				}
@@ -412,72 +464,74 @@ void Mesh::tessellate(DiagSplit *split)
 				swap(hull[2], hull[3]);
 				swap(normals[2], normals[3]);
 
-				subpatch.patch = &quad_patch;
+				patch = &quad_patch;
 			}
 
-			subpatch.patch->shader = face.shader;
+			patch->patch_index = face.ptex_offset;
+			patch->shader = face.shader;
+			patches[patch->patch_index] = patch;
 
 			/* Quad faces need to be split at least once to line up with split ngons, we do this
 			 * here in this manner because if we do it later edge factors may end up slightly off.
 			 */
+			QuadDice::SubPatch subpatch;
+			subpatch.patch = patch;
+
 			subpatch.P00 = make_float2(0.0f, 0.0f);
 			subpatch.P10 = make_float2(0.5f, 0.0f);
 			subpatch.P01 = make_float2(0.0f, 0.5f);
 			subpatch.P11 = make_float2(0.5f, 0.5f);
-			split->split_quad(subpatch.patch, &subpatch);
+			regions.push_back(subpatch);
 
 			subpatch.P00 = make_float2(0.5f, 0.0f);
 			subpatch.P10 = make_float2(1.0f, 0.0f);
 			subpatch.P01 = make_float2(0.5f, 0.5f);
 			subpatch.P11 = make_float2(1.0f, 0.5f);
-			split->split_quad(subpatch.patch, &subpatch);
+			regions.push_back(subpatch);
 
 			subpatch.P00 = make_float2(0.0f, 0.5f);
 			subpatch.P10 = make_float2(0.5f, 0.5f);
 			subpatch.P01 = make_float2(0.0f, 1.0f);
 			subpatch.P11 = make_float2(0.5f, 1.0f);
-			split->split_quad(subpatch.patch, &subpatch);
+			regions.push_back(subpatch);
 
 			subpatch.P00 = make_float2(0.5f, 0.5f);
 			subpatch.P10 = make_float2(1.0f, 0.5f);
 			subpatch.P01 = make_float2(0.5f, 1.0f);
 			subpatch.P11 = make_float2(1.0f, 1.0f);
-			split->split_quad(subpatch.patch, &subpatch);
+			regions.push_back(subpatch);
 		}
 		else {
 			/* ngon */
-#ifdef WITH_OPENSUBDIV
-			if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
-				OsdPatch patch(&osd_data);
-
-				patch.shader = face.shader;
-
-				for(int corner = 0; corner < face.num_corners; corner++) {
-					patch.patch_index = face.ptex_offset + corner;
+			float3 center_vert = make_float3(0.0f, 0.0f, 0.0f);
+			float3 center_normal = make_float3(0.0f, 0.0f, 0.0f);
 
-					split->split_quad(&patch);
-				}
-			}
-			else
+#ifdef WITH_OPENSUBDIV
+			if(subdivision_type != SUBDIVISION_CATMULL_CLARK)
 #endif
 			{
-				float3 center_vert = make_float3(0.0f, 0.0f, 0.0f);
-				float3 center_normal = make_float3(0.0f, 0.0f, 0.0f);
-
 				float inv_num_corners = 1.0f/float(face.num_corners);
 				for(int corner = 0; corner < face.num_corners; corner++) {
 					center_vert += verts[subd_face_corners[face.start_corner + corner]] * inv_num_corners;
 					center_normal += vN[subd_face_corners[face.start_corner + corner]] * inv_num_corners;
 				}
+			}
 
-				for(int corner = 0; corner < face.num_corners; corner++) {
-					LinearQuadPatch patch;
-					float3 *hull = patch.hull;
-					float3 *normals = patch.normals;
-
-					patch.patch_index = face.ptex_offset + corner;
+			for(int corner = 0; corner < face.num_corners; corner++) {
+				Patch *patch;
 
-					patch.shader = face.shader;
+#ifdef WITH_OPENSUBDIV
+				if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
+					osd_patches.push_back(OsdPatch(&osd_data));
+					patch = &osd_patches.back();
+				}
+				else
+#endif
+				{
+					linear_patches.push_back(LinearQuadPatch());
+					LinearQuadPatch& quad_patch = linear_patches.back();
+					float3 *hull = quad_patch.hull;
+					float3 *normals = quad_patch.normals;
 
 					hull[0] = verts[subd_face_corners[face.start_corner + mod(corner + 0, face.num_corners)]];
 					hull[1] = verts[subd_face_corners[face.start_corner + mod(corner + 1, face.num_corners)]];
@@ -503,12 +557,123 @@ void Mesh::tessellate(DiagSplit *split)
 						}
 					}
 
-					split->split_quad(&patch);
+					patch = &quad_patch;
 				}
+
+				patch->patch_index = face.ptex_offset + corner;
+				patch->shader = face.shader;
+				patches[patch->patch_index] = patch;
+
+				QuadDice::SubPatch subpatch;
+				subpatch.patch = patch;
+				subpatch.P00 = make_float2(0.0f, 0.0f);
+				subpatch.P10 = make_float2(1.0f, 0.0f);
+				subpatch.P01 = make_float2(0.0f, 1.0f);
+				subpatch.P11 = make_float2(1.0f, 1.0f);
+				regions.push_back(subpatch);
 			}
 		}
 	}
 
+	/* Split patches, or reuse split results from the previous tessellation
+	 * when nothing they depend on changed much. */
+	SubdSplitCache cache_key;
+	cache_key.key_from_mesh(this);
+
+	vector<QuadDice::SubPatch>& subpatches = split->subpatches_quad;
+	vector<QuadDice::EdgeFactors>& edgefactors = split->edgefactors_quad;
+
+	if(subd_split_cache && subd_split_cache->matches(cache_key)) {
+		VLOG(2) << "Reusing split patches of mesh " << name << ".";
+
+		subpatches = subd_split_cache->subpatches;
+		edgefactors = subd_split_cache->edgefactors;
+		for(size_t i = 0; i < subpatches.size(); i++) {
+			subpatches[i].patch = patches[subd_split_cache->subpatch_patch_index[i]];
+		}
+	}
+	else {
+		int num_tasks = divide_up(regions.size(), TESSELLATE_REGIONS_PER_TASK);
+		vector<DiagSplit> task_splits(num_tasks, DiagSplit(split->params));
+
+		TaskPool pool;
+		for(int i = 0; i < num_tasks; i++) {
+			int start = i * TESSELLATE_REGIONS_PER_TASK;
+			int end = min(start + TESSELLATE_REGIONS_PER_TASK, (int)regions.size());
+			pool.push(function_bind(&tessellate_split_regions,
+			                        &task_splits[i],
+			                        &regions[start],
+			                        end - start));
+		}
+		pool.wait_work();
+
+		/* Gather in order, so vertex order doesn't depend on threading. */
+		subpatches.clear();
+		edgefactors.clear();
+		for(int i = 0; i < num_tasks; i++) {
+			subpatches.insert(subpatches.end(),
+			                  task_splits[i].subpatches_quad.begin(),
+			                  task_splits[i].subpatches_quad.end());
+			edgefactors.insert(edgefactors.end(),
+			                   task_splits[i].edgefactors_quad.begin(),
+			                   task_splits[i].edgefactors_quad.end());
+		}
+
+		if(!subd_split_cache) {
+			subd_split_cache = new SubdSplitCache();
+		}
+		*subd_split_cache = cache_key;
+		subd_split_cache->subpatches = subpatches;
+		subd_split_cache->edgefactors = edgefactors;
+		subd_split_cache->subpatch_patch_index.resize(subpatches.size());
+		for(size_t i = 0; i < subpatches.size(); i++) {
+			subd_split_cache->subpatch_patch_index[i] = subpatches[i].patch->patch_index;
+		}
+	}
+
+	/* Allocate verts and triangles of all subpatches at once, then dice in
+	 * parallel with every subpatch writing to its own range. */
+	vector<int> subpatch_vert_offset(subpatches.size());
+	vector<int> subpatch_tri_offset(subpatches.size());
+	int num_dice_verts = 0;
+	int num_dice_triangles = 0;
+
+	for(size_t i = 0; i < subpatches.size(); i++) {
+		int num_sub_verts, num_sub_triangles;
+		QuadDice::count(edgefactors[i], &num_sub_verts, &num_sub_triangles);
+
+		subpatch_vert_offset[i] = num_dice_verts;
+		subpatch_tri_offset[i] = num_dice_triangles;
+		num_dice_verts += num_sub_verts;
+		num_dice_triangles += num_sub_triangles;
+	}
+
+	QuadDice dice(split->params);
+	dice.reserve(num_dice_verts, num_dice_triangles);
+
+	for(size_t i = 0; i < subpatches.size(); i++) {
+		subpatch_vert_offset[i] += dice.vert_offset;
+		subpatch_tri_offset[i] += dice.tri_offset;
+	}
+
+	{
+		TaskPool pool;
+		for(int start = 0; start < (int)subpatches.size(); start += TESSELLATE_SUBPATCHES_PER_TASK) {
+			int end = min(start + TESSELLATE_SUBPATCHES_PER_TASK, (int)subpatches.size());
+			pool.push(function_bind(&tessellate_dice_subpatches,
+			                        &dice,
+			                        &subpatches[start],
+			                        &edgefactors[start],
+			                        &subpatch_vert_offset[start],
+			                        &subpatch_tri_offset[start],
+			                        end - start));
+		}
+		pool.wait_work();
+	}
+
+	subpatches.clear();
+	edgefactors.clear();
+
 	/* interpolate center points for attributes */
 	foreach(Attribute& attr, subd_attributes.attributes) {
 #ifdef WITH_OPENSUBDIV
@@ -16,6 +16,7 @@
 
 #include "render/mesh.h"
 #include "render/attribute.h"
+#include "render/image.h"
 #include "render/scene.h"
 
 #include "util/util_foreach.h"
@@ -355,6 +356,7 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 /* ************************************************************************** */
 
 struct VoxelAttributeGrid {
+	const device_memory *memory;
 	float *data;
 	int channels;
 };
@@ -392,6 +394,7 @@ void MeshManager::create_volume_mesh(Scene *scene,
 		}
 
 		VoxelAttributeGrid voxel_grid;
+		voxel_grid.memory = image_memory;
 		voxel_grid.data = static_cast<float*>(image_memory->host_pointer);
 		voxel_grid.channels = image_memory->data_elements;
 		voxel_grids.push_back(voxel_grid);
@@ -452,11 +455,11 @@ void MeshManager::create_volume_mesh(Scene *scene,
 	for(int z = 0; z < resolution.z; ++z) {
 		for(int y = 0; y < resolution.y; ++y) {
 			for(int x = 0; x < resolution.x; ++x) {
-				size_t voxel_index = compute_voxel_index(resolution, x, y, z);
-
 				for(size_t i = 0; i < voxel_grids.size(); ++i) {
 					const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
 					const int channels = voxel_grid.channels;
+					/* Grids may be stored in sparse tiles, each with its own layout. */
+					const size_t voxel_index = ImageManager::voxel_index(voxel_grid.memory, x, y, z);
 
 					for(int c = 0; c < channels; c++) {
 						if(voxel_grid.data[voxel_index * channels + c] >= isovalue) {
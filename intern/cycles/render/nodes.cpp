@@ -146,6 +146,11 @@ bool TextureMapping::skip()
 	return true;
 }
 
+bool TextureMapping::is_transform_only()
+{
+	return !skip() && !use_minmax && type != NORMAL;
+}
+
 void TextureMapping::compile(SVMCompiler& compiler, int offset_in, int offset_out)
 {
 	compiler.add_node(NODE_MAPPING, offset_in, offset_out);
@@ -238,6 +243,8 @@ NODE_DEFINE(ImageTextureNode)
 	SOCKET_FLOAT(projection_blend, "Projection Blend", 0.0f);
 
 	SOCKET_IN_POINT(vector, "Vector", make_float3(0.0f, 0.0f, 0.0f), SocketType::LINK_TEXTURE_UV);
+	SOCKET_IN_POINT(vector_dx, "VectorDX", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
+	SOCKET_IN_POINT(vector_dy, "VectorDY", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
 
 	SOCKET_OUT_COLOR(color, "Color");
 	SOCKET_OUT_FLOAT(alpha, "Alpha");
@@ -315,9 +322,30 @@ void ImageTextureNode::compile(SVMCompiler& compiler)
 
 	if(slot != -1) {
 		int srgb = (is_linear || color_space != NODE_COLOR_SPACE_COLOR)? 0: 1;
-		int vector_offset = tex_mapping.compile_begin(compiler, vector_in);
+		/* Image node applies plain transforms itself, without a separate
+		 * mapping node. */
+		bool fuse_mapping = (projection != NODE_IMAGE_PROJ_BOX) && tex_mapping.is_transform_only();
+		int vector_offset = (fuse_mapping)? compiler.stack_assign(vector_in):
+		                                    tex_mapping.compile_begin(compiler, vector_in);
 
 		if(projection != NODE_IMAGE_PROJ_BOX) {
+			/* Coordinates at positions offset by the ray differentials, only
+			 * linked when images are read through the texture cache. */
+			ShaderInput *vector_dx_in = input("VectorDX");
+			ShaderInput *vector_dy_in = input("VectorDY");
+			int vector_dx_offset = SVM_STACK_INVALID;
+			int vector_dy_offset = SVM_STACK_INVALID;
+			if(vector_dx_in->link && vector_dy_in->link) {
+				if(fuse_mapping) {
+					vector_dx_offset = compiler.stack_assign(vector_dx_in);
+					vector_dy_offset = compiler.stack_assign(vector_dy_in);
+				}
+				else {
+					vector_dx_offset = tex_mapping.compile_begin(compiler, vector_dx_in);
+					vector_dy_offset = tex_mapping.compile_begin(compiler, vector_dy_in);
+				}
+			}
+
 			compiler.add_node(NODE_TEX_IMAGE,
 				slot,
 				compiler.encode_uchar4(
@@ -326,6 +354,18 @@ void ImageTextureNode::compile(SVMCompiler& compiler)
 					compiler.stack_assign_if_linked(alpha_out),
 					srgb),
 				projection);
+			compiler.add_node(vector_dx_offset, vector_dy_offset, fuse_mapping, 0);
+
+			if(fuse_mapping) {
+				Transform tfm = tex_mapping.compute_transform();
+				compiler.add_node(tfm.x);
+				compiler.add_node(tfm.y);
+				compiler.add_node(tfm.z);
+			}
+			else if(vector_dx_offset != SVM_STACK_INVALID) {
+				tex_mapping.compile_end(compiler, vector_dx_in, vector_dx_offset);
+				tex_mapping.compile_end(compiler, vector_dy_in, vector_dy_offset);
+			}
 		}
 		else {
 			compiler.add_node(NODE_TEX_IMAGE_BOX,
@@ -338,7 +378,9 @@ void ImageTextureNode::compile(SVMCompiler& compiler)
 				__float_as_int(projection_blend));
 		}
 
-		tex_mapping.compile_end(compiler, vector_in, vector_offset);
+		if(!fuse_mapping) {
+			tex_mapping.compile_end(compiler, vector_in, vector_offset);
+		}
 	}
 	else {
 		/* image not found */
@@ -5269,13 +5311,29 @@ void MathNode::compile(SVMCompiler& compiler)
 	ShaderInput *value2_in = input("Value2");
 	ShaderOutput *value_out = output("Value");
 
-	compiler.add_node(NODE_MATH, type, compiler.stack_assign(value1_in), compiler.stack_assign(value2_in));
-	compiler.add_node(NODE_MATH, compiler.stack_assign(value_out));
+	/* Chain onto the math node computing the linked input when the other
+	 * input is constant, e.g. (x * a) + b runs as a single node. */
+	int clamp_flag = (use_clamp)? NODE_MATH_CHAIN_CLAMP: 0;
 
-	if(use_clamp) {
-		compiler.add_node(NODE_MATH, NODE_MATH_CLAMP, compiler.stack_assign(value_out));
-		compiler.add_node(NODE_MATH, compiler.stack_assign(value_out));
+	if(!value2_in->link &&
+	   compiler.math_chain_append(value1_in, type, clamp_flag, value2, value_out))
+	{
+		return;
+	}
+	if(!value1_in->link &&
+	   compiler.math_chain_append(value2_in, type, clamp_flag | NODE_MATH_CHAIN_SWAP, value1, value_out))
+	{
+		return;
 	}
+
+	/* Operation, clamp and all stack offsets fit in a single node. */
+	compiler.add_node(NODE_MATH,
+	                  compiler.encode_uchar4(type,
+	                                         compiler.stack_assign(value1_in),
+	                                         compiler.stack_assign(value2_in),
+	                                         compiler.stack_assign(value_out)),
+	                  use_clamp);
+	compiler.math_chain_begin(value_out);
 }
 
 void MathNode::compile(OSLCompiler& compiler)
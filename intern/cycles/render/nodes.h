@@ -37,6 +37,8 @@ public:
 	TextureMapping();
 	Transform compute_transform();
 	bool skip();
+	/* Mapping only transforms the vector, which nodes can apply themselves. */
+	bool is_transform_only();
 	void compile(SVMCompiler& compiler, int offset_in, int offset_out);
 	int compile(SVMCompiler& compiler, ShaderInput *vector_in);
 	void compile(OSLCompiler &compiler);
@@ -99,6 +101,7 @@ public:
 	float projection_blend;
 	bool animated;
 	float3 vector;
+	float3 vector_dx, vector_dy;
 
 	virtual bool equals(const ShaderNode& other)
 	{
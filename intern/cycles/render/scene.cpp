@@ -53,6 +53,7 @@ DeviceScene::DeviceScene(Device *device)
   prim_time(device, "__prim_time", MEM_TEXTURE),
   tri_shader(device, "__tri_shader", MEM_TEXTURE),
   tri_vnormal(device, "__tri_vnormal", MEM_TEXTURE),
+  tri_vnormal_packed(device, "__tri_vnormal_packed", MEM_TEXTURE),
   tri_vindex(device, "__tri_vindex", MEM_TEXTURE),
   tri_patch(device, "__tri_patch", MEM_TEXTURE),
   tri_patch_uv(device, "__tri_patch_uv", MEM_TEXTURE),
@@ -68,15 +69,21 @@ DeviceScene::DeviceScene(Device *device)
   attributes_float(device, "__attributes_float", MEM_TEXTURE),
   attributes_float3(device, "__attributes_float3", MEM_TEXTURE),
   attributes_uchar4(device, "__attributes_uchar4", MEM_TEXTURE),
+  attributes_half2(device, "__attributes_half2", MEM_TEXTURE),
   light_distribution(device, "__light_distribution", MEM_TEXTURE),
   lights(device, "__lights", MEM_TEXTURE),
   light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_TEXTURE),
   light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_TEXTURE),
+  light_tree_nodes(device, "__light_tree_nodes", MEM_TEXTURE),
+  light_tree_emitters(device, "__light_tree_emitters", MEM_TEXTURE),
+  light_tree_emitter_map(device, "__light_tree_emitter_map", MEM_TEXTURE),
   particles(device, "__particles", MEM_TEXTURE),
   svm_nodes(device, "__svm_nodes", MEM_TEXTURE),
   shaders(device, "__shaders", MEM_TEXTURE),
   lookup_table(device, "__lookup_table", MEM_TEXTURE),
   sobol_directions(device, "__sobol_directions", MEM_TEXTURE),
+  pmj_samples(device, "__pmj_samples", MEM_TEXTURE),
+  blue_noise(device, "__blue_noise", MEM_TEXTURE),
   ies_lights(device, "__ies", MEM_TEXTURE)
 {
 	memset((void*)&data, 0, sizeof(data));
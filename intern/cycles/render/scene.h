@@ -77,6 +77,7 @@ public:
 	/* mesh */
 	device_vector<uint> tri_shader;
 	device_vector<float4> tri_vnormal;
+	device_vector<uint> tri_vnormal_packed;
 	device_vector<uint4> tri_vindex;
 	device_vector<uint> tri_patch;
 	device_vector<float2> tri_patch_uv;
@@ -100,12 +101,16 @@ public:
 	device_vector<float> attributes_float;
 	device_vector<float4> attributes_float3;
 	device_vector<uchar4> attributes_uchar4;
+	device_vector<uint> attributes_half2;
 
 	/* lights */
 	device_vector<KernelLightDistribution> light_distribution;
 	device_vector<KernelLight> lights;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
+	device_vector<KernelLightTreeNode> light_tree_nodes;
+	device_vector<KernelLightTreeEmitter> light_tree_emitters;
+	device_vector<int> light_tree_emitter_map;
 
 	/* particles */
 	device_vector<KernelParticle> particles;
@@ -119,6 +124,8 @@ public:
 
 	/* integrator */
 	device_vector<uint> sobol_directions;
+	device_vector<float> pmj_samples;
+	device_vector<float> blue_noise;
 
 	/* ies lights */
 	device_vector<float> ies_lights;
@@ -165,9 +172,17 @@ public:
 	BVHType bvh_type;
 	bool use_bvh_spatial_split;
 	bool use_bvh_unaligned_nodes;
+	bool use_bvh_quantized_nodes;
 	int num_bvh_time_steps;
 	bool persistent_data;
 	int texture_limit;
+	/* Size of the texture cache in megabytes. When non-zero, image files are
+	 * read on demand instead of being loaded before rendering. Only supported
+	 * on the CPU. */
+	int texture_cache_size;
+	/* Store vertex normals and texture coordinates with reduced precision,
+	 * to fit larger meshes into memory. */
+	bool use_compact_geometry;
 
 	SceneParams()
 	{
@@ -176,9 +191,12 @@ public:
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_spatial_split = false;
 		use_bvh_unaligned_nodes = true;
+		use_bvh_quantized_nodes = false;
 		num_bvh_time_steps = 0;
 		persistent_data = false;
 		texture_limit = 0;
+		texture_cache_size = 0;
+		use_compact_geometry = false;
 	}
 
 	bool modified(const SceneParams& params)
@@ -187,9 +205,12 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes
+		&& use_bvh_quantized_nodes == params.use_bvh_quantized_nodes
 		&& num_bvh_time_steps == params.num_bvh_time_steps
 		&& persistent_data == params.persistent_data
-		&& texture_limit == params.texture_limit); }
+		&& texture_limit == params.texture_limit
+		&& texture_cache_size == params.texture_cache_size
+		&& use_compact_geometry == params.use_compact_geometry); }
 };
 
 /* Scene */
@@ -54,6 +54,12 @@ Session::Session(const SessionParams& params_)
 
 	TaskScheduler::init(params.threads);
 
+	/* Split tiles at the end of final renders, so no thread idles while the
+	 * last tiles are rendered. */
+	if(params.background && !params.progressive_refine && params.device.type == DEVICE_CPU) {
+		tile_manager.split_num_workers = TaskScheduler::num_threads();
+	}
+
 	device = Device::create(params.device, stats, profiler, params.background);
 
 	if(params.background && !params.write_render_cb) {
@@ -70,6 +76,8 @@ Session::Session(const SessionParams& params_)
 
 	reset_time = 0.0;
 	last_update_time = 0.0;
+	tiles_start_time = 0.0;
+	tiles_end_time = 0.0;
 
 	delayed_reset.do_reset = false;
 	delayed_reset.samples = 0;
@@ -381,6 +389,12 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	rtile.tile_index = tile->index;
 	rtile.task = (tile->state == Tile::DENOISE)? RenderTile::DENOISE: RenderTile::PATH_TRACE;
 
+	const double time = time_dt();
+	if(tiles_start_time == 0.0) {
+		tiles_start_time = time;
+	}
+	thread_tile_time[std::this_thread::get_id()].start_time = time;
+
 	tile_lock.unlock();
 
 	/* in case of a permanent buffer, return it, otherwise we will allocate
@@ -445,6 +459,10 @@ void Session::release_tile(RenderTile& rtile)
 
 	progress.add_finished_tile(rtile.task == RenderTile::DENOISE);
 
+	ThreadTileTime& tile_time = thread_tile_time[std::this_thread::get_id()];
+	tiles_end_time = time_dt();
+	tile_time.busy_time += tiles_end_time - tile_time.start_time;
+
 	bool delete_tile;
 
 	if(tile_manager.finish_tile(rtile.tile_index, delete_tile)) {
@@ -784,6 +802,13 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 	tile_manager.reset(buffer_params, samples);
 	progress.reset_sample();
 
+	{
+		thread_scoped_lock tile_lock(tile_mutex);
+		thread_tile_time.clear();
+		tiles_start_time = 0.0;
+		tiles_end_time = 0.0;
+	}
+
 	bool show_progress = params.background || tile_manager.get_num_effective_samples() != INT_MAX;
 	progress.set_total_pixel_samples(show_progress? tile_manager.state.total_pixel_samples : 0);
 
@@ -1078,6 +1103,18 @@ void Session::device_free()
 void Session::collect_statistics(RenderStats *render_stats)
 {
 	scene->collect_statistics(render_stats);
+
+	{
+		thread_scoped_lock tile_lock(tile_mutex);
+		TileStats& tile_stats = render_stats->tiles;
+		tile_stats.wall_time = tiles_end_time - tiles_start_time;
+		tile_stats.num_split_tiles = tile_manager.state.num_split_tiles;
+		tile_stats.thread_busy_time.clear();
+		map<std::thread::id, ThreadTileTime>::iterator it;
+		for(it = thread_tile_time.begin(); it != thread_tile_time.end(); it++) {
+			tile_stats.thread_busy_time.push_back(it->second.busy_time);
+		}
+	}
 	if(params.use_profiling && (params.device.type == DEVICE_CPU)) {
 		render_stats->collect_profiling(scene, profiler);
 	}
@@ -23,6 +23,7 @@
 #include "render/stats.h"
 #include "render/tile.h"
 
+#include "util/util_map.h"
 #include "util/util_progress.h"
 #include "util/util_stats.h"
 #include "util/util_thread.h"
@@ -232,6 +233,17 @@ protected:
 
 	double reset_time;
 
+	/* Time spent on tiles by every thread rendering them, for statistics.
+	 * Protected by tile_mutex. */
+	struct ThreadTileTime {
+		ThreadTileTime() : start_time(0.0), busy_time(0.0) {}
+		double start_time;
+		double busy_time;
+	};
+	map<std::thread::id, ThreadTileTime> thread_tile_time;
+	double tiles_start_time;
+	double tiles_end_time;
+
 	/* progressive refine */
 	double last_update_time;
 	bool update_progressive_refine(bool cancel);
@@ -197,7 +197,10 @@ string NamedSampleCountStats::full_report(int indent_level)
 
 /* Mesh statistics. */
 
-MeshStats::MeshStats() {
+MeshStats::MeshStats()
+: bvh_build_time(0.0),
+  sync_time(0.0)
+{
 }
 
 string MeshStats::full_report(int indent_level)
@@ -205,19 +208,65 @@ string MeshStats::full_report(int indent_level)
 	const string indent(indent_level * kIndentNumSpaces, ' ');
 	string result = "";
 	result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+	result += indent + string_printf("BVH build time: %.2fs\n", bvh_build_time);
+	result += indent + string_printf("Sync time: %.2fs\n", sync_time);
 	return result;
 }
 
 /* Image statistics. */
 
-ImageStats::ImageStats() {
+ImageStats::ImageStats()
+: load_time(0.0),
+  use_texture_cache(false),
+  texture_cache_memory(0),
+  texture_cache_bytes_read(0)
+{
 }
 
 string ImageStats::full_report(int indent_level)
 {
 	const string indent(indent_level * kIndentNumSpaces, ' ');
+	const string sub_indent((indent_level + 1) * kIndentNumSpaces, ' ');
 	string result = "";
 	result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+	result += indent + string_printf("Load time: %.2fs\n", load_time);
+	if(use_texture_cache) {
+		result += indent + "Texture cache:\n";
+		result += sub_indent + "Memory: " +
+		          string_human_readable_size(texture_cache_memory) + "\n";
+		result += sub_indent + "Read from files: " +
+		          string_human_readable_size(texture_cache_bytes_read) + "\n";
+	}
+	return result;
+}
+
+/* Tile statistics. */
+
+TileStats::TileStats()
+: wall_time(0.0),
+  num_split_tiles(0)
+{
+}
+
+string TileStats::full_report(int indent_level)
+{
+	const string indent(indent_level * kIndentNumSpaces, ' ');
+	const string sub_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+	string result = "";
+	result += indent + string_printf("Wall time: %.2fs\n", wall_time);
+	result += indent + string_printf("Split tiles: %d\n", num_split_tiles);
+	if(thread_busy_time.size()) {
+		double total_busy_time = 0.0;
+		result += indent + "Thread utilization:\n";
+		for(size_t i = 0; i < thread_busy_time.size(); i++) {
+			const double utilization = (wall_time > 0.0)? thread_busy_time[i] / wall_time: 0.0;
+			result += sub_indent + string_printf("Thread %d: %.1f%%\n", (int)i, utilization * 100.0);
+			total_busy_time += thread_busy_time[i];
+		}
+		const double utilization = (wall_time > 0.0)?
+		        total_busy_time / (wall_time * thread_busy_time.size()): 0.0;
+		result += sub_indent + string_printf("Average: %.1f%%\n", utilization * 100.0);
+	}
 	return result;
 }
 
@@ -297,6 +346,7 @@ string RenderStats::full_report()
 	string result = "";
 	result += "Mesh statistics:\n" + mesh.full_report(1);
 	result += "Image statistics:\n" + image.full_report(1);
+	result += "Tile statistics:\n" + tiles.full_report(1);
 	if(has_profiling) {
 		result += "Kernel statistics:\n" + kernel.full_report(1);
 		result += "Shader statistics:\n" + shaders.full_report(1);
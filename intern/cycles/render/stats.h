@@ -122,6 +122,12 @@ public:
 	 * memory like BVH.
 	 */
 	NamedSizeStats geometry;
+
+	/* Time spent building BVH of meshes and of the scene, in seconds. */
+	double bvh_build_time;
+
+	/* Time spent synchronizing geometry from the host application, in seconds. */
+	double sync_time;
 };
 
 /* Statistics about images held in memory. */
@@ -133,6 +139,33 @@ public:
 	string full_report(int indent_level = 0);
 
 	NamedSizeStats textures;
+
+	/* Time spent loading images before rendering could start, in seconds. */
+	double load_time;
+
+	/* Memory used by the texture cache and amount of data read from image
+	 * files through it, when images are read on demand. */
+	bool use_texture_cache;
+	size_t texture_cache_memory;
+	size_t texture_cache_bytes_read;
+};
+
+/* Statistics about rendering of tiles. */
+class TileStats {
+public:
+	TileStats();
+
+	/* Generate full human-readable report. */
+	string full_report(int indent_level = 0);
+
+	/* Time from acquiring the first tile to releasing the last one, in seconds. */
+	double wall_time;
+
+	/* Number of tiles added by splitting tiles at the end of the frame. */
+	int num_split_tiles;
+
+	/* Time every thread spent rendering tiles, in seconds. */
+	vector<double> thread_busy_time;
 };
 
 /* Render process statistics. */
@@ -150,6 +183,7 @@ public:
 
 	MeshStats mesh;
 	ImageStats image;
+	TileStats tiles;
 	NamedNestedSampleStats kernel;
 	NamedSampleCountStats shaders;
 	NamedSampleCountStats objects;
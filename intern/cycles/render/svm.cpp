@@ -168,6 +168,8 @@ SVMCompiler::SVMCompiler(ShaderManager *shader_manager_,
 	background = false;
 	mix_weight_offset = SVM_STACK_INVALID;
 	compile_failed = false;
+	math_chain_head = -1;
+	math_chain_output = NULL;
 }
 
 int SVMCompiler::stack_size(SocketType::Type type)
@@ -366,6 +368,40 @@ uint SVMCompiler::encode_uchar4(uint x, uint y, uint z, uint w)
 	return (x) | (y << 8) | (z << 16) | (w << 24);
 }
 
+void SVMCompiler::math_chain_begin(ShaderOutput *output)
+{
+	math_chain_head = current_svm_nodes.size() - 1;
+	math_chain_output = output;
+}
+
+bool SVMCompiler::math_chain_append(ShaderInput *input,
+                                    int type,
+                                    int flags,
+                                    float value,
+                                    ShaderOutput *output)
+{
+	/* Only extend the math node that was emitted last, so nothing else can
+	 * have reused the stack slots it reads from or the one we write to, and
+	 * only when this input is the single user of its result. */
+	if(math_chain_output == NULL ||
+	   input->link != math_chain_output ||
+	   math_chain_output->links.size() != 1)
+	{
+		return false;
+	}
+
+	int num_chained = current_svm_nodes[math_chain_head].w;
+	if(math_chain_head + num_chained + 1 != (int)current_svm_nodes.size()) {
+		return false;
+	}
+
+	add_node(type, flags, __float_as_int(value), stack_assign(output));
+	current_svm_nodes[math_chain_head].w = num_chained + 1;
+	math_chain_output = output;
+
+	return true;
+}
+
 void SVMCompiler::add_node(int a, int b, int c, int d)
 {
 	current_svm_nodes.push_back_slow(make_int4(a, b, c, d));
@@ -640,6 +676,9 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
 				/* Fill in jump instruction location to be after closure. */
 				current_svm_nodes[node_jump_skip_index].y =
 				        current_svm_nodes.size() - node_jump_skip_index - 1;
+				/* Nodes after the jump target must not be chained into the
+				 * skipped ones. */
+				math_chain_output = NULL;
 			}
 
 			/* generate instructions for input closure 2 */
@@ -658,6 +697,9 @@ void SVMCompiler::generate_multi_closure(ShaderNode *root_node,
 				/* Fill in jump instruction location to be after closure. */
 				current_svm_nodes[node_jump_skip_index].y =
 				        current_svm_nodes.size() - node_jump_skip_index - 1;
+				/* Nodes after the jump target must not be chained into the
+				 * skipped ones. */
+				math_chain_output = NULL;
 			}
 
 			/* unassign */
@@ -728,6 +770,7 @@ void SVMCompiler::compile_type(Shader *shader, ShaderGraph *graph, ShaderType ty
 	/* clear all compiler state */
 	memset((void *)&active_stack, 0, sizeof(active_stack));
 	current_svm_nodes.clear();
+	math_chain_output = NULL;
 
 	foreach(ShaderNode *node_iter, graph->nodes) {
 		foreach(ShaderInput *input, node_iter->inputs)
@@ -122,6 +122,12 @@ public:
 	uint attribute(AttributeStandard std);
 	uint attribute_standard(ustring name);
 	uint encode_uchar4(uint x, uint y = 0, uint z = 0, uint w = 0);
+	void math_chain_begin(ShaderOutput *output);
+	bool math_chain_append(ShaderInput *input,
+	                       int type,
+	                       int flags,
+	                       float value,
+	                       ShaderOutput *output);
 	uint closure_mix_weight_offset() { return mix_weight_offset; }
 
 	ShaderType output_type() { return current_type; }
@@ -218,6 +224,10 @@ protected:
 	int max_stack_use;
 	uint mix_weight_offset;
 	bool compile_failed;
+
+	/* Last emitted math node, and the output holding its result. */
+	int math_chain_head;
+	ShaderOutput *math_chain_output;
 };
 
 CCL_NAMESPACE_END
@@ -22,6 +22,11 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Tiles are not split below this size, in pixels. */
+#define TILE_SPLIT_MIN_SIZE 8
+/* Number of tiles which can be added by splitting, per worker. */
+#define TILE_SPLIT_MAX_TILES_PER_WORKER 16
+
 namespace {
 
 class TileComparator {
@@ -102,6 +107,7 @@ TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, i
 	preserve_tile_device = preserve_tile_device_;
 	background = background_;
 	schedule_denoising = false;
+	split_num_workers = 0;
 
 	range_start_sample = 0;
 	range_num_samples = -1;
@@ -149,6 +155,7 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	state.buffer = BufferParams();
 	state.sample = range_start_sample - 1;
 	state.num_tiles = 0;
+	state.num_split_tiles = 0;
 	state.num_samples = 0;
 	state.resolution_divider = get_divider(params.width, params.height, start_resolution);
 	state.render_tiles.clear();
@@ -363,6 +370,13 @@ void TileManager::set_tiles()
 	int image_h = max(1, params.height/resolution);
 
 	state.num_tiles = gen_tiles(!background);
+	state.num_split_tiles = 0;
+
+	/* Tiles are handed out by pointer, make sure splitting does not
+	 * reallocate them while other tiles are being rendered. */
+	if(split_num_workers) {
+		state.tiles.reserve(state.tiles.size() + split_num_workers*TILE_SPLIT_MAX_TILES_PER_WORKER);
+	}
 
 	state.buffer.width = image_w;
 	state.buffer.height = image_h;
@@ -476,15 +490,82 @@ bool TileManager::next_tile(Tile* &tile, int device)
 		return true;
 	}
 
-	if(state.render_tiles[logical_device].empty())
+	list<int>& tile_list = state.render_tiles[logical_device];
+	if(tile_list.empty())
 		return false;
 
-	int idx = state.render_tiles[logical_device].front();
-	state.render_tiles[logical_device].pop_front();
+	int idx = tile_list.front();
+	tile_list.pop_front();
+
+	/* Keep a tile for every worker, instead of leaving them idle while this
+	 * one is rendered. */
+	if((int)tile_list.size() + 1 < split_num_workers) {
+		split_tile(idx, tile_list);
+	}
+
 	tile = &state.tiles[idx];
 	return true;
 }
 
+bool TileManager::split_tile(int index, list<int>& tile_list)
+{
+	/* Neighbor lookup for denoising and buffers which are kept for next
+	 * samples rely on fixed tiles. */
+	if(progressive || preserve_tile_device || schedule_denoising) {
+		return false;
+	}
+
+	const Tile tile = state.tiles[index];
+	const int num_target = split_num_workers - (int)tile_list.size();
+	const int num_available = (int)(state.tiles.capacity() - state.tiles.size()) + 1;
+
+	/* Cut the longer side first, so pieces stay close to square. */
+	int num_x = 1, num_y = 1;
+	while(num_x*num_y < num_target) {
+		const bool can_split_x = tile.w/(num_x + 1) >= TILE_SPLIT_MIN_SIZE &&
+		                         (num_x + 1)*num_y <= num_available;
+		const bool can_split_y = tile.h/(num_y + 1) >= TILE_SPLIT_MIN_SIZE &&
+		                         num_x*(num_y + 1) <= num_available;
+		if(can_split_x && (tile.w/num_x >= tile.h/num_y || !can_split_y)) {
+			num_x++;
+		}
+		else if(can_split_y) {
+			num_y++;
+		}
+		else {
+			break;
+		}
+	}
+
+	if(num_x*num_y == 1) {
+		return false;
+	}
+
+	for(int j = num_y - 1; j >= 0; j--) {
+		for(int i = num_x - 1; i >= 0; i--) {
+			const int x = tile.x + (tile.w*i)/num_x;
+			const int y = tile.y + (tile.h*j)/num_y;
+			const int w = tile.x + (tile.w*(i + 1))/num_x - x;
+			const int h = tile.y + (tile.h*(j + 1))/num_y - y;
+
+			if(i == 0 && j == 0) {
+				/* Acquired tile becomes the first piece. */
+				state.tiles[index] = Tile(index, x, y, w, h, tile.device, tile.state);
+			}
+			else {
+				const int split_index = state.tiles.size();
+				state.tiles.push_back(Tile(split_index, x, y, w, h, tile.device, tile.state));
+				tile_list.push_front(split_index);
+			}
+		}
+	}
+
+	state.num_tiles += num_x*num_y - 1;
+	state.num_split_tiles += num_x*num_y - 1;
+
+	return true;
+}
+
 bool TileManager::done()
 {
 	int end_sample = (range_num_samples == -1)
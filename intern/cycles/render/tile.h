@@ -73,6 +73,8 @@ public:
 		int num_samples;
 		int resolution_divider;
 		int num_tiles;
+		/* Number of tiles which were added by splitting tiles. */
+		int num_split_tiles;
 
 		/* Total samples over all pixels: Generally num_samples*num_pixels,
 		 * but can be higher due to the initial resolution division for previews. */
@@ -114,6 +116,11 @@ public:
 
 	/* Schedule tiles for denoising after they've been rendered. */
 	bool schedule_denoising;
+
+	/* Number of threads which render tiles. Once fewer tiles than threads are
+	 * left, acquired tiles are split so threads do not idle at the end of the
+	 * frame while others finish slow tiles. Zero disables splitting. */
+	int split_num_workers;
 protected:
 
 	void set_tiles();
@@ -148,6 +155,9 @@ protected:
 	int gen_tiles(bool sliced);
 	void gen_render_tiles();
 
+	/* Split tile into smaller ones, which are put at the front of the list. */
+	bool split_tile(int index, list<int>& tile_list);
+
 	int get_neighbor_index(int index, int neighbor);
 	bool check_neighbor_state(int index, Tile::State state);
 };
@@ -56,19 +56,32 @@ struct SubdParams {
 
 };
 
-/* EdgeDice Base */
+/* EdgeDice Base
+ *
+ * Space for all verts and triangles is reserved in the mesh up front, after
+ * which every subpatch writes to its own range. Copies of the dicer which
+ * point to different ranges can dice in parallel. */
 
 class EdgeDice {
 public:
 	SubdParams params;
 	float3 *mesh_P;
 	float3 *mesh_N;
+	float2 *mesh_patch_uv;
+	int *mesh_triangles;
+	int *mesh_shader;
+	bool *mesh_smooth;
+	int *mesh_triangle_patch;
+	float3 *mesh_ptex_uv;
+	float *mesh_ptex_face_id;
 	size_t vert_offset;
 	size_t tri_offset;
 
 	explicit EdgeDice(const SubdParams& params);
 
-	void reserve(int num_verts);
+	/* Resize mesh for the given number of new verts and triangles, offsets
+	 * are set to the first new vert and triangle. */
+	void reserve(int num_verts, int num_triangles);
 
 	int add_vert(Patch *patch, float2 uv);
 	void add_triangle(Patch *patch, int v0, int v1, int v2);
@@ -109,7 +122,10 @@ public:
 
 	explicit QuadDice(const SubdParams& params);
 
-	void reserve(EdgeFactors& ef, int Mu, int Mv);
+	/* Number of verts and triangles dice() creates for given edge factors. */
+	static void count(const EdgeFactors& ef, int *num_verts, int *num_triangles);
+	static void grid_size(const EdgeFactors& ef, int *Mu, int *Mv);
+
 	float3 eval_projected(SubPatch& sub, float u, float v);
 
 	float2 map_uv(SubPatch& sub, float u, float v);
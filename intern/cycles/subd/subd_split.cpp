@@ -21,6 +21,7 @@
 #include "subd/subd_patch.h"
 #include "subd/subd_split.h"
 
+#include "util/util_boundbox.h"
 #include "util/util_math.h"
 #include "util/util_types.h"
 
@@ -35,6 +36,11 @@ DiagSplit::DiagSplit(const SubdParams& params_)
 
 void DiagSplit::dispatch(QuadDice::SubPatch& sub, QuadDice::EdgeFactors& ef)
 {
+	ef.tu0 = max(ef.tu0, 1);
+	ef.tu1 = max(ef.tu1, 1);
+	ef.tv0 = max(ef.tv0, 1);
+	ef.tv1 = max(ef.tv1, 1);
+
 	subpatches_quad.push_back(sub);
 	edgefactors_quad.push_back(ef);
 }
@@ -238,23 +244,91 @@ void DiagSplit::split_quad(Patch *patch, QuadDice::SubPatch *subpatch)
 	limit_edge_factors(sub_split, ef_split, 1 << params.max_level);
 
 	split(sub_split, ef_split);
+}
+
+/* Split Cache */
+
+SubdSplitCache::SubdSplitCache()
+: subdivision_type(0),
+  dicing_rate(0.0f),
+  max_level(0),
+  split_threshold(0),
+  test_steps(0),
+  camera(NULL),
+  camera_type(0),
+  offscreen_dicing_scale(0.0f),
+  world_size(0.0f)
+{
+}
+
+void SubdSplitCache::key_from_mesh(Mesh *mesh)
+{
+	const SubdParams& params = *mesh->subd_params;
+
+	subdivision_type = mesh->subdivision_type;
 
-	QuadDice dice(params);
+	face_num_corners.resize(mesh->subd_faces.size());
+	for(size_t i = 0; i < mesh->subd_faces.size(); i++) {
+		face_num_corners[i] = mesh->subd_faces[i].num_corners;
+	}
+	face_corners = mesh->subd_face_corners;
+
+	/* Only control verts, tessellated verts are appended after these. */
+	BoundBox bounds = BoundBox::empty;
+	world_verts.resize(mesh->verts.size() - mesh->num_subd_verts);
+	for(size_t i = 0; i < world_verts.size(); i++) {
+		world_verts[i] = transform_point(&params.objecttoworld, mesh->verts[i]);
+		bounds.grow(world_verts[i]);
+	}
+	world_size = (bounds.valid())? len(bounds.size()): 0.0f;
+
+	dicing_rate = params.dicing_rate;
+	max_level = params.max_level;
+	split_threshold = params.split_threshold;
+	test_steps = params.test_steps;
+
+	camera = params.camera;
+	if(camera) {
+		camera_type = camera->type;
+		worldtoraster = camera->worldtoraster;
+		offscreen_dicing_scale = camera->offscreen_dicing_scale;
+	}
+}
 
-	for(size_t i = 0; i < subpatches_quad.size(); i++) {
-		QuadDice::SubPatch& sub = subpatches_quad[i];
-		QuadDice::EdgeFactors& ef = edgefactors_quad[i];
+bool SubdSplitCache::matches(const SubdSplitCache& other) const
+{
+	if(subdivision_type != other.subdivision_type ||
+	   face_num_corners != other.face_num_corners ||
+	   face_corners != other.face_corners ||
+	   world_verts.size() != other.world_verts.size() ||
+	   dicing_rate != other.dicing_rate ||
+	   max_level != other.max_level ||
+	   split_threshold != other.split_threshold ||
+	   test_steps != other.test_steps ||
+	   camera != other.camera)
+	{
+		return false;
+	}
 
-		ef.tu0 = max(ef.tu0, 1);
-		ef.tu1 = max(ef.tu1, 1);
-		ef.tv0 = max(ef.tv0, 1);
-		ef.tv1 = max(ef.tv1, 1);
+	if(camera &&
+	   (camera_type != other.camera_type ||
+	    memcmp(&worldtoraster, &other.worldtoraster, sizeof(worldtoraster)) != 0 ||
+	    offscreen_dicing_scale != other.offscreen_dicing_scale))
+	{
+		return false;
+	}
 
-		dice.dice(sub, ef);
+	/* Allow surface to move a little, edge factors only change marginally
+	 * and stay consistent between neighboring patches. */
+	const float max_distance = SUBD_SPLIT_CACHE_TOLERANCE * world_size;
+	const float max_distance_sq = max_distance * max_distance;
+	for(size_t i = 0; i < world_verts.size(); i++) {
+		if(len_squared(world_verts[i] - other.world_verts[i]) > max_distance_sq) {
+			return false;
+		}
 	}
 
-	subpatches_quad.clear();
-	edgefactors_quad.clear();
+	return true;
 }
 
 CCL_NAMESPACE_END
@@ -24,16 +24,23 @@
 
 #include "subd/subd_dice.h"
 
+#include "util/util_array.h"
+#include "util/util_projection.h"
 #include "util/util_types.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
+class Camera;
 class Mesh;
 class Patch;
 
 #define DSPLIT_NON_UNIFORM -1
 
+/* Maximum distance control verts may move relative to the size of the mesh,
+ * for the split results of the previous tessellation to be used again. */
+#define SUBD_SPLIT_CACHE_TOLERANCE 0.01f
+
 class DiagSplit {
 public:
 	vector<QuadDice::SubPatch> subpatches_quad;
@@ -51,9 +58,47 @@ public:
 	void dispatch(QuadDice::SubPatch& sub, QuadDice::EdgeFactors& ef);
 	void split(QuadDice::SubPatch& sub, QuadDice::EdgeFactors& ef, int depth=0);
 
+	/* Split patch into subpatches with edge factors, which are appended to
+	 * subpatches_quad and edgefactors_quad for dicing. */
 	void split_quad(Patch *patch, QuadDice::SubPatch *subpatch=NULL);
 };
 
+/* Split Cache
+ *
+ * Subpatches and edge factors from the last tessellation of a mesh, along
+ * with everything they depend on. When a mesh is synced again with the same
+ * topology, dicing parameters and camera, and its surface moved only a
+ * little, splitting is skipped and the mesh is diced with these. */
+
+class SubdSplitCache {
+public:
+	int subdivision_type;
+	array<int> face_num_corners;
+	array<int> face_corners;
+	array<float3> world_verts;
+	float world_size;
+
+	float dicing_rate;
+	int max_level;
+	int split_threshold;
+	int test_steps;
+
+	Camera *camera;
+	int camera_type;
+	ProjectionTransform worldtoraster;
+	float offscreen_dicing_scale;
+
+	/* Patch of every subpatch is stored as its patch index. */
+	vector<QuadDice::SubPatch> subpatches;
+	vector<QuadDice::EdgeFactors> edgefactors;
+	vector<int> subpatch_patch_index;
+
+	SubdSplitCache();
+
+	void key_from_mesh(Mesh *mesh);
+	bool matches(const SubdSplitCache& other) const;
+};
+
 CCL_NAMESPACE_END
 
 #endif  /* __SUBD_SPLIT_H__ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "app/cycles_binary.h"
+
+#include "device/device.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/stats.h"
+#include "util/util_path.h"
+#include "util/util_profiling.h"
+#include "util/util_transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+class AppBinary : public testing::Test
+{
+protected:
+	Stats stats;
+	Profiler profiler;
+	DeviceInfo device_info;
+	Device *device_cpu;
+	SceneParams scene_params;
+	string filepath;
+
+	virtual void SetUp()
+	{
+		device_cpu = Device::create(device_info, stats, profiler, true);
+		/* Written to the working directory of the test. */
+		filepath = "cycles_app_binary_test.bin";
+	}
+
+	virtual void TearDown()
+	{
+		path_remove(filepath);
+		delete device_cpu;
+	}
+};
+
+/* Small scene with a quad, an instance of it and a light. */
+TEST_F(AppBinary, round_trip)
+{
+	{
+		Scene scene(scene_params, device_cpu);
+		scene.film->exposure = 2.0f;
+		scene.integrator->max_bounce = 3;
+		scene.camera->width = 64;
+		scene.camera->height = 32;
+
+		Mesh *mesh = new Mesh();
+		mesh->name = ustring("Quad");
+		mesh->used_shaders.push_back(scene.default_surface);
+		mesh->reserve_mesh(4, 2);
+		mesh->add_vertex(make_float3(0.0f, 0.0f, 0.0f));
+		mesh->add_vertex(make_float3(1.0f, 0.0f, 0.0f));
+		mesh->add_vertex(make_float3(1.0f, 1.0f, 0.0f));
+		mesh->add_vertex(make_float3(0.0f, 1.0f, 0.0f));
+		mesh->add_triangle(0, 1, 2, 0, false);
+		mesh->add_triangle(0, 2, 3, 0, true);
+		scene.meshes.push_back(mesh);
+
+		Object *object = new Object();
+		object->name = ustring("Quad");
+		object->mesh = mesh;
+		object->tfm = transform_translate(1.0f, 2.0f, 3.0f);
+		scene.objects.push_back(object);
+
+		Light *light = new Light();
+		light->co = make_float3(0.0f, 0.0f, 5.0f);
+		light->shader = scene.default_light;
+		scene.lights.push_back(light);
+
+		EXPECT_TRUE(binary_write_file(&scene, filepath.c_str()));
+	}
+
+	EXPECT_TRUE(binary_is_file(filepath.c_str()));
+
+	Scene scene(scene_params, device_cpu);
+	ASSERT_TRUE(binary_read_file(&scene, filepath.c_str()));
+
+	EXPECT_EQ(scene.film->exposure, 2.0f);
+	EXPECT_EQ(scene.integrator->max_bounce, 3);
+	EXPECT_EQ(scene.camera->width, 64);
+	EXPECT_EQ(scene.camera->height, 32);
+
+	ASSERT_EQ(scene.meshes.size(), 1);
+	const Mesh *mesh = scene.meshes[0];
+	EXPECT_EQ(mesh->name, ustring("Quad"));
+	ASSERT_EQ(mesh->used_shaders.size(), 1);
+	EXPECT_EQ(mesh->used_shaders[0], scene.default_surface);
+	ASSERT_EQ(mesh->verts.size(), 4);
+	EXPECT_EQ(mesh->verts[2].x, 1.0f);
+	EXPECT_EQ(mesh->verts[2].y, 1.0f);
+	ASSERT_EQ(mesh->triangles.size(), 6);
+	EXPECT_EQ(mesh->triangles[4], 2);
+	EXPECT_EQ(mesh->triangles[5], 3);
+	ASSERT_EQ(mesh->smooth.size(), 2);
+	EXPECT_FALSE(mesh->smooth[0]);
+	EXPECT_TRUE(mesh->smooth[1]);
+
+	ASSERT_EQ(scene.objects.size(), 1);
+	EXPECT_EQ(scene.objects[0]->mesh, mesh);
+	EXPECT_TRUE(scene.objects[0]->tfm == transform_translate(1.0f, 2.0f, 3.0f));
+
+	ASSERT_EQ(scene.lights.size(), 1);
+	EXPECT_EQ(scene.lights[0]->co.z, 5.0f);
+	EXPECT_EQ(scene.lights[0]->shader, scene.default_light);
+}
+
+/* File cut off in the header is reported as invalid. */
+TEST_F(AppBinary, truncated_header)
+{
+	{
+		Scene scene(scene_params, device_cpu);
+		EXPECT_TRUE(binary_write_file(&scene, filepath.c_str()));
+	}
+
+	vector<uint8_t> binary;
+	ASSERT_TRUE(path_read_binary(filepath, binary));
+	binary.resize(10);
+	ASSERT_TRUE(path_write_binary(filepath, binary));
+
+	EXPECT_TRUE(binary_is_file(filepath.c_str()));
+
+	Scene scene(scene_params, device_cpu);
+	EXPECT_FALSE(binary_read_file(&scene, filepath.c_str()));
+}
+
+CCL_NAMESPACE_END
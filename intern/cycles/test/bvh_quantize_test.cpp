@@ -0,0 +1,128 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh4.h"
+
+#include "util/util_hash.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Decoding as done by the kernel, with and without fused multiply-add. */
+float dequantize(uint q, float origin, float scale, bool use_fma)
+{
+	if(use_fma) {
+		return fmaf(scale, (float)q, origin);
+	}
+	volatile float product = scale * (float)q;
+	return origin + product;
+}
+
+float random_float(uint seed, uint index)
+{
+	return (hash_int_2d(seed, index) >> 8) * (1.0f / 16777216.0f);
+}
+
+/* Quantize child range [lower, upper] of node range [node_lower, node_upper]
+ * and check decoded bounds enclose it. */
+void check_round_trip(float node_lower, float node_upper, float lower, float upper)
+{
+	float origin, scale, tolerance;
+	bvh_quantize_axis(node_lower, node_upper, &origin, &scale, &tolerance);
+
+	const uint q_lower = bvh_quantize_lower(lower, origin, scale, tolerance);
+	const uint q_upper = bvh_quantize_upper(upper, origin, scale, tolerance);
+	EXPECT_LE(q_lower, 255);
+	EXPECT_LE(q_upper, 255);
+	EXPECT_LE(q_lower, q_upper);
+
+	for(int use_fma = 0; use_fma < 2; use_fma++) {
+		EXPECT_LE(dequantize(q_lower, origin, scale, use_fma), lower)
+		        << "node [" << node_lower << ", " << node_upper << "], "
+		        << "child [" << lower << ", " << upper << "], fma " << use_fma;
+		EXPECT_GE(dequantize(q_upper, origin, scale, use_fma), upper)
+		        << "node [" << node_lower << ", " << node_upper << "], "
+		        << "child [" << lower << ", " << upper << "], fma " << use_fma;
+	}
+}
+
+}  // namespace
+
+TEST(bvh_quantize, round_trip) {
+	for(int exponent = -20; exponent <= 20; exponent++) {
+		const float magnitude = powf(10.0f, (float)exponent);
+		for(uint i = 0; i < 64; i++) {
+			/* Node ranges which are far from, near and across the origin. */
+			const float offset = magnitude * (random_float(i, 0) * 4.0f - 2.0f);
+			const float extent = magnitude * powf(2.0f, -20.0f * random_float(i, 1));
+			const float node_lower = offset;
+			const float node_upper = offset + extent;
+
+			/* Child ranges inside the node range, including its bounds. */
+			for(uint j = 0; j < 16; j++) {
+				float a = node_lower + (node_upper - node_lower) * random_float(i, 2 + 2*j);
+				float b = node_lower + (node_upper - node_lower) * random_float(i, 3 + 2*j);
+				if(j == 0) {
+					a = node_lower;
+					b = node_upper;
+				}
+				check_round_trip(node_lower, node_upper, min(a, b), max(a, b));
+			}
+		}
+	}
+}
+
+TEST(bvh_quantize, small_child_far_from_origin) {
+	/* Decoding error depends on the magnitude of the node range, not on the
+	 * magnitude of the child bounds. */
+	check_round_trip(-1000.0f, 0.001f, 0.0005f, 0.001f);
+	check_round_trip(-1000.0f, 0.001f, -1e-7f, 1e-7f);
+	check_round_trip(-0.001f, 1e6f, -0.001f, -0.0009f);
+	check_round_trip(1e6f, 1e6f + 1.0f, 1e6f + 0.5f, 1e6f + 0.5f);
+	check_round_trip(-5.0f, -5.0f, -5.0f, -5.0f);
+}
+
+TEST(bvh_quantize, grid_points) {
+	/* Child bounds at or between the decoded quantization steps of the two
+	 * rounding modes, where outward rounding of one mode is not enough for
+	 * the other one. */
+	const float node_ranges[][2] = {{-1000.0f, 0.001f},
+	                                {-0.001f, 1000.0f},
+	                                {-1e6f, 1.0f},
+	                                {123.456f, 124.0f},
+	                                {-3.0f, 7.0f}};
+	for(size_t i = 0; i < sizeof(node_ranges) / sizeof(*node_ranges); i++) {
+		const float node_lower = node_ranges[i][0];
+		const float node_upper = node_ranges[i][1];
+		float origin, scale, tolerance;
+		bvh_quantize_axis(node_lower, node_upper, &origin, &scale, &tolerance);
+		for(uint q = 0; q < 256; q++) {
+			const float a = dequantize(q, origin, scale, false);
+			const float b = dequantize(q, origin, scale, true);
+			const float values[3] = {a, b, 0.5f*a + 0.5f*b};
+			for(int j = 0; j < 3; j++) {
+				const float value = clamp(values[j], node_lower, node_upper);
+				check_round_trip(node_lower, node_upper, value, value);
+			}
+		}
+	}
+}
+
+CCL_NAMESPACE_END
@@ -20,6 +20,7 @@
 #include "render/graph.h"
 #include "render/scene.h"
 #include "render/nodes.h"
+#include "render/svm.h"
 #include "util/util_array.h"
 #include "util/util_logging.h"
 #include "util/util_string.h"
@@ -154,6 +155,13 @@ protected:
 	map<string, ShaderNode *> node_map_;
 };
 
+/* Shader manager which reports OSL as the shading system, for tests of graph
+ * simplifications which depend on it. */
+class OSLShaderManagerMock : public SVMShaderManager {
+public:
+	bool use_osl() { return true; }
+};
+
 }  // namespace
 
 class RenderGraph : public testing::Test
@@ -189,6 +197,12 @@ protected:
 		delete scene;
 		delete device_cpu;
 	}
+
+	void use_osl()
+	{
+		delete scene->shader_manager;
+		scene->shader_manager = new OSLShaderManagerMock();
+	}
 };
 
 #define EXPECT_ANY_MESSAGE(log) \
@@ -1581,4 +1595,110 @@ TEST_F(RenderGraph, constant_fold_convert_color_float_color)
 	graph.finalize(scene);
 }
 
+/*
+ * Tests:
+ *  - merging of mapping node with min/max clamping into image texture for SVM.
+ */
+TEST_F(RenderGraph, merge_texture_mapping_minmax)
+{
+	EXPECT_ANY_MESSAGE(log);
+	CORRECT_INFO_MESSAGE(log, "Merged 1 mapping nodes into image textures.");
+
+	TextureMapping tex_mapping;
+	tex_mapping.translation = make_float3(0.5f, 0.0f, 0.0f);
+	tex_mapping.use_minmax = true;
+
+	builder
+		.add_attribute("Attribute")
+		.add_node(ShaderNodeBuilder<MappingNode>("Mapping")
+		          .set(&MappingNode::tex_mapping, tex_mapping))
+		.add_node(ShaderNodeBuilder<ImageTextureNode>("Image"))
+		.add_connection("Attribute::Vector", "Mapping::Vector")
+		.add_connection("Mapping::Vector", "Image::Vector")
+		.output_color("Image::Color");
+
+	graph.finalize(scene);
+
+	ImageTextureNode *image_node = (ImageTextureNode*)builder.find_node("Image");
+	EXPECT_EQ(image_node->input("Vector")->link->parent, builder.find_node("Attribute"));
+	EXPECT_TRUE(image_node->tex_mapping.use_minmax);
+}
+
+/*
+ * Tests:
+ *  - merging of transform only mapping node into image texture for OSL.
+ */
+TEST_F(RenderGraph, merge_texture_mapping_transform_osl)
+{
+	EXPECT_ANY_MESSAGE(log);
+	CORRECT_INFO_MESSAGE(log, "Merged 1 mapping nodes into image textures.");
+
+	use_osl();
+
+	TextureMapping tex_mapping;
+	tex_mapping.translation = make_float3(0.5f, 0.0f, 0.0f);
+
+	builder
+		.add_attribute("Attribute")
+		.add_node(ShaderNodeBuilder<MappingNode>("Mapping")
+		          .set(&MappingNode::tex_mapping, tex_mapping))
+		.add_node(ShaderNodeBuilder<ImageTextureNode>("Image"))
+		.add_connection("Attribute::Vector", "Mapping::Vector")
+		.add_connection("Mapping::Vector", "Image::Vector")
+		.output_color("Image::Color");
+
+	graph.finalize(scene);
+
+	ImageTextureNode *image_node = (ImageTextureNode*)builder.find_node("Image");
+	EXPECT_EQ(image_node->input("Vector")->link->parent, builder.find_node("Attribute"));
+	EXPECT_EQ(image_node->tex_mapping.translation, tex_mapping.translation);
+}
+
+/*
+ * Tests:
+ *  - NOT merging of mapping node with min/max clamping or normal mapping into
+ *    image texture for OSL, which only applies the mapping transform.
+ */
+TEST_F(RenderGraph, merge_texture_mapping_minmax_normal_osl)
+{
+	EXPECT_ANY_MESSAGE(log);
+	INVALID_INFO_MESSAGE(log, "Merged");
+
+	use_osl();
+
+	TextureMapping minmax_mapping;
+	minmax_mapping.translation = make_float3(0.5f, 0.0f, 0.0f);
+	minmax_mapping.use_minmax = true;
+
+	TextureMapping normal_mapping;
+	normal_mapping.rotation = make_float3(0.5f, 0.0f, 0.0f);
+	normal_mapping.type = TextureMapping::NORMAL;
+
+	builder
+		.add_attribute("Attribute")
+		.add_node(ShaderNodeBuilder<MappingNode>("MappingMinMax")
+		          .set(&MappingNode::tex_mapping, minmax_mapping))
+		.add_node(ShaderNodeBuilder<MappingNode>("MappingNormal")
+		          .set(&MappingNode::tex_mapping, normal_mapping))
+		.add_node(ShaderNodeBuilder<ImageTextureNode>("Image1"))
+		.add_node(ShaderNodeBuilder<ImageTextureNode>("Image2"))
+		.add_node(ShaderNodeBuilder<MixNode>("Mix")
+		          .set(&MixNode::type, NODE_MIX_BLEND)
+		          .set("Fac", 0.5f))
+		.add_connection("Attribute::Vector", "MappingMinMax::Vector")
+		.add_connection("Attribute::Vector", "MappingNormal::Vector")
+		.add_connection("MappingMinMax::Vector", "Image1::Vector")
+		.add_connection("MappingNormal::Vector", "Image2::Vector")
+		.add_connection("Image1::Color", "Mix::Color1")
+		.add_connection("Image2::Color", "Mix::Color2")
+		.output_color("Mix::Color");
+
+	graph.finalize(scene);
+
+	EXPECT_EQ(builder.find_node("Image1")->input("Vector")->link->parent,
+	          builder.find_node("MappingMinMax"));
+	EXPECT_EQ(builder.find_node("Image2")->input("Vector")->link->parent,
+	          builder.find_node("MappingNormal"));
+}
+
 CCL_NAMESPACE_END
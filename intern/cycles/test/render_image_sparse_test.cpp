@@ -0,0 +1,113 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+#include "render/image.h"
+#include "render/stats.h"
+#include "util/util_boundbox.h"
+#include "util/util_profiling.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Resolution which is not a multiple of the tile size, so the volume has
+ * partially filled tiles. */
+const int width = 37, height = 20, depth = 29;
+
+/* Mostly empty volume with a box and a single voxel in it. */
+void fill_volume(device_vector<float>& volume)
+{
+	float *data = volume.alloc(width, height, depth);
+	for(int z = 0; z < depth; z++) {
+		for(int y = 0; y < height; y++) {
+			for(int x = 0; x < width; x++) {
+				const bool in_box = (x >= 3 && x < 11) && (y >= 9 && y < 19) && (z >= 5 && z < 7);
+				data[x + (y + z*height)*width] = in_box ? 0.5f : 0.0f;
+			}
+		}
+	}
+	data[36 + (0 + 28*height)*width] = 1.0f;
+}
+
+/* Bounds of voxels at or above the isovalue, as found by the volume mesh. */
+BoundBox occupied_bounds(const device_vector<float>& volume, float isovalue)
+{
+	const float *data = (const float*)volume.host_pointer;
+	BoundBox bounds = BoundBox::empty;
+	for(int z = 0; z < depth; z++) {
+		for(int y = 0; y < height; y++) {
+			for(int x = 0; x < width; x++) {
+				if(data[ImageManager::voxel_index(&volume, x, y, z)] >= isovalue) {
+					bounds.grow(make_float3(x, y, z));
+				}
+			}
+		}
+	}
+	return bounds;
+}
+
+void expect_bounds_eq(const BoundBox& a, const BoundBox& b)
+{
+	EXPECT_EQ(a.min.x, b.min.x);
+	EXPECT_EQ(a.min.y, b.min.y);
+	EXPECT_EQ(a.min.z, b.min.z);
+	EXPECT_EQ(a.max.x, b.max.x);
+	EXPECT_EQ(a.max.y, b.max.y);
+	EXPECT_EQ(a.max.z, b.max.z);
+}
+
+}  // namespace
+
+TEST(render_image_sparse, occupied_bounds) {
+	DeviceInfo device_info;
+	Stats stats;
+	Profiler profiler;
+	Device *device = Device::create(device_info, stats, profiler, true);
+	ImageManager image_manager(device->info);
+
+	{
+		device_vector<float> dense(device, "dense", MEM_TEXTURE);
+		device_vector<float> sparse(device, "sparse", MEM_TEXTURE);
+		fill_volume(dense);
+		fill_volume(sparse);
+
+		image_manager.sparse_tiles_from_dense(sparse);
+		EXPECT_FALSE(dense.sparse_tiles);
+		EXPECT_TRUE(sparse.sparse_tiles);
+		EXPECT_LT(sparse.size(), dense.size());
+		EXPECT_EQ(sparse.data_width, (size_t)width);
+		EXPECT_EQ(sparse.data_height, (size_t)height);
+		EXPECT_EQ(sparse.data_depth, (size_t)depth);
+
+		/* Box and single voxel. */
+		const BoundBox dense_bounds = occupied_bounds(dense, 0.1f);
+		expect_bounds_eq(dense_bounds, BoundBox(make_float3(3.0f, 0.0f, 5.0f),
+		                                        make_float3(36.0f, 18.0f, 28.0f)));
+		expect_bounds_eq(occupied_bounds(sparse, 0.1f), dense_bounds);
+
+		/* Single voxel only. */
+		expect_bounds_eq(occupied_bounds(sparse, 0.75f), occupied_bounds(dense, 0.75f));
+		expect_bounds_eq(occupied_bounds(sparse, 0.75f),
+		                 BoundBox(make_float3(36.0f, 0.0f, 28.0f)));
+	}
+
+	delete device;
+}
+
+CCL_NAMESPACE_END
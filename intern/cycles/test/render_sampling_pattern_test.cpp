@@ -0,0 +1,249 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/jitter.h"
+#include "render/sobol.h"
+
+#include "util/util_hash.h"
+#include "util/util_math.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const int num_samples = 64*64;
+const int mask_size = 64;
+
+float fract(float x)
+{
+	return x - floorf(x);
+}
+
+/* Sobol dimensions 0 and 1 with the samples skipped by the kernel. */
+float2 sobol_sample(const vector<uint>& directions, int index)
+{
+	float r[2];
+	for(int dimension = 0; dimension < 2; dimension++) {
+		uint result = 0;
+		uint i = index + 64;
+		for(uint j = 0; i; i >>= 1, j++) {
+			if(i & 1) {
+				result ^= directions[SOBOL_BITS*dimension + j];
+			}
+		}
+		r[dimension] = (float)result * (1.0f/(float)0xFFFFFFFF);
+	}
+	return make_float2(r[0], r[1]);
+}
+
+/* Test integrands over the unit square, with known integrals. */
+
+float integrand_disk(float x, float y)
+{
+	return (x*x + y*y < 2.0f/M_PI_F)? 1.0f: 0.0f;
+}
+
+float integrand_triangle(float x, float y)
+{
+	return (x + y < 1.1f)? 1.0f: 0.0f;
+}
+
+float integrand_gaussian(float x, float y)
+{
+	return expf(-8.0f*((x - 0.5f)*(x - 0.5f) + (y - 0.5f)*(y - 0.5f)));
+}
+
+typedef float (*Integrand)(float x, float y);
+
+struct ConvergenceResult {
+	vector<int> counts;
+	vector<double> sobol_error;
+	vector<double> pmj_error;
+
+	/* Lowest sample count at which PMJ has at most the error of Sobol with
+	 * the given number of samples, or -1 if not reached. */
+	int pmj_equal_error_count(int sobol_count) const
+	{
+		for(size_t i = 0; i < counts.size(); i++) {
+			if(counts[i] == sobol_count) {
+				for(size_t j = 0; j < counts.size(); j++) {
+					if(pmj_error[j] <= sobol_error[i]) {
+						return counts[j];
+					}
+				}
+			}
+		}
+		return -1;
+	}
+};
+
+/* RMS error of pixel estimates over a blue noise mask sized image, every
+ * pixel using its own Cranley-Patterson rotation like the kernel does. */
+ConvergenceResult convergence(Integrand integrand, double reference, int max_samples)
+{
+	vector<uint> directions(SOBOL_BITS*2);
+	sobol_generate_direction_vectors((uint(*)[SOBOL_BITS])&directions[0], 2);
+
+	vector<float2> pmj(num_samples);
+	progressive_multi_jitter_02_generate_2D(&pmj[0], num_samples, 0);
+
+	vector<float> blue_noise(mask_size*mask_size);
+	blue_noise_generate_2D(&blue_noise[0], mask_size, 0);
+
+	ConvergenceResult result;
+	for(int n = 1; n <= max_samples; n *= 2) {
+		result.counts.push_back(n);
+		if(n >= 4 && n < max_samples) {
+			result.counts.push_back(n + n/2);
+		}
+	}
+	result.sobol_error.resize(result.counts.size(), 0.0);
+	result.pmj_error.resize(result.counts.size(), 0.0);
+
+	const uint offset_x = hash_int_2d(0, 1), offset_y = hash_int_2d(1, 1);
+
+	for(int y = 0; y < mask_size; y++) {
+		for(int x = 0; x < mask_size; x++) {
+			const uint rng_hash = hash_int_2d(x, y);
+			const float sobol_shift_x = hash_int_2d(rng_hash, 0) * (1.0f/(float)0xFFFFFFFF);
+			const float sobol_shift_y = hash_int_2d(rng_hash, 1) * (1.0f/(float)0xFFFFFFFF);
+			const float pmj_shift_x = blue_noise[((y + (offset_x >> 16)) % mask_size)*mask_size + (x + offset_x) % mask_size];
+			const float pmj_shift_y = blue_noise[((y + (offset_y >> 16)) % mask_size)*mask_size + (x + offset_y) % mask_size];
+
+			double sobol_sum = 0.0, pmj_sum = 0.0;
+			size_t c = 0;
+
+			for(int n = 1; n <= max_samples; n++) {
+				const float2 s = sobol_sample(directions, n - 1);
+				sobol_sum += integrand(fract(s.x + sobol_shift_x), fract(s.y + sobol_shift_y));
+
+				const float2 p = pmj[n - 1];
+				pmj_sum += integrand(fract(p.x + pmj_shift_x), fract(p.y + pmj_shift_y));
+
+				if(n == result.counts[c]) {
+					result.sobol_error[c] += (sobol_sum/n - reference) * (sobol_sum/n - reference);
+					result.pmj_error[c] += (pmj_sum/n - reference) * (pmj_sum/n - reference);
+					c++;
+				}
+			}
+		}
+	}
+
+	for(size_t c = 0; c < result.counts.size(); c++) {
+		result.sobol_error[c] = sqrt(result.sobol_error[c] / (mask_size*mask_size));
+		result.pmj_error[c] = sqrt(result.pmj_error[c] / (mask_size*mask_size));
+	}
+
+	return result;
+}
+
+void print_convergence(const char *name, const ConvergenceResult& result)
+{
+	printf("%s\n", name);
+	printf("  %8s %12s %12s %12s\n", "samples", "sobol rmse", "pmj rmse", "pmj equal");
+	for(size_t c = 0; c < result.counts.size(); c++) {
+		printf("  %8d %12.3e %12.3e %12d\n",
+		       result.counts[c],
+		       result.sobol_error[c],
+		       result.pmj_error[c],
+		       result.pmj_equal_error_count(result.counts[c]));
+	}
+}
+
+}  // namespace
+
+TEST(render_sampling_pattern, pmj02_stratification) {
+	vector<float2> points(num_samples);
+
+	for(int seed = 0; seed < 4; seed++) {
+		progressive_multi_jitter_02_generate_2D(&points[0], num_samples, seed);
+
+		/* Every power of two prefix has exactly one point in every elementary
+		 * interval. */
+		for(int m = 0; (1 << m) <= num_samples; m++) {
+			const int n = 1 << m;
+			for(int k = 0; k <= m; k++) {
+				vector<int> count(n, 0);
+				for(int i = 0; i < n; i++) {
+					ASSERT_GE(points[i].x, 0.0f);
+					ASSERT_LT(points[i].x, 1.0f);
+					ASSERT_GE(points[i].y, 0.0f);
+					ASSERT_LT(points[i].y, 1.0f);
+					const int x = (int)(points[i].x * (1 << k));
+					const int y = (int)(points[i].y * (1 << (m - k)));
+					count[(y << k) + x]++;
+				}
+				for(int i = 0; i < n; i++) {
+					EXPECT_EQ(count[i], 1) << "seed " << seed << ", " << n << " points, shape " << k;
+				}
+			}
+		}
+	}
+}
+
+TEST(render_sampling_pattern, blue_noise_mask) {
+	vector<float> values(mask_size*mask_size);
+	blue_noise_generate_2D(&values[0], mask_size, 0);
+
+	/* Values are a permutation of uniformly spaced ranks. */
+	vector<int> count(values.size(), 0);
+	for(size_t i = 0; i < values.size(); i++) {
+		count[(int)(values[i] * values.size())]++;
+	}
+	for(size_t i = 0; i < values.size(); i++) {
+		EXPECT_EQ(count[i], 1);
+	}
+
+	/* Neighboring values differ more than for white noise, where the
+	 * expected absolute difference is 1/3. */
+	double difference = 0.0;
+	for(int y = 0; y < mask_size; y++) {
+		for(int x = 0; x < mask_size; x++) {
+			const float value = values[y*mask_size + x];
+			difference += fabsf(value - values[y*mask_size + (x + 1) % mask_size]);
+			difference += fabsf(value - values[((y + 1) % mask_size)*mask_size + x]);
+		}
+	}
+	difference /= 2*mask_size*mask_size;
+	EXPECT_GT(difference, 0.38);
+}
+
+/* Benchmark reporting the number of PMJ samples needed for the same error as
+ * Sobol, for smooth and discontinuous integrands. */
+TEST(render_sampling_pattern, convergence) {
+	const int max_samples = 1024;
+	const float gaussian_1D = sqrtf(M_PI_F/8.0f) * erff(sqrtf(2.0f));
+
+	const ConvergenceResult disk = convergence(integrand_disk, 0.5, max_samples);
+	const ConvergenceResult triangle = convergence(integrand_triangle, 1.0 - 0.9*0.9/2.0, max_samples);
+	const ConvergenceResult gaussian = convergence(integrand_gaussian,
+	                                               (double)gaussian_1D*gaussian_1D,
+	                                               max_samples);
+
+	print_convergence("disk", disk);
+	print_convergence("triangle", triangle);
+	print_convergence("gaussian", gaussian);
+
+	/* At high sample counts PMJ should be at least as good as Sobol. */
+	EXPECT_NE(disk.pmj_equal_error_count(max_samples), -1);
+	EXPECT_NE(triangle.pmj_equal_error_count(max_samples), -1);
+	EXPECT_NE(gaussian.pmj_equal_error_count(max_samples), -1);
+}
+
+CCL_NAMESPACE_END
@@ -228,6 +228,16 @@ __forceinline const avxb operator <=(const avxf& a, const avxf& b) {
 	return _mm256_cmp_ps(a.m256, b.m256, _CMP_LE_OS);
 }
 
+/* Bit mask of lanes where a <= b. AVX-512 compares straight into an opmask
+ * register, without going through a vector mask and movemask. */
+__forceinline int mask_le(const avxf& a, const avxf& b) {
+#ifdef __KERNEL_AVX512__
+	return (int)_mm256_cmp_ps_mask(a.m256, b.m256, _CMP_LE_OS);
+#else
+	return (int)movemask(a <= b);
+#endif
+}
+
 #endif
 
 #ifndef _mm256_set_m128
@@ -41,6 +41,7 @@ public:
 		void reset();
 
 		/* Flags describing which instructions sets are allowed for use. */
+		bool avx512;
 		bool avx2;
 		bool avx;
 		bool sse41;
@@ -50,6 +51,7 @@ public:
 		/* Check functions to see whether instructions up to the given one
 		 * are allowed for use.
 		 */
+		bool has_avx512() { return has_avx2() && avx512; }
 		bool has_avx2()  { return has_avx()   && avx2; }
 		bool has_avx()   { return has_sse41() && avx; }
 		bool has_sse41() { return has_sse3()  && sse41; }
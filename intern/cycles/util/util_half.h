@@ -126,18 +126,17 @@ ccl_device_inline half float_to_half(float f)
 	/* Sign bit, shifted to it's position. */
 	uint sign_bit = u & 0x80000000;
 	sign_bit >>= 16;
+	/* Non-sign bits, clamp-to-max (also for infinity and NaN). */
+	uint abs_bits = u & 0x7fffffff;
+	abs_bits = (abs_bits > 0x477fe000) ? 0x477fe000 : abs_bits;
+	/* Round to nearest even, mantissa overflow carries into the exponent. */
+	abs_bits += 0x0fff + ((abs_bits >> 13) & 1);
 	/* Exponent. */
-	uint exponent_bits = u & 0x7f800000;
-	/* Non-sign bits. */
-	uint value_bits = u & 0x7fffffff;
-	value_bits >>= 13;  /* Align mantissa on MSB. */
+	uint exponent_bits = abs_bits & 0x7f800000;
+	uint value_bits = abs_bits >> 13;  /* Align mantissa on MSB. */
 	value_bits -= 0x1c000;  /* Adjust bias. */
-	/* Flush-to-zero. */
+	/* Flush-to-zero, also takes care of denormals. */
 	value_bits = (exponent_bits < 0x38800000) ? 0 : value_bits;
-	/* Clamp-to-max. */
-	value_bits = (exponent_bits > 0x47000000) ? 0x7bff : value_bits;
-	/* Denormals-as-zero. */
-	value_bits = (exponent_bits == 0 ? 0 : value_bits);
 	/* Re-insert sign bit and return. */
 	return (value_bits | sign_bit);
 }
@@ -146,6 +145,23 @@ ccl_device_inline half float_to_half(float f)
 
 #endif
 
+/* Pair of half floats packed into an unsigned integer, x in the lower bits.
+ * Unlike half_to_float() zero is decoded exactly, which matters for data like
+ * texture coordinates. Infinity and NaN are not supported. */
+
+ccl_device_inline float half_bits_to_float(uint h)
+{
+	/* Move exponent and mantissa in place and rebias the exponent with a
+	 * multiplication, which also takes care of zero. */
+	const float f = __uint_as_float((h & 0x7fff) << 13) * __uint_as_float(0x77800000);
+	return (h & 0x8000)? -f: f;
+}
+
+ccl_device_inline float2 half2_bits_to_float2(uint h)
+{
+	return make_float2(half_bits_to_float(h & 0xffff), half_bits_to_float(h >> 16));
+}
+
 CCL_NAMESPACE_END
 
 #endif  /* __UTIL_HALF_H__ */
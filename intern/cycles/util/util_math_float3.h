@@ -417,6 +417,38 @@ ccl_device_inline float3 ensure_finite3(float3 v)
 	return v;
 }
 
+/* Octahedral encoding of unit vectors, with two 16 bit signed components
+ * packed into an unsigned integer. Precision is well below 0.01 degrees. */
+
+ccl_device_inline uint float3_to_octahedral(float3 n)
+{
+	const float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	if(l1 == 0.0f) {
+		return 0;
+	}
+	float u = n.x / l1, v = n.y / l1;
+	if(n.z < 0.0f) {
+		const float fold_u = (1.0f - fabsf(v)) * signf(u);
+		v = (1.0f - fabsf(u)) * signf(v);
+		u = fold_u;
+	}
+	const int qu = float_to_int(floorf(clamp(u, -1.0f, 1.0f)*32767.0f + 0.5f));
+	const int qv = float_to_int(floorf(clamp(v, -1.0f, 1.0f)*32767.0f + 0.5f));
+	return ((uint)qu & 0xffff) | (((uint)qv & 0xffff) << 16);
+}
+
+ccl_device_inline float3 octahedral_to_float3(uint packed)
+{
+	const float u = (float)(short)(packed & 0xffff) * (1.0f/32767.0f);
+	const float v = (float)(short)(packed >> 16) * (1.0f/32767.0f);
+	float3 n = make_float3(u, v, 1.0f - fabsf(u) - fabsf(v));
+	if(n.z < 0.0f) {
+		n.x = (1.0f - fabsf(v)) * signf(u);
+		n.y = (1.0f - fabsf(u)) * signf(v);
+	}
+	return normalize(n);
+}
+
 CCL_NAMESPACE_END
 
 #endif  /* __UTIL_MATH_FLOAT3_H__ */
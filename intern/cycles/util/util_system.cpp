@@ -188,6 +188,11 @@ struct CPUCapabilities {
 	bool fma4;
 	bool bmi1;
 	bool bmi2;
+	bool avx512f;
+	bool avx512cd;
+	bool avx512dq;
+	bool avx512bw;
+	bool avx512vl;
 };
 
 static CPUCapabilities& system_cpu_capabilities()
@@ -205,19 +210,20 @@ static CPUCapabilities& system_cpu_capabilities()
 
 		if(num >= 1) {
 			__cpuid(result, 0x00000001);
-			caps.mmx = (result[3] & ((int)1 << 23)) != 0;
-			caps.sse = (result[3] & ((int)1 << 25)) != 0;
-			caps.sse2 = (result[3] & ((int)1 << 26)) != 0;
-			caps.sse3 = (result[2] & ((int)1 <<  0)) != 0;
+			caps.mmx = (result[3] & (1u << 23)) != 0;
+			caps.sse = (result[3] & (1u << 25)) != 0;
+			caps.sse2 = (result[3] & (1u << 26)) != 0;
+			caps.sse3 = (result[2] & (1u << 0)) != 0;
 
-			caps.ssse3 = (result[2] & ((int)1 <<  9)) != 0;
-			caps.sse41 = (result[2] & ((int)1 << 19)) != 0;
-			caps.sse42 = (result[2] & ((int)1 << 20)) != 0;
+			caps.ssse3 = (result[2] & (1u << 9)) != 0;
+			caps.sse41 = (result[2] & (1u << 19)) != 0;
+			caps.sse42 = (result[2] & (1u << 20)) != 0;
 
-			caps.fma3 = (result[2] & ((int)1 << 12)) != 0;
+			caps.fma3 = (result[2] & (1u << 12)) != 0;
 			caps.avx = false;
-			bool os_uses_xsave_xrestore = (result[2] & ((int)1 << 27)) != 0;
-			bool cpu_avx_support = (result[2] & ((int)1 << 28)) != 0;
+			bool os_saves_zmm = false;
+			bool os_uses_xsave_xrestore = (result[2] & (1u << 27)) != 0;
+			bool cpu_avx_support = (result[2] & (1u << 28)) != 0;
 
 			if( os_uses_xsave_xrestore && cpu_avx_support) {
 				// Check if the OS will save the YMM registers
@@ -232,14 +238,24 @@ static CPUCapabilities& system_cpu_capabilities()
 				xcr_feature_mask = 0;
 #endif
 				caps.avx = (xcr_feature_mask & 0x6) == 0x6;
+				/* Opmask and both halves of ZMM registers are saved as well. */
+				os_saves_zmm = (xcr_feature_mask & 0xe6) == 0xe6;
 			}
 
-			caps.f16c = (result[2] & ((int)1 << 29)) != 0;
+			caps.f16c = (result[2] & (1u << 29)) != 0;
 
 			__cpuid(result, 0x00000007);
-			caps.bmi1 = (result[1] & ((int)1 << 3)) != 0;
-			caps.bmi2 = (result[1] & ((int)1 << 8)) != 0;
-			caps.avx2 = (result[1] & ((int)1 << 5)) != 0;
+			caps.bmi1 = (result[1] & (1u << 3)) != 0;
+			caps.bmi2 = (result[1] & (1u << 8)) != 0;
+			caps.avx2 = (result[1] & (1u << 5)) != 0;
+
+			if(os_saves_zmm) {
+				caps.avx512f = (result[1] & (1u << 16)) != 0;
+				caps.avx512dq = (result[1] & (1u << 17)) != 0;
+				caps.avx512cd = (result[1] & (1u << 28)) != 0;
+				caps.avx512bw = (result[1] & (1u << 30)) != 0;
+				caps.avx512vl = (result[1] & (1u << 31)) != 0;
+			}
 		}
 
 		caps_init = true;
@@ -280,6 +296,14 @@ bool system_cpu_support_avx2()
 	       caps.avx && caps.f16c && caps.avx2 && caps.fma3 && caps.bmi1 &&
 	       caps.bmi2;
 }
+
+bool system_cpu_support_avx512()
+{
+	CPUCapabilities& caps = system_cpu_capabilities();
+	return system_cpu_support_avx2() &&
+	       caps.avx512f && caps.avx512cd && caps.avx512dq && caps.avx512bw &&
+	       caps.avx512vl;
+}
 #else
 
 bool system_cpu_support_sse2()
@@ -306,6 +330,11 @@ bool system_cpu_support_avx2()
 	return false;
 }
 
+bool system_cpu_support_avx512()
+{
+	return false;
+}
+
 #endif
 
 size_t system_physical_ram()
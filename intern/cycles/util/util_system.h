@@ -55,6 +55,7 @@ bool system_cpu_support_sse3();
 bool system_cpu_support_sse41();
 bool system_cpu_support_avx();
 bool system_cpu_support_avx2();
+bool system_cpu_support_avx512();
 
 size_t system_physical_ram();
 
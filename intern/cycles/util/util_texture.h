@@ -28,6 +28,12 @@ CCL_NAMESPACE_BEGIN
 #define TEX_IMAGE_MISSING_B 1
 #define TEX_IMAGE_MISSING_A 1
 
+/* Volumes are stored in tiles of this size cubed when most of them are
+ * empty, with all empty tiles sharing the same memory. */
+#define TEX_SPARSE_TILE_SHIFT 3
+#define TEX_SPARSE_TILE_SIZE (1 << TEX_SPARSE_TILE_SHIFT)
+#define TEX_SPARSE_TILE_MASK (TEX_SPARSE_TILE_SIZE - 1)
+
 /* Texture type. */
 #define kernel_tex_type(tex) (tex & IMAGE_DATA_TYPE_MASK)
 
@@ -79,12 +85,18 @@ typedef enum ExtensionType {
 typedef struct TextureInfo {
 	/* Pointer, offset or texture depending on device. */
 	uint64_t data;
+	/* Handle of images which are read on demand through the texture cache,
+	 * zero for images loaded into memory. Only used on the CPU. */
+	uint64_t cache_handle;
 	/* Buffer number for OpenCL. */
 	uint cl_buffer;
 	/* Interpolation and extension type. */
 	uint interpolation, extension;
 	/* Dimensions. */
 	uint width, height, depth;
+	/* Voxels are stored in sparse tiles, with the offset of every tile in
+	 * front of the tiles. Only used on the CPU. */
+	uint sparse_tiles;
 } TextureInfo;
 
 CCL_NAMESPACE_END
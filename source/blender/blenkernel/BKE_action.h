@@ -94,6 +94,9 @@ void calc_action_range(const struct bAction *act, float *start, float *end, shor
 /* Does action have any motion data at all? */
 bool action_has_motion(const struct bAction *act);
 
+/* Does evaluating the action give different results on different frames? */
+bool action_depends_on_time(const struct bAction *act);
+
 /* Action Groups API ----------------- */
 
 /* Get the active action-group for an Action */
@@ -264,6 +264,9 @@ bool BKE_fcurve_is_protected(struct FCurve *fcu);
 /* The curve is an infinite cycle via Cycles modifier */
 bool BKE_fcurve_is_cyclic(struct FCurve *fcu);
 
+/* The curve evaluates to the same value on every frame. */
+bool BKE_fcurve_is_constant(const struct FCurve *fcu);
+
 /* Type of infinite cycle for a curve. */
 typedef enum eFCU_Cycle_Type {
 	FCU_CYCLE_NONE = 0,
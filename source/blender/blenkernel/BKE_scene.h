@@ -138,6 +138,9 @@ void BKE_scene_graph_update_tagged(struct Depsgraph *depsgraph,
 
 void BKE_scene_graph_update_for_newframe(struct Depsgraph *depsgraph,
                                          struct Main *bmain);
+void BKE_scene_graph_update_for_newframe_ex(struct Depsgraph *depsgraph,
+                                            struct Main *bmain,
+                                            const bool clear_recalc);
 
 void BKE_scene_view_layer_graph_evaluated_ensure(
         struct Main *bmain, struct Scene *scene, struct ViewLayer *view_layer);
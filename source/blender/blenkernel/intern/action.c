@@ -1105,6 +1105,21 @@ bool action_has_motion(const bAction *act)
 	return false;
 }
 
+/* Check whether any of the F-Curves in the action changes its value over time.
+ * Actions which do not can be evaluated once instead of on every frame change.
+ */
+bool action_depends_on_time(const bAction *act)
+{
+	if (act) {
+		for (const FCurve *fcu = act->curves.first; fcu; fcu = fcu->next) {
+			if (!BKE_fcurve_is_constant(fcu))
+				return true;
+		}
+	}
+
+	return false;
+}
+
 /* Calculate the extents of given action */
 void calc_action_range(const bAction *act, float *start, float *end, short incl_modifiers)
 {
@@ -919,6 +919,45 @@ bool BKE_fcurve_is_cyclic(FCurve *fcu)
 	return BKE_fcurve_get_cycle_type(fcu) != FCU_CYCLE_NONE;
 }
 
+/* Checks whether the F-Curve gives the same value regardless of the frame it is evaluated at.
+ * This is conservative: any modifier is considered to make the curve vary over time.
+ */
+bool BKE_fcurve_is_constant(const FCurve *fcu)
+{
+	/* muted curves are not evaluated at all */
+	if (fcu->flag & FCURVE_MUTED)
+		return true;
+	if (!BLI_listbase_is_empty(&fcu->modifiers))
+		return false;
+
+	if (fcu->bezt) {
+		/* With all keys and handles at the same height neither interpolation (including the
+		 * overshooting easing modes, which scale by the change in value) nor extrapolation
+		 * can leave that height.
+		 */
+		const float value = fcu->bezt[0].vec[1][1];
+		const BezTriple *bezt = fcu->bezt;
+		for (int a = 0; a < fcu->totvert; a++, bezt++) {
+			if ((bezt->vec[0][1] != value) ||
+			    (bezt->vec[1][1] != value) ||
+			    (bezt->vec[2][1] != value))
+			{
+				return false;
+			}
+		}
+	}
+	else if (fcu->fpt) {
+		const float value = fcu->fpt[0].vec[1];
+		const FPoint *fpt = fcu->fpt;
+		for (int a = 0; a < fcu->totvert; a++, fpt++) {
+			if (fpt->vec[1] != value)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /* Shifts 'in' by the difference in coordinates between 'to' and 'from', using 'out' as the output buffer.
  * When 'to' and 'from' are end points of the loop, this moves the 'in' point one loop cycle.
  */
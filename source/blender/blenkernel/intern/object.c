@@ -2715,10 +2715,21 @@ void BKE_scene_foreach_display_point(
 	        depsgraph, ob,
 	        DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
 	        DEG_ITER_OBJECT_FLAG_VISIBLE |
-	        DEG_ITER_OBJECT_FLAG_DUPLI)
+	        DEG_ITER_OBJECT_FLAG_DUPLI |
+	        DEG_ITER_OBJECT_FLAG_DUPLI_BATCH)
 	{
 		if ((ob->base_flag & BASE_SELECTED) != 0) {
-			BKE_object_foreach_display_point(ob, ob->obmat, func_cb, user_data);
+			/* All instances of the same object share evaluated geometry, only
+			 * their matrices differ. */
+			const DEGDupliBatch *batch = &data_.dupli_batch;
+			if (batch->num_instances != 0) {
+				for (int i = 0; i < batch->num_instances; i++) {
+					BKE_object_foreach_display_point(ob, batch->matrices[i], func_cb, user_data);
+				}
+			}
+			else {
+				BKE_object_foreach_display_point(ob, ob->obmat, func_cb, user_data);
+			}
 		}
 	}
 	DEG_OBJECT_ITER_END;
@@ -3826,53 +3837,6 @@ KDTree *BKE_object_as_kdtree(Object *ob, int *r_tot)
 	return tree;
 }
 
-bool BKE_object_modifier_use_time(Object *ob, ModifierData *md)
-{
-	if (modifier_dependsOnTime(md)) {
-		return true;
-	}
-
-	/* Check whether modifier is animated. */
-	/* TODO: this should be handled as part of build_animdata() -- Aligorith */
-	if (ob->adt) {
-		AnimData *adt = ob->adt;
-		FCurve *fcu;
-
-		char pattern[MAX_NAME + 16];
-		BLI_snprintf(pattern, sizeof(pattern), "modifiers[\"%s\"]", md->name);
-
-		/* action - check for F-Curves with paths containing 'modifiers[' */
-		if (adt->action) {
-			for (fcu = (FCurve *)adt->action->curves.first;
-			     fcu != NULL;
-			     fcu = (FCurve *)fcu->next)
-			{
-				if (fcu->rna_path && strstr(fcu->rna_path, pattern))
-					return true;
-			}
-		}
-
-		/* This here allows modifier properties to get driven and still update properly
-		 *
-		 * Workaround to get [#26764] (e.g. subsurf levels not updating when animated/driven)
-		 * working, without the updating problems ([#28525] [#28690] [#28774] [#28777]) caused
-		 * by the RNA updates cache introduced in r.38649
-		 */
-		for (fcu = (FCurve *)adt->drivers.first;
-		     fcu != NULL;
-		     fcu = (FCurve *)fcu->next)
-		{
-			if (fcu->rna_path && strstr(fcu->rna_path, pattern))
-				return true;
-		}
-
-		/* XXX: also, should check NLA strips, though for now assume that nobody uses
-		 * that and we can omit that for performance reasons... */
-	}
-
-	return false;
-}
-
 bool BKE_object_modifier_gpencil_use_time(Object *ob, GpencilModifierData *md)
 {
 	if (BKE_gpencil_modifier_dependsOnTime(md)) {
@@ -1510,6 +1510,15 @@ void BKE_scene_graph_update_tagged(Depsgraph *depsgraph,
 /* applies changes right away, does all sets too */
 void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph,
                                          Main *bmain)
+{
+	BKE_scene_graph_update_for_newframe_ex(depsgraph, bmain, true);
+}
+
+/* Keeping the recalc flags allows render engines to only update
+ * datablocks which changed since the previous frame. */
+void BKE_scene_graph_update_for_newframe_ex(Depsgraph *depsgraph,
+                                            Main *bmain,
+                                            const bool clear_recalc)
 {
 	Scene *scene = DEG_get_input_scene(depsgraph);
 	ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
@@ -1546,7 +1555,9 @@ void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph,
 	/* Inform editors about possible changes. */
 	DEG_ids_check_recalc(bmain, depsgraph, scene, view_layer, true);
 	/* clear recalc flags */
-	DEG_ids_clear_recalc(bmain, depsgraph);
+	if (clear_recalc) {
+		DEG_ids_clear_recalc(bmain, depsgraph);
+	}
 }
 
 /** Ensures given scene/view_layer pair has a valid, up-to-date depsgraph.
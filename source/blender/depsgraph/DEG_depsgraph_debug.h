@@ -52,6 +52,18 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* Time (in seconds) spent on the stages of the last relations update. */
+void DEG_stats_build_time(const struct Depsgraph *graph,
+                          double *r_nodes_time,
+                          double *r_relations_time,
+                          double *r_finalize_time);
+
+/* Number of operations which are re-evaluated on frame change, and number of
+ * operations which are skipped because they do not change over time. */
+void DEG_stats_time_dependency(const struct Depsgraph *graph,
+                               int *r_time_dependent_operations,
+                               int *r_time_invariant_operations);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
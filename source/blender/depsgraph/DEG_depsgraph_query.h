@@ -102,8 +102,33 @@ enum {
 	DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET    = (1 << 2),
 	DEG_ITER_OBJECT_FLAG_VISIBLE           = (1 << 3),
 	DEG_ITER_OBJECT_FLAG_DUPLI             = (1 << 4),
+	/* Report instances of the same object generated by one dupli parent as a
+	 * single batch, see DEGDupliBatch. Only used together with
+	 * DEG_ITER_OBJECT_FLAG_DUPLI. */
+	DEG_ITER_OBJECT_FLAG_DUPLI_BATCH       = (1 << 5),
 };
 
+/* Instances of a single object generated by the same dupli parent, stored as
+ * flat arrays which are ready to be consumed by render engines as-is.
+ *
+ * Every array has num_instances elements, and is only valid until the iterator
+ * steps to the next object. */
+typedef struct DEGDupliBatch {
+	/* Number of instances in the batch, 0 when the current object is not an
+	 * instance. */
+	int num_instances;
+	/* World space transforms of instances. */
+	float (*matrices)[4][4];
+	/* Generated and UV coordinates in the parent object space. */
+	float (*orcos)[3];
+	float (*uvs)[2];
+	/* Random identifiers used for shading. */
+	unsigned int *random_ids;
+	/* Dupli objects the instances are created from, gives access to persistent
+	 * identifiers and particle systems. */
+	struct DupliObject **dupli_objects;
+} DEGDupliBatch;
+
 typedef struct DEGObjectIterData {
 	struct Depsgraph *graph;
 	int flag;
@@ -127,6 +152,17 @@ typedef struct DEGObjectIterData {
 	 * other users of the iterator. */
 	struct Object temp_dupli_object;
 
+	/* **** Batching of dupli-list. **** */
+
+	/* All visible instances of the dupli-list, grouped by the instanced
+	 * object. */
+	DEGDupliBatch dupli_batch_storage;
+	/* Index of the first instance of the next batch in the storage. */
+	int dupli_batch_next;
+	/* Corresponds to current object: instances of temp_dupli_object, points
+	 * into the storage. */
+	DEGDupliBatch dupli_batch;
+
 	/* **** Iteration over ID nodes **** */
 	size_t id_node_index;
 	size_t num_id_nodes;
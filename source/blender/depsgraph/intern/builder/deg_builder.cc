@@ -42,6 +42,7 @@ extern "C" {
 #include "intern/node/deg_node_id.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_operation.h"
+#include "intern/node/deg_node_time.h"
 
 #include "DEG_depsgraph.h"
 
@@ -110,12 +111,100 @@ void deg_graph_build_flush_visibility(Depsgraph *graph)
 	BLI_stack_free(stack);
 }
 
+/* Gather statistics of how many operations are tagged for update on frame
+ * change, and how many are skipped because they only depend on time via
+ * time invariant relations. Mimics the update flush: operations are
+ * traversed via flushable relations, and all operations of a component
+ * are tagged once any of them is reached. */
+void deg_graph_build_time_dependency_stats(Depsgraph *graph)
+{
+	enum {
+		DEG_NODE_VISITED        = (1 << 0),
+		DEG_NODE_TIME_DEPENDENT = (1 << 1),
+		DEG_NODE_TIME_INVARIANT = (1 << 2),
+	};
+
+	graph->debug_num_time_dependent_operations = 0;
+	graph->debug_num_time_invariant_operations = 0;
+	TimeSourceNode *time_source = graph->find_time_source();
+	if (time_source == NULL) {
+		return;
+	}
+	for (OperationNode *op_node : graph->operations) {
+		op_node->custom_flags = 0;
+	}
+	BLI_Stack *stack = BLI_stack_new(sizeof(OperationNode *),
+	                                 "DEG time dependency stack");
+	/* Time dependent part of the graph goes first, so the operations which
+	 * are reachable from both kinds of relations are not counted as skipped. */
+	for (int pass = 0; pass < 2; ++pass) {
+		const bool is_time_invariant_pass = (pass == 1);
+		const int tag_flag = is_time_invariant_pass ? DEG_NODE_TIME_INVARIANT
+		                                            : DEG_NODE_TIME_DEPENDENT;
+		for (Relation *rel : time_source->outlinks) {
+			if (((rel->flag & RELATION_FLAG_TIME_INVARIANT) != 0) !=
+			    is_time_invariant_pass)
+			{
+				continue;
+			}
+			if (rel->to->type != NodeType::OPERATION) {
+				continue;
+			}
+			OperationNode *op_to = (OperationNode *)rel->to;
+			if ((op_to->custom_flags & DEG_NODE_VISITED) == 0) {
+				BLI_stack_push(stack, &op_to);
+				op_to->custom_flags |= DEG_NODE_VISITED;
+			}
+		}
+		while (!BLI_stack_is_empty(stack)) {
+			OperationNode *op_node;
+			BLI_stack_pop(stack, &op_node);
+			ComponentNode *comp_node = op_node->owner;
+			if (comp_node->type != NodeType::PARTICLE_SETTINGS &&
+			    comp_node->type != NodeType::PARTICLE_SYSTEM)
+			{
+				for (OperationNode *op : comp_node->operations) {
+					if ((op->custom_flags & (DEG_NODE_TIME_DEPENDENT |
+					                         DEG_NODE_TIME_INVARIANT)) == 0)
+					{
+						op->custom_flags |= tag_flag;
+					}
+				}
+			}
+			op_node->custom_flags |= tag_flag;
+			for (Relation *rel : op_node->outlinks) {
+				if (rel->flag & (RELATION_FLAG_NO_FLUSH |
+				                 RELATION_FLAG_FLUSH_USER_EDIT_ONLY))
+				{
+					continue;
+				}
+				OperationNode *op_to = (OperationNode *)rel->to;
+				if ((op_to->custom_flags & DEG_NODE_VISITED) == 0) {
+					BLI_stack_push(stack, &op_to);
+					op_to->custom_flags |= DEG_NODE_VISITED;
+				}
+			}
+		}
+	}
+	BLI_stack_free(stack);
+	for (OperationNode *op_node : graph->operations) {
+		if (op_node->custom_flags & DEG_NODE_TIME_DEPENDENT) {
+			++graph->debug_num_time_dependent_operations;
+		}
+		else if (op_node->custom_flags & DEG_NODE_TIME_INVARIANT) {
+			++graph->debug_num_time_invariant_operations;
+		}
+	}
+}
+
 }  // namespace
 
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
 {
 	/* Make sure dependencies of visible ID datablocks are visible. */
 	deg_graph_build_flush_visibility(graph);
+	/* Count operations which are skipped on frame change. */
+	deg_graph_build_time_dependency_stats(graph);
 	/* Re-tag IDs for update if it was tagged before the relations
 	 * update tag. */
 	for (IDNode *id_node : graph->id_nodes) {
@@ -30,6 +30,8 @@
 namespace DEG {
 
 BuilderMap::BuilderMap()
+        : known_ids(NULL),
+          isolated_id(NULL)
 {
 	set = BLI_gset_ptr_new("deg builder gset");
 }
@@ -41,7 +43,7 @@ BuilderMap::~BuilderMap()
 
 bool BuilderMap::checkIsBuilt(ID *id)
 {
-	return BLI_gset_haskey(set, id);
+	return checkIsBuiltByOthers(id) || BLI_gset_haskey(set, id);
 }
 
 void BuilderMap::tagBuild(ID *id)
@@ -51,6 +53,9 @@ void BuilderMap::tagBuild(ID *id)
 
 bool BuilderMap::checkIsBuiltAndTag(ID *id)
 {
+	if (checkIsBuiltByOthers(id)) {
+		return true;
+	}
 	void **key_p;
 	if (!BLI_gset_ensure_p_ex(set, id, &key_p)) {
 		*key_p = id;
@@ -59,4 +64,19 @@ bool BuilderMap::checkIsBuiltAndTag(ID *id)
 	return true;
 }
 
+void BuilderMap::isolate(GHash *known_ids, const ID *id)
+{
+	BLI_gset_clear(set, NULL);
+	this->known_ids = known_ids;
+	isolated_id = id;
+}
+
+bool BuilderMap::checkIsBuiltByOthers(const ID *id) const
+{
+	if (known_ids == NULL || id == isolated_id) {
+		return false;
+	}
+	return BLI_ghash_haskey(known_ids, id);
+}
+
 }  // namespace DEG
@@ -22,6 +22,7 @@
 
 #pragma once
 
+struct GHash;
 struct GSet;
 struct ID;
 
@@ -53,7 +54,21 @@ public:
 		return checkIsBuiltAndTag(&datablock->id);
 	}
 
+	/* Restrict building to a single ID: all other IDs which are keys of the
+	 * given hash are considered to be handled by someone else already.
+	 * Pass NULL hash to disable the isolation.
+	 *
+	 * NOTE: Clears the map. */
+	void isolate(GHash *known_ids, const ID *id);
+
 	GSet *set;
+
+	/* IDs which are considered built unless it is the isolated one. */
+	GHash *known_ids;
+	const ID *isolated_id;
+
+protected:
+	bool checkIsBuiltByOthers(const ID *id) const;
 };
 
 }  // namespace DEG
@@ -32,6 +32,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 
 extern "C" {
 #include "DNA_action_types.h"
@@ -94,6 +95,8 @@ extern "C" {
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 
+#include "atomic_ops.h"
+
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_pchanmap.h"
 #include "intern/debug/deg_debug.h"
@@ -206,14 +209,43 @@ static bool bone_has_segments(Object *object, const char *bone_name)
 	return pchan && pchan->bone && pchan->bone->segments > 1;
 }
 
+/* Pending relations are identified by their nodes and name, same as for the
+ * check done by Depsgraph::check_nodes_connected(). */
+static unsigned int pending_relation_hash(const void *key)
+{
+	const Relation *rel = (const Relation *)key;
+	size_t hash = BLI_ghashutil_ptrhash(rel->from);
+	hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_ptrhash(rel->to));
+	hash = BLI_ghashutil_combine_hash(hash, BLI_ghashutil_strhash_p(rel->name));
+	return (unsigned int)hash;
+}
+
+static bool pending_relation_cmp(const void *a, const void *b)
+{
+	const Relation *rel_a = (const Relation *)a;
+	const Relation *rel_b = (const Relation *)b;
+	return !(rel_a->from == rel_b->from &&
+	         rel_a->to == rel_b->to &&
+	         STREQ(rel_a->name, rel_b->name));
+}
+
 /* **** General purpose functions ****  */
 
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph)
     : bmain_(bmain),
       graph_(graph),
-      scene_(NULL)
+      scene_(NULL),
+      pending_relations_(NULL),
+      pending_relations_set_(NULL)
+{
+}
+
+DepsgraphRelationBuilder::~DepsgraphRelationBuilder()
 {
+	if (pending_relations_set_ != NULL) {
+		BLI_gset_free(pending_relations_set_, NULL);
+	}
 }
 
 TimeSourceNode *DepsgraphRelationBuilder::get_node(
@@ -287,7 +319,17 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object, uint64_t mask
 			BLI_assert(!"ID should always be valid");
 		}
 		else {
-			id_node->customdata_mask |= mask;
+			/* Relations of different IDs might be built from multiple
+			 * threads. */
+			uint64_t old_mask = id_node->customdata_mask;
+			while ((old_mask & mask) != mask) {
+				const uint64_t current_mask = atomic_cas_uint64(
+				        &id_node->customdata_mask, old_mask, old_mask | mask);
+				if (current_mask == old_mask) {
+					break;
+				}
+				old_mask = current_mask;
+			}
 		}
 	}
 }
@@ -299,7 +341,7 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
 		BLI_assert(!"ID should always be valid");
 	}
 	else {
-		id_node->eval_flags |= flag;
+		atomic_fetch_and_or_uint32(&id_node->eval_flags, flag);
 	}
 }
 
@@ -310,8 +352,7 @@ Relation *DepsgraphRelationBuilder::add_time_relation(
         int flags)
 {
 	if (timesrc && node_to) {
-		return graph_->add_new_relation(
-		        timesrc, node_to, description, flags);
+		return add_new_relation(timesrc, node_to, description, flags);
 	}
 	else {
 		DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -330,10 +371,7 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(
         int flags)
 {
 	if (node_from && node_to) {
-		return graph_->add_new_relation(node_from,
-		                                node_to,
-		                                description,
-		                                flags);
+		return add_new_relation(node_from, node_to, description, flags);
 	}
 	else {
 		DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -345,6 +383,35 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(
 	return NULL;
 }
 
+Relation *DepsgraphRelationBuilder::add_new_relation(Node *node_from,
+                                                     Node *node_to,
+                                                     const char *description,
+                                                     int flags)
+{
+	if (pending_relations_ == NULL) {
+		return graph_->add_new_relation(node_from,
+		                                node_to,
+		                                description,
+		                                flags);
+	}
+	/* Only check relations which are pending from this builder, the ones
+	 * coming from other builders are checked when linking pending relations
+	 * to the graph. */
+	if (flags & RELATION_CHECK_BEFORE_ADD) {
+		Relation key(node_from, node_to, description);
+		Relation *rel = (Relation *)BLI_gset_lookup(pending_relations_set_, &key);
+		if (rel != NULL) {
+			rel->flag |= flags;
+			return rel;
+		}
+	}
+	Relation *rel = OBJECT_GUARDED_NEW(Relation, node_from, node_to, description);
+	rel->flag |= flags;
+	pending_relations_->push_back(rel);
+	BLI_gset_add(pending_relations_set_, rel);
+	return rel;
+}
+
 void DepsgraphRelationBuilder::add_particle_collision_relations(
         const OperationKey &key,
         Object *object,
@@ -508,6 +575,71 @@ void DepsgraphRelationBuilder::build_id(ID *id)
 	}
 }
 
+void DepsgraphRelationBuilder::isolate_id(ID *id)
+{
+	built_map_.isolate(graph_->id_hash, id);
+}
+
+void DepsgraphRelationBuilder::build_id_isolated(Scene *scene, ID *id)
+{
+	scene_ = scene;
+	isolate_id(id);
+	switch (GS(id->name)) {
+		case ID_AC:
+		case ID_AR:
+		case ID_CA:
+		case ID_GR:
+		case ID_OB:
+		case ID_KE:
+		case ID_LA:
+		case ID_LP:
+		case ID_NT:
+		case ID_MA:
+		case ID_TE:
+		case ID_WO:
+		case ID_MSK:
+		case ID_MC:
+		case ID_ME:
+		case ID_CU:
+		case ID_MB:
+		case ID_LT:
+		case ID_SPK:
+		case ID_CF:
+			build_id(id);
+			break;
+		case ID_GD:
+			/* Grease pencil datablock is only reachable as an object data. */
+			build_object_data_geometry_datablock(id);
+			break;
+		case ID_PA:
+			build_particle_settings((ParticleSettings *)id);
+			break;
+		default:
+			/* Scene is handled by the view layer builder, other IDs do not
+			 * have relations on their own (images, for example). */
+			break;
+	}
+}
+
+void DepsgraphRelationBuilder::set_pending_relations(
+        Relations *pending_relations)
+{
+	pending_relations_ = pending_relations;
+	if (pending_relations_set_ == NULL) {
+		pending_relations_set_ = BLI_gset_new(pending_relation_hash,
+		                                      pending_relation_cmp,
+		                                      "deg pending relations");
+	}
+	else {
+		BLI_gset_clear(pending_relations_set_, NULL);
+	}
+	if (pending_relations != NULL) {
+		for (Relation *rel : *pending_relations) {
+			BLI_gset_add(pending_relations_set_, rel);
+		}
+	}
+}
+
 void DepsgraphRelationBuilder::build_collection(
         LayerCollection *from_layer_collection,
         Object *object,
@@ -713,8 +845,12 @@ void DepsgraphRelationBuilder::build_object_data(Object *object)
 		return;
 	}
 	ID *obdata_id = (ID *)object->data;
-	/* Object data animation. */
-	if (!built_map_.checkIsBuilt(obdata_id)) {
+	/* Object data animation. Camera and lamp builders build animation of
+	 * their data themselves, since they are also invoked from the per-ID
+	 * tasks which do not go through the object. */
+	if (!ELEM(object->type, OB_CAMERA, OB_LAMP) &&
+	    !built_map_.checkIsBuilt(obdata_id))
+	{
 		build_animdata(obdata_id);
 	}
 	/* type-specific data. */
@@ -1174,6 +1310,24 @@ void DepsgraphRelationBuilder::build_animdata(ID *id)
 	build_animdata_drivers(id);
 }
 
+void DepsgraphRelationBuilder::build_parameters(ID *id)
+{
+	/* Animated properties resolve to the parameters component of the ID, but
+	 * parameters evaluation must follow the animation even when none of the
+	 * paths resolve (for example, custom properties). */
+	if (!check_id_has_anim_component(id)) {
+		return;
+	}
+	ComponentKey animation_key(id, NodeType::ANIMATION);
+	OperationKey parameters_key(id,
+	                            NodeType::PARAMETERS,
+	                            OperationCode::PARAMETERS_EVAL);
+	add_relation(animation_key,
+	             parameters_key,
+	             "Animation -> Parameters",
+	             RELATION_CHECK_BEFORE_ADD);
+}
+
 void DepsgraphRelationBuilder::build_animdata_curves(ID *id)
 {
 	AnimData *adt = BKE_animdata_from_id(id);
@@ -1193,6 +1347,12 @@ void DepsgraphRelationBuilder::build_animdata_curves(ID *id)
 		ComponentKey action_key(&adt->action->id, NodeType::ANIMATION);
 		add_relation(action_key, adt_key, "Action -> Animation");
 	}
+	/* Strip ranges, blending and influence make NLA result depend on time
+	 * even when all actions used by the strips are constant. */
+	if (adt->nla_tracks.first != NULL) {
+		TimeSourceKey time_src_key;
+		add_relation(time_src_key, adt_key, "TimeSrc -> NLA");
+	}
 	/* Get source operations. */
 	Node *node_from = get_node(adt_key);
 	BLI_assert(node_from != NULL);
@@ -1250,9 +1410,9 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(
 			             RELATION_CHECK_BEFORE_ADD);
 			continue;
 		}
-		graph_->add_new_relation(operation_from, operation_to,
-		                         "Animation -> Prop",
-		                         RELATION_CHECK_BEFORE_ADD);
+		add_new_relation(operation_from, operation_to,
+		                 "Animation -> Prop",
+		                 RELATION_CHECK_BEFORE_ADD);
 		/* It is possible that animation is writing to a nested ID datablock,
 		 * need to make sure animation is evaluated after target ID is copied. */
 		const IDNode *id_node_from = operation_from->owner->owner;
@@ -1365,9 +1525,17 @@ void DepsgraphRelationBuilder::build_action(bAction *action)
 	if (built_map_.checkIsBuiltAndTag(action)) {
 		return;
 	}
+	/* Action where none of the F-Curves changes its value over time only
+	 * needs to be evaluated once. The relation is still added, so it's
+	 * possible to see what is animated and to know that relations are to be
+	 * updated when action stops being constant. */
+	int flags = 0;
+	if (!action_depends_on_time(action)) {
+		flags |= RELATION_FLAG_TIME_INVARIANT;
+	}
 	TimeSourceKey time_src_key;
 	ComponentKey animation_key(&action->id, NodeType::ANIMATION);
-	add_relation(time_src_key, animation_key, "TimeSrc -> Animation");
+	add_relation(time_src_key, animation_key, "TimeSrc -> Animation", flags);
 }
 
 void DepsgraphRelationBuilder::build_driver(ID *id, FCurve *fcu)
@@ -1992,7 +2160,10 @@ void DepsgraphRelationBuilder::build_object_data_geometry(Object *object)
 				ctx.node = reinterpret_cast< ::DepsNodeHandle* >(&handle);
 				mti->updateDepsgraph(md, &ctx);
 			}
-			if (BKE_object_modifier_use_time(object, md)) {
+			/* Animated and driven modifier settings are handled by relations
+			 * from animation and drivers to the geometry, which are only
+			 * flushed when the animation actually changes. */
+			if (modifier_dependsOnTime(md)) {
 				TimeSourceKey time_src_key;
 				add_relation(time_src_key, obdata_ubereval_key, "Time Source");
 			}
@@ -2238,6 +2409,8 @@ void DepsgraphRelationBuilder::build_camera(Camera *camera)
 	if (built_map_.checkIsBuiltAndTag(camera)) {
 		return;
 	}
+	build_animdata(&camera->id);
+	build_parameters(&camera->id);
 	if (camera->dof_ob != NULL) {
 		ComponentKey camera_parameters_key(&camera->id, NodeType::PARAMETERS);
 		ComponentKey dof_ob_key(&camera->dof_ob->id, NodeType::TRANSFORM);
@@ -2251,6 +2424,8 @@ void DepsgraphRelationBuilder::build_lamp(Lamp *lamp)
 	if (built_map_.checkIsBuiltAndTag(lamp)) {
 		return;
 	}
+	build_animdata(&lamp->id);
+	build_parameters(&lamp->id);
 	/* lamp's nodetree */
 	if (lamp->nodetree != NULL) {
 		build_nodetree(lamp->nodetree);
@@ -2555,7 +2730,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
 		 * copy of ID. */
 		OperationNode *op_entry = comp_node->get_entry_operation();
 		if (op_entry != NULL) {
-			Relation *rel = graph_->add_new_relation(
+			Relation *rel = add_new_relation(
 			        op_cow, op_entry, "CoW Dependency");
 			rel->flag |= rel_flag;
 		}
@@ -2566,7 +2741,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
 				continue;
 			}
 			if (op_node->inlinks.size() == 0) {
-				Relation *rel = graph_->add_new_relation(
+				Relation *rel = add_new_relation(
 				        op_cow, op_node, "CoW Dependency");
 				rel->flag |= rel_flag;
 			}
@@ -2584,7 +2759,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
 					}
 				}
 				if (!has_same_comp_dependency) {
-					Relation *rel = graph_->add_new_relation(
+					Relation *rel = add_new_relation(
 					        op_cow, op_node, "CoW Dependency");
 					rel->flag |= rel_flag;
 				}
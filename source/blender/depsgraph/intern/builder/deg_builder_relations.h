@@ -48,6 +48,7 @@ struct Collection;
 struct EffectorWeights;
 struct FCurve;
 struct GHash;
+struct GSet;
 struct ID;
 struct Key;
 struct Lamp;
@@ -172,10 +173,27 @@ struct RNAPathKey
 
 struct DepsgraphRelationBuilder
 {
+	typedef vector<Relation *> Relations;
+
 	DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph);
+	~DepsgraphRelationBuilder();
 
 	void begin_build();
 
+	/* Consider all IDs of the graph except of the given one to be handled by
+	 * other builders.
+	 *
+	 * Used by the threaded builder, see deg_builder_relations_parallel.cc. */
+	void isolate_id(ID *id);
+	/* Build relations of the given ID only. */
+	void build_id_isolated(Scene *scene, ID *id);
+
+	/* When storage is set, new relations are not linked to the nodes and are
+	 * collected into the storage instead. This allows to build relations of
+	 * different IDs from multiple threads, and link them afterwards in a
+	 * deterministic order. */
+	void set_pending_relations(Relations *pending_relations);
+
 	template <typename KeyFrom, typename KeyTo>
 	Relation *add_relation(const KeyFrom& key_from,
 	                       const KeyTo& key_to,
@@ -220,6 +238,7 @@ struct DepsgraphRelationBuilder
 	                       ListBase *constraints,
 	                       RootPChanMap *root_map);
 	void build_animdata(ID *id);
+	void build_parameters(ID *id);
 	void build_animdata_curves(ID *id);
 	void build_animdata_curves_targets(ID *id,
 	                                   ComponentKey &adt_key,
@@ -305,6 +324,10 @@ protected:
 	                                 OperationNode *node_to,
 	                                 const char *description,
 	                                 int flags = 0);
+	Relation *add_new_relation(Node *node_from,
+	                           Node *node_to,
+	                           const char *description,
+	                           int flags = 0);
 
 	template <typename KeyType>
 	DepsNodeHandle create_node_handle(const KeyType& key,
@@ -349,6 +372,11 @@ private:
 	Scene *scene_;
 
 	BuilderMap built_map_;
+
+	/* Relations which are to be linked to the graph later on. */
+	Relations *pending_relations_;
+	/* Same relations, for the duplicate check. */
+	GSet *pending_relations_set_;
 };
 
 struct DepsNodeHandle
@@ -0,0 +1,201 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2019 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file \ingroup depsgraph
+ *
+ * Threaded construction of relations.
+ *
+ * Relations of the view layer itself are built on the calling thread. After
+ * that every ID node gets its own task, which builds relations of this ID
+ * only: all other IDs are considered to be handled by their own tasks. Tasks
+ * do not modify any of the nodes, relations are collected into per-ID storage
+ * and are linked to the nodes afterwards, in the order of ID nodes. This keeps
+ * the resulting graph independent from the threads scheduling.
+ */
+
+#include "intern/builder/deg_builder_relations_parallel.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+
+extern "C" {
+#include "DNA_scene_types.h"
+
+#include "BKE_global.h"
+} /* extern "C" */
+
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/depsgraph.h"
+
+namespace DEG {
+
+namespace {
+
+typedef DepsgraphRelationBuilder::Relations Relations;
+
+/* Graphs with less IDs are built on a single thread, threading overhead is
+ * higher than the benefit for them. */
+const int MIN_THREADED_ID_NODES = 256;
+
+struct BuildRelationsData {
+	Main *bmain;
+	Depsgraph *graph;
+	Scene *scene;
+	/* Relations which are pending to be linked, indexed by ID node. */
+	vector<Relations> pending_relations;
+};
+
+struct BuildRelationsTLS {
+	DepsgraphRelationBuilder *builder;
+};
+
+DepsgraphRelationBuilder *builder_ensure(BuildRelationsData *data,
+                                         const ParallelRangeTLS *tls)
+{
+	BuildRelationsTLS *tls_data = (BuildRelationsTLS *)tls->userdata_chunk;
+	if (tls_data->builder == NULL) {
+		tls_data->builder = OBJECT_GUARDED_NEW(DepsgraphRelationBuilder,
+		                                       data->bmain,
+		                                       data->graph);
+		tls_data->builder->begin_build();
+	}
+	return tls_data->builder;
+}
+
+void build_id_relations_func(void *__restrict data_v,
+                             const int i,
+                             const ParallelRangeTLS *__restrict tls)
+{
+	BuildRelationsData *data = (BuildRelationsData *)data_v;
+	DepsgraphRelationBuilder *builder = builder_ensure(data, tls);
+	IDNode *id_node = data->graph->id_nodes[i];
+	builder->set_pending_relations(&data->pending_relations[i]);
+	builder->build_id_isolated(data->scene, id_node->id_orig);
+	builder->set_pending_relations(NULL);
+}
+
+void build_copy_on_write_relations_func(void *__restrict data_v,
+                                        const int i,
+                                        const ParallelRangeTLS *__restrict tls)
+{
+	BuildRelationsData *data = (BuildRelationsData *)data_v;
+	DepsgraphRelationBuilder *builder = builder_ensure(data, tls);
+	IDNode *id_node = data->graph->id_nodes[i];
+	builder->set_pending_relations(&data->pending_relations[i]);
+	builder->build_copy_on_write_relations(id_node);
+	builder->set_pending_relations(NULL);
+}
+
+void build_relations_finalize(void *__restrict /*data_v*/,
+                              void *__restrict tls_v)
+{
+	BuildRelationsTLS *tls_data = (BuildRelationsTLS *)tls_v;
+	if (tls_data->builder != NULL) {
+		OBJECT_GUARDED_DELETE(tls_data->builder, DepsgraphRelationBuilder);
+	}
+}
+
+void build_relations_parallel(BuildRelationsData *data,
+                              TaskParallelRangeFunc func)
+{
+	BuildRelationsTLS tls_data = {NULL};
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	/* Cost of different IDs varies a lot, from no relations at all to a
+	 * complex rig. */
+	settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+	settings.userdata_chunk = &tls_data;
+	settings.userdata_chunk_size = sizeof(tls_data);
+	settings.func_finalize = build_relations_finalize;
+	BLI_task_parallel_range(0, data->graph->id_nodes.size(),
+	                        data,
+	                        func,
+	                        &settings);
+}
+
+/* Link pending relations to the nodes, doing the check which builders were
+ * not able to do since they did not see relations of each other. */
+void link_pending_relations(BuildRelationsData *data)
+{
+	Depsgraph *graph = data->graph;
+	for (Relations& relations : data->pending_relations) {
+		for (Relation *rel : relations) {
+			if (rel->flag & RELATION_CHECK_BEFORE_ADD) {
+				Relation *existing_rel = graph->check_nodes_connected(
+				        rel->from, rel->to, rel->name);
+				if (existing_rel != NULL) {
+					existing_rel->flag |= rel->flag;
+					OBJECT_GUARDED_DELETE(rel, Relation);
+					continue;
+				}
+			}
+			rel->link();
+		}
+		relations.clear();
+	}
+}
+
+bool build_relations_use_threading(const Depsgraph *graph, const Scene *scene)
+{
+	if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
+		return false;
+	}
+	/* Builder uses scene it is currently building for some of the object
+	 * relations. Without set scenes it is the same scene for all IDs. */
+	if (scene->set != NULL) {
+		return false;
+	}
+	return graph->id_nodes.size() >= MIN_THREADED_ID_NODES;
+}
+
+}  // namespace
+
+void deg_graph_build_relations(Main *bmain,
+                               Depsgraph *graph,
+                               Scene *scene,
+                               ViewLayer *view_layer)
+{
+	DepsgraphRelationBuilder relation_builder(bmain, graph);
+	relation_builder.begin_build();
+	if (!build_relations_use_threading(graph, scene)) {
+		relation_builder.build_view_layer(scene, view_layer);
+		relation_builder.build_copy_on_write_relations();
+		return;
+	}
+	/* Relations of the view layer itself. */
+	relation_builder.isolate_id(&scene->id);
+	relation_builder.build_view_layer(scene, view_layer);
+	/* Relations of all the IDs. */
+	BuildRelationsData data;
+	data.bmain = bmain;
+	data.graph = graph;
+	data.scene = scene;
+	data.pending_relations.resize(graph->id_nodes.size());
+	build_relations_parallel(&data, build_id_relations_func);
+	link_pending_relations(&data);
+	/* Copy-on-write relations depend on the relations which are already in
+	 * the graph, so they are built once all other relations are linked. */
+	build_relations_parallel(&data, build_copy_on_write_relations_func);
+	link_pending_relations(&data);
+}
+
+}  // namespace DEG
@@ -267,7 +267,7 @@ static void deg_debug_graphviz_relation_style(const DebugContext &ctx,
 	const char *style_no_flush = "dashed";
 	const char *style_flush_user_only = "dotted";
 	const char *style = style_default;
-	if (rel->flag & RELATION_FLAG_NO_FLUSH) {
+	if (rel->flag & (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_TIME_INVARIANT)) {
 		style = style_no_flush;
 	}
 	if (rel->flag & RELATION_FLAG_FLUSH_USER_EDIT_ONLY) {
@@ -87,9 +87,15 @@ Depsgraph::Depsgraph(Scene *scene,
     ctime(BKE_scene_frame_get(scene)),
     scene_cow(NULL),
     is_active(false),
-    debug_is_evaluating(false)
+    debug_is_evaluating(false),
+    debug_build_nodes_time(0.0),
+    debug_build_relations_time(0.0),
+    debug_build_finalize_time(0.0),
+    debug_num_time_dependent_operations(0),
+    debug_num_time_invariant_operations(0)
 {
 	BLI_spin_init(&lock);
+	BLI_mutex_init(&physics_relations_lock);
 	id_hash = BLI_ghash_ptr_new("Depsgraph id hash");
 	entry_tags = BLI_gset_ptr_new("Depsgraph entry_tags");
 	debug_flags = G.debug;
@@ -105,6 +111,7 @@ Depsgraph::~Depsgraph()
 	if (time_source != NULL) {
 		OBJECT_GUARDED_DELETE(time_source, TimeSourceNode);
 	}
+	BLI_mutex_end(&physics_relations_lock);
 	BLI_spin_end(&lock);
 }
 
@@ -416,6 +423,7 @@ Relation *Depsgraph::add_new_relation(Node *from, Node *to,
 	/* Create new relation, and add it to the graph. */
 	rel = OBJECT_GUARDED_NEW(Relation, from, to, description);
 	rel->flag |= flags;
+	rel->link();
 	return rel;
 }
 
@@ -445,21 +453,6 @@ Relation::Relation(Node *from, Node *to, const char *description)
     name(description),
     flag(0)
 {
-	/* Hook it up to the nodes which use it.
-	 *
-	 * NOTE: We register relation in the nodes which this link connects to here
-	 * in constructor but we don't unregister it in the destructor.
-	 *
-	 * Reasoning:
-	 *
-	 * - Destructor is currently used on global graph destruction, so there's no
-	 *   real need in avoiding dangling pointers, all the memory is to be freed
-	 *   anyway.
-	 *
-	 * - Unregistering relation is not a cheap operation, so better to have it
-	 *   as an explicit call if we need this. */
-	from->outlinks.push_back(this);
-	to->inlinks.push_back(this);
 }
 
 Relation::~Relation()
@@ -468,6 +461,27 @@ Relation::~Relation()
 	BLI_assert(from != NULL && to != NULL);
 }
 
+/* Hook relation up to the nodes which use it.
+ *
+ * NOTE: We register relation in the nodes which this link connects to, but we
+ * don't unregister it in the destructor.
+ *
+ * Reasoning:
+ *
+ * - Destructor is currently used on global graph destruction, so there's no
+ *   real need in avoiding dangling pointers, all the memory is to be freed
+ *   anyway.
+ *
+ * - Unregistering relation is not a cheap operation, so better to have it
+ *   as an explicit call if we need this. */
+void Relation::link()
+{
+	/* Sanity check. */
+	BLI_assert(from != NULL && to != NULL);
+	from->outlinks.push_back(this);
+	to->inlinks.push_back(this);
+}
+
 void Relation::unlink()
 {
 	/* Sanity check. */
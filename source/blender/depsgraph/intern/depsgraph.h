@@ -76,6 +76,10 @@ enum RelationFlag {
 	RELATION_FLAG_GODMODE              = (1 << 4),
 	/* Relation will check existance before being added. */
 	RELATION_CHECK_BEFORE_ADD          = (1 << 5),
+	/* Relation from the time source to something what was detected to not
+	 * change over time (i.e. action where all keyframes have the same value).
+	 * Frame changes are not flushed through this relation. */
+	RELATION_FLAG_TIME_INVARIANT       = (1 << 6),
 };
 
 /* B depends on A (A -> B) */
@@ -83,6 +87,7 @@ struct Relation {
 	Relation(Node *from, Node *to, const char *description);
 	~Relation();
 
+	void link();
 	void unlink();
 
 	/* the nodes in the relationship (since this is shared between the nodes) */
@@ -232,6 +237,20 @@ struct Depsgraph {
 	/* Cached list of colliders/effectors for collections and the scene
 	 * created along with relations, for fast lookup during evaluation. */
 	GHash *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
+	/* Guards lazy creation of the cache above, relations of different IDs
+	 * might be built from multiple threads. */
+	ThreadMutex physics_relations_lock;
+
+	/* Time (in seconds) spent on the last relations update, split into the
+	 * individual stages of the build. */
+	double debug_build_nodes_time;
+	double debug_build_relations_time;
+	double debug_build_finalize_time;
+	/* Number of operations which are tagged for update on frame change, and
+	 * number of operations which are skipped on frame change because all
+	 * their time dependencies are time invariant. */
+	int debug_num_time_dependent_operations;
+	int debug_num_time_invariant_operations;
 };
 
 }  // namespace DEG
@@ -48,6 +48,7 @@ extern "C" {
 #include "builder/deg_builder_cycle.h"
 #include "builder/deg_builder_nodes.h"
 #include "builder/deg_builder_relations.h"
+#include "builder/deg_builder_relations_parallel.h"
 #include "builder/deg_builder_transitive.h"
 
 #include "intern/debug/deg_debug.h"
@@ -230,10 +231,7 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
                                       Scene *scene,
                                       ViewLayer *view_layer)
 {
-	double start_time = 0.0;
-	if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
-		start_time = PIL_check_seconds_timer();
-	}
+	const double start_time = PIL_check_seconds_timer();
 	DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
 	/* Perform sanity checks. */
 	BLI_assert(BLI_findindex(&scene->view_layers, view_layer) != -1);
@@ -246,12 +244,10 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
 	                               view_layer,
 	                               DEG::DEG_ID_LINKED_DIRECTLY);
 	node_builder.end_build();
+	const double nodes_time = PIL_check_seconds_timer();
 	/* Hook up relationships between operations - to determine evaluation
 	 * order. */
-	DEG::DepsgraphRelationBuilder relation_builder(bmain, deg_graph);
-	relation_builder.begin_build();
-	relation_builder.build_view_layer(scene, view_layer);
-	relation_builder.build_copy_on_write_relations();
+	DEG::deg_graph_build_relations(bmain, deg_graph, scene, view_layer);
 	/* Detect and solve cycles. */
 	DEG::deg_graph_detect_cycles(deg_graph);
 	/* Simplify the graph by removing redundant relations (to optimize
@@ -261,6 +257,7 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
 	if (G.debug_value == 799) {
 		DEG::deg_graph_transitive_reduction(deg_graph);
 	}
+	const double relations_time = PIL_check_seconds_timer();
 	/* Store pointers to commonly used valuated datablocks. */
 	deg_graph->scene_cow = (Scene *)deg_graph->get_cow_id(&deg_graph->scene->id);
 	/* Flush visibility layer and re-schedule nodes for update. */
@@ -275,9 +272,17 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
 	/* Relations are up to date. */
 	deg_graph->need_update = false;
 	/* Finish statistics. */
+	const double end_time = PIL_check_seconds_timer();
+	deg_graph->debug_build_nodes_time = nodes_time - start_time;
+	deg_graph->debug_build_relations_time = relations_time - nodes_time;
+	deg_graph->debug_build_finalize_time = end_time - relations_time;
 	if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
-		printf("Depsgraph built in %f seconds.\n",
-		       PIL_check_seconds_timer() - start_time);
+		printf("Depsgraph built in %f seconds "
+		       "(nodes %f, relations %f, finalize %f).\n",
+		       end_time - start_time,
+		       deg_graph->debug_build_nodes_time,
+		       deg_graph->debug_build_relations_time,
+		       deg_graph->debug_build_finalize_time);
 	}
 }
 
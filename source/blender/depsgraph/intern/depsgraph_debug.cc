@@ -243,6 +243,42 @@ void DEG_stats_simple(const Depsgraph *graph, size_t *r_outer,
 	}
 }
 
+/**
+ * Obtain timing of the last depsgraph relations update
+ * \param[out] r_nodes_time      Time spent on creating nodes of the graph
+ * \param[out] r_relations_time  Time spent on building relations between nodes
+ * \param[out] r_finalize_time   Time spent on finalizing the graph
+ */
+void DEG_stats_build_time(const Depsgraph *graph,
+                          double *r_nodes_time,
+                          double *r_relations_time,
+                          double *r_finalize_time)
+{
+	const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+	if (r_nodes_time)     *r_nodes_time     = deg_graph->debug_build_nodes_time;
+	if (r_relations_time) *r_relations_time = deg_graph->debug_build_relations_time;
+	if (r_finalize_time)  *r_finalize_time  = deg_graph->debug_build_finalize_time;
+}
+
+/**
+ * Obtain how much of the graph is evaluated on frame change
+ * \param[out] r_time_dependent_operations  Operations tagged for update on frame change
+ * \param[out] r_time_invariant_operations  Operations which only depend on time
+ *                                          via something what does not change over time
+ */
+void DEG_stats_time_dependency(const Depsgraph *graph,
+                               int *r_time_dependent_operations,
+                               int *r_time_invariant_operations)
+{
+	const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+	if (r_time_dependent_operations) {
+		*r_time_dependent_operations = deg_graph->debug_num_time_dependent_operations;
+	}
+	if (r_time_invariant_operations) {
+		*r_time_invariant_operations = deg_graph->debug_num_time_invariant_operations;
+	}
+}
+
 bool DEG_debug_is_evaluating(struct Depsgraph *depsgraph)
 {
 	DEG::Depsgraph *deg_graph =
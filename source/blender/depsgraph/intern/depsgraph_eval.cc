@@ -38,6 +38,7 @@ extern "C" {
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#include "intern/debug/deg_debug.h"
 #include "intern/eval/deg_eval.h"
 #include "intern/eval/deg_eval_flush.h"
 
@@ -73,6 +74,11 @@ void DEG_evaluate_on_framechange(Main *bmain,
 	DEG::TimeSourceNode *tsrc = deg_graph->find_time_source();
 	tsrc->cfra = ctime;
 	tsrc->tag_update(deg_graph, DEG::DEG_UPDATE_SOURCE_TIME);
+	DEG_DEBUG_PRINTF(graph, TIME,
+	                 "Frame change: %d time dependent operations, "
+	                 "%d skipped as time invariant\n",
+	                 deg_graph->debug_num_time_dependent_operations,
+	                 deg_graph->debug_num_time_invariant_operations);
 	DEG::deg_graph_flush_updates(bmain, deg_graph);
 	/* Update time in scene. */
 	if (deg_graph->scene_cow) {
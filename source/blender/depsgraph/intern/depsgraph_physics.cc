@@ -193,6 +193,7 @@ namespace DEG
 
 ListBase *build_effector_relations(Depsgraph *graph, Collection *collection)
 {
+	BLI_mutex_lock(&graph->physics_relations_lock);
 	GHash *hash = graph->physics_relations[DEG_PHYSICS_EFFECTOR];
 	if (hash == NULL) {
 		graph->physics_relations[DEG_PHYSICS_EFFECTOR] =
@@ -207,6 +208,7 @@ ListBase *build_effector_relations(Depsgraph *graph, Collection *collection)
 		        depsgraph, graph->view_layer, collection);
 		BLI_ghash_insert(hash, &collection->id, relations);
 	}
+	BLI_mutex_unlock(&graph->physics_relations_lock);
 	return relations;
 }
 
@@ -215,6 +217,7 @@ ListBase *build_collision_relations(Depsgraph *graph,
                                     unsigned int modifier_type)
 {
 	const ePhysicsRelationType type = modifier_to_relation_type(modifier_type);
+	BLI_mutex_lock(&graph->physics_relations_lock);
 	GHash *hash = graph->physics_relations[type];
 	if (hash == NULL) {
 		graph->physics_relations[type] =
@@ -229,6 +232,7 @@ ListBase *build_collision_relations(Depsgraph *graph,
 		        depsgraph, collection, modifier_type);
 		BLI_ghash_insert(hash, &collection->id, relations);
 	}
+	BLI_mutex_unlock(&graph->physics_relations_lock);
 	return relations;
 }
 
@@ -29,6 +29,8 @@
 
 extern "C" {
 #include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BKE_anim.h"
 #include "BKE_idprop.h"
@@ -44,6 +46,7 @@ extern "C" {
 #include "DEG_depsgraph_query.h"
 
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_type.h"
 #include "intern/node/deg_node_id.h"
 
 #ifndef NDEBUG
@@ -117,50 +120,176 @@ static bool deg_object_hide_original(eEvaluationMode eval_mode, Object *ob, Dupl
 	return false;
 }
 
+bool deg_dupli_object_is_skipped(DEGObjectIterData *data, DupliObject *dob)
+{
+	if (dob->no_draw) {
+		return true;
+	}
+	if (dob->ob->type == OB_MBALL) {
+		return true;
+	}
+	if (deg_object_hide_original(data->eval_mode, dob->ob, dob)) {
+		return true;
+	}
+	return false;
+}
+
+/* Make temporary object represent given dupli object.
+ * Returns false if the dupli object is not visible. */
+bool deg_dupli_temp_object_setup(DEGObjectIterData *data, DupliObject *dob)
+{
+	verify_id_properties_freed(data);
+
+	data->dupli_object_current = dob;
+
+	/* Temporary object to evaluate. */
+	Object *dupli_parent = data->dupli_parent;
+	Object *temp_dupli_object = &data->temp_dupli_object;
+	*temp_dupli_object = *dob->ob;
+	temp_dupli_object->select_color = dupli_parent->select_color;
+	temp_dupli_object->base_flag = dupli_parent->base_flag | BASE_FROM_DUPLI;
+	temp_dupli_object->base_local_view_bits = dupli_parent->base_local_view_bits;
+
+	/* Duplicated elements shouldn't care whether their original collection is visible or not. */
+	temp_dupli_object->base_flag |= BASE_VISIBLE;
+
+	int ob_visibility = BKE_object_visibility(temp_dupli_object, data->eval_mode);
+	if (ob_visibility == 0) {
+		return false;
+	}
+
+	copy_m4_m4(data->temp_dupli_object.obmat, dob->mat);
+	BLI_assert(
+	        DEG::deg_validate_copy_on_write_datablock(
+	                &data->temp_dupli_object.id));
+	return true;
+}
+
 bool deg_objects_dupli_iterator_next(BLI_Iterator *iter)
 {
 	DEGObjectIterData *data = (DEGObjectIterData *)iter->data;
 	while (data->dupli_object_next != NULL) {
 		DupliObject *dob = data->dupli_object_next;
-		Object *obd = dob->ob;
 
 		data->dupli_object_next = data->dupli_object_next->next;
 
-		if (dob->no_draw) {
-			continue;
-		}
-		if (obd->type == OB_MBALL) {
+		if (deg_dupli_object_is_skipped(data, dob)) {
 			continue;
 		}
-		if (deg_object_hide_original(data->eval_mode, dob->ob, dob)) {
+		if (!deg_dupli_temp_object_setup(data, dob)) {
 			continue;
 		}
 
-		verify_id_properties_freed(data);
+		iter->current = &data->temp_dupli_object;
+		return true;
+	}
 
-		data->dupli_object_current = dob;
+	return false;
+}
+
+void deg_dupli_batch_storage_free(DEGObjectIterData *data)
+{
+	DEGDupliBatch *storage = &data->dupli_batch_storage;
+	MEM_SAFE_FREE(storage->matrices);
+	MEM_SAFE_FREE(storage->orcos);
+	MEM_SAFE_FREE(storage->uvs);
+	MEM_SAFE_FREE(storage->random_ids);
+	MEM_SAFE_FREE(storage->dupli_objects);
+	storage->num_instances = 0;
+	data->dupli_batch_next = 0;
+	memset(&data->dupli_batch, 0, sizeof(data->dupli_batch));
+}
 
-		/* Temporary object to evaluate. */
-		Object *dupli_parent = data->dupli_parent;
-		Object *temp_dupli_object = &data->temp_dupli_object;
-		*temp_dupli_object = *dob->ob;
-		temp_dupli_object->select_color = dupli_parent->select_color;
-		temp_dupli_object->base_flag = dupli_parent->base_flag | BASE_FROM_DUPLI;
-		temp_dupli_object->base_local_view_bits = dupli_parent->base_local_view_bits;
+/* Group dupli objects of the current dupli-list by the object they instance,
+ * so all instances of an object are stored next to each other. Objects are
+ * kept in the order of their first appearance in the dupli-list, which keeps
+ * iteration order stable. */
+void deg_dupli_batch_storage_build(DEGObjectIterData *data)
+{
+	DEG::vector<DupliObject *> dupli_objects;
+	DEG::vector<int> batch_indices;
+	DEG::vector<int> batch_offsets;
+	GHash *batch_index_map = BLI_ghash_ptr_new(__func__);
+	LISTBASE_FOREACH (DupliObject *, dob, data->dupli_list) {
+		if (deg_dupli_object_is_skipped(data, dob)) {
+			continue;
+		}
+		void **batch_index_p;
+		if (!BLI_ghash_ensure_p(batch_index_map, dob->ob, &batch_index_p)) {
+			*batch_index_p = POINTER_FROM_INT(batch_offsets.size());
+			batch_offsets.push_back(0);
+		}
+		const int batch_index = POINTER_AS_INT(*batch_index_p);
+		++batch_offsets[batch_index];
+		dupli_objects.push_back(dob);
+		batch_indices.push_back(batch_index);
+	}
+	BLI_ghash_free(batch_index_map, NULL, NULL);
+	/* Convert sizes of batches to offsets in the storage. */
+	int offset = 0;
+	for (int &batch_offset : batch_offsets) {
+		const int num_instances = batch_offset;
+		batch_offset = offset;
+		offset += num_instances;
+	}
+	const int num_instances = dupli_objects.size();
+	DEGDupliBatch *storage = &data->dupli_batch_storage;
+	storage->num_instances = num_instances;
+	data->dupli_batch_next = 0;
+	if (num_instances == 0) {
+		return;
+	}
+	storage->matrices = (float (*)[4][4])MEM_malloc_arrayN(
+	        num_instances, sizeof(*storage->matrices), "dupli batch matrices");
+	storage->orcos = (float (*)[3])MEM_malloc_arrayN(
+	        num_instances, sizeof(*storage->orcos), "dupli batch orcos");
+	storage->uvs = (float (*)[2])MEM_malloc_arrayN(
+	        num_instances, sizeof(*storage->uvs), "dupli batch uvs");
+	storage->random_ids = (unsigned int *)MEM_malloc_arrayN(
+	        num_instances, sizeof(*storage->random_ids), "dupli batch random ids");
+	storage->dupli_objects = (DupliObject **)MEM_malloc_arrayN(
+	        num_instances, sizeof(*storage->dupli_objects), "dupli batch objects");
+	for (int i = 0; i < num_instances; ++i) {
+		DupliObject *dob = dupli_objects[i];
+		const int index = batch_offsets[batch_indices[i]]++;
+		copy_m4_m4(storage->matrices[index], dob->mat);
+		copy_v3_v3(storage->orcos[index], dob->orco);
+		copy_v2_v2(storage->uvs[index], dob->uv);
+		storage->random_ids[index] = dob->random_id;
+		storage->dupli_objects[index] = dob;
+	}
+}
 
-		/* Duplicated elements shouldn't care whether their original collection is visible or not. */
-		temp_dupli_object->base_flag |= BASE_VISIBLE;
+bool deg_objects_dupli_batch_iterator_next(BLI_Iterator *iter)
+{
+	DEGObjectIterData *data = (DEGObjectIterData *)iter->data;
+	DEGDupliBatch *storage = &data->dupli_batch_storage;
+	while (data->dupli_batch_next < storage->num_instances) {
+		const int start = data->dupli_batch_next;
+		DupliObject *dob = storage->dupli_objects[start];
+		int end = start + 1;
+		while (end < storage->num_instances &&
+		       storage->dupli_objects[end]->ob == dob->ob)
+		{
+			++end;
+		}
+		data->dupli_batch_next = end;
 
-		int ob_visibility = BKE_object_visibility(temp_dupli_object, data->eval_mode);
-		if (ob_visibility == 0) {
+		/* Visibility only depends on the instanced object and dupli parent,
+		 * so it is the same for all instances of the batch. */
+		if (!deg_dupli_temp_object_setup(data, dob)) {
 			continue;
 		}
 
-		copy_m4_m4(data->temp_dupli_object.obmat, dob->mat);
+		DEGDupliBatch *batch = &data->dupli_batch;
+		batch->num_instances = end - start;
+		batch->matrices = storage->matrices + start;
+		batch->orcos = storage->orcos + start;
+		batch->uvs = storage->uvs + start;
+		batch->random_ids = storage->random_ids + start;
+		batch->dupli_objects = storage->dupli_objects + start;
+
 		iter->current = &data->temp_dupli_object;
-		BLI_assert(
-		        DEG::deg_validate_copy_on_write_datablock(
-		                &data->temp_dupli_object.id));
 		return true;
 	}
 
@@ -179,6 +308,9 @@ void deg_iterator_objects_step(BLI_Iterator *iter, DEG::IDNode *id_node)
 	DEGObjectIterData *data = (DEGObjectIterData *)iter->data;
 	const ID_Type id_type = GS(id_node->id_orig->name);
 
+	/* Object of the ID node itself is never a part of batch. */
+	memset(&data->dupli_batch, 0, sizeof(data->dupli_batch));
+
 	if (id_type != ID_OB) {
 		return;
 	}
@@ -220,6 +352,9 @@ void deg_iterator_objects_step(BLI_Iterator *iter, DEG::IDNode *id_node)
 			data->dupli_parent = object;
 			data->dupli_list = object_duplilist(data->graph, data->scene, object);
 			data->dupli_object_next = (DupliObject *)data->dupli_list->first;
+			if (data->flag & DEG_ITER_OBJECT_FLAG_DUPLI_BATCH) {
+				deg_dupli_batch_storage_build(data);
+			}
 		}
 	}
 
@@ -248,6 +383,9 @@ void DEG_iterator_objects_begin(BLI_Iterator *iter, DEGObjectIterData *data)
 	data->dupli_list = NULL;
 	data->dupli_object_next = NULL;
 	data->dupli_object_current = NULL;
+	memset(&data->dupli_batch_storage, 0, sizeof(data->dupli_batch_storage));
+	memset(&data->dupli_batch, 0, sizeof(data->dupli_batch));
+	data->dupli_batch_next = 0;
 	data->scene = DEG_get_evaluated_scene(depsgraph);
 	data->id_node_index = 0;
 	data->num_id_nodes = num_id_nodes;
@@ -270,11 +408,16 @@ void DEG_iterator_objects_next(BLI_Iterator *iter)
 	do {
 		iter->skip = false;
 		if (data->dupli_list) {
-			if (deg_objects_dupli_iterator_next(iter)) {
+			const bool has_next =
+			        (data->flag & DEG_ITER_OBJECT_FLAG_DUPLI_BATCH)
+			                ? deg_objects_dupli_batch_iterator_next(iter)
+			                : deg_objects_dupli_iterator_next(iter);
+			if (has_next) {
 				return;
 			}
 			else {
 				verify_id_properties_freed(data);
+				deg_dupli_batch_storage_free(data);
 				free_object_duplilist(data->dupli_list);
 				data->dupli_parent = NULL;
 				data->dupli_list = NULL;
@@ -299,6 +442,21 @@ void DEG_iterator_objects_end(BLI_Iterator *iter)
 {
 	DEGObjectIterData *data = (DEGObjectIterData *)iter->data;
 	if (data != NULL) {
+		/* Iteration was stopped in the middle of a dupli-list, free batches
+		 * which would otherwise be freed once the list is exhausted. The
+		 * per-instance iteration leaves this to the caller, since the RNA
+		 * iterator shares the dupli-list between two copies of the data. */
+		if ((data->flag & DEG_ITER_OBJECT_FLAG_DUPLI_BATCH) &&
+		    data->dupli_list != NULL)
+		{
+			verify_id_properties_freed(data);
+			deg_dupli_batch_storage_free(data);
+			free_object_duplilist(data->dupli_list);
+			data->dupli_parent = NULL;
+			data->dupli_list = NULL;
+			data->dupli_object_next = NULL;
+			data->dupli_object_current = NULL;
+		}
 		/* Force crash in case the iterator data is referenced and accessed down
 		 * the line. (T51718) */
 		deg_invalidate_iterator_work_data(data);
@@ -44,6 +44,7 @@ extern "C" {
 #include "DNA_screen_types.h"
 #include "DNA_windowmanager_types.h"
 
+#include "BKE_action.h"
 #include "BKE_animsys.h"
 #include "BKE_global.h"
 #include "BKE_idcode.h"
@@ -57,6 +58,7 @@ extern "C" {
 } /* extern "C" */
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
@@ -467,6 +469,34 @@ void deg_graph_node_tag_zero(Main *bmain,
 	        bmain, graph, id, (IDRecalcFlag)0, update_source);
 }
 
+/* Constant actions are connected to the time source with a time invariant
+ * relation. Editing an action might change that (for example, keyframe with a
+ * different value is added), in which case relations are to be rebuilt. */
+void deg_graph_tag_action_time_dependency(Depsgraph *graph, IDNode *id_node)
+{
+	ComponentNode *anim_comp = id_node->find_component(NodeType::ANIMATION);
+	if (anim_comp == NULL) {
+		return;
+	}
+	OperationNode *anim_op = anim_comp->get_entry_operation();
+	if (anim_op == NULL) {
+		return;
+	}
+	const bAction *action = (const bAction *)id_node->id_orig;
+	for (Relation *rel : anim_op->inlinks) {
+		if (rel->from->type != NodeType::TIMESOURCE) {
+			continue;
+		}
+		const bool is_time_invariant =
+		        (rel->flag & RELATION_FLAG_TIME_INVARIANT) != 0;
+		if (is_time_invariant == action_depends_on_time(action)) {
+			DEG_graph_tag_relations_update(
+			        reinterpret_cast< ::Depsgraph *>(graph));
+		}
+		break;
+	}
+}
+
 void deg_graph_on_visible_update(Main *bmain, Depsgraph *graph)
 {
 	for (DEG::IDNode *id_node : graph->id_nodes) {
@@ -609,11 +639,18 @@ void graph_id_tag_update(Main *bmain,
 	}
 	/* Special case for nested node tree datablocks. */
 	id_tag_update_ntree_special(bmain, graph, id, flag, update_source);
+	/* Action might have stopped (or started) changing over time. */
+	if (id_node != NULL && GS(id->name) == ID_AC) {
+		deg_graph_tag_action_time_dependency(graph, id_node);
+	}
 	/* Direct update tags means that something outside of simulated/cached
 	 * physics did change and that cache is to be invalidated. */
 	if (update_source == DEG_UPDATE_SOURCE_USER_EDIT) {
 		graph_id_tag_update_single_flag(
 		        bmain, graph, id, id_node, ID_RECALC_POINT_CACHE, update_source);
+		if (id_node != NULL) {
+			id_node->is_user_modified = true;
+		}
 	}
 }
 
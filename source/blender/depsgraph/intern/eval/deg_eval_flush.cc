@@ -24,8 +24,6 @@
 
 #include "intern/eval/deg_eval_flush.h"
 
-// TODO(sergey): Use some sort of wrapper.
-#include <deque>
 #include <cmath>
 
 #include "BKE_object.h"
@@ -55,6 +53,8 @@ extern "C" {
 
 #include "intern/eval/deg_eval_copy_on_write.h"
 
+#include "atomic_ops.h"
+
 // Invalidate datablock data when update is flushed on it.
 //
 // The idea of this is to help catching cases when area is accessing data which
@@ -79,7 +79,17 @@ enum {
 	COMPONENT_STATE_DONE      = 2,
 };
 
-typedef std::deque<OperationNode *> FlushQueue;
+/* Operations which are to be handled on the same level of the flush. */
+typedef vector<OperationNode *> FlushQueue;
+
+/* Flush is done level by level: all operations of the current level are
+ * handled in parallel, children which are reached for the first time are
+ * gathered into per-thread queues, which then form the next level. */
+struct FlushState {
+	FlushQueue current_level;
+	/* Indexed by thread ID. */
+	vector<FlushQueue> next_level;
+};
 
 namespace {
 
@@ -145,7 +155,30 @@ BLI_INLINE void flush_schedule_entrypoints(Depsgraph *graph, FlushQueue *queue)
 
 BLI_INLINE void flush_handle_id_node(IDNode *id_node)
 {
-	id_node->custom_flags = ID_STATE_MODIFIED;
+	/* Same ID is reached from multiple threads, skip the atomic write when
+	 * the state is already set by one of them. */
+	if (id_node->custom_flags == ID_STATE_MODIFIED) {
+		return;
+	}
+	atomic_cas_int32(&id_node->custom_flags, ID_STATE_NONE, ID_STATE_MODIFIED);
+}
+
+BLI_INLINE void flush_tag_operation(OperationNode *op_node, int flag)
+{
+	/* Avoid atomic write, and the cache line bouncing between threads, when
+	 * there is nothing new to be set. */
+	if ((op_node->flag & flag) == flag) {
+		return;
+	}
+	atomic_fetch_and_or_uint32((uint32_t *)&op_node->flag, (uint32_t)flag);
+}
+
+/* Returns true if the operation was not scheduled for flush yet, and is now
+ * scheduled by the caller. */
+BLI_INLINE bool flush_try_schedule_operation(OperationNode *op_node)
+{
+	return !atomic_fetch_and_or_uint8((uint8_t *)&op_node->scheduled,
+	                                  (uint8_t)true);
 }
 
 /* TODO(sergey): We can reduce number of arguments here. */
@@ -153,11 +186,18 @@ BLI_INLINE void flush_handle_component_node(IDNode *id_node,
                                             ComponentNode *comp_node,
                                             FlushQueue *queue)
 {
-	/* We only handle component once. */
-	if (comp_node->custom_flags == COMPONENT_STATE_DONE) {
-		return;
-	}
-	comp_node->custom_flags = COMPONENT_STATE_DONE;
+	/* We only handle component once. Component might be reached from
+	 * multiple threads, so only the one which changes its state to done
+	 * handles it. */
+	int state;
+	do {
+		state = comp_node->custom_flags;
+		if (state == COMPONENT_STATE_DONE) {
+			return;
+		}
+	} while (atomic_cas_int32(&comp_node->custom_flags,
+	                          state,
+	                          COMPONENT_STATE_DONE) != state);
 	/* Tag all required operations in component for update, unless this is a
 	 * special component where we don't want all operations to be tagged.
 	 *
@@ -166,7 +206,7 @@ BLI_INLINE void flush_handle_component_node(IDNode *id_node,
 	    comp_node->type != NodeType::PARTICLE_SYSTEM)
 	{
 		for (OperationNode *op : comp_node->operations) {
-			op->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
+			flush_tag_operation(op, DEPSOP_FLAG_NEEDS_UPDATE);
 		}
 	}
 	/* when some target changes bone, we might need to re-run the
@@ -175,24 +215,20 @@ BLI_INLINE void flush_handle_component_node(IDNode *id_node,
 		ComponentNode *pose_comp =
 		        id_node->find_component(NodeType::EVAL_POSE);
 		BLI_assert(pose_comp != NULL);
-		if (pose_comp->custom_flags == COMPONENT_STATE_NONE) {
-			queue->push_front(pose_comp->get_entry_operation());
-			pose_comp->custom_flags = COMPONENT_STATE_SCHEDULED;
+		if (atomic_cas_int32(&pose_comp->custom_flags,
+		                     COMPONENT_STATE_NONE,
+		                     COMPONENT_STATE_SCHEDULED) == COMPONENT_STATE_NONE)
+		{
+			queue->push_back(pose_comp->get_entry_operation());
 		}
 	}
 }
 
-/* Schedule children of the given operation node for traversal.
- *
- * One of the children will by-pass the queue and will be returned as a function
- * return value, so it can start being handled right away, without building too
- * much of a queue.
- */
-BLI_INLINE OperationNode *flush_schedule_children(
-        OperationNode *op_node,
-        FlushQueue *queue)
+/* Schedule children of the given operation node for traversal on the next
+ * level of the flush. */
+BLI_INLINE void flush_schedule_children(OperationNode *op_node,
+                                        FlushQueue *queue)
 {
-	OperationNode *result = NULL;
 	for (Relation *rel : op_node->outlinks) {
 		/* Flush is forbidden, completely. */
 		if (rel->flag & RELATION_FLAG_NO_FLUSH) {
@@ -208,20 +244,44 @@ BLI_INLINE OperationNode *flush_schedule_children(
 		OperationNode *to_node = (OperationNode *)rel->to;
 		/* Always flush flushable flags, so children always know what happened
 		 * to their parents. */
-		to_node->flag |= (op_node->flag & DEPSOP_FLAG_FLUSH);
+		flush_tag_operation(to_node, op_node->flag & DEPSOP_FLAG_FLUSH);
 		/* Flush update over the relation, if it was not flushed yet. */
-		if (to_node->scheduled) {
+		if (!flush_try_schedule_operation(to_node)) {
 			continue;
 		}
-		if (result != NULL) {
-			queue->push_front(to_node);
-		}
-		else {
-			result = to_node;
-		}
-		to_node->scheduled = true;
+		queue->push_back(to_node);
+	}
+}
+
+void flush_operation_node_func(
+        void *__restrict data_v,
+        const int i,
+        const ParallelRangeTLS *__restrict tls)
+{
+	FlushState *state = (FlushState *)data_v;
+	OperationNode *op_node = state->current_level[i];
+	FlushQueue *queue = &state->next_level[tls->thread_id];
+	/* Tag operation as required for update. */
+	flush_tag_operation(op_node, DEPSOP_FLAG_NEEDS_UPDATE);
+	/* Inform corresponding ID and component nodes about the change. */
+	ComponentNode *comp_node = op_node->owner;
+	IDNode *id_node = comp_node->owner;
+	flush_handle_id_node(id_node);
+	flush_handle_component_node(id_node, comp_node, queue);
+	/* Flush to nodes along links. */
+	flush_schedule_children(op_node, queue);
+}
+
+/* Gather operations scheduled by all threads into the next level. */
+BLI_INLINE void flush_advance_level(FlushState *state)
+{
+	state->current_level.clear();
+	for (FlushQueue &queue : state->next_level) {
+		state->current_level.insert(state->current_level.end(),
+		                            queue.begin(),
+		                            queue.end());
+		queue.clear();
 	}
-	return result;
 }
 
 void flush_engine_data_update(ID *id)
@@ -370,31 +430,30 @@ void deg_graph_flush_updates(Main *bmain, Depsgraph *graph)
 	/* Reset all flags, get ready for the flush. */
 	flush_prepare(graph);
 	/* Starting from the tagged "entry" nodes, flush outwards. */
-	FlushQueue queue;
-	flush_schedule_entrypoints(graph, &queue);
+	FlushState state;
+	state.next_level.resize(
+	        BLI_task_scheduler_num_threads(BLI_task_scheduler_get()) + 1);
+	flush_schedule_entrypoints(graph, &state.current_level);
 	/* Prepare update context for editors. */
 	DEGEditorUpdateContext update_ctx;
 	update_ctx.bmain = bmain;
 	update_ctx.depsgraph = (::Depsgraph *)graph;
 	update_ctx.scene = graph->scene;
 	update_ctx.view_layer = graph->view_layer;
-	/* Do actual flush. */
-	while (!queue.empty()) {
-		OperationNode *op_node = queue.front();
-		queue.pop_front();
-		while (op_node != NULL) {
-			/* Tag operation as required for update. */
-			op_node->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
-			/* Inform corresponding ID and component nodes about the change. */
-			ComponentNode *comp_node = op_node->owner;
-			IDNode *id_node = comp_node->owner;
-			flush_handle_id_node(id_node);
-			flush_handle_component_node(id_node,
-			                            comp_node,
-			                            &queue);
-			/* Flush to nodes along links. */
-			op_node = flush_schedule_children(op_node, &queue);
-		}
+	/* Do actual flush, one level at a time. Levels are usually small, so
+	 * only big ones are worth threading. */
+	const bool do_threads = (DEG_debug_flags_get((::Depsgraph *)graph) &
+	                         G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+	while (!state.current_level.empty()) {
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = do_threads;
+		settings.min_iter_per_thread = 256;
+		BLI_task_parallel_range(0, state.current_level.size(),
+		                        &state,
+		                        flush_operation_node_func,
+		                        &settings);
+		flush_advance_level(&state);
 	}
 	/* Inform editors about all changes. */
 	flush_editors_id_update(bmain, graph, &update_ctx);
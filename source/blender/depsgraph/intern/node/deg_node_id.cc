@@ -113,6 +113,7 @@ void IDNode::init(const ID *id, const char *UNUSED(subdata))
 	linked_state = DEG_ID_LINKED_INDIRECTLY;
 	is_directly_visible = true;
 	is_collection_fully_expanded = false;
+	is_user_modified = false;
 
 	visible_components_mask = 0;
 	previously_visible_components_mask = 0;
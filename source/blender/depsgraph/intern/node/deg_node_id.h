@@ -97,6 +97,12 @@ struct IDNode : public Node {
 	 * recursed into. */
 	bool is_collection_fully_expanded;
 
+	/* Datablock was edited by the user since its animation was last
+	 * re-evaluated on frame change. Animation coming from a time invariant
+	 * action is only re-evaluated on frame change when this is set, so edits
+	 * of an animated property are reverted to the keyed value. */
+	bool is_user_modified;
+
 	IDComponentsMask visible_components_mask;
 	IDComponentsMask previously_visible_components_mask;
 
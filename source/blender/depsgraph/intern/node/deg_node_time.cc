@@ -25,12 +25,49 @@
 #include "DNA_scene_types.h"
 
 #include "intern/depsgraph.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 
 namespace DEG {
 
+namespace {
+
+/* Time invariant action did not change, but the user might have edited
+ * properties it animates. Re-evaluate animation of such owners, so the edited
+ * values are reverted to the keyed ones, same as for animated actions. */
+void tag_user_modified_action_owners(Depsgraph *graph, Node *action_node)
+{
+	if (action_node->get_class() != NodeClass::OPERATION) {
+		return;
+	}
+	ComponentNode *action_comp = ((OperationNode *)action_node)->owner;
+	for (OperationNode *action_op : action_comp->operations) {
+		for (Relation *rel : action_op->outlinks) {
+			if (rel->to->get_class() != NodeClass::OPERATION) {
+				continue;
+			}
+			OperationNode *owner_op = (OperationNode *)rel->to;
+			IDNode *owner_id_node = owner_op->owner->owner;
+			if (!owner_id_node->is_user_modified) {
+				continue;
+			}
+			owner_id_node->is_user_modified = false;
+			owner_op->tag_update(graph, DEG_UPDATE_SOURCE_TIME);
+		}
+	}
+}
+
+}  // namespace
+
 void TimeSourceNode::tag_update(Depsgraph *graph, eUpdateSource /*source*/)
 {
 	for (Relation *rel : outlinks) {
+		/* Nothing has changed on the other side of the relation. */
+		if (rel->flag & RELATION_FLAG_TIME_INVARIANT) {
+			tag_user_modified_action_owners(graph, rel->to);
+			continue;
+		}
 		Node *node = rel->to;
 		node->tag_update(graph, DEG_UPDATE_SOURCE_TIME);
 	}
@@ -246,10 +246,19 @@ static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 static void rna_Depsgraph_debug_stats(Depsgraph *depsgraph, char *result)
 {
 	size_t outer, ops, rels;
+	double nodes_time, relations_time, finalize_time;
+	int time_dependent_ops, time_invariant_ops;
 	DEG_stats_simple(depsgraph, &outer, &ops, &rels);
+	DEG_stats_build_time(depsgraph, &nodes_time, &relations_time, &finalize_time);
+	DEG_stats_time_dependency(depsgraph, &time_dependent_ops, &time_invariant_ops);
 	BLI_snprintf(result, STATS_MAX_SIZE,
-	            "Approx %lu Operations, %lu Relations, %lu Outer Nodes",
-	             ops, rels, outer);
+	            "Approx %lu Operations, %lu Relations, %lu Outer Nodes, "
+	            "Built in %.3fs (Nodes %.3fs, Relations %.3fs, Finalize %.3fs), "
+	            "Frame change updates %d Operations (%d skipped as time invariant)",
+	             ops, rels, outer,
+	             nodes_time + relations_time + finalize_time,
+	             nodes_time, relations_time, finalize_time,
+	             time_dependent_ops, time_invariant_ops);
 }
 
 /* Iteration over objects, simple version */
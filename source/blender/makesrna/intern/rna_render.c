@@ -772,6 +772,13 @@ static void rna_def_render_engine(BlenderRNA *brna)
 	RNA_def_property_boolean_sdna(prop, NULL, "type->flag", RE_USE_SPHERICAL_STEREO);
 	RNA_def_property_flag(prop, PROP_REGISTER_OPTIONAL);
 
+	prop = RNA_def_property(srna, "bl_use_persistent_depsgraph", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "type->flag", RE_USE_PERSISTENT_DEPSGRAPH);
+	RNA_def_property_flag(prop, PROP_REGISTER_OPTIONAL);
+	RNA_def_property_ui_text(prop, "Use Persistent Depsgraph",
+	                         "Keep the dependency graph between frames of an animation with Persistent Data, "
+	                         "so the engine can update only the datablocks which changed");
+
 	RNA_define_verify_sdna(1);
 }
 
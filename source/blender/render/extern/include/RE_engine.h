@@ -60,6 +60,7 @@ struct bNodeTree;
 #define RE_USE_TEXTURE_PREVIEW		128
 #define RE_USE_SHADING_NODES_CUSTOM 	256
 #define RE_USE_SPHERICAL_STEREO 512
+#define RE_USE_PERSISTENT_DEPSGRAPH	1024
 
 /* RenderEngine.flag */
 #define RE_ENGINE_ANIMATION		1
@@ -187,5 +188,6 @@ void RE_bake_engine_set_engine_parameters(
         struct Render *re, struct Main *bmain, struct Scene *scene);
 
 void RE_engine_free_blender_memory(struct RenderEngine *engine);
+void RE_engine_free_depsgraph(struct RenderEngine *engine);
 
 #endif /* __RE_ENGINE_H__ */
@@ -148,6 +148,9 @@ RenderEngine *RE_engine_create_ex(RenderEngineType *type, bool use_for_viewport)
 
 void RE_engine_free(RenderEngine *engine)
 {
+	/* Depsgraph kept for persistent data. */
+	RE_engine_free_depsgraph(engine);
+
 #ifdef WITH_PYTHON
 	if (engine->py_instance) {
 		BPY_DECREF_RNA_INVALIDATE(engine->py_instance);
@@ -484,22 +487,75 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+
+/* With persistent data the depsgraph is kept between frames of an animation
+ * for engines which support it, and recalc flags are only cleared after
+ * rendering, so the render engine can update only the datablocks which
+ * changed since the previous frame. Other engines expect a freshly built
+ * depsgraph for every frame.
+ *
+ * The depsgraph is not tagged for edits made in between renders, so it is
+ * freed once the animation is done. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+	Render *re = engine->re;
+	return (engine->type->flag & RE_USE_PERSISTENT_DEPSGRAPH) &&
+	       (re->r.mode & R_PERSISTENT_DATA) &&
+	       (re->flag & R_ANIMATION);
+}
+
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+	DEG_graph_free(engine->depsgraph);
+
+	engine->depsgraph = NULL;
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
 	Main *bmain = engine->re->main;
 	Scene *scene = engine->re->scene;
+	const bool keep_depsgraph = engine_keep_depsgraph(engine);
+
+	if (engine->depsgraph) {
+		if (keep_depsgraph &&
+		    DEG_get_input_scene(engine->depsgraph) == scene &&
+		    DEG_get_input_view_layer(engine->depsgraph) == view_layer)
+		{
+			/* Reuse depsgraph of the previous frame. */
+			BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, bmain, false);
+			return;
+		}
+		engine_depsgraph_free(engine);
+	}
 
 	engine->depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_RENDER);
 	DEG_debug_name_set(engine->depsgraph, "RENDER");
 
-	BKE_scene_graph_update_for_newframe(engine->depsgraph, bmain);
+	/* All datablocks of a new depsgraph are tagged, so the engine sees them
+	 * as updated when it keeps its own data between frames. */
+	BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, bmain, !keep_depsgraph);
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
+static void engine_depsgraph_exit(RenderEngine *engine)
 {
-	DEG_graph_free(engine->depsgraph);
+	if (engine->depsgraph == NULL) {
+		return;
+	}
 
-	engine->depsgraph = NULL;
+	if (engine_keep_depsgraph(engine)) {
+		DEG_ids_clear_recalc(engine->re->main, engine->depsgraph);
+	}
+	else {
+		engine_depsgraph_free(engine);
+	}
+}
+
+void RE_engine_free_depsgraph(RenderEngine *engine)
+{
+	if (engine->depsgraph) {
+		engine_depsgraph_free(engine);
+	}
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -692,8 +748,11 @@ int RE_engine_render(Render *re, int do_all)
 	/* TODO: actually link to a parent which shouldn't happen */
 	engine->re = re;
 
+	/* Engine can be reused from a previous render with persistent data. */
 	if (re->flag & R_ANIMATION)
 		engine->flag |= RE_ENGINE_ANIMATION;
+	else
+		engine->flag &= ~RE_ENGINE_ANIMATION;
 	if (re->r.scemode & R_BUTS_PREVIEW)
 		engine->flag |= RE_ENGINE_PREVIEW;
 	engine->camera_override = re->camera_override;
@@ -743,7 +802,7 @@ int RE_engine_render(Render *re, int do_all)
 				DRW_render_gpencil(engine, engine->depsgraph);
 			}
 
-			engine_depsgraph_free(engine);
+			engine_depsgraph_exit(engine);
 
 			if (RE_engine_test_break(engine)) {
 				break;
@@ -829,6 +888,10 @@ void RE_engine_free_blender_memory(RenderEngine *engine)
 	if (DRW_render_check_grease_pencil(engine->depsgraph)) {
 		return;
 	}
+	/* Depsgraph is needed again for the next frame. */
+	if (engine_keep_depsgraph(engine)) {
+		return;
+	}
 	DEG_graph_free(engine->depsgraph);
 	engine->depsgraph = NULL;
 }
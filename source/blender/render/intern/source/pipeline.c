@@ -2537,6 +2537,12 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, ViewLayer *single_lay
 
 	scene->r.cfra = cfrao;
 
+	/* Depsgraph kept between frames for persistent data is not tagged for
+	 * edits made after the animation, it can not be reused. */
+	if (re->engine) {
+		RE_engine_free_depsgraph(re->engine);
+	}
+
 	re->flag &= ~R_ANIMATION;
 
 	BLI_callback_exec(re->main, (ID *)scene, G.is_break ? BLI_CB_EVT_RENDER_CANCEL : BLI_CB_EVT_RENDER_COMPLETE);
@@ -0,0 +1,233 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+#include "BKE_action.h"
+#include "BKE_animsys.h"
+#include "BKE_camera.h"
+#include "BKE_collection.h"
+#include "BKE_fcurve.h"
+#include "BKE_global.h"
+#include "BKE_lamp.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "DNA_anim_types.h"
+#include "DNA_camera_types.h"
+#include "DNA_lamp_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "RNA_define.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_operation.h"
+
+/* Number of animated cameras and lamps, enough for the graph to be above the
+ * threshold for threaded relations building. */
+#define NUM_ANIMATED_OBJECTS 100
+
+/* Builds relations of a real scene with and without threads, the resulting
+ * sets of relations are to be identical. */
+class DepsgraphThreadedRelationsTest : public testing::Test
+{
+protected:
+	Main *bmain;
+	Scene *scene;
+	Object *driver_target;
+	std::vector<ID *> animated_ids;
+
+	virtual void SetUp()
+	{
+		RNA_init();
+		DEG_register_node_types();
+		bmain = BKE_main_new();
+		scene = BKE_scene_add(bmain, "Scene");
+		driver_target = add_object(OB_EMPTY, "Target", NULL);
+	}
+
+	virtual void TearDown()
+	{
+		BKE_main_free(bmain);
+		DEG_free_node_types();
+		RNA_exit();
+	}
+
+	Object *add_object(int type, const char *name, ID *data)
+	{
+		Object *object = BKE_object_add_only_object(bmain, type, name);
+		object->data = data;
+		BKE_collection_object_add(bmain, scene->master_collection, object);
+		return object;
+	}
+
+	FCurve *add_fcurve(ListBase *curves, const char *rna_path, int array_index)
+	{
+		FCurve *fcu = (FCurve *)MEM_callocN(sizeof(FCurve), "test fcurve");
+		fcu->rna_path = BLI_strdup(rna_path);
+		fcu->array_index = array_index;
+		BLI_addtail(curves, fcu);
+		return fcu;
+	}
+
+	/* Action on one property and a driver on another one, driven by the
+	 * location of the target object. */
+	void add_animation(ID *id,
+	                   const char *animated_path,
+	                   const char *driven_path,
+	                   int driven_index)
+	{
+		AnimData *adt = BKE_animdata_add_id(id);
+		adt->action = BKE_action_add(bmain, "Action");
+		add_fcurve(&adt->action->curves, animated_path, 0);
+
+		FCurve *fcu = add_fcurve(&adt->drivers, driven_path, driven_index);
+		fcu->driver = (ChannelDriver *)MEM_callocN(sizeof(ChannelDriver), "test driver");
+		fcu->driver->type = DRIVER_TYPE_AVERAGE;
+		DriverVar *dvar = driver_add_new_variable(fcu->driver);
+		driver_change_variable_type(dvar, DVAR_TYPE_TRANSFORM_CHAN);
+		dvar->targets[0].id = &driver_target->id;
+		dvar->targets[0].transChan = DTAR_TRANSCHAN_LOCX;
+
+		animated_ids.push_back(id);
+	}
+
+	/* Datablocks get unique names without numeric suffix, so the name of one
+	 * is never a prefix of the name of another one followed by a dot. */
+	void build_scene()
+	{
+		char name[MAX_ID_NAME - 2];
+		for (int i = 0; i < NUM_ANIMATED_OBJECTS; ++i) {
+			BLI_snprintf(name, sizeof(name), "Camera%d", i);
+			Camera *camera = (Camera *)BKE_camera_add(bmain, name);
+			add_animation(&camera->id, "lens", "dof_distance", -1);
+			add_object(OB_CAMERA, name, &camera->id);
+
+			BLI_snprintf(name, sizeof(name), "Lamp%d", i);
+			Lamp *lamp = BKE_lamp_add(bmain, name);
+			add_animation(&lamp->id, "energy", "color", 0);
+			add_object(OB_LAMP, name, &lamp->id);
+		}
+	}
+
+	/* Every relation of the graph, the same relation is listed as many times
+	 * as it was added. */
+	std::multiset<std::string> build_relations(bool use_threads)
+	{
+		const int debug_value = G.debug;
+		if (use_threads) {
+			G.debug &= ~G_DEBUG_DEPSGRAPH_NO_THREADS;
+		}
+		else {
+			G.debug |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+		}
+
+		ViewLayer *view_layer = (ViewLayer *)scene->view_layers.first;
+		Depsgraph *depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+		DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+		DEG::Depsgraph *graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
+
+		EXPECT_GE(graph->id_nodes.size(), 256);
+
+		std::multiset<std::string> relations;
+		for (DEG::OperationNode *op_node : graph->operations) {
+			for (DEG::Relation *rel : op_node->outlinks) {
+				DEG::OperationNode *to = static_cast<DEG::OperationNode *>(rel->to);
+				relations.insert(op_node->full_identifier() + " -> " +
+				                 to->full_identifier() + " : " + rel->name);
+			}
+		}
+
+		DEG_graph_free(depsgraph);
+		G.debug = debug_value;
+		return relations;
+	}
+
+	/* Serial builder might add the same relation multiple times, only the
+	 * set of relations is compared. */
+	std::set<std::string> build_relation_set(bool use_threads)
+	{
+		const std::multiset<std::string> relations = build_relations(use_threads);
+		return std::set<std::string>(relations.begin(), relations.end());
+	}
+
+	/* Number of relations with the given name from (or to) any operation of
+	 * the ID. */
+	template<typename Relations>
+	static int count_relations(const Relations &relations,
+	                           const ID *id,
+	                           const char *name,
+	                           bool to_id = false)
+	{
+		const std::string prefix = (to_id ? " -> " : "") + std::string(id->name) + ".";
+		const std::string suffix = std::string(" : ") + name;
+		int count = 0;
+		for (const std::string &relation : relations) {
+			const size_t prefix_pos = to_id ? relation.find(prefix) : 0;
+			if (prefix_pos != std::string::npos &&
+			    relation.compare(prefix_pos, prefix.size(), prefix) == 0 &&
+			    relation.size() >= suffix.size() &&
+			    relation.compare(relation.size() - suffix.size(), suffix.size(), suffix) == 0)
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+};
+
+TEST_F(DepsgraphThreadedRelationsTest, AnimatedCameraAndLamp)
+{
+	build_scene();
+
+	const std::set<std::string> serial_relations = build_relation_set(false);
+	const std::set<std::string> threaded_relations = build_relation_set(true);
+
+	EXPECT_EQ(serial_relations.size(), threaded_relations.size());
+	EXPECT_TRUE(serial_relations == threaded_relations);
+
+	/* Animation of the datablocks themselves is part of the graph. */
+	for (ID *id : animated_ids) {
+		EXPECT_EQ(count_relations(threaded_relations, id, "Animation -> Parameters"), 1)
+		        << id->name;
+	}
+
+	/* Report the difference, if any. */
+	for (const std::string &relation : serial_relations) {
+		if (threaded_relations.count(relation) == 0) {
+			printf("Missing in threaded build: %s\n", relation.c_str());
+		}
+	}
+	for (const std::string &relation : threaded_relations) {
+		if (serial_relations.count(relation) == 0) {
+			printf("Missing in serial build: %s\n", relation.c_str());
+		}
+	}
+}
+
+TEST_F(DepsgraphThreadedRelationsTest, SerialAnimationNotDuplicated)
+{
+	build_scene();
+
+	/* Animation of camera and lamp data is built once, not by both the object
+	 * data and the camera or lamp builder. */
+	const std::multiset<std::string> serial_relations = build_relations(false);
+	for (ID *id : animated_ids) {
+		EXPECT_EQ(count_relations(serial_relations, id, "Action -> Animation", true), 1)
+		        << id->name;
+		EXPECT_EQ(count_relations(serial_relations, id, "Animation -> Parameters"), 1)
+		        << id->name;
+	}
+}
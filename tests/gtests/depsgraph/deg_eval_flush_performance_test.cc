@@ -0,0 +1,133 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "deg_synthetic_graph.h"
+
+extern "C" {
+#include "PIL_time.h"
+}
+
+#include "intern/eval/deg_eval_flush.h"
+
+/* Number of times flush is measured for every graph. */
+#define NUM_FLUSH_RUNS 10
+
+/* Synthetic graph which mimics a rig: every object has a transform component
+ * with local, parent and final operations, and final transform of an object
+ * is used by local transform of objects on the next level of the graph.
+ *
+ * All objects of the first level depend on a single driver-like operation,
+ * which is what gets tagged for update. */
+class DepsgraphFlushPerformanceTest : public DepsgraphSyntheticTest
+{
+protected:
+	DEG::OperationNode *root_op;
+
+	/* Build graph of num_levels levels, every level has width objects, and
+	 * every object is used by fan_out objects of the next level. */
+	void build_graph(int num_levels, int width, int fan_out)
+	{
+		DEG::IDNode *driver_node = add_id_node("Driver");
+		DEG::ComponentNode *driver_comp =
+		        driver_node->add_component(DEG::NodeType::PARAMETERS);
+		root_op = add_operation(driver_comp, DEG::OperationCode::DRIVER);
+		std::vector<DEG::OperationNode *> prev_level, level;
+		for (int level_index = 0; level_index < num_levels; ++level_index) {
+			level.clear();
+			for (int i = 0; i < width; ++i) {
+				DEG::IDNode *id_node = add_id_node("Object");
+				DEG::ComponentNode *comp_node =
+				        id_node->add_component(DEG::NodeType::TRANSFORM);
+				DEG::OperationNode *local_op = add_operation(
+				        comp_node, DEG::OperationCode::TRANSFORM_LOCAL);
+				DEG::OperationNode *parent_op = add_operation(
+				        comp_node, DEG::OperationCode::TRANSFORM_PARENT);
+				DEG::OperationNode *final_op = add_operation(
+				        comp_node, DEG::OperationCode::TRANSFORM_FINAL);
+				add_relation(local_op, parent_op, "Local -> Parent");
+				add_relation(parent_op, final_op, "Parent -> Final");
+				if (prev_level.empty()) {
+					add_relation(root_op, local_op, "Driver");
+				}
+				else {
+					for (int j = 0; j < fan_out; ++j) {
+						DEG::OperationNode *parent_final_op =
+						        prev_level[(i + j) % prev_level.size()];
+						add_relation(parent_final_op, local_op, "Parent");
+					}
+				}
+				level.push_back(final_op);
+			}
+			prev_level.swap(level);
+		}
+		finalize_graph();
+	}
+
+	void flush_and_check(const char *id)
+	{
+		const bool use_threads =
+		        (graph->debug_flags & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+		double time_total = 0.0;
+		for (int run = 0; run < NUM_FLUSH_RUNS; ++run) {
+			root_op->tag_update(graph, DEG::DEG_UPDATE_SOURCE_USER_EDIT);
+			const double time_start = PIL_check_seconds_timer();
+			DEG::deg_graph_flush_updates(bmain, graph);
+			time_total += PIL_check_seconds_timer() - time_start;
+			for (DEG::OperationNode *op_node : graph->operations) {
+				EXPECT_TRUE(op_node->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+			}
+			DEG::deg_graph_clear_tags(graph);
+		}
+		printf("%s (%d operations, %s): %.6f sec per flush\n",
+		       id,
+		       (int)graph->operations.size(),
+		       use_threads ? "threaded" : "single thread",
+		       time_total / NUM_FLUSH_RUNS);
+	}
+
+	void flush_test(const char *id, int num_levels, int width, int fan_out)
+	{
+		build_graph(num_levels, width, fan_out);
+		graph->debug_flags |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+		flush_and_check(id);
+		graph->debug_flags &= ~G_DEBUG_DEPSGRAPH_NO_THREADS;
+		flush_and_check(id);
+	}
+};
+
+/* Single driver affecting many objects directly. */
+
+TEST_F(DepsgraphFlushPerformanceTest, Wide1000)
+{
+	flush_test("Wide1000", 1, 1000, 1);
+}
+
+TEST_F(DepsgraphFlushPerformanceTest, Wide50000)
+{
+	flush_test("Wide50000", 1, 50000, 1);
+}
+
+/* Long dependency chain, nothing to be done in parallel. */
+
+TEST_F(DepsgraphFlushPerformanceTest, Deep1000)
+{
+	flush_test("Deep1000", 1000, 1, 1);
+}
+
+TEST_F(DepsgraphFlushPerformanceTest, Deep10000)
+{
+	flush_test("Deep10000", 10000, 1, 1);
+}
+
+/* Many levels of objects depending on multiple objects of previous level. */
+
+TEST_F(DepsgraphFlushPerformanceTest, Layered10000)
+{
+	flush_test("Layered10000", 100, 100, 4);
+}
+
+TEST_F(DepsgraphFlushPerformanceTest, Layered50000)
+{
+	flush_test("Layered50000", 200, 250, 4);
+}
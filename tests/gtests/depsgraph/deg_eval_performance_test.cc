@@ -0,0 +1,332 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "deg_synthetic_graph.h"
+
+extern "C" {
+#include "BLI_task.h"
+#include "PIL_time.h"
+}
+
+#include "intern/eval/deg_eval.h"
+#include "intern/eval/deg_eval_flush.h"
+
+/* Number of times evaluation is measured for every graph. */
+#define NUM_EVAL_RUNS 5
+
+/* Time spent by busy operations, in seconds. */
+#define BUSY_OPERATION_TIME 10e-6
+
+/* What synthetic operations are doing when evaluated. */
+typedef enum eOperationCost {
+	/* Operation has callback which returns right away, measures pure
+	 * scheduling overhead. */
+	OPERATION_COST_EMPTY,
+	/* Operation is spinning for BUSY_OPERATION_TIME. */
+	OPERATION_COST_BUSY,
+} eOperationCost;
+
+/* Measures how well evaluation of synthetic graphs is scheduled. For every
+ * graph the following is reported:
+ *
+ * - Scheduling overhead per operation: difference between wall time of the
+ *   evaluation and the best possible time (the bigger one of critical path and
+ *   total work split across all threads), divided by number of operations.
+ * - Thread utilization: total time spent in operations callbacks, relative to
+ *   wall time multiplied by number of threads.
+ * - Time to completion relative to critical path: 1.0 means evaluation was as
+ *   fast as the longest chain of dependent operations allows.
+ *
+ * Structural operations (roots, joins, done operations) have no callback, the
+ * same as their real counterparts, so they are never scheduled as tasks. */
+class DepsgraphEvalPerformanceTest : public DepsgraphSyntheticTest
+{
+protected:
+	eOperationCost cost;
+	/* Time spent in callback of every operation during last evaluation,
+	 * indexed the same way as graph operations. Negative for operations
+	 * which were not evaluated. */
+	std::vector<double> operation_time;
+	DEG::OperationNode *root_op;
+
+	virtual void SetUp()
+	{
+		DepsgraphSyntheticTest::SetUp();
+		cost = OPERATION_COST_EMPTY;
+		root_op = NULL;
+	}
+
+	void run_operation(int index)
+	{
+		const double start_time = PIL_check_seconds_timer();
+		double end_time = start_time;
+		if (cost == OPERATION_COST_BUSY) {
+			while (end_time - start_time < BUSY_OPERATION_TIME) {
+				end_time = PIL_check_seconds_timer();
+			}
+		}
+		else {
+			end_time = PIL_check_seconds_timer();
+		}
+		operation_time[index] = std::max(end_time - start_time, 0.0);
+	}
+
+	/* Operation which does some (configurable) work when evaluated. */
+	DEG::OperationNode *add_work_operation(DEG::ComponentNode *comp_node,
+	                                       DEG::OperationCode opcode,
+	                                       int name_tag = -1)
+	{
+		const int index = graph->operations.size();
+		operation_time.push_back(0.0);
+		return add_operation(
+		        comp_node,
+		        opcode,
+		        [this, index](::Depsgraph * /*depsgraph*/) { run_operation(index); },
+		        name_tag);
+	}
+
+	/* Operation without callback. */
+	DEG::OperationNode *add_noop_operation(DEG::ComponentNode *comp_node,
+	                                       DEG::OperationCode opcode,
+	                                       int name_tag = -1)
+	{
+		operation_time.push_back(0.0);
+		return add_operation(comp_node, opcode, NULL, name_tag);
+	}
+
+	DEG::ComponentNode *add_parameters_component(const char *name)
+	{
+		DEG::IDNode *id_node = add_id_node(name);
+		return id_node->add_component(DEG::NodeType::PARAMETERS);
+	}
+
+	/* Root followed by width independent operations. */
+	void build_wide(int width)
+	{
+		DEG::ComponentNode *comp_node = add_parameters_component("Wide");
+		root_op = add_noop_operation(comp_node, DEG::OperationCode::PARAMETERS_EVAL);
+		for (int i = 0; i < width; ++i) {
+			DEG::OperationNode *op_node = add_work_operation(
+			        comp_node, DEG::OperationCode::DRIVER, i);
+			add_relation(root_op, op_node);
+		}
+	}
+
+	/* Single chain of length dependent operations. */
+	void build_deep(int length)
+	{
+		DEG::ComponentNode *comp_node = add_parameters_component("Deep");
+		root_op = add_noop_operation(comp_node, DEG::OperationCode::PARAMETERS_EVAL);
+		DEG::OperationNode *prev_op = root_op;
+		for (int i = 0; i < length; ++i) {
+			DEG::OperationNode *op_node = add_work_operation(
+			        comp_node, DEG::OperationCode::DRIVER, i);
+			add_relation(prev_op, op_node);
+			prev_op = op_node;
+		}
+	}
+
+	/* Sequence of num_diamonds fork-join blocks of width operations each. */
+	void build_diamond(int num_diamonds, int width)
+	{
+		DEG::ComponentNode *comp_node = add_parameters_component("Diamond");
+		root_op = add_noop_operation(comp_node, DEG::OperationCode::PARAMETERS_EVAL);
+		DEG::OperationNode *fork_op = root_op;
+		int name_tag = 0;
+		for (int i = 0; i < num_diamonds; ++i) {
+			std::vector<DEG::OperationNode *> ops;
+			for (int j = 0; j < width; ++j) {
+				DEG::OperationNode *op_node = add_work_operation(
+				        comp_node, DEG::OperationCode::DRIVER, name_tag++);
+				add_relation(fork_op, op_node);
+				ops.push_back(op_node);
+			}
+			DEG::OperationNode *join_op = add_noop_operation(
+			        comp_node, DEG::OperationCode::ID_PROPERTY, i);
+			for (DEG::OperationNode *op_node : ops) {
+				add_relation(op_node, join_op);
+			}
+			fork_op = join_op;
+		}
+	}
+
+	/* Armature with num_chains chains of chain_length bones growing from a
+	 * common root bone. Every bone has local, pose parent, ready and done
+	 * operations, and depends on the ready state of its parent. */
+	void build_rig(int num_chains, int chain_length)
+	{
+		DEG::IDNode *id_node = add_id_node("Rig");
+		DEG::ComponentNode *pose_comp =
+		        id_node->add_component(DEG::NodeType::EVAL_POSE);
+		root_op = add_noop_operation(pose_comp, DEG::OperationCode::POSE_INIT);
+		pose_comp->set_entry_operation(root_op);
+		std::vector<DEG::OperationNode *> done_ops;
+		DEG::OperationNode *root_ready_op = NULL;
+		char name[64];
+		for (int chain = 0; chain < num_chains; ++chain) {
+			DEG::OperationNode *parent_ready_op = root_ready_op;
+			const int first_bone = (chain == 0) ? 0 : 1;
+			for (int bone = first_bone; bone < chain_length; ++bone) {
+				BLI_snprintf(name, sizeof(name), "Chain%d.Bone%d", chain, bone);
+				DEG::ComponentNode *bone_comp = id_node->add_component(
+				        DEG::NodeType::BONE, add_name(name));
+				DEG::OperationNode *local_op = add_work_operation(
+				        bone_comp, DEG::OperationCode::BONE_LOCAL);
+				DEG::OperationNode *pose_parent_op = add_work_operation(
+				        bone_comp, DEG::OperationCode::BONE_POSE_PARENT);
+				DEG::OperationNode *ready_op = add_noop_operation(
+				        bone_comp, DEG::OperationCode::BONE_READY);
+				DEG::OperationNode *done_op = add_work_operation(
+				        bone_comp, DEG::OperationCode::BONE_DONE);
+				add_relation(root_op, local_op, "Pose Init -> Bone Local");
+				add_relation(local_op, pose_parent_op, "Bone Local -> Pose Parent");
+				if (parent_ready_op != NULL) {
+					add_relation(parent_ready_op, pose_parent_op, "Parent Bone -> Child Bone");
+				}
+				add_relation(pose_parent_op, ready_op, "Pose Parent -> Ready");
+				add_relation(ready_op, done_op, "Ready -> Done");
+				done_ops.push_back(done_op);
+				parent_ready_op = ready_op;
+				if (root_ready_op == NULL) {
+					root_ready_op = ready_op;
+				}
+			}
+		}
+		DEG::OperationNode *pose_done_op =
+		        add_noop_operation(pose_comp, DEG::OperationCode::POSE_DONE);
+		pose_comp->set_exit_operation(pose_done_op);
+		for (DEG::OperationNode *done_op : done_ops) {
+			add_relation(done_op, pose_done_op, "Bone Done -> Pose Done");
+		}
+	}
+
+	/* Longest chain of operation times. Operations are created after all
+	 * operations they depend on, so a single pass is enough. */
+	double calculate_critical_path()
+	{
+		std::unordered_map<DEG::OperationNode *, int> op_index;
+		const int num_operations = graph->operations.size();
+		for (int i = 0; i < num_operations; ++i) {
+			op_index[graph->operations[i]] = i;
+		}
+		std::vector<double> path_time(num_operations, 0.0);
+		double critical_path = 0.0;
+		for (int i = 0; i < num_operations; ++i) {
+			double parents_time = 0.0;
+			for (DEG::Relation *rel : graph->operations[i]->inlinks) {
+				const int parent_index = op_index[(DEG::OperationNode *)rel->from];
+				BLI_assert(parent_index < i);
+				parents_time = std::max(parents_time, path_time[parent_index]);
+			}
+			path_time[i] = parents_time + std::max(operation_time[i], 0.0);
+			critical_path = std::max(critical_path, path_time[i]);
+		}
+		return critical_path;
+	}
+
+	void evaluate_and_report(const char *id, int num_threads)
+	{
+		const int num_operations = graph->operations.size();
+		double wall_time = 0.0, work_time = 0.0, critical_path = 0.0;
+		for (int run = 0; run < NUM_EVAL_RUNS; ++run) {
+			std::fill(operation_time.begin(), operation_time.end(), -1.0);
+			root_op->tag_update(graph, DEG::DEG_UPDATE_SOURCE_USER_EDIT);
+			DEG::deg_graph_flush_updates(bmain, graph);
+			const double start_time = PIL_check_seconds_timer();
+			DEG::deg_evaluate_on_refresh(graph);
+			wall_time += PIL_check_seconds_timer() - start_time;
+			for (int i = 0; i < num_operations; ++i) {
+				DEG::OperationNode *op_node = graph->operations[i];
+				if (op_node->is_noop()) {
+					continue;
+				}
+				EXPECT_GE(operation_time[i], 0.0);
+				work_time += std::max(operation_time[i], 0.0);
+			}
+			critical_path += calculate_critical_path();
+		}
+		wall_time /= NUM_EVAL_RUNS;
+		work_time /= NUM_EVAL_RUNS;
+		critical_path /= NUM_EVAL_RUNS;
+		const double best_time = std::max(critical_path, work_time / num_threads);
+		printf("%s (%d operations, %d threads):\n"
+		       "  Wall time: %.6f sec (critical path %.6f sec, total work %.6f sec)\n"
+		       "  Scheduling overhead per operation: %.3f usec\n"
+		       "  Thread utilization: %.1f%%\n"
+		       "  Time to completion relative to critical path: %.2f\n",
+		       id,
+		       num_operations,
+		       num_threads,
+		       wall_time,
+		       critical_path,
+		       work_time,
+		       std::max(0.0, wall_time - best_time) / num_operations * 1e6,
+		       work_time / (wall_time * num_threads) * 100.0,
+		       (critical_path > 0.0) ? wall_time / critical_path : 0.0);
+	}
+
+	void eval_test(const char *id, eOperationCost operation_cost)
+	{
+		finalize_graph();
+		cost = operation_cost;
+		const int debug = G.debug;
+		G.debug |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+		evaluate_and_report(id, 1);
+		G.debug = debug & ~G_DEBUG_DEPSGRAPH_NO_THREADS;
+		evaluate_and_report(
+		        id, BLI_task_scheduler_num_threads(BLI_task_scheduler_get()));
+		G.debug = debug;
+	}
+};
+
+TEST_F(DepsgraphEvalPerformanceTest, WideEmpty)
+{
+	build_wide(10000);
+	eval_test("WideEmpty", OPERATION_COST_EMPTY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, WideBusy)
+{
+	build_wide(10000);
+	eval_test("WideBusy", OPERATION_COST_BUSY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, DeepEmpty)
+{
+	build_deep(10000);
+	eval_test("DeepEmpty", OPERATION_COST_EMPTY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, DeepBusy)
+{
+	build_deep(10000);
+	eval_test("DeepBusy", OPERATION_COST_BUSY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, DiamondEmpty)
+{
+	build_diamond(100, 100);
+	eval_test("DiamondEmpty", OPERATION_COST_EMPTY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, DiamondBusy)
+{
+	build_diamond(100, 100);
+	eval_test("DiamondBusy", OPERATION_COST_BUSY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, RigEmpty)
+{
+	build_rig(64, 32);
+	eval_test("RigEmpty", OPERATION_COST_EMPTY);
+}
+
+TEST_F(DepsgraphEvalPerformanceTest, RigBusy)
+{
+	build_rig(64, 32);
+	eval_test("RigBusy", OPERATION_COST_BUSY);
+}
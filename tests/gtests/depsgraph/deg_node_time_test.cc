@@ -0,0 +1,64 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "deg_synthetic_graph.h"
+
+#include "intern/eval/deg_eval_flush.h"
+#include "intern/node/deg_node_time.h"
+
+/* Object animated by a constant action: the action is connected to the time
+ * source with a time invariant relation. */
+class DepsgraphTimeSourceTest : public DepsgraphSyntheticTest
+{
+protected:
+	DEG::TimeSourceNode *time_source;
+	DEG::IDNode *object_node;
+	DEG::OperationNode *action_op;
+	DEG::OperationNode *object_anim_op;
+
+	virtual void SetUp()
+	{
+		DepsgraphSyntheticTest::SetUp();
+		time_source = graph->add_time_source();
+		DEG::IDNode *action_node = add_id_node("Action", ID_AC);
+		action_op = add_operation(
+		        action_node->add_component(DEG::NodeType::ANIMATION),
+		        DEG::OperationCode::ANIMATION);
+		object_node = add_id_node("Object");
+		object_anim_op = add_operation(
+		        object_node->add_component(DEG::NodeType::ANIMATION),
+		        DEG::OperationCode::ANIMATION);
+		graph->add_new_relation(time_source,
+		                        action_op,
+		                        "TimeSrc -> Animation",
+		                        DEG::RELATION_FLAG_TIME_INVARIANT);
+		add_relation(action_op, object_anim_op, "Action -> Animation");
+		finalize_graph();
+	}
+
+	void tag_time()
+	{
+		DEG::deg_graph_clear_tags(graph);
+		time_source->tag_update(graph, DEG::DEG_UPDATE_SOURCE_TIME);
+	}
+};
+
+TEST_F(DepsgraphTimeSourceTest, ConstantActionSkipped)
+{
+	tag_time();
+	EXPECT_FALSE(action_op->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+	EXPECT_FALSE(object_anim_op->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+}
+
+TEST_F(DepsgraphTimeSourceTest, UserEditRevertedOnFrameChange)
+{
+	/* Property animated by the constant action was edited by the user. */
+	object_node->is_user_modified = true;
+	tag_time();
+	EXPECT_FALSE(action_op->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+	EXPECT_TRUE(object_anim_op->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+	/* Keyed value is restored, following frame changes skip it again. */
+	tag_time();
+	EXPECT_FALSE(object_anim_op->flag & DEG::DEPSOP_FLAG_NEEDS_UPDATE);
+}
@@ -0,0 +1,187 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+#include "BKE_anim.h"
+#include "BKE_collection.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "DNA_collection_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+}
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#define DUPLI_FLAGS (DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY | \
+                     DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | \
+                     DEG_ITER_OBJECT_FLAG_VISIBLE | \
+                     DEG_ITER_OBJECT_FLAG_DUPLI)
+
+/* Instanced object name and location of the instance. */
+typedef std::pair<std::string, std::vector<float> > Instance;
+
+static Instance make_instance(const Object *object, float matrix[4][4])
+{
+	return Instance(object->id.name, std::vector<float>(matrix[3], matrix[3] + 3));
+}
+
+/* Scene with an empty instancing a collection of two empties, each of them
+ * instancing a collection of two more objects. The dupli-list of the parent
+ * has two instances of every object. */
+class DepsgraphDupliBatchTest : public testing::Test
+{
+protected:
+	Main *bmain;
+	Scene *scene;
+	Depsgraph *depsgraph;
+	Object *parent, *nested[2], *instanced[2];
+
+	virtual void SetUp()
+	{
+		DEG_register_node_types();
+		bmain = BKE_main_new();
+		scene = BKE_scene_add(bmain, "Scene");
+
+		Collection *instanced_collection = BKE_collection_add(bmain, NULL, "Instanced");
+		for (int i = 0; i < 2; ++i) {
+			instanced[i] = add_object(instanced_collection, i ? "B" : "A");
+			instanced[i]->loc[i] = 1.0f;
+		}
+
+		Collection *nested_collection = BKE_collection_add(bmain, NULL, "Nested");
+		for (int i = 0; i < 2; ++i) {
+			nested[i] = add_object(nested_collection, i ? "NestedB" : "NestedA");
+			nested[i]->loc[2] = 10.0f * (i + 1);
+			set_instance_collection(nested[i], instanced_collection);
+		}
+
+		parent = add_object(scene->master_collection, "Parent");
+		set_instance_collection(parent, nested_collection);
+
+		ViewLayer *view_layer = (ViewLayer *)scene->view_layers.first;
+		depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_VIEWPORT);
+		DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+		DEG_graph_flush_update(bmain, depsgraph);
+		DEG_evaluate_on_refresh(depsgraph);
+	}
+
+	virtual void TearDown()
+	{
+		DEG_graph_free(depsgraph);
+		BKE_main_free(bmain);
+		DEG_free_node_types();
+	}
+
+	Object *add_object(Collection *collection, const char *name)
+	{
+		Object *object = BKE_object_add_only_object(bmain, OB_EMPTY, name);
+		BKE_collection_object_add(bmain, collection, object);
+		return object;
+	}
+
+	static void set_instance_collection(Object *object, Collection *collection)
+	{
+		object->transflag |= OB_DUPLICOLLECTION;
+		object->dup_group = collection;
+		id_us_plus(&collection->id);
+	}
+
+	std::vector<Instance> instances()
+	{
+		std::vector<Instance> result;
+		DEG_OBJECT_ITER_BEGIN(depsgraph, object, DUPLI_FLAGS)
+		{
+			if (data_.dupli_object_current != NULL) {
+				result.push_back(make_instance(object, object->obmat));
+			}
+		}
+		DEG_OBJECT_ITER_END;
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+};
+
+TEST_F(DepsgraphDupliBatchTest, BatchContents)
+{
+	std::vector<Instance> batched_instances;
+	int num_batches = 0;
+
+	DEG_OBJECT_ITER_BEGIN(depsgraph, object, DUPLI_FLAGS | DEG_ITER_OBJECT_FLAG_DUPLI_BATCH)
+	{
+		const DEGDupliBatch *batch = &data_.dupli_batch;
+		if (data_.dupli_object_current == NULL) {
+			/* Objects which are not instances have no batch. */
+			EXPECT_EQ(batch->num_instances, 0);
+			continue;
+		}
+		++num_batches;
+		/* Temporary object corresponds to the first instance. */
+		EXPECT_EQ(data_.dupli_object_current, batch->dupli_objects[0]);
+		for (int i = 0; i < batch->num_instances; ++i) {
+			const DupliObject *dob = batch->dupli_objects[i];
+			EXPECT_STREQ(dob->ob->id.name, object->id.name);
+			EXPECT_EQ(batch->random_ids[i], dob->random_id);
+			EXPECT_EQ(memcmp(batch->matrices[i], dob->mat, sizeof(dob->mat)), 0);
+			EXPECT_EQ(memcmp(batch->orcos[i], dob->orco, sizeof(dob->orco)), 0);
+			EXPECT_EQ(memcmp(batch->uvs[i], dob->uv, sizeof(dob->uv)), 0);
+			batched_instances.push_back(make_instance(object, batch->matrices[i]));
+		}
+	}
+	DEG_OBJECT_ITER_END;
+
+	/* One batch for the nested empties and one for every instanced object. */
+	EXPECT_EQ(num_batches, 3);
+
+	/* Same instances as reported one by one. */
+	std::sort(batched_instances.begin(), batched_instances.end());
+	EXPECT_EQ(batched_instances.size(), (size_t)6);
+	EXPECT_TRUE(batched_instances == instances());
+
+	/* Instances are placed by the nested empties. */
+	for (int i = 0; i < 2; ++i) {
+		for (int j = 0; j < 2; ++j) {
+			float location[3];
+			add_v3_v3v3(location, instanced[i]->loc, nested[j]->loc);
+			const Instance expected(instanced[i]->id.name,
+			                        std::vector<float>(location, location + 3));
+			EXPECT_EQ(std::count(batched_instances.begin(), batched_instances.end(), expected), 1)
+			        << instanced[i]->id.name << " in " << nested[j]->id.name;
+		}
+	}
+}
+
+TEST_F(DepsgraphDupliBatchTest, EarlyExit)
+{
+	const unsigned int num_blocks = MEM_get_memory_blocks_in_use();
+
+	/* Stop in the middle of the dupli-list, the batch storage and dupli-list
+	 * are to be freed by the end of iteration. */
+	int num_batches = 0;
+	DEG_OBJECT_ITER_BEGIN(depsgraph, object, DUPLI_FLAGS | DEG_ITER_OBJECT_FLAG_DUPLI_BATCH)
+	{
+		if (data_.dupli_batch.num_instances != 0) {
+			EXPECT_NE(data_.dupli_list, (ListBase *)NULL);
+			++num_batches;
+			break;
+		}
+		UNUSED_VARS(object);
+	}
+	DEG_OBJECT_ITER_END;
+
+	EXPECT_EQ(num_batches, 1);
+	EXPECT_EQ(MEM_get_memory_blocks_in_use(), num_blocks);
+}
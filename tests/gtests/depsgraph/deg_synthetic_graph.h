@@ -0,0 +1,120 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include <vector>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_string.h"
+#include "BKE_global.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "DNA_ID.h"
+#include "DNA_scene_types.h"
+}
+
+#include "DEG_depsgraph.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+/* Base for tests which work on synthetic dependency graphs: nodes and relations
+ * are created directly, without any real data or builders behind them.
+ *
+ * IDs are not added to the main database: ensuring unique names of so many
+ * datablocks would take longer than the actual test. */
+class DepsgraphSyntheticTest : public testing::Test
+{
+protected:
+	Main *bmain;
+	Scene scene;
+	Depsgraph *depsgraph;
+	DEG::Depsgraph *graph;
+	std::vector<ID *> ids;
+	/* Storage for names of components and operations, nodes only store the
+	 * pointer. */
+	std::vector<char *> names;
+
+	virtual void SetUp()
+	{
+		DEG_register_node_types();
+		bmain = BKE_main_new();
+		memset(&scene, 0, sizeof(scene));
+		BLI_strncpy(scene.id.name, "SCSynthetic", sizeof(scene.id.name));
+		depsgraph = DEG_graph_new(&scene, NULL, DAG_EVAL_VIEWPORT);
+		graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
+		/* There is no scene in the graph, use the original one as an already
+		 * expanded copy, so evaluation does not try to update it. */
+		graph->scene_cow = &scene;
+	}
+
+	virtual void TearDown()
+	{
+		DEG_graph_free(depsgraph);
+		for (ID *id : ids) {
+			MEM_freeN(id);
+		}
+		ids.clear();
+		for (char *name : names) {
+			MEM_freeN(name);
+		}
+		names.clear();
+		BKE_main_free(bmain);
+		DEG_free_node_types();
+	}
+
+	const char *add_name(const char *name)
+	{
+		names.push_back(BLI_strdup(name));
+		return names.back();
+	}
+
+	DEG::IDNode *add_id_node(const char *name, short id_type = ID_OB)
+	{
+		ID *id = (ID *)BKE_libblock_alloc_notest(id_type);
+		*((short *)id->name) = id_type;
+		BLI_strncpy(id->name + 2, name, sizeof(id->name) - 2);
+		ids.push_back(id);
+		return graph->add_id_node(id);
+	}
+
+	DEG::OperationNode *add_operation(
+	        DEG::ComponentNode *comp_node,
+	        DEG::OperationCode opcode,
+	        const DEG::DepsEvalOperationCb &op = NULL,
+	        int name_tag = -1)
+	{
+		DEG::OperationNode *op_node =
+		        comp_node->add_operation(op, opcode, "", name_tag);
+		graph->operations.push_back(op_node);
+		return op_node;
+	}
+
+	void add_relation(DEG::OperationNode *from,
+	                  DEG::OperationNode *to,
+	                  const char *description = "Synthetic")
+	{
+		graph->add_new_relation(from, to, description);
+	}
+
+	/* Make graph ready for flush and evaluation, counterpart of the build
+	 * finalization. Everything is considered visible. */
+	void finalize_graph()
+	{
+		for (DEG::IDNode *id_node : graph->id_nodes) {
+			id_node->finalize_build(graph);
+			GHASH_FOREACH_BEGIN(DEG::ComponentNode *, comp_node, id_node->components)
+			{
+				comp_node->affects_directly_visible = true;
+			}
+			GHASH_FOREACH_END();
+		}
+	}
+};